@@ -74,7 +74,8 @@ enum ImreadModes {
        IMREAD_REDUCED_COLOR_4      = 33, //!< If set, always convert image to the 3 channel BGR color image and the image size reduced 1/4.
        IMREAD_REDUCED_GRAYSCALE_8  = 64, //!< If set, always convert image to the single channel grayscale image and the image size reduced 1/8.
        IMREAD_REDUCED_COLOR_8      = 65, //!< If set, always convert image to the 3 channel BGR color image and the image size reduced 1/8.
-       IMREAD_IGNORE_ORIENTATION   = 128 //!< If set, do not rotate the image according to EXIF's orientation flag.
+       IMREAD_IGNORE_ORIENTATION   = 128, //!< If set, do not rotate the image according to EXIF's orientation flag.
+       IMREAD_RGB                  = 256  //!< If set, the color images are returned in the R G B channel order instead of B G R.
      };
 
 //! Imwrite flags
@@ -91,6 +92,7 @@ enum ImwriteFlags {
        IMWRITE_PXM_BINARY          = 32, //!< For PPM, PGM, or PBM, it can be a binary format flag, 0 or 1. Default value is 1.
        IMWRITE_WEBP_QUALITY        = 64, //!< For WEBP, it can be a quality from 1 to 100 (the higher is the better). By default (without any parameter) and for quality above 100 the lossless compression is used.
        IMWRITE_PAM_TUPLETYPE       = 128,//!< For PAM, sets the TUPLETYPE field to the corresponding string value that is defined for the format
+       IMWRITE_PARALLEL            = 65536 //!< For PNG and TIFF, 0 or 1. If 1, the parts of the image are compressed on the parallel threads. Default is 0. The value is above the 16-bit TIFF tag ids, which the TIFF encoder accepts as parameters.
      };
 
 //! Imwrite PNG specific flags used to tune the compression algorithm.
@@ -160,6 +162,10 @@ Currently, the following file formats are supported:
     [Vector](http://www.gdal.org/ogr_formats.html).
 -   If EXIF information are embedded in the image file, the EXIF orientation will be taken into account
     and thus the image will be rotated accordingly except if the flag @ref IMREAD_IGNORE_ORIENTATION is passed.
+-   The files of the formats that can be decoded from memory are mapped (mmap on POSIX systems, file
+    mapping on Windows) and decoded as the memory buffers. The mapping can be disabled by setting the
+    OPENCV_IMGCODECS_MMAP environment variable to 0, for example, when the files may be truncated
+    while being read.
 @param filename Name of file to be loaded.
 @param flags Flag that can take values of cv::ImreadModes
 */
@@ -175,6 +181,143 @@ The function imreadmulti loads a multi-page image from the specified file into a
 */
 CV_EXPORTS_W bool imreadmulti(const String& filename, CV_OUT std::vector<Mat>& mats, int flags = IMREAD_ANYCOLOR);
 
+/** @brief Reads the pages of a multi-page image one at a time.
+
+Unlike cv::imreadmulti, only the requested pages are decoded, so the memory does not grow with the
+number of pages. The reader is created by cv::imreadPages or cv::imdecodePages.
+*/
+class CV_EXPORTS PageReader
+{
+public:
+    virtual ~PageReader();
+
+    /** @brief Decodes the current page and moves to the next one.
+    @param page The decoded page.
+    @return false if there are no more pages or the page can not be decoded.
+    */
+    virtual bool read( OutputArray page ) = 0;
+
+    /** @brief Moves to the page with the given index, so that it is returned by the next read.
+
+    The TIFF directories are located directly, the other multi-page formats are reached by reading
+    the headers of the preceding pages.
+    @return false if there is no such page; the position is not changed then.
+    */
+    virtual bool seek( int index ) = 0;
+
+    /** @brief Returns the index of the page returned by the next read. */
+    virtual int position() const = 0;
+
+    /** @brief Returns the number of pages. The headers of all the pages are read on the first call. */
+    virtual int count() = 0;
+
+    /** @brief Enables the prefetching of the following page.
+
+    When it is enabled, read starts decoding the following page by another decoder instance on a
+    background thread before returning, so that the decoding overlaps with the processing of the
+    returned page. The next read in order waits for it and returns it without decoding. The pages are
+    decoded on demand if OpenCV is built without C++11 support.
+    */
+    virtual void setPrefetch( bool prefetch ) = 0;
+};
+
+/** @brief Opens a multi-page image file for reading the pages on demand.
+
+@param filename Name of file to be loaded.
+@param flags Flag that can take values of cv::ImreadModes, except the reduced modes (IMREAD_REDUCED_*).
+The EXIF orientation is applied to every page, as in cv::imreadmulti.
+@return The reader, or an empty pointer if the format is not supported or the header can not be read.
+@sa cv::imreadmulti, cv::imdecodePages
+*/
+CV_EXPORTS Ptr<PageReader> imreadPages( const String& filename, int flags = IMREAD_ANYCOLOR );
+
+/** @brief Loads a rectangular part of an image from a file.
+
+The function decodes only the pixels inside roi. The TIFF images are read by the tiles or strips that
+intersect the rectangle, and the JPEG images are decoded only up to the bottom of the rectangle. The
+other formats are decoded entirely and then cropped.
+
+@param filename Name of file to be loaded.
+@param roi The rectangle to decode, in the coordinates of the selected level. It is clipped to the image.
+@param flags Flag that can take values of cv::ImreadModes. The reduced modes (IMREAD_REDUCED_*) are
+not supported, and the EXIF orientation is not applied.
+@param level Index of the page to read, for example the level of a pyramidal TIFF image where each
+level is stored as a separate directory.
+@return The image of the clipped roi size, or an empty matrix if the image or the level can not be read
+or roi does not intersect the image.
+@sa cv::imread, cv::imdecodeROI
+*/
+CV_EXPORTS_W Mat imreadROI( const String& filename, const Rect& roi, int flags = IMREAD_COLOR, int level = 0 );
+
+/** @brief Loads a list of images from files in parallel.
+
+The images are decoded on all the available threads. Each thread reuses one decoder instance per
+format for its consecutive images, and the matrices already present in mats are reused when they
+have the decoded size and type.
+
+@param filenames Names of the files to be loaded.
+@param mats The decoded images, in the order of filenames. The images that can not be read are empty.
+@param flags Flag that can take values of cv::ImreadModes, except the reduced modes (IMREAD_REDUCED_*).
+@param dsize If not empty, the images are resized to this size with cv::INTER_AREA. The JPEG images
+are downscaled by 2, 4 or 8 while decoding when the result still covers dsize. The EXIF orientation
+is applied after resizing.
+@return true if all the images have been decoded.
+@sa cv::imread, cv::imdecodeBatch
+*/
+CV_EXPORTS_W bool imreadBatch( const std::vector<String>& filenames, CV_OUT std::vector<Mat>& mats,
+                               int flags = IMREAD_COLOR, Size dsize = Size() );
+
+/** @brief Loads an image downscaled to fit into the given size.
+
+The image is scaled with the preserved aspect ratio, so that it fits into maxSize; the smaller images
+are not enlarged. The JPEG images are downscaled by 2, 4 or 8 with the DCT scaling and the WebP images
+are shrunk while decoding, as long as the result still covers the target size. The rest of the
+reduction is done by cv::resize with cv::INTER_AREA, so the time is mostly spent on decoding the
+reduced image.
+
+@param filename Name of file to be loaded.
+@param maxSize The maximum size of the output image, after the EXIF orientation is applied.
+@param flags Flag that can take values of cv::ImreadModes, except the reduced modes (IMREAD_REDUCED_*).
+@return The downscaled image, or an empty matrix if the image can not be read.
+@sa cv::imread, cv::imdecodeThumbnail
+*/
+CV_EXPORTS_W Mat imreadThumbnail( const String& filename, Size maxSize, int flags = IMREAD_COLOR );
+
+/** @brief The image properties read from the file header, see cv::imreadHeader.
+*/
+struct CV_EXPORTS ImageHeader
+{
+    ImageHeader();
+
+    int width;       //!< width of the first page, before the EXIF orientation is applied
+    int height;      //!< height of the first page, before the EXIF orientation is applied
+    int type;        //!< type of the first page read with cv::IMREAD_UNCHANGED, so CV_MAT_CN(type) and CV_MAT_DEPTH(type) give the channels and the depth; -1 if unknown
+    int pages;       //!< number of pages (TIFF directories), 1 for the single page formats
+    int orientation; //!< EXIF orientation from 1 to 8, 1 (no transformation) if the image has no EXIF data
+};
+
+/** @brief Reads the image properties without decoding the pixels.
+
+Only the header of the file is parsed, together with the directories of the following pages and the
+EXIF data, so the function is much cheaper than cv::imread.
+
+@param filename Name of the file.
+@param header The image properties.
+@return true if the format is supported and the header has been read.
+@sa cv::imdecodeHeader, cv::imreadHeaderBatch
+*/
+CV_EXPORTS bool imreadHeader( const String& filename, ImageHeader& header );
+
+/** @brief Reads the properties of a list of images in parallel.
+
+@param filenames Names of the files.
+@param headers The image properties, in the order of filenames. The properties of the images that
+can not be read are left with the default values (zero width and height).
+@return true if all the headers have been read.
+@sa cv::imreadHeader, cv::imdecodeHeaderBatch
+*/
+CV_EXPORTS bool imreadHeaderBatch( const std::vector<String>& filenames, std::vector<ImageHeader>& headers );
+
 /** @brief Saves an image to a specified file.
 
 The function imwrite saves the image to the specified file. The image format is chosen based on the
@@ -260,6 +403,85 @@ reallocations when the function is called repeatedly for images of the same size
 */
 CV_EXPORTS Mat imdecode( InputArray buf, int flags, Mat* dst);
 
+/** @brief Reads an image from a buffer in memory into the given matrix.
+
+Unlike cv::imdecode, the function never reallocates dst when it is not empty, so the image can be
+decoded directly into a preallocated buffer, including a part of a bigger matrix with an arbitrary
+step. The EXIF orientation is not applied.
+
+@param buf Input array or vector of bytes.
+@param dst The destination. If it is empty, it is allocated. Otherwise it must have the size and
+type of the decoded image, or for the planar output the size (width, height*channels) and the depth
+of the decoded image with one channel.
+@param flags The same flags as in cv::imread, see cv::ImreadModes. With cv::IMREAD_RGB the JPEG,
+PNG and WebP decoders produce the R G B order natively.
+@param planar If true, the channels of the color image are stored as the separate planes one under
+another (the CHW layout). The JPEG decoder writes the planes natively, the other formats are decoded
+to a temporary image and split.
+@return true if the image has been decoded.
+*/
+CV_EXPORTS bool imdecodeInto( InputArray buf, Mat& dst, int flags = IMREAD_COLOR, bool planar = false );
+
+/** @brief Reads a rectangular part of an image from a buffer in memory.
+
+The function is the in-memory counterpart of cv::imreadROI.
+
+@param buf Input array or vector of bytes.
+@param roi The rectangle to decode, in the coordinates of the selected level.
+@param flags The same flags as in cv::imreadROI.
+@param level Index of the page to read.
+*/
+CV_EXPORTS_W Mat imdecodeROI( InputArray buf, const Rect& roi, int flags = IMREAD_COLOR, int level = 0 );
+
+/** @brief Reads a list of images from buffers in memory in parallel.
+
+The function is the in-memory counterpart of cv::imreadBatch.
+
+@param bufs Input arrays or vectors of bytes.
+@param mats The decoded images, in the order of bufs. The images that can not be read are empty.
+@param flags The same flags as in cv::imreadBatch.
+@param dsize The optional size of the output images, see cv::imreadBatch.
+*/
+CV_EXPORTS_W bool imdecodeBatch( InputArrayOfArrays bufs, CV_OUT std::vector<Mat>& mats,
+                                 int flags = IMREAD_COLOR, Size dsize = Size() );
+
+/** @brief Reads an image from a buffer in memory downscaled to fit into the given size.
+
+The function is the in-memory counterpart of cv::imreadThumbnail.
+
+@param buf Input array or vector of bytes.
+@param maxSize The maximum size of the output image, see cv::imreadThumbnail.
+@param flags The same flags as in cv::imreadThumbnail.
+*/
+CV_EXPORTS_W Mat imdecodeThumbnail( InputArray buf, Size maxSize, int flags = IMREAD_COLOR );
+
+/** @brief Reads the properties of an image in a memory buffer without decoding the pixels.
+
+The function is the in-memory counterpart of cv::imreadHeader.
+
+@param buf Input array or vector of bytes.
+@param header The image properties.
+*/
+CV_EXPORTS bool imdecodeHeader( InputArray buf, ImageHeader& header );
+
+/** @brief Reads the properties of a list of images in memory buffers in parallel.
+
+The function is the in-memory counterpart of cv::imreadHeaderBatch.
+
+@param bufs Input arrays or vectors of bytes.
+@param headers The image properties, in the order of bufs.
+*/
+CV_EXPORTS bool imdecodeHeaderBatch( InputArrayOfArrays bufs, std::vector<ImageHeader>& headers );
+
+/** @brief Opens a multi-page image in a memory buffer for reading the pages on demand.
+
+The function is the in-memory counterpart of cv::imreadPages.
+
+@param buf Input array or vector of bytes. It is not copied and must stay valid while the reader is used.
+@param flags The same flags as in cv::imreadPages.
+*/
+CV_EXPORTS Ptr<PageReader> imdecodePages( InputArray buf, int flags = IMREAD_ANYCOLOR );
+
 /** @brief Encodes an image into a memory buffer.
 
 The function imencode compresses the image and stores it in the memory buffer that is resized to fit the
@@ -0,0 +1,67 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+namespace
+{
+
+// Writes a set of images of the mixed formats to the temporary files
+static vector<String> writeMixedImages(int count)
+{
+    const string exts[] = { ".jpg", ".png", ".bmp", ".tiff" };
+    vector<String> filenames;
+    RNG& rng = theRNG();
+    for (int i = 0; i < count; i++)
+    {
+        Mat img(480, 640, CV_8UC3);
+        rng.fill(img, RNG::UNIFORM, 0, 256);
+        GaussianBlur(img, img, Size(9, 9), 0);
+        filenames.push_back(cv::tempfile(exts[i % 4].c_str()));
+        imwrite(filenames.back(), img);
+    }
+    return filenames;
+}
+
+static void removeFiles(const vector<String>& filenames)
+{
+    for (size_t i = 0; i < filenames.size(); i++)
+        remove(filenames[i].c_str());
+}
+
+}
+
+typedef TestBaseWithParam<Size> Imgcodecs_Batch;
+
+PERF_TEST_P(Imgcodecs_Batch, imread_loop, testing::Values(Size(), Size(160, 120)))
+{
+    Size dsize = GetParam();
+    vector<String> filenames = writeMixedImages(32);
+    vector<Mat> mats(filenames.size());
+
+    TEST_CYCLE()
+    {
+        for (size_t i = 0; i < filenames.size(); i++)
+        {
+            mats[i] = imread(filenames[i]);
+            if (dsize.area() > 0)
+                resize(mats[i], mats[i], dsize, 0, 0, INTER_AREA);
+        }
+    }
+
+    removeFiles(filenames);
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Imgcodecs_Batch, imreadBatch, testing::Values(Size(), Size(160, 120)))
+{
+    Size dsize = GetParam();
+    vector<String> filenames = writeMixedImages(32);
+    vector<Mat> mats;
+
+    TEST_CYCLE() imreadBatch(filenames, mats, IMREAD_COLOR, dsize);
+
+    removeFiles(filenames);
+    SANITY_CHECK_NOTHING();
+}
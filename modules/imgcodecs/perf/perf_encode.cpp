@@ -0,0 +1,41 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::get;
+
+CV_ENUM(ParallelMode, 0, 1)
+
+typedef std::tr1::tuple<string, MatType, ParallelMode> Ext_Type_Parallel_t;
+typedef TestBaseWithParam<Ext_Type_Parallel_t> Imgcodecs_Encode;
+
+PERF_TEST_P(Imgcodecs_Encode, imencode,
+            testing::Combine(
+                testing::Values(string(".png"), string(".tiff")),
+                testing::Values(CV_8UC3, CV_16UC1),
+                ParallelMode::all()))
+{
+    string ext = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int parallel = get<2>(GetParam());
+
+    Mat img(2160, 3840, type);
+    randu(img, 0, CV_MAT_DEPTH(type) == CV_8U ? 256 : 65536);
+    GaussianBlur(img, img, Size(9, 9), 0);
+    declare.in(img);
+
+    vector<int> params;
+    params.push_back(IMWRITE_PARALLEL);
+    params.push_back(parallel);
+    if (ext == ".tiff")
+    {
+        params.push_back(259); // TIFFTAG_COMPRESSION
+        params.push_back(8);   // Deflate
+    }
+    vector<uchar> buf;
+
+    TEST_CYCLE() imencode(ext, img, buf, params);
+
+    SANITY_CHECK_NOTHING();
+}
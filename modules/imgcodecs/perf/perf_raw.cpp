@@ -0,0 +1,44 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::get;
+
+typedef std::tr1::tuple<string, MatType> Ext_Type_t;
+typedef TestBaseWithParam<Ext_Type_t> Imgcodecs_Raw;
+
+#define RAW_FORMATS testing::Values( \
+    Ext_Type_t(".pgm", CV_16UC1), Ext_Type_t(".ppm", CV_8UC3), Ext_Type_t(".ppm", CV_16UC3), \
+    Ext_Type_t(".pam", CV_16UC1), Ext_Type_t(".bmp", CV_8UC3))
+
+PERF_TEST_P(Imgcodecs_Raw, imencode, RAW_FORMATS)
+{
+    string ext = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat img(1080, 1920, type);
+    randu(img, 0, CV_MAT_DEPTH(type) == CV_8U ? 256 : 65536);
+    declare.in(img);
+    vector<uchar> buf;
+
+    TEST_CYCLE() imencode(ext, img, buf);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Imgcodecs_Raw, imdecode, RAW_FORMATS)
+{
+    string ext = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat img(1080, 1920, type), dst;
+    randu(img, 0, CV_MAT_DEPTH(type) == CV_8U ? 256 : 65536);
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(ext, img, buf));
+    declare.in(buf);
+
+    TEST_CYCLE() dst = imdecode(buf, IMREAD_UNCHANGED);
+
+    SANITY_CHECK_NOTHING();
+}
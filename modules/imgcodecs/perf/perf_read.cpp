@@ -0,0 +1,27 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+typedef TestBaseWithParam<string> Imgcodecs_Read;
+
+// OPENCV_IMGCODECS_MMAP=0 gives the baseline with the stdio reads
+PERF_TEST_P(Imgcodecs_Read, imread, testing::Values(string(".jpg"), string(".png"), string(".bmp"),
+                                                    string(".tiff"), string(".webp")))
+{
+    Mat img(2448, 3264, CV_8UC3);
+    randu(img, 0, 256);
+    GaussianBlur(img, img, Size(9, 9), 0);
+    string filename = cv::tempfile(GetParam().c_str());
+    vector<int> params;
+    params.push_back(IMWRITE_WEBP_QUALITY); // lossy WebP, ignored by the other codecs
+    params.push_back(90);
+    ASSERT_TRUE(imwrite(filename, img, params));
+    Mat dst;
+
+    TEST_CYCLE() dst = imread(filename, IMREAD_UNCHANGED);
+
+    remove(filename.c_str());
+    SANITY_CHECK_NOTHING();
+}
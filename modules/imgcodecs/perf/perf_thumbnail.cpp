@@ -0,0 +1,44 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+typedef TestBaseWithParam<string> Imgcodecs_Thumbnail;
+
+static vector<uchar> encodeLargeImage(const string& ext)
+{
+    Mat img(2448, 3264, CV_8UC3);
+    randu(img, 0, 256);
+    GaussianBlur(img, img, Size(9, 9), 0);
+    vector<int> params;
+    params.push_back(IMWRITE_WEBP_QUALITY); // lossy WebP, ignored by JPEG
+    params.push_back(90);
+    vector<uchar> buf;
+    imencode(ext, img, buf, params);
+    return buf;
+}
+
+PERF_TEST_P(Imgcodecs_Thumbnail, imdecode_resize, testing::Values(string(".jpg"), string(".webp")))
+{
+    vector<uchar> buf = encodeLargeImage(GetParam());
+    Mat img, thumb;
+
+    TEST_CYCLE()
+    {
+        img = imdecode(buf, IMREAD_COLOR);
+        resize(img, thumb, Size(256, 192), 0, 0, INTER_AREA);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Imgcodecs_Thumbnail, imdecodeThumbnail, testing::Values(string(".jpg"), string(".webp")))
+{
+    vector<uchar> buf = encodeLargeImage(GetParam());
+    Mat thumb;
+
+    TEST_CYCLE() thumb = imdecodeThumbnail(buf, Size(256, 256));
+
+    SANITY_CHECK_NOTHING();
+}
@@ -469,6 +469,18 @@ void WLByteStream::putBytes( const void* buffer, int count )
 
     assert( data && m_current && count >= 0 );
 
+    // the spans larger than a block go straight to the file or the buffer
+    if( count >= m_block_size )
+    {
+        writeBlock();
+        if( m_buf )
+            m_buf->insert( m_buf->end(), data, data + count );
+        else
+            fwrite( data, 1, count, m_file );
+        m_block_pos += count;
+        return;
+    }
+
     while( count )
     {
         int l = (int)(m_end - m_current);
@@ -0,0 +1,136 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "filemap.hpp"
+#include "opencv2/core/utils/configuration.private.hpp"
+
+#if defined _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <windows.h>
+#  define HAVE_FILE_MAPPING 1
+#elif defined __unix__ || defined __APPLE__
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  define HAVE_FILE_MAPPING 1
+#endif
+
+namespace cv
+{
+
+MappedFile::MappedFile() : m_data(0), m_size(0)
+{
+#ifdef _WIN32
+    m_mapping = 0;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::isEnabled()
+{
+    static bool enabled = utils::getConfigurationParameterBool("OPENCV_IMGCODECS_MMAP", true);
+    return enabled;
+}
+
+#if defined _WIN32 && !defined WINRT
+
+bool MappedFile::open( const String& filename )
+{
+    close();
+
+    HANDLE file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+    if( file == INVALID_HANDLE_VALUE )
+        return false;
+
+    LARGE_INTEGER size;
+    if( GetFileSizeEx( file, &size ) && size.QuadPart > 0 && (unsigned long long)size.QuadPart <= (size_t)INT_MAX )
+    {
+        m_mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+        if( m_mapping )
+        {
+            m_data = (uchar*)MapViewOfFile( (HANDLE)m_mapping, FILE_MAP_READ, 0, 0, 0 );
+            m_size = m_data ? (size_t)size.QuadPart : 0;
+        }
+    }
+    CloseHandle( file );
+
+    if( !m_data )
+        close();
+    return m_data != 0;
+}
+
+void MappedFile::close()
+{
+    if( m_data )
+        UnmapViewOfFile( m_data );
+    if( m_mapping )
+        CloseHandle( (HANDLE)m_mapping );
+    m_data = 0;
+    m_size = 0;
+    m_mapping = 0;
+}
+
+#elif defined HAVE_FILE_MAPPING && !defined _WIN32
+
+bool MappedFile::open( const String& filename )
+{
+    close();
+
+    int fd = ::open( filename.c_str(), O_RDONLY );
+    if( fd < 0 )
+        return false;
+
+    // the empty files can not be mapped, and the matrix size is limited by int
+    struct stat st;
+    if( fstat( fd, &st ) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && st.st_size <= INT_MAX )
+    {
+        void* ptr = mmap( 0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if( ptr != MAP_FAILED )
+        {
+            m_data = (uchar*)ptr;
+            m_size = (size_t)st.st_size;
+            // the decoders read the data mostly from the beginning to the end
+            posix_madvise( ptr, m_size, POSIX_MADV_SEQUENTIAL );
+        }
+    }
+    ::close( fd );
+    return m_data != 0;
+}
+
+void MappedFile::close()
+{
+    if( m_data )
+        munmap( m_data, m_size );
+    m_data = 0;
+    m_size = 0;
+}
+
+#else
+
+bool MappedFile::open( const String& )
+{
+    return false;
+}
+
+void MappedFile::close()
+{
+}
+
+#endif
+
+Mat MappedFile::data() const
+{
+    return m_data ? Mat( 1, (int)m_size, CV_8U, m_data ) : Mat();
+}
+
+}
@@ -0,0 +1,44 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef _OPENCV_FILEMAP_HPP_
+#define _OPENCV_FILEMAP_HPP_
+
+namespace cv
+{
+
+/**
+ * Read-only memory mapping of a whole file. The mapped contents are exposed as a 1xN CV_8U
+ * matrix, so they can be given to the decoders that read from memory.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    /** Maps the file; returns false if the file can not be mapped on this platform */
+    bool open( const String& filename );
+    void close();
+
+    /** The matrix header over the mapped data, valid until the file is closed */
+    Mat data() const;
+
+    /** Whether imread maps the files, controlled by OPENCV_IMGCODECS_MMAP (default is on) */
+    static bool isEnabled();
+
+private:
+    MappedFile( const MappedFile& );
+    MappedFile& operator = ( const MappedFile& );
+
+    uchar* m_data;
+    size_t m_size;
+#ifdef _WIN32
+    void* m_mapping;
+#endif
+};
+
+}
+
+#endif /* _OPENCV_FILEMAP_HPP_ */
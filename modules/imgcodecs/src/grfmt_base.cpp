@@ -53,12 +53,17 @@ BaseImageDecoder::BaseImageDecoder()
     m_type = -1;
     m_buf_supported = false;
     m_scale_denom = 1;
+    m_scale_supported = false;
+    m_use_rgb = m_rgb_supported = false;
+    m_planar = m_planar_supported = false;
 }
 
 bool BaseImageDecoder::setSource( const String& filename )
 {
     m_filename = filename;
     m_buf.release();
+    m_roi = Rect();
+    m_use_rgb = m_planar = false;
     return true;
 }
 
@@ -68,6 +73,8 @@ bool BaseImageDecoder::setSource( const Mat& buf )
         return false;
     m_filename = String();
     m_buf = buf;
+    m_roi = Rect();
+    m_use_rgb = m_planar = false;
     return true;
 }
 
@@ -89,6 +96,27 @@ int BaseImageDecoder::setScale( const int& scale_denom )
     return temp;
 }
 
+bool BaseImageDecoder::setROI( const Rect& )
+{
+    return false;
+}
+
+bool BaseImageDecoder::setRGB( bool useRGB )
+{
+    if( !m_rgb_supported )
+        return false;
+    m_use_rgb = useRGB;
+    return true;
+}
+
+bool BaseImageDecoder::setPlanar( bool planar )
+{
+    if( !m_planar_supported )
+        return false;
+    m_planar = planar;
+    return true;
+}
+
 ImageDecoder BaseImageDecoder::newDecoder() const
 {
     return ImageDecoder();
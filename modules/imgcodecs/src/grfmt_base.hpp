@@ -68,12 +68,34 @@ public:
     virtual bool setSource( const String& filename );
     virtual bool setSource( const Mat& buf );
     virtual int setScale( const int& scale_denom );
+
+    /// Returns true if the decoder applies the scale set by setScale when reading the header,
+    /// so that the header has to be read again after changing the scale.
+    bool scaleSupported() const { return m_scale_supported; }
     virtual bool readHeader() = 0;
     virtual bool readData( Mat& img ) = 0;
 
+    /// Called after readHeader to decode only the given part of the image, then readData
+    /// expects the image of the rectangle size. Returns false if the decoder can only
+    /// decode the whole image.
+    virtual bool setROI( const Rect& roi );
+
+    /// Called after readHeader to get the color images in the R G B channel order instead of
+    /// B G R. Returns false if the decoder does not support it.
+    virtual bool setRGB( bool useRGB );
+
+    /// Called after readHeader to get the channels as separate planes, then readData expects
+    /// the single-channel image with the planes stored one under another. Returns false if
+    /// the decoder does not support it.
+    virtual bool setPlanar( bool planar );
+
     /// Called after readData to advance to the next page, if any.
     virtual bool nextPage() { return false; }
 
+    /// Called after readHeader to move to the page with the given index and read its header.
+    /// Returns false if there is no such page or if the decoder can only advance by nextPage.
+    virtual bool setPage( int /*index*/ ) { return false; }
+
     virtual size_t signatureLength() const;
     virtual bool checkSignature( const String& signature ) const;
     virtual ImageDecoder newDecoder() const;
@@ -83,10 +105,16 @@ protected:
     int  m_height; // height of the image ( filled by readHeader )
     int  m_type;
     int  m_scale_denom;
+    bool m_scale_supported;
+    Rect m_roi;    // the decoded part of the image, empty if the whole image is decoded
     String m_filename;
     String m_signature;
     Mat m_buf;
     bool m_buf_supported;
+    bool m_use_rgb;       // set by setRGB
+    bool m_rgb_supported;
+    bool m_planar;        // set by setPlanar
+    bool m_planar_supported;
 };
 
 
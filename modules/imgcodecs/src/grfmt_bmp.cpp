@@ -465,11 +465,15 @@ decode_rle8_bad: ;
         case 24:
             for( y = 0; y < m_height; y++, data += step )
             {
+                if( color )
+                {
+                    // the rows are stored as BGR already, only the padding is skipped
+                    m_strm.getBytes( data, m_width*3 );
+                    m_strm.skip( src_pitch - m_width*3 );
+                    continue;
+                }
                 m_strm.getBytes( src, src_pitch );
-                if(!color)
-                    icvCvt_BGR2Gray_8u_C3C1R( src, 0, data, 0, cvSize(m_width,1) );
-                else
-                    memcpy( data, src, m_width*3 );
+                icvCvt_BGR2Gray_8u_C3C1R( src, 0, data, 0, cvSize(m_width,1) );
             }
             result = true;
             break;
@@ -477,14 +481,17 @@ decode_rle8_bad: ;
         case 32:
             for( y = 0; y < m_height; y++, data += step )
             {
+                if( img.channels() == 4 )
+                {
+                    m_strm.getBytes( data, src_pitch );
+                    continue;
+                }
                 m_strm.getBytes( src, src_pitch );
 
                 if( !color )
                     icvCvt_BGRA2Gray_8u_C4C1R( src, 0, data, 0, cvSize(m_width,1) );
-                else if( img.channels() == 3 )
+                else
                     icvCvt_BGRA2BGR_8u_C4C3R(src, 0, data, 0, cvSize(m_width, 1));
-                else if( img.channels() == 4 )
-                    memcpy(data, src, m_width * 4);
             }
             result = true;
             break;
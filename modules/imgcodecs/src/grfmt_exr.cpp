@@ -58,6 +58,7 @@
 #include <ImfChannelList.h>
 #include <ImfStandardAttributes.h>
 #include <half.h>
+#include <Iex.h>
 #include "grfmt_exr.hpp"
 
 #if defined _WIN32
@@ -74,12 +75,75 @@
 namespace cv
 {
 
+// The EXR file in the imdecode buffer. The stream is memory mapped, so
+// the uncompressed files are read without copying the data.
+class ExrMemIStream : public IStream
+{
+public:
+    ExrMemIStream( const uchar* data, size_t size )
+        : IStream( "" ), m_data( (char*)data ), m_size( size ), m_pos( 0 ) {}
+
+    bool isMemoryMapped() const { return true; }
+
+    bool read( char c[], int n )
+    {
+        memcpy( c, readMemoryMapped( n ), n );
+        return m_pos < m_size;
+    }
+
+    char* readMemoryMapped( int n )
+    {
+        if( n < 0 || (size_t)n > m_size - m_pos )
+            throw Iex::InputExc( "Unexpected end of file." );
+        char* ptr = m_data + m_pos;
+        m_pos += n;
+        return ptr;
+    }
+
+    Int64 tellg() { return m_pos; }
+
+    void seekg( Int64 pos )
+    {
+        if( pos > m_size )
+            throw Iex::InputExc( "Invalid seek offset." );
+        m_pos = (size_t)pos;
+    }
+
+private:
+    char* m_data;
+    size_t m_size, m_pos;
+};
+
+// Writes the EXR file into the imencode buffer
+class ExrVectorOStream : public OStream
+{
+public:
+    ExrVectorOStream( std::vector<uchar>& buf ) : OStream( "" ), m_buf( buf ), m_pos( 0 ) {}
+
+    void write( const char c[], int n )
+    {
+        if( m_pos + n > m_buf.size() )
+            m_buf.resize( m_pos + n );
+        memcpy( &m_buf[m_pos], c, n );
+        m_pos += n;
+    }
+
+    Int64 tellp() { return m_pos; }
+    void seekp( Int64 pos ) { m_pos = (size_t)pos; }
+
+private:
+    std::vector<uchar>& m_buf;
+    size_t m_pos;
+};
+
 /////////////////////// ExrDecoder ///////////////////
 
 ExrDecoder::ExrDecoder()
 {
     m_signature = "\x76\x2f\x31\x01";
     m_file = 0;
+    m_stream = 0;
+    m_buf_supported = true;
     m_red = m_green = m_blue = 0;
     m_type = ((Imf::PixelType)0);
     m_iscolor = false;
@@ -104,6 +168,11 @@ void  ExrDecoder::close()
         delete m_file;
         m_file = 0;
     }
+    if( m_stream )
+    {
+        delete m_stream;
+        m_stream = 0;
+    }
 }
 
 
@@ -117,7 +186,16 @@ bool  ExrDecoder::readHeader()
 {
     bool result = false;
 
-    m_file = new InputFile( m_filename.c_str() );
+    // the decoder may be reused for another image
+    close();
+
+    if( !m_buf.empty() )
+    {
+        m_stream = new ExrMemIStream( m_buf.ptr(), m_buf.total()*m_buf.elemSize() );
+        m_file = new InputFile( *m_stream );
+    }
+    else
+        m_file = new InputFile( m_filename.c_str() );
 
     if( !m_file ) // probably paranoid
         return false;
@@ -570,6 +648,7 @@ ImageDecoder ExrDecoder::newDecoder() const
 ExrEncoder::ExrEncoder()
 {
     m_description = "OpenEXR Image files (*.exr)";
+    m_buf_supported = true;
 }
 
 
@@ -618,7 +697,17 @@ bool  ExrEncoder::write( const Mat& img, const std::vector<int>& )
         //printf("gray\n");
     }
 
-    OutputFile file( m_filename.c_str(), header );
+    // the output file is finalized by the destructor, so it must be destroyed before the stream
+    Ptr<ExrVectorOStream> stream;
+    Ptr<OutputFile> pfile;
+    if( m_buf )
+    {
+        stream.reset( new ExrVectorOStream( *m_buf ) );
+        pfile.reset( new OutputFile( *stream, header ) );
+    }
+    else
+        pfile.reset( new OutputFile( m_filename.c_str(), header ) );
+    OutputFile& file = *pfile;
 
     FrameBuffer frame;
 
@@ -53,10 +53,21 @@ HdrDecoder::HdrDecoder()
     m_signature_alt = "#?RADIANCE";
     file = NULL;
     m_type = CV_32FC3;
+    m_buf_supported = true;
 }
 
 HdrDecoder::~HdrDecoder()
 {
+    close();
+}
+
+void HdrDecoder::close()
+{
+    m_stream.release();
+    if(file) {
+        fclose(file);
+        file = NULL;
+    }
 }
 
 size_t HdrDecoder::signatureLength() const
@@ -67,14 +78,19 @@ size_t HdrDecoder::signatureLength() const
 
 bool  HdrDecoder::readHeader()
 {
-    file = fopen(m_filename.c_str(), "rb");
-    if(!file) {
-        return false;
+    close();
+    if(!m_buf.empty()) {
+        m_stream = makePtr<RGBEStream>(m_buf.ptr(), m_buf.total() * m_buf.elemSize());
+    } else {
+        file = fopen(m_filename.c_str(), "rb");
+        if(!file) {
+            return false;
+        }
+        m_stream = makePtr<RGBEStream>(file);
     }
-    RGBE_ReadHeader(file, &m_width, &m_height, NULL);
+    RGBE_ReadHeader(m_stream.get(), &m_width, &m_height, NULL);
     if(m_width <= 0 || m_height <= 0) {
-        fclose(file);
-        file = NULL;
+        close();
         return false;
     }
     return true;
@@ -83,13 +99,13 @@ bool  HdrDecoder::readHeader()
 bool HdrDecoder::readData(Mat& _img)
 {
     Mat img(m_height, m_width, CV_32FC3);
-    if(!file) {
+    if(!m_stream) {
         if(!readHeader()) {
             return false;
         }
     }
-    RGBE_ReadPixels_RLE(file, const_cast<float*>(img.ptr<float>()), img.cols, img.rows);
-    fclose(file); file = NULL;
+    RGBE_ReadPixels_RLE(m_stream.get(), const_cast<float*>(img.ptr<float>()), img.cols, img.rows);
+    close();
 
     if(_img.depth() == img.depth()) {
         img.convertTo(_img, _img.type());
@@ -116,6 +132,7 @@ ImageDecoder HdrDecoder::newDecoder() const
 HdrEncoder::HdrEncoder()
 {
     m_description = "Radiance HDR (*.hdr;*.pic)";
+    m_buf_supported = true;
 }
 
 HdrEncoder::~HdrEncoder()
@@ -136,19 +153,27 @@ bool HdrEncoder::write( const Mat& input_img, const std::vector<int>& params )
         img.convertTo(img, CV_32FC3, 1/255.0f);
     }
     CV_Assert(params.empty() || params[0] == HDR_NONE || params[0] == HDR_RLE);
-    FILE *fout = fopen(m_filename.c_str(), "wb");
-    if(!fout) {
-        return false;
+    FILE *fout = NULL;
+    if(!m_buf) {
+        fout = fopen(m_filename.c_str(), "wb");
+        if(!fout) {
+            return false;
+        }
+    } else {
+        m_buf->reserve(img.total() * 4 + 128);
     }
+    RGBEStream strm = m_buf ? RGBEStream(m_buf) : RGBEStream(fout);
 
-    RGBE_WriteHeader(fout, img.cols, img.rows, NULL);
+    RGBE_WriteHeader(&strm, img.cols, img.rows, NULL);
     if(params.empty() || params[0] == HDR_RLE) {
-        RGBE_WritePixels_RLE(fout, const_cast<float*>(img.ptr<float>()), img.cols, img.rows);
+        RGBE_WritePixels_RLE(&strm, const_cast<float*>(img.ptr<float>()), img.cols, img.rows);
     } else {
-        RGBE_WritePixels(fout, const_cast<float*>(img.ptr<float>()), img.cols * img.rows);
+        RGBE_WritePixels(&strm, const_cast<float*>(img.ptr<float>()), img.cols * img.rows);
     }
 
-    fclose(fout);
+    if(fout) {
+        fclose(fout);
+    }
     return true;
 }
 
@@ -44,6 +44,7 @@
 #define _GRFMT_HDR_H_
 
 #include "grfmt_base.hpp"
+#include "rgbe.hpp"
 
 namespace cv
 {
@@ -62,12 +63,14 @@ public:
     ~HdrDecoder();
     bool readHeader();
     bool readData( Mat& img );
+    void close();
     bool checkSignature( const String& signature ) const;
     ImageDecoder newDecoder() const;
     size_t signatureLength() const;
 protected:
     String m_signature_alt;
     FILE *file;
+    Ptr<RGBEStream> m_stream;
 };
 
 // ... writer
@@ -177,6 +177,9 @@ JpegDecoder::JpegDecoder()
     m_state = 0;
     m_f = 0;
     m_buf_supported = true;
+    m_rgb_supported = true;
+    m_planar_supported = true;
+    m_scale_supported = true;
 }
 
 
@@ -393,11 +396,29 @@ int my_jpeg_load_dht (struct jpeg_decompress_struct *info, unsigned char *dht,
  * based on a message of Laurent Pinchart on the video4linux mailing list
  ***************************************************************************/
 
+bool JpegDecoder::setROI( const Rect& roi )
+{
+    m_roi = roi;
+    return true;
+}
+
+// Stores the interleaved row as the rows of the separate planes
+static void scatterPlanes( const uchar* src, int width, int cn, const int* order, uchar** planes )
+{
+    for( int c = 0; c < cn; c++ )
+    {
+        const uchar* s = src + order[c];
+        uchar* d = planes[c];
+        for( int x = 0; x < width; x++, s += cn )
+            d[x] = *s;
+    }
+}
+
 bool  JpegDecoder::readData( Mat& img )
 {
     volatile bool result = false;
-    size_t step = img.step;
-    bool color = img.channels() > 1;
+    // the planar image holds the planes of the ROI height one under another
+    Rect roi = m_roi.area() > 0 ? m_roi : Rect(0, 0, m_width, m_height);
 
     if( m_state && m_width && m_height )
     {
@@ -407,6 +428,9 @@ bool  JpegDecoder::readData( Mat& img )
 
         if( setjmp( jerr->setjmp_buffer ) == 0 )
         {
+            int dcn = m_planar ? img.rows / roi.height : img.channels();
+            bool color = dcn > 1;
+
             /* check if this is a mjpeg image format */
             if ( cinfo->ac_huff_tbl_ptrs[0] == NULL &&
                 cinfo->ac_huff_tbl_ptrs[1] == NULL &&
@@ -453,28 +477,65 @@ bool  JpegDecoder::readData( Mat& img )
             buffer = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
                                               JPOOL_IMAGE, m_width*4, 1 );
 
-            uchar* data = img.ptr();
-            for( ; m_height--; data += step )
+            // the scanlines below the ROI are not decoded at all, the ones above it are
+            // decoded and skipped, libjpeg can not seek within the entropy coded data
+            CV_Assert( m_planar ? img.size() == Size(roi.width, roi.height*dcn) && img.channels() == 1 :
+                                  img.size() == roi.size() );
+            int cn = cinfo->out_color_components;
+            AutoBuffer<uchar> _row( m_planar ? roi.width*3 : 0 );
+            const int same_order[] = { 0, 1, 2 }, swapped_order[] = { 2, 1, 0 };
+            for( int y = 0; y < roi.y + roi.height; y++ )
             {
                 jpeg_read_scanlines( cinfo, buffer, 1 );
+                if( y < roi.y )
+                    continue;
+
+                const uchar* src = buffer[0] + roi.x*cn;
+                int dy = y - roi.y;
+                if( m_planar && color )
+                {
+                    uchar* planes[] = { img.ptr(dy), img.ptr(dy + roi.height), img.ptr(dy + roi.height*2) };
+                    if( cn == 3 )
+                        scatterPlanes( src, roi.width, 3, m_use_rgb ? same_order : swapped_order, planes );
+                    else
+                    {
+                        icvCvt_CMYK2BGR_8u_C4C3R( src, 0, _row, 0, cvSize(roi.width,1) );
+                        scatterPlanes( _row, roi.width, 3, m_use_rgb ? swapped_order : same_order, planes );
+                    }
+                    continue;
+                }
+
+                uchar* data = img.ptr(dy);
                 if( color )
                 {
-                    if( cinfo->out_color_components == 3 )
-                        icvCvt_RGB2BGR_8u_C3R( buffer[0], 0, data, 0, cvSize(m_width,1) );
+                    if( cn == 3 )
+                    {
+                        if( m_use_rgb )
+                            memcpy( data, src, roi.width*3 );
+                        else
+                            icvCvt_RGB2BGR_8u_C3R( src, 0, data, 0, cvSize(roi.width,1) );
+                    }
                     else
-                        icvCvt_CMYK2BGR_8u_C4C3R( buffer[0], 0, data, 0, cvSize(m_width,1) );
+                    {
+                        icvCvt_CMYK2BGR_8u_C4C3R( src, 0, data, 0, cvSize(roi.width,1) );
+                        if( m_use_rgb )
+                            icvCvt_BGR2RGB_8u_C3R( data, 0, data, 0, cvSize(roi.width,1) );
+                    }
                 }
                 else
                 {
-                    if( cinfo->out_color_components == 1 )
-                        memcpy( data, buffer[0], m_width );
+                    if( cn == 1 )
+                        memcpy( data, src, roi.width );
                     else
-                        icvCvt_CMYK2Gray_8u_C4C1R( buffer[0], 0, data, 0, cvSize(m_width,1) );
+                        icvCvt_CMYK2Gray_8u_C4C1R( src, 0, data, 0, cvSize(roi.width,1) );
                 }
             }
 
             result = true;
-            jpeg_finish_decompress( cinfo );
+            if( roi.y + roi.height < m_height )
+                jpeg_abort_decompress( cinfo );
+            else
+                jpeg_finish_decompress( cinfo );
         }
     }
 
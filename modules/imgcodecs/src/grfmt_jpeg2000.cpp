@@ -80,6 +80,7 @@ Jpeg2KDecoder::Jpeg2KDecoder()
     m_signature = '\0' + String() + '\0' + String() + '\0' + String("\x0cjP  \r\n\x87\n");
     m_stream = 0;
     m_image = 0;
+    m_buf_supported = true;
 }
 
 
@@ -113,7 +114,10 @@ bool  Jpeg2KDecoder::readHeader()
     bool result = false;
 
     close();
-    jas_stream_t* stream = jas_stream_fopen( m_filename.c_str(), "rb" );
+    // the memory stream only reads the buffer, it is neither copied nor freed by jasper
+    jas_stream_t* stream = !m_buf.empty() ?
+        jas_stream_memopen( (char*)m_buf.ptr(), (int)(m_buf.total()*m_buf.elemSize()) ) :
+        jas_stream_fopen( m_filename.c_str(), "rb" );
     m_stream = stream;
 
     if( stream )
@@ -417,6 +421,7 @@ bool  Jpeg2KDecoder::readComponent16u( unsigned short *data, void *_buffer,
 Jpeg2KEncoder::Jpeg2KEncoder()
 {
     m_description = "JPEG-2000 files (*.jp2)";
+    m_buf_supported = true;
 }
 
 
@@ -476,11 +481,24 @@ bool  Jpeg2KEncoder::write( const Mat& _img, const std::vector<int>& )
         result = writeComponent16u( img, _img );
     if( result )
     {
-        jas_stream_t *stream = jas_stream_fopen( m_filename.c_str(), "wb" );
+        // the memory stream grows as needed, its content is copied to the output buffer
+        jas_stream_t *stream = m_buf ? jas_stream_memopen( 0, 0 ) :
+                                       jas_stream_fopen( m_filename.c_str(), "wb" );
+        result = stream != 0;
         if( stream )
         {
             result = !jas_image_encode( img, stream, jas_image_strtofmt( (char*)"jp2" ), (char*)"" );
 
+            if( result && m_buf )
+            {
+                long len = jas_stream_flush( stream ) == 0 ? jas_stream_length( stream ) : -1;
+                result = len > 0 && jas_stream_rewind( stream ) == 0;
+                if( result )
+                {
+                    m_buf->resize( len );
+                    result = jas_stream_read( stream, &(*m_buf)[0], (int)len ) == len;
+                }
+            }
             jas_stream_close( stream );
         }
 
@@ -522,18 +522,18 @@ bool  PAMDecoder::readData( Mat& img )
             {
                 for (y = 0; y < m_height; y++, data += imp_stride )
                 {
-                    m_strm.getBytes( src, src_stride );
-                    for( x = 0; x < src_elems_per_row; x++ )
-                    {
-                        uchar v = src[x * 2];
-                        data[x * 2] = src[x * 2 + 1];
-                        data[x * 2 + 1] = v;
-                    }
+                    m_strm.getBytes( data, src_stride );
+                    icvCvt_SwapBytes_16u_C1R( (ushort *)data, 0, (ushort *)data, 0,
+                        cvSize(src_elems_per_row, 1) );
                 }
             }
-            else {
+            else if (img.isContinuous()) {
                 m_strm.getBytes( data, src_stride * m_height );
             }
+            else {
+                for (y = 0; y < m_height; y++, data += imp_stride )
+                    m_strm.getBytes( data, src_stride );
+            }
 
         }
         else {
@@ -566,14 +566,8 @@ bool  PAMDecoder::readData( Mat& img )
 
                     /* endianess correction */
                     if( m_sampledepth == CV_16U && !isBigEndian() )
-                    {
-                        for( x = 0; x < src_elems_per_row; x++ )
-                        {
-                            uchar v = src[x * 2];
-                            src[x * 2] = src[x * 2 + 1];
-                            src[x * 2 + 1] = v;
-                        }
-                    }
+                        icvCvt_SwapBytes_16u_C1R( (ushort *)src, 0, (ushort *)src, 0,
+                            cvSize(src_elems_per_row, 1) );
 
                     /* scale down */
                     if( img.depth() == CV_8U && m_sampledepth == CV_16U )
@@ -655,7 +649,7 @@ bool PAMEncoder::write( const Mat& img, const std::vector<int>& params )
     int stride = width*(int)img.elemSize();
     const uchar* data = img.ptr();
     const struct pam_format *fmt = NULL;
-    int x, y, tmp, bufsize = 256;
+    int y, tmp, bufsize = 256;
 
     /* parse save file type */
     for( size_t i = 0; i < params.size(); i += 2 )
@@ -695,25 +689,20 @@ bool PAMEncoder::write( const Mat& img, const std::vector<int>& params )
 
     strm.putBytes( buffer, (int)strlen(buffer) );
     /* write data */
-    if (img.depth() == CV_8U)
-        strm.putBytes( data, stride*height );
-    else if (img.depth() == CV_16U) {
+    CV_Assert (img.depth() == CV_8U || img.depth() == CV_16U);
+    if (img.depth() == CV_16U && !isBigEndian()) {
         /* fix endianess */
-        if (!isBigEndian()) {
-            for( y = 0; y < height; y++ ) {
-                memcpy( buffer, img.ptr(y), stride );
-                for( x = 0; x < stride; x += 2 )
-                {
-                    uchar v = buffer[x];
-                    buffer[x] = buffer[x + 1];
-                    buffer[x + 1] = v;
-                }
-                strm.putBytes( buffer, stride );
-            }
-        } else
-            strm.putBytes( data, stride*height );
-    } else
-        assert (0);
+        for( y = 0; y < height; y++ ) {
+            icvCvt_SwapBytes_16u_C1R( img.ptr<ushort>(y), 0, (ushort *)buffer, 0,
+                cvSize(width*img.channels(), 1) );
+            strm.putBytes( buffer, stride );
+        }
+    } else if (img.isContinuous())
+        strm.putBytes( data, stride*height );
+    else {
+        for( y = 0; y < height; y++ )
+            strm.putBytes( img.ptr(y), stride );
+    }
 
     strm.close();
     return true;
@@ -90,6 +90,7 @@ PngDecoder::PngDecoder()
     m_info_ptr = m_end_info = 0;
     m_f = 0;
     m_buf_supported = true;
+    m_rgb_supported = true;
     m_buf_pos = 0;
     m_bit_depth = 0;
 }
@@ -269,7 +270,10 @@ bool  PngDecoder::readData( Mat& img )
 #endif
 
             if( (m_color_type & PNG_COLOR_MASK_COLOR) && color )
-                png_set_bgr( png_ptr ); // convert RGB to BGR
+            {
+                if( !m_use_rgb )
+                    png_set_bgr( png_ptr ); // convert RGB to BGR
+            }
             else if( color )
                 png_set_gray_to_rgb( png_ptr ); // Gray->RGB
             else
@@ -336,6 +340,218 @@ void PngEncoder::flushBuf(void*)
 {
 }
 
+// Converts an image row to the PNG sample layout: RGB(A) order and big-endian 16-bit samples
+static void pngPackRow( const Mat& img, int y, uchar* dst )
+{
+    int cn = img.channels(), n = img.cols*cn;
+
+    if( img.depth() == CV_8U )
+    {
+        const uchar* src = img.ptr(y);
+        if( cn < 3 )
+            memcpy( dst, src, n );
+        else
+            for( int x = 0; x < n; x += cn )
+            {
+                dst[x] = src[x+2]; dst[x+1] = src[x+1]; dst[x+2] = src[x];
+                if( cn == 4 )
+                    dst[x+3] = src[x+3];
+            }
+    }
+    else
+    {
+        const ushort* src = img.ptr<ushort>(y);
+        for( int x = 0; x < n; x += cn )
+            for( int c = 0; c < cn; c++ )
+            {
+                ushort v = src[x + (cn >= 3 && c < 3 ? 2 - c : c)];
+                dst[(x + c)*2] = (uchar)(v >> 8);
+                dst[(x + c)*2 + 1] = (uchar)v;
+            }
+    }
+}
+
+static inline int pngPaeth( int a, int b, int c )
+{
+    int p = b - c, q = a - c;
+    int pa = std::abs(p), pb = std::abs(q), pc = std::abs(p + q);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+// Writes the filter type byte followed by the filtered row; prev is the previous row or zeros
+static void pngFilterRow( int filter, const uchar* row, const uchar* prev, int len, int bpp, uchar* dst )
+{
+    int i;
+    *dst++ = (uchar)filter;
+
+    switch( filter )
+    {
+    case PNG_FILTER_VALUE_NONE:
+        memcpy( dst, row, len );
+        break;
+    case PNG_FILTER_VALUE_SUB:
+        for( i = 0; i < bpp; i++ )
+            dst[i] = row[i];
+        for( ; i < len; i++ )
+            dst[i] = (uchar)(row[i] - row[i-bpp]);
+        break;
+    case PNG_FILTER_VALUE_UP:
+        for( i = 0; i < len; i++ )
+            dst[i] = (uchar)(row[i] - prev[i]);
+        break;
+    case PNG_FILTER_VALUE_AVG:
+        for( i = 0; i < bpp; i++ )
+            dst[i] = (uchar)(row[i] - (prev[i] >> 1));
+        for( ; i < len; i++ )
+            dst[i] = (uchar)(row[i] - ((row[i-bpp] + prev[i]) >> 1));
+        break;
+    default:
+        for( i = 0; i < bpp; i++ )
+            dst[i] = (uchar)(row[i] - prev[i]);
+        for( ; i < len; i++ )
+            dst[i] = (uchar)(row[i] - pngPaeth(row[i-bpp], prev[i], prev[i-bpp]));
+    }
+}
+
+// Deflates the filtered rows of a range of chunks. Every chunk is an independent raw deflate
+// stream terminated by the sync flush (the last one by Z_FINISH), so the streams can simply be
+// concatenated into a single zlib stream. The Adler-32 checksums are combined by the caller.
+class PngDeflateInvoker : public ParallelLoopBody
+{
+public:
+    PngDeflateInvoker( const Mat& _img, int _chunkRows, int _level, int _strategy, bool _adaptive,
+                       std::vector<std::vector<uchar> >& _chunks, std::vector<uLong>& _adlers )
+        : img(_img), chunkRows(_chunkRows), level(_level), strategy(_strategy),
+          adaptive(_adaptive), chunks(&_chunks), adlers(&_adlers) {}
+
+    virtual void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+            deflateChunk(i);
+    }
+
+private:
+    void deflateChunk( int idx ) const
+    {
+        int y0 = idx*chunkRows, y1 = std::min(y0 + chunkRows, img.rows);
+        int bpp = (int)img.elemSize(), rowBytes = img.cols*bpp;
+        AutoBuffer<uchar> _buf(rowBytes*2 + (rowBytes + 1)*5);
+        uchar *prev = _buf, *cur = prev + rowBytes, *filtered = cur + rowBytes;
+
+        if( y0 > 0 )
+            pngPackRow( img, y0 - 1, prev );
+        else
+            memset( prev, 0, rowBytes );
+
+        z_stream strm;
+        memset( &strm, 0, sizeof(strm) );
+        if( deflateInit2( &strm, level, Z_DEFLATED, -MAX_WBITS, 8, strategy ) != Z_OK )
+            CV_Error( CV_StsError, "Can not initialize the deflate stream" );
+
+        std::vector<uchar>& dst = (*chunks)[idx];
+        dst.resize( deflateBound( &strm, (uLong)(rowBytes + 1)*(y1 - y0) ) + 64 );
+        strm.next_out = &dst[0];
+        strm.avail_out = (uInt)dst.size();
+        uLong adler = adler32( 0, 0, 0 );
+
+        for( int y = y0; y < y1; y++ )
+        {
+            pngPackRow( img, y, cur );
+
+            const uchar* row = filtered;
+            if( adaptive )
+            {
+                // the minimum sum of absolute differences heuristic, as in libpng
+                int bestSum = INT_MAX;
+                for( int f = PNG_FILTER_VALUE_NONE; f <= PNG_FILTER_VALUE_PAETH; f++ )
+                {
+                    uchar* d = filtered + f*(rowBytes + 1);
+                    pngFilterRow( f, cur, prev, rowBytes, bpp, d );
+                    int sum = 0;
+                    for( int i = 1; i <= rowBytes; i++ )
+                        sum += std::abs((int)(schar)d[i]);
+                    if( sum < bestSum )
+                    {
+                        bestSum = sum;
+                        row = d;
+                    }
+                }
+            }
+            else
+                pngFilterRow( PNG_FILTER_VALUE_SUB, cur, prev, rowBytes, bpp, filtered );
+
+            adler = adler32( adler, row, rowBytes + 1 );
+            strm.next_in = (Bytef*)row;
+            strm.avail_in = rowBytes + 1;
+            int flush = y + 1 < y1 ? Z_NO_FLUSH : y1 == img.rows ? Z_FINISH : Z_SYNC_FLUSH;
+            do
+            {
+                if( strm.avail_out == 0 )
+                {
+                    size_t used = dst.size();
+                    dst.resize( used*2 );
+                    strm.next_out = &dst[used];
+                    strm.avail_out = (uInt)(dst.size() - used);
+                }
+                deflate( &strm, flush );
+            }
+            while( strm.avail_in > 0 || strm.avail_out == 0 );
+
+            std::swap( prev, cur );
+        }
+
+        dst.resize( strm.total_out );
+        deflateEnd( &strm );
+        (*adlers)[idx] = adler;
+    }
+
+    Mat img;
+    int chunkRows, level, strategy;
+    bool adaptive;
+    std::vector<std::vector<uchar> >* chunks;
+    std::vector<uLong>* adlers;
+};
+
+// Writes the image data as IDAT chunks compressed in parallel, followed by IEND
+static void pngWriteParallel( png_structp png_ptr, const Mat& img, int level, int strategy, bool adaptive )
+{
+    int rowBytes = img.cols*(int)img.elemSize();
+    int chunkRows = std::max((1 << 18)/(rowBytes + 1), 1);
+    int nchunks = (img.rows + chunkRows - 1)/chunkRows;
+    std::vector<std::vector<uchar> > chunks(nchunks);
+    std::vector<uLong> adlers(nchunks);
+
+    parallel_for_( Range(0, nchunks),
+                   PngDeflateInvoker(img, chunkRows, level, strategy, adaptive, chunks, adlers),
+                   nchunks );
+
+    // zlib header with the compression level hint
+    int flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    int cmf = 0x78, flg = flevel << 6;
+    flg += 31 - (cmf*256 + flg) % 31;
+
+    std::vector<uchar> zdata;
+    zdata.push_back( (uchar)cmf );
+    zdata.push_back( (uchar)flg );
+
+    uLong adler = adler32( 0, 0, 0 );
+    for( int i = 0; i < nchunks; i++ )
+    {
+        int rows = std::min(chunkRows, img.rows - i*chunkRows);
+        zdata.insert( zdata.end(), chunks[i].begin(), chunks[i].end() );
+        adler = adler32_combine( adler, adlers[i], (z_off_t)(rowBytes + 1)*rows );
+        std::vector<uchar>().swap( chunks[i] );
+    }
+    for( int k = 3; k >= 0; k-- )
+        zdata.push_back( (uchar)(adler >> (k*8)) );
+
+    const size_t maxChunkSize = 1 << 20;
+    for( size_t pos = 0; pos < zdata.size(); pos += maxChunkSize )
+        png_write_chunk( png_ptr, (png_bytep)"IDAT", &zdata[pos],
+                         std::min(maxChunkSize, zdata.size() - pos) );
+    png_write_chunk( png_ptr, (png_bytep)"IEND", 0, 0 );
+}
+
 bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
 {
     png_structp png_ptr = png_create_write_struct( PNG_LIBPNG_VER_STRING, 0, 0, 0 );
@@ -372,6 +588,7 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                 int compression_level = -1; // Invalid value to allow setting 0-9 as valid
                 int compression_strategy = IMWRITE_PNG_STRATEGY_RLE; // Default strategy
                 bool isBilevel = false;
+                bool parallel = false;
 
                 for( size_t i = 0; i < params.size(); i += 2 )
                 {
@@ -390,6 +607,10 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                     {
                         isBilevel = params[i+1] != 0;
                     }
+                    if( params[i] == IMWRITE_PARALLEL )
+                    {
+                        parallel = params[i+1] != 0;
+                    }
                 }
 
                 if( m_buf || f )
@@ -415,21 +636,31 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
 
                     png_write_info( png_ptr, info_ptr );
 
-                    if (isBilevel)
-                        png_set_packing(png_ptr);
+                    if( parallel && !isBilevel )
+                    {
+                        pngWriteParallel( png_ptr, img,
+                                          compression_level >= 0 ? compression_level : Z_BEST_SPEED,
+                                          compression_strategy, compression_level >= 0 );
+                        result = true;
+                    }
+                    else
+                    {
+                        if (isBilevel)
+                            png_set_packing(png_ptr);
 
-                    png_set_bgr( png_ptr );
-                    if( !isBigEndian() )
-                        png_set_swap( png_ptr );
+                        png_set_bgr( png_ptr );
+                        if( !isBigEndian() )
+                            png_set_swap( png_ptr );
 
-                    buffer.allocate(height);
-                    for( y = 0; y < height; y++ )
-                        buffer[y] = img.data + y*img.step;
+                        buffer.allocate(height);
+                        for( y = 0; y < height; y++ )
+                            buffer[y] = img.data + y*img.step;
 
-                    png_write_image( png_ptr, buffer );
-                    png_write_end( png_ptr, info_ptr );
+                        png_write_image( png_ptr, buffer );
+                        png_write_end( png_ptr, info_ptr );
 
-                    result = true;
+                        result = true;
+                    }
                 }
             }
         }
@@ -279,9 +279,26 @@ bool PxMDecoder::readData( Mat& img )
         {
             AutoBuffer<uchar> _src(std::max<size_t>(width3*2, src_pitch));
             uchar* src = _src;
+            // the binary rows of the same depth and channels are read straight into the image
+            bool direct = m_binary && img.depth() == CV_MAT_DEPTH(m_type) && color == (m_bpp == 24);
 
             for (int y = 0; y < m_height; y++, data += img.step)
             {
+                if( direct )
+                {
+                    m_strm.getBytes( data, src_pitch );
+                    if( bit_depth == 16 && !isBigEndian() )
+                        icvCvt_SwapBytes_16u_C1R( (ushort *)data, 0, (ushort *)data, 0, cvSize(width3,1) );
+                    if( color )
+                    {
+                        if( bit_depth == 8 )
+                            icvCvt_RGB2BGR_8u_C3R( data, 0, data, 0, cvSize(m_width,1) );
+                        else
+                            icvCvt_RGB2BGR_16u_C3R( (ushort *)data, 0, (ushort *)data, 0, cvSize(m_width,1) );
+                    }
+                    continue;
+                }
+
                 if( !m_binary )
                 {
                     for (int x = 0; x < width3; x++)
@@ -298,14 +315,7 @@ bool PxMDecoder::readData( Mat& img )
                 {
                     m_strm.getBytes( src, src_pitch );
                     if( bit_depth == 16 && !isBigEndian() )
-                    {
-                        for (int x = 0; x < width3; x++)
-                        {
-                            uchar v = src[x * 2];
-                            src[x * 2] = src[x * 2 + 1];
-                            src[x * 2 + 1] = v;
-                        }
-                    }
+                        icvCvt_SwapBytes_16u_C1R( (ushort *)src, 0, (ushort *)src, 0, cvSize(width3,1) );
                 }
 
                 if( img.depth() == CV_8U && bit_depth == 16 )
@@ -446,10 +456,22 @@ bool  PxMEncoder::write( const Mat& img, const std::vector<int>& params )
 
     strm.putBytes( buffer, (int)strlen(buffer) );
 
-    for( y = 0; y < height; y++ )
+    // the rows that need no conversion are written as is, all at once when the image is continuous
+    bool direct = isBinary && _channels == 1 && (depth == 8 || isBigEndian());
+    if( direct && img.isContinuous() && (double)fileStep*height < INT_MAX )
+    {
+        strm.putBytes( img.ptr(), fileStep*height );
+        y = height;
+    }
+    else
+        y = 0;
+
+    for( ; y < height; y++ )
     {
         const uchar* const data = img.ptr(y);
-        if( isBinary )
+        if( direct )
+            strm.putBytes( data, fileStep );
+        else if( isBinary )
         {
             if( _channels == 3 )
             {
@@ -463,16 +485,8 @@ bool  PxMEncoder::write( const Mat& img, const std::vector<int>& params )
 
             // swap endianness if necessary
             if( depth == 16 && !isBigEndian() )
-            {
-                if( _channels == 1 )
-                    memcpy( buffer, data, fileStep );
-                for( x = 0; x < width*channels*2; x += 2 )
-                {
-                    uchar v = buffer[x];
-                    buffer[x] = buffer[x + 1];
-                    buffer[x + 1] = v;
-                }
-            }
+                icvCvt_SwapBytes_16u_C1R( (const ushort*)(_channels == 1 ? (const char*)data : buffer), 0,
+                                          (ushort*)buffer, 0, cvSize(width*channels,1) );
             strm.putBytes( (channels > 1 || depth > 8) ? buffer : (const char*)data, fileStep );
         }
         else
@@ -58,6 +58,7 @@ SunRasterDecoder::SunRasterDecoder()
     m_encoding = RAS_STANDARD;
     m_maptype = RMT_NONE;
     m_maplength = 0;
+    m_buf_supported = true;
 }
 
 
@@ -80,7 +81,13 @@ bool  SunRasterDecoder::readHeader()
 {
     bool result = false;
 
-    if( !m_strm.open( m_filename )) return false;
+    if( !m_buf.empty() )
+    {
+        if( !m_strm.open( m_buf ) )
+            return false;
+    }
+    else if( !m_strm.open( m_filename ))
+        return false;
 
     try
     {
@@ -387,6 +394,7 @@ bad_decoding_end:
 SunRasterEncoder::SunRasterEncoder()
 {
     m_description = "Sun raster files (*.sr;*.ras)";
+    m_buf_supported = true;
 }
 
 
@@ -401,29 +409,33 @@ SunRasterEncoder::~SunRasterEncoder()
 
 bool  SunRasterEncoder::write( const Mat& img, const std::vector<int>& )
 {
-    bool result = false;
     int y, width = img.cols, height = img.rows, channels = img.channels();
     int fileStep = (width*channels + 1) & -2;
     WMByteStream  strm;
 
-    if( strm.open(m_filename) )
+    if( m_buf )
     {
-        strm.putBytes( fmtSignSunRas, (int)strlen(fmtSignSunRas) );
-        strm.putDWord( width );
-        strm.putDWord( height );
-        strm.putDWord( channels*8 );
-        strm.putDWord( fileStep*height );
-        strm.putDWord( RAS_STANDARD );
-        strm.putDWord( RMT_NONE );
-        strm.putDWord( 0 );
-
-        for( y = 0; y < height; y++ )
-            strm.putBytes( img.ptr(y), fileStep );
-
-        strm.close();
-        result = true;
+        if( !strm.open( *m_buf ) )
+            return false;
+        m_buf->reserve( alignSize(fileStep*height + 32, 256) );
     }
-    return result;
+    else if( !strm.open( m_filename ))
+        return false;
+
+    strm.putBytes( fmtSignSunRas, (int)strlen(fmtSignSunRas) );
+    strm.putDWord( width );
+    strm.putDWord( height );
+    strm.putDWord( channels*8 );
+    strm.putDWord( fileStep*height );
+    strm.putDWord( RAS_STANDARD );
+    strm.putDWord( RMT_NONE );
+    strm.putDWord( 0 );
+
+    for( y = 0; y < height; y++ )
+        strm.putBytes( img.ptr(y), fileStep );
+
+    strm.close();
+    return true;
 }
 
 }
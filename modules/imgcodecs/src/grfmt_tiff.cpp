@@ -99,6 +99,19 @@ TiffDecoder::~TiffDecoder()
     close();
 }
 
+// the file stays open after readData for nextPage, so it is closed when the decoder is reused
+bool TiffDecoder::setSource( const String& filename )
+{
+    close();
+    return BaseImageDecoder::setSource( filename );
+}
+
+bool TiffDecoder::setSource( const Mat& buf )
+{
+    close();
+    return BaseImageDecoder::setSource( buf );
+}
+
 size_t TiffDecoder::signatureLength() const
 {
     return 4;
@@ -221,6 +234,7 @@ bool TiffDecoder::readHeader()
         }
     }
 
+    m_roi = Rect();
     if( tif )
     {
         uint32 wdth = 0, hght = 0;
@@ -288,6 +302,23 @@ bool TiffDecoder::nextPage()
            readHeader();
 }
 
+bool TiffDecoder::setPage( int index )
+{
+    // the directories are found by following the chain of offsets, without reading the data
+    return m_tif && index >= 0 &&
+           TIFFSetDirectory(static_cast<TIFF*>(m_tif), (tdir_t)index) &&
+           readHeader();
+}
+
+bool TiffDecoder::setROI( const Rect& roi )
+{
+    // the LogLuv images are read by the whole strips
+    if( m_hdr )
+        return false;
+    m_roi = roi;
+    return true;
+}
+
 bool  TiffDecoder::readData( Mat& img )
 {
     if(m_hdr && img.type() == CV_32FC3)
@@ -296,7 +327,7 @@ bool  TiffDecoder::readData( Mat& img )
     }
     bool result = false;
     bool color = img.channels() > 1;
-    uchar* data = img.ptr();
+    uchar* data = 0;
 
     if( img.depth() != CV_8U && img.depth() != CV_16U && img.depth() != CV_32F && img.depth() != CV_64F )
         return false;
@@ -352,22 +383,43 @@ bool  TiffDecoder::readData( Mat& img )
             ushort* buffer16 = (ushort*)buffer;
             float* buffer32 = (float*)buffer;
             double* buffer64 = (double*)buffer;
-            int tileidx = 0;
 
-            for( y = 0; y < m_height; y += tile_height0, data += img.step*tile_height0 )
+            // only the tiles or strips intersecting the ROI are decoded, the ones on the ROI border
+            // are converted into the temporary tile and then copied
+            Rect roi = m_roi.area() > 0 ? m_roi : Rect(0, 0, m_width, m_height);
+            CV_Assert( img.size() == roi.size() );
+            Mat border_tile;
+
+            for( y = roi.y - roi.y % (int)tile_height0; y < roi.y + roi.height; y += tile_height0 )
             {
                 int tile_height = tile_height0;
 
                 if( y + tile_height > m_height )
                     tile_height = m_height - y;
 
-                for( x = 0; x < m_width; x += tile_width0, tileidx++ )
+                for( x = roi.x - roi.x % (int)tile_width0; x < roi.x + roi.width; x += tile_width0 )
                 {
                     int tile_width = tile_width0, ok;
 
                     if( x + tile_width > m_width )
                         tile_width = m_width - x;
 
+                    int tileidx = is_tiled ? (int)TIFFComputeTile( tif, x, y, 0, 0 ) :
+                                             (int)TIFFComputeStrip( tif, y, 0 );
+                    Rect tile_rect(x, y, tile_width, tile_height);
+                    Rect dst_rect = (tile_rect & roi) - roi.tl();
+                    bool inside = dst_rect.size() == tile_rect.size();
+                    Mat dst_tile;
+                    if( inside )
+                        dst_tile = img(dst_rect);
+                    else
+                    {
+                        border_tile.create(tile_height, tile_width, img.type());
+                        dst_tile = border_tile;
+                    }
+                    data = dst_tile.ptr();
+                    size_t dst_step = dst_tile.step;
+
                     switch(dst_bpp)
                     {
                         case 8:
@@ -393,19 +445,19 @@ bool  TiffDecoder::readData( Mat& img )
                                     if (wanted_channels == 4)
                                     {
                                         icvCvt_BGRA2RGBA_8u_C4R( bstart + i*tile_width0*4, 0,
-                                                             data + x*4 + img.step*(tile_height - i - 1), 0,
+                                                             data + dst_step*(tile_height - i - 1), 0,
                                                              cvSize(tile_width,1) );
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2BGR_8u_C4C3R( bstart + i*tile_width0*4, 0,
-                                                             data + x*3 + img.step*(tile_height - i - 1), 0,
+                                                             data + dst_step*(tile_height - i - 1), 0,
                                                              cvSize(tile_width,1), 2 );
                                     }
                                 }
                                 else
                                     icvCvt_BGRA2Gray_8u_C4C1R( bstart + i*tile_width0*4, 0,
-                                                              data + x + img.step*(tile_height - i - 1), 0,
+                                                              data + dst_step*(tile_height - i - 1), 0,
                                                               cvSize(tile_width,1), 2 );
                             break;
                         }
@@ -430,13 +482,13 @@ bool  TiffDecoder::readData( Mat& img )
                                     if( ncn == 1 )
                                     {
                                         icvCvt_Gray2BGR_16u_C1C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                                  (ushort*)(data + img.step*i) + x*3, 0,
+                                                                  (ushort*)(data + dst_step*i), 0,
                                                                   cvSize(tile_width,1) );
                                     }
                                     else if( ncn == 3 )
                                     {
                                         icvCvt_RGB2BGR_16u_C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
+                                                               (ushort*)(data + dst_step*i), 0,
                                                                cvSize(tile_width,1) );
                                     }
                                     else if (ncn == 4)
@@ -444,20 +496,20 @@ bool  TiffDecoder::readData( Mat& img )
                                         if (wanted_channels == 4)
                                         {
                                             icvCvt_BGRA2RGBA_16u_C4R(buffer16 + i*tile_width0*ncn, 0,
-                                                (ushort*)(data + img.step*i) + x * 4, 0,
+                                                (ushort*)(data + dst_step*i), 0,
                                                 cvSize(tile_width, 1));
                                         }
                                         else
                                         {
                                             icvCvt_BGRA2BGR_16u_C4C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                (ushort*)(data + img.step*i) + x * 3, 0,
+                                                (ushort*)(data + dst_step*i), 0,
                                                 cvSize(tile_width, 1), 2);
                                         }
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2BGR_16u_C4C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
+                                                               (ushort*)(data + dst_step*i), 0,
                                                                cvSize(tile_width,1), 2 );
                                     }
                                 }
@@ -465,14 +517,14 @@ bool  TiffDecoder::readData( Mat& img )
                                 {
                                     if( ncn == 1 )
                                     {
-                                        memcpy((ushort*)(data + img.step*i)+x,
+                                        memcpy((ushort*)(data + dst_step*i),
                                                buffer16 + i*tile_width0*ncn,
                                                tile_width*sizeof(buffer16[0]));
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2Gray_16u_CnC1R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x, 0,
+                                                               (ushort*)(data + dst_step*i), 0,
                                                                cvSize(tile_width,1), ncn, 2 );
                                     }
                                 }
@@ -498,13 +550,13 @@ bool  TiffDecoder::readData( Mat& img )
                             {
                                 if(dst_bpp == 32)
                                 {
-                                    memcpy((float*)(data + img.step*i)+x,
+                                    memcpy((float*)(data + dst_step*i),
                                            buffer32 + i*tile_width0*ncn,
                                            tile_width*sizeof(buffer32[0]));
                                 }
                                 else
                                 {
-                                    memcpy((double*)(data + img.step*i)+x,
+                                    memcpy((double*)(data + dst_step*i),
                                          buffer64 + i*tile_width0*ncn,
                                          tile_width*sizeof(buffer64[0]));
                                 }
@@ -518,6 +570,9 @@ bool  TiffDecoder::readData( Mat& img )
                             return false;
                         }
                     }
+
+                    if( !inside )
+                        border_tile(dst_rect + roi.tl() - tile_rect.tl()).copyTo(img(dst_rect));
                 }
             }
 
@@ -676,6 +731,100 @@ static void readParam(const std::vector<int>& params, int key, int& value)
         }
 }
 
+static bool setTiffFields( TIFF* tif, int width, int height, int bitsPerChannel, int channels,
+                           int compression, int predictor, int rowsPerStrip )
+{
+    int colorspace = channels > 1 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK;
+
+    return TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, width)
+        && TIFFSetField(tif, TIFFTAG_IMAGELENGTH, height)
+        && TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bitsPerChannel)
+        && TIFFSetField(tif, TIFFTAG_COMPRESSION, compression)
+        && TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, colorspace)
+        && TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, channels)
+        && TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG)
+        && TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, rowsPerStrip)
+        && (compression == COMPRESSION_NONE || TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor));
+}
+
+// Converts the image row to the TIFF channel order
+static void packTiffRow( const Mat& img, int y, uchar* buffer, size_t scanlineSize )
+{
+    int width = img.cols;
+    bool is8u = img.depth() == CV_8U;
+
+    switch( img.channels() )
+    {
+        case 1:
+            memcpy(buffer, img.ptr(y), scanlineSize);
+            break;
+        case 3:
+            if (is8u)
+                icvCvt_BGR2RGB_8u_C3R( img.ptr(y), 0, buffer, 0, cvSize(width,1) );
+            else
+                icvCvt_BGR2RGB_16u_C3R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width,1) );
+            break;
+        default:
+            if (is8u)
+                icvCvt_BGRA2RGBA_8u_C4R( img.ptr(y), 0, buffer, 0, cvSize(width,1) );
+            else
+                icvCvt_BGRA2RGBA_16u_C4R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width,1) );
+    }
+}
+
+// Compresses a range of strips into a separate in-memory TIFF with the same fields and
+// takes the raw compressed strips from it, so any libtiff codec can run on the parallel threads
+class TiffStripsInvoker : public ParallelLoopBody
+{
+public:
+    TiffStripsInvoker( const Mat& _img, int _bitsPerChannel, int _compression, int _predictor,
+                       int _rowsPerStrip, std::vector<std::vector<uchar> >& _strips, uchar* _status )
+        : img(_img), bitsPerChannel(_bitsPerChannel), compression(_compression), predictor(_predictor),
+          rowsPerStrip(_rowsPerStrip), strips(&_strips), status(_status) {}
+
+    virtual void operator()( const Range& range ) const
+    {
+        int y0 = range.start*rowsPerStrip, y1 = std::min(range.end*rowsPerStrip, img.rows);
+        std::vector<uchar> buf;
+        TiffEncoderBufHelper buf_helper(&buf);
+        TIFF* tif = buf_helper.open();
+        bool ok = tif && setTiffFields(tif, img.cols, y1 - y0, bitsPerChannel, img.channels(),
+                                       compression, predictor, rowsPerStrip);
+
+        size_t scanlineSize = ok ? (size_t)TIFFScanlineSize(tif) : 0;
+        AutoBuffer<uchar> _buffer(scanlineSize*rowsPerStrip + 32);
+        uchar* buffer = _buffer;
+
+        for( int i = range.start; ok && i < range.end; i++ )
+        {
+            int rows = std::min(rowsPerStrip, img.rows - i*rowsPerStrip);
+            for( int y = 0; y < rows; y++ )
+                packTiffRow(img, i*rowsPerStrip + y, buffer + scanlineSize*y, scanlineSize);
+            ok = TIFFWriteEncodedStrip(tif, i - range.start, buffer, (tmsize_t)(scanlineSize*rows)) != (tmsize_t)-1;
+        }
+
+        toff_t *offsets = 0, *counts = 0;
+        ok = ok && TIFFGetField(tif, TIFFTAG_STRIPOFFSETS, &offsets) &&
+                   TIFFGetField(tif, TIFFTAG_STRIPBYTECOUNTS, &counts);
+        for( int i = range.start; ok && i < range.end; i++ )
+        {
+            size_t ofs = (size_t)offsets[i - range.start], count = (size_t)counts[i - range.start];
+            (*strips)[i].assign(buf.begin() + ofs, buf.begin() + ofs + count);
+        }
+
+        if( tif )
+            TIFFClose(tif);
+        for( int i = range.start; i < range.end; i++ )
+            status[i] = (uchar)ok;
+    }
+
+private:
+    Mat img;
+    int bitsPerChannel, compression, predictor, rowsPerStrip;
+    std::vector<std::vector<uchar> >* strips;
+    uchar* status;
+};
+
 bool  TiffEncoder::writeLibTiff( const Mat& img, const std::vector<int>& params)
 {
     int channels = img.channels();
@@ -701,6 +850,9 @@ bool  TiffEncoder::writeLibTiff( const Mat& img, const std::vector<int>& params)
         }
     }
 
+    if (channels != 1 && channels != 3 && channels != 4)
+        return false;
+
     const int bitsPerByte = 8;
     size_t fileStep = (width * channels * bitsPerChannel) / bitsPerByte;
 
@@ -735,30 +887,47 @@ bool  TiffEncoder::writeLibTiff( const Mat& img, const std::vector<int>& params)
     // defaults for now, maybe base them on params in the future
     int   compression  = COMPRESSION_LZW;
     int   predictor    = PREDICTOR_HORIZONTAL;
+    int   parallel     = 0;
 
     readParam(params, TIFFTAG_COMPRESSION, compression);
     readParam(params, TIFFTAG_PREDICTOR, predictor);
+    readParam(params, IMWRITE_PARALLEL, parallel);
 
-    int   colorspace = channels > 1 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK;
-
-    if ( !TIFFSetField(pTiffHandle, TIFFTAG_IMAGEWIDTH, width)
-      || !TIFFSetField(pTiffHandle, TIFFTAG_IMAGELENGTH, height)
-      || !TIFFSetField(pTiffHandle, TIFFTAG_BITSPERSAMPLE, bitsPerChannel)
-      || !TIFFSetField(pTiffHandle, TIFFTAG_COMPRESSION, compression)
-      || !TIFFSetField(pTiffHandle, TIFFTAG_PHOTOMETRIC, colorspace)
-      || !TIFFSetField(pTiffHandle, TIFFTAG_SAMPLESPERPIXEL, channels)
-      || !TIFFSetField(pTiffHandle, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG)
-      || !TIFFSetField(pTiffHandle, TIFFTAG_ROWSPERSTRIP, rowsPerStrip)
-       )
+    if ( !setTiffFields(pTiffHandle, width, height, bitsPerChannel, channels,
+                        compression, predictor, rowsPerStrip) )
     {
         TIFFClose(pTiffHandle);
         return false;
     }
 
-    if (compression != COMPRESSION_NONE && !TIFFSetField(pTiffHandle, TIFFTAG_PREDICTOR, predictor) )
+    int nstrips = (height + rowsPerStrip - 1)/rowsPerStrip;
+
+    // the strips of the codecs without the state shared between them (e.g. the JPEG tables)
+    // are compressed in parallel and then written as they are
+    if (parallel != 0 && nstrips > 1 &&
+        (compression == COMPRESSION_NONE || compression == COMPRESSION_LZW ||
+         compression == COMPRESSION_ADOBE_DEFLATE || compression == COMPRESSION_DEFLATE ||
+         compression == COMPRESSION_PACKBITS))
     {
+        std::vector<std::vector<uchar> > strips(nstrips);
+        AutoBuffer<uchar> status(nstrips);
+        double nstripes = std::min((double)nstrips, std::max(getNumThreads(), 1)*4.);
+        parallel_for_(Range(0, nstrips),
+                      TiffStripsInvoker(img, bitsPerChannel, compression, predictor, rowsPerStrip, strips, status),
+                      nstripes);
+
+        for (int i = 0; i < nstrips; i++)
+        {
+            if (!status[i] || TIFFWriteRawStrip(pTiffHandle, i, strips[i].empty() ? 0 : &strips[i][0],
+                                                (tmsize_t)strips[i].size()) == (tmsize_t)-1)
+            {
+                TIFFClose(pTiffHandle);
+                return false;
+            }
+        }
+
         TIFFClose(pTiffHandle);
-        return false;
+        return true;
     }
 
     // row buffer, because TIFFWriteScanline modifies the original data!
@@ -773,38 +942,7 @@ bool  TiffEncoder::writeLibTiff( const Mat& img, const std::vector<int>& params)
 
     for (int y = 0; y < height; ++y)
     {
-        switch(channels)
-        {
-            case 1:
-            {
-                memcpy(buffer, img.ptr(y), scanlineSize);
-                break;
-            }
-
-            case 3:
-            {
-                if (depth == CV_8U)
-                    icvCvt_BGR2RGB_8u_C3R( img.ptr(y), 0, buffer, 0, cvSize(width,1) );
-                else
-                    icvCvt_BGR2RGB_16u_C3R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width,1) );
-                break;
-            }
-
-            case 4:
-            {
-                if (depth == CV_8U)
-                    icvCvt_BGRA2RGBA_8u_C4R( img.ptr(y), 0, buffer, 0, cvSize(width,1) );
-                else
-                    icvCvt_BGRA2RGBA_16u_C4R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width,1) );
-                break;
-            }
-
-            default:
-            {
-                TIFFClose(pTiffHandle);
-                return false;
-            }
-        }
+        packTiffRow(img, y, buffer, scanlineSize);
 
         int writeResult = TIFFWriteScanline(pTiffHandle, buffer, y, 0);
         if (writeResult != 1)
@@ -96,10 +96,14 @@ public:
     TiffDecoder();
     virtual ~TiffDecoder();
 
+    bool  setSource( const String& filename );
+    bool  setSource( const Mat& buf );
     bool  readHeader();
     bool  readData( Mat& img );
     void  close();
     bool  nextPage();
+    bool  setPage( int index );
+    bool  setROI( const Rect& roi );
 
     size_t signatureLength() const;
     bool checkSignature( const String& signature ) const;
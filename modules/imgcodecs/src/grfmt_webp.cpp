@@ -62,7 +62,10 @@ namespace cv
 WebPDecoder::WebPDecoder()
 {
     m_buf_supported = true;
+    m_rgb_supported = true;
+    m_scale_supported = true;
     channels = 0;
+    scaled = false;
 }
 
 WebPDecoder::~WebPDecoder() {}
@@ -142,6 +145,15 @@ bool WebPDecoder::readHeader()
         m_width  = features.width;
         m_height = features.height;
 
+        // shrink on load, the size is rounded down as imread used to resize the WebP images
+        if (m_scale_denom > 1)
+        {
+            m_width = std::max(m_width / m_scale_denom, 1);
+            m_height = std::max(m_height / m_scale_denom, 1);
+        }
+        m_scale_denom = 1; // the same trick as in JpegDecoder, see imread_
+        scaled = m_width != features.width || m_height != features.height;
+
         if (features.has_alpha)
         {
             m_type = CV_8UC4;
@@ -161,35 +173,41 @@ bool WebPDecoder::readHeader()
 
 bool WebPDecoder::readData(Mat &img)
 {
-    if( m_width > 0 && m_height > 0 )
+    if( m_width > 0 && m_height > 0 && img.cols == m_width && img.rows == m_height )
     {
-        bool convert_grayscale = (img.type() == CV_8UC1); // IMREAD_GRAYSCALE requested
-
-        if (img.cols != m_width || img.rows != m_height || img.type() != m_type)
-        {
-            img.create(m_height, m_width, m_type);
-        }
-
-        uchar* out_data = img.ptr();
-        size_t out_data_size = img.cols * img.rows * img.elemSize();
-
-        uchar *res_ptr = 0;
-        if (channels == 3)
+        // the grayscale image is decoded to the temporary color one, the others are
+        // decoded directly to img, which may be a part of a bigger matrix
+        int cn = img.channels();
+        Mat temp;
+        Mat& dst = cn == 1 ? temp : img;
+        if( cn == 1 )
+            temp.create(m_height, m_width, CV_8UC3);
+
+        WebPDecoderConfig config;
+        if (!WebPInitDecoderConfig(&config))
         {
-            res_ptr = WebPDecodeBGRInto(data.ptr(), data.total(), out_data,
-                                        (int)out_data_size, (int)img.step);
+            return false;
         }
-        else if (channels == 4)
+        if (scaled)
         {
-            res_ptr = WebPDecodeBGRAInto(data.ptr(), data.total(), out_data,
-                                         (int)out_data_size, (int)img.step);
+            config.options.use_scaling = 1;
+            config.options.scaled_width = m_width;
+            config.options.scaled_height = m_height;
         }
+        if (dst.channels() == 3)
+            config.output.colorspace = m_use_rgb ? MODE_RGB : MODE_BGR;
+        else
+            config.output.colorspace = m_use_rgb ? MODE_RGBA : MODE_BGRA;
+        config.output.is_external_memory = 1;
+        config.output.u.RGBA.rgba = dst.ptr();
+        config.output.u.RGBA.stride = (int)dst.step;
+        config.output.u.RGBA.size = dst.step*(dst.rows - 1) + dst.cols*dst.elemSize();
 
-        if(res_ptr == out_data)
+        if (WebPDecode(data.ptr(), data.total(), &config) == VP8_STATUS_OK)
         {
-            if (convert_grayscale)
+            if (cn == 1)
             {
-                cvtColor(img, img, COLOR_BGR2GRAY);
+                cvtColor(temp, img, COLOR_BGR2GRAY);
             }
             return true;
         }
@@ -71,6 +71,7 @@ public:
 protected:
     Mat data;
     int channels;
+    bool scaled;
 };
 
 class WebPEncoder : public BaseImageEncoder
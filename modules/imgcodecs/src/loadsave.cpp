@@ -47,10 +47,14 @@
 #include "grfmts.hpp"
 #include "utils.hpp"
 #include "exif.hpp"
+#include "filemap.hpp"
 #undef min
 #undef max
 #include <iostream>
 #include <fstream>
+#ifdef CV_CXX11
+#include <thread>
+#endif
 
 /****************************************************************************************\
 *                                      Image Codecs                                      *
@@ -75,6 +79,40 @@ static Size validateInputImageSize(const Size& size)
     return size;
 }
 
+// The type of the image returned for the type decoded from the file and the imread flags
+static int getDecodedType(int type, int flags)
+{
+    if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
+    {
+        if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
+            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
+
+        if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
+           ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
+            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
+        else
+            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
+    }
+    return type;
+}
+
+// Asks the decoder for the R G B channel order if the flags request it. Returns true if the
+// decoder can not do it, then the channels are swapped by swapRB after decoding.
+static bool requestRGB( const ImageDecoder& decoder, int flags )
+{
+    if( flags == IMREAD_UNCHANGED || (flags & IMREAD_RGB) == 0 )
+        return false;
+    return !decoder->setRGB( true );
+}
+
+static void swapRB( Mat& img )
+{
+    if( img.channels() == 3 )
+        cvtColor( img, img, COLOR_BGR2RGB );
+    else if( img.channels() == 4 )
+        cvtColor( img, img, COLOR_BGRA2RGBA );
+}
+
 
 namespace {
 
@@ -184,9 +222,9 @@ static ImageCodecInitializer codecs;
  *
  * @param[in] filename File to search
  *
- * @return Image decoder to parse image file.
+ * @return Index of the registered decoder to parse image file, or -1.
 */
-static ImageDecoder findDecoder( const String& filename ) {
+static int findDecoderIndex( const String& filename ) {
 
     size_t i, maxlen = 0;
 
@@ -200,9 +238,9 @@ static ImageDecoder findDecoder( const String& filename ) {
     /// Open the file
     FILE* f= fopen( filename.c_str(), "rb" );
 
-    /// in the event of a failure, return an empty image decoder
+    /// in the event of a failure, return no decoder
     if( !f )
-        return ImageDecoder();
+        return -1;
 
     // read the file signature
     String signature(maxlen, ' ');
@@ -214,19 +252,19 @@ static ImageDecoder findDecoder( const String& filename ) {
     for( i = 0; i < codecs.decoders.size(); i++ )
     {
         if( codecs.decoders[i]->checkSignature(signature) )
-            return codecs.decoders[i]->newDecoder();
+            return (int)i;
     }
 
-    /// If no decoder was found, return base type
-    return ImageDecoder();
+    /// If no decoder was found, return -1
+    return -1;
 }
 
-static ImageDecoder findDecoder( const Mat& buf )
+static int findDecoderIndex( const Mat& buf )
 {
     size_t i, maxlen = 0;
 
     if( buf.rows*buf.cols < 1 || !buf.isContinuous() )
-        return ImageDecoder();
+        return -1;
 
     for( i = 0; i < codecs.decoders.size(); i++ )
     {
@@ -242,10 +280,22 @@ static ImageDecoder findDecoder( const Mat& buf )
     for( i = 0; i < codecs.decoders.size(); i++ )
     {
         if( codecs.decoders[i]->checkSignature(signature) )
-            return codecs.decoders[i]->newDecoder();
+            return (int)i;
     }
 
-    return ImageDecoder();
+    return -1;
+}
+
+static ImageDecoder findDecoder( const String& filename )
+{
+    int idx = findDecoderIndex( filename );
+    return idx >= 0 ? codecs.decoders[idx]->newDecoder() : ImageDecoder();
+}
+
+static ImageDecoder findDecoder( const Mat& buf )
+{
+    int idx = findDecoderIndex( buf );
+    return idx >= 0 ? codecs.decoders[idx]->newDecoder() : ImageDecoder();
 }
 
 static ImageEncoder findEncoder( const String& _ext )
@@ -288,6 +338,22 @@ static ImageEncoder findEncoder( const String& _ext )
 }
 
 
+/**
+ * Sets the file as the source of the decoder. The decoders that read from memory get the
+ * mapped file instead, so the data is not copied through the stdio buffers. The mapping
+ * must outlive the use of the decoder.
+ */
+static void setFileSource_( ImageDecoder& decoder, const String& filename, MappedFile& file )
+{
+    if( MappedFile::isEnabled() && file.open(filename) )
+    {
+        if( decoder->setSource(file.data()) )
+            return;
+        file.close();
+    }
+    decoder->setSource( filename );
+}
+
 enum { LOAD_CVMAT=0, LOAD_IMAGE=1, LOAD_MAT=2 };
 
 static void ExifTransform(int orientation, Mat& img)
@@ -327,7 +393,7 @@ static void ExifTransform(int orientation, Mat& img)
     }
 }
 
-static void ApplyExifOrientation(const String& filename, Mat& img)
+static int GetExifOrientation(const String& filename)
 {
     int orientation = IMAGE_ORIENTATION_TL;
 
@@ -346,10 +412,10 @@ static void ApplyExifOrientation(const String& filename, Mat& img)
         stream.close();
     }
 
-    ExifTransform(orientation, img);
+    return orientation;
 }
 
-static void ApplyExifOrientation(const Mat& buf, Mat& img)
+static int GetExifOrientation(const Mat& buf)
 {
     int orientation = IMAGE_ORIENTATION_TL;
 
@@ -368,7 +434,17 @@ static void ApplyExifOrientation(const Mat& buf, Mat& img)
         }
     }
 
-    ExifTransform(orientation, img);
+    return orientation;
+}
+
+static void ApplyExifOrientation(const String& filename, Mat& img)
+{
+    ExifTransform(GetExifOrientation(filename), img);
+}
+
+static void ApplyExifOrientation(const Mat& buf, Mat& img)
+{
+    ExifTransform(GetExifOrientation(buf), img);
 }
 
 /**
@@ -390,6 +466,7 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
     IplImage* image = 0;
     CvMat *matrix = 0;
     Mat temp, *data = &temp;
+    MappedFile file;
 
     /// Search for the relevant decoder to handle the imagery
     ImageDecoder decoder;
@@ -424,7 +501,7 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
     decoder->setScale( scale_denom );
 
     /// set the filename in the driver
-    decoder->setSource( filename );
+    setFileSource_( decoder, filename, file );
 
     try
     {
@@ -448,18 +525,7 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
     Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
 
     // grab the decoded type
-    int type = decoder->type();
-    if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
-    {
-        if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
-            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
-
-        if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
-           ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
-        else
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
-    }
+    int type = getDecodedType( decoder->type(), flags );
 
     if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
     {
@@ -484,8 +550,13 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
     bool success = false;
     try
     {
+        bool swap_rb = requestRGB( decoder, flags );
         if (decoder->readData(*data))
+        {
+            if( swap_rb )
+                swapRB( *data );
             success = true;
+        }
     }
     catch (const cv::Exception& e)
     {
@@ -525,6 +596,8 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
 static bool
 imreadmulti_(const String& filename, int flags, std::vector<Mat>& mats)
 {
+    MappedFile file;
+
     /// Search for the relevant decoder to handle the imagery
     ImageDecoder decoder;
 
@@ -545,7 +618,7 @@ imreadmulti_(const String& filename, int flags, std::vector<Mat>& mats)
     }
 
     /// set the filename in the driver
-    decoder->setSource(filename);
+    setFileSource_(decoder, filename, file);
 
     // read the header to make sure it succeeds
     try
@@ -568,18 +641,7 @@ imreadmulti_(const String& filename, int flags, std::vector<Mat>& mats)
     for (;;)
     {
         // grab the decoded type
-        int type = decoder->type();
-        if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
-        {
-            if ((flags & CV_LOAD_IMAGE_ANYDEPTH) == 0)
-                type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
-
-            if ((flags & CV_LOAD_IMAGE_COLOR) != 0 ||
-                ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1))
-                type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
-            else
-                type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
-        }
+        int type = getDecodedType( decoder->type(), flags );
 
         // established the required input image size
         Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
@@ -589,8 +651,13 @@ imreadmulti_(const String& filename, int flags, std::vector<Mat>& mats)
         bool success = false;
         try
         {
+            bool swap_rb = requestRGB( decoder, flags );
             if (decoder->readData(mat))
+            {
+                if( swap_rb )
+                    swapRB( mat );
                 success = true;
+            }
         }
         catch (const cv::Exception& e)
         {
@@ -767,18 +834,8 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
     // established the required input image size
     Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
 
-    int type = decoder->type();
-    if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
-    {
-        if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
-            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
-
-        if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
-           ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
-        else
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
-    }
+    // grab the decoded type
+    int type = getDecodedType( decoder->type(), flags );
 
     if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
     {
@@ -802,8 +859,13 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
     success = false;
     try
     {
+        bool swap_rb = requestRGB( decoder, flags );
         if (decoder->readData(*data))
+        {
+            if( swap_rb )
+                swapRB( *data );
             success = true;
+        }
     }
     catch (const cv::Exception& e)
     {
@@ -869,6 +931,978 @@ Mat imdecode( InputArray _buf, int flags, Mat* dst )
     return *dst;
 }
 
+bool imdecodeInto( InputArray _buf, Mat& dst, int flags, bool planar )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat buf = _buf.getMat();
+    CV_Assert(!buf.empty() && buf.isContinuous());
+
+    ImageDecoder decoder = findDecoder(buf);
+    if( !decoder )
+        return false;
+
+    Mat img;
+    bool native = decoder->setSource(buf);
+    if( native )
+    {
+        try
+        {
+            if( !decoder->readHeader() )
+                return false;
+        }
+        catch (const cv::Exception& e)
+        {
+            std::cerr << "imdecodeInto: can't read header: " << e.what() << std::endl << std::flush;
+            return false;
+        }
+        catch (...)
+        {
+            std::cerr << "imdecodeInto: can't read header: unknown exception" << std::endl << std::flush;
+            return false;
+        }
+    }
+    else
+    {
+        // the decoders without the memory input go through imdecode and the copy
+        imdecode_( buf, flags, LOAD_MAT, &img );
+        if( img.empty() )
+            return false;
+    }
+
+    Size size = native ? validateInputImageSize(Size(decoder->width(), decoder->height())) : img.size();
+    int type = native ? getDecodedType( decoder->type(), flags ) : img.type();
+    int cn = CV_MAT_CN(type);
+    planar = planar && cn > 1;
+    Size dsize = planar ? Size(size.width, size.height*cn) : size;
+    int dtype = planar ? CV_MAT_DEPTH(type) : type;
+
+    if( dst.empty() )
+        dst.create( dsize, dtype );
+    else if( dst.size() != dsize || dst.type() != dtype )
+        CV_Error( CV_StsUnmatchedSizes, "the destination does not match the size or type of the decoded image" );
+
+    if( native )
+    {
+        bool success = false;
+        try
+        {
+            bool swap_rb = requestRGB( decoder, flags );
+            if( planar && decoder->setPlanar(true) )
+                success = decoder->readData( dst );
+            else
+            {
+                if( planar )
+                    img.create( size, type );
+                else
+                    img = dst;
+                success = decoder->readData( img );
+                if( success && swap_rb )
+                    swapRB( img );
+            }
+        }
+        catch (const cv::Exception& e)
+        {
+            std::cerr << "imdecodeInto: can't read data: " << e.what() << std::endl << std::flush;
+        }
+        catch (...)
+        {
+            std::cerr << "imdecodeInto: can't read data: unknown exception" << std::endl << std::flush;
+        }
+        if( !success )
+            return false;
+        if( !planar )
+        {
+            CV_Assert( img.data == dst.data );
+            return true;
+        }
+    }
+
+    if( planar )
+    {
+        if( img.empty() )
+            return true;
+        std::vector<Mat> planes(cn);
+        for( int c = 0; c < cn; c++ )
+            planes[c] = dst.rowRange(size.height*c, size.height*(c + 1));
+        split( img, planes );
+    }
+    else
+        img.copyTo( dst );
+    return true;
+}
+
+/**
+ * Reads the header of the given page and decodes the part of it inside roi. If the decoder
+ * can not decode a part of the image, the whole page is decoded and then cropped.
+ */
+static bool
+readROI_( ImageDecoder& decoder, const String& filename, const Rect& roi, int flags, int level, Mat& mat )
+{
+    CV_Assert( level >= 0 );
+    CV_Assert( flags == IMREAD_UNCHANGED || (flags & (IMREAD_REDUCED_GRAYSCALE_2 |
+               IMREAD_REDUCED_GRAYSCALE_4 | IMREAD_REDUCED_GRAYSCALE_8)) == 0 );
+
+    try
+    {
+        if( !decoder->readHeader() )
+            return false;
+        for( int i = 0; i < level; i++ )
+            if( !decoder->nextPage() )
+                return false;
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "readROI_('" << filename << "'): can't read header: " << e.what() << std::endl << std::flush;
+        return false;
+    }
+    catch (...)
+    {
+        std::cerr << "readROI_('" << filename << "'): can't read header: unknown exception" << std::endl << std::flush;
+        return false;
+    }
+
+    Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
+    Rect r = roi & Rect(0, 0, size.width, size.height);
+    if( r.empty() )
+        return false;
+
+    int type = getDecodedType( decoder->type(), flags );
+
+    bool success = false;
+    try
+    {
+        bool swap_rb = requestRGB( decoder, flags );
+        if( decoder->setROI(r) )
+        {
+            mat.create( r.size(), type );
+            success = decoder->readData(mat);
+        }
+        else
+        {
+            Mat whole( size, type );
+            if( decoder->readData(whole) )
+            {
+                whole(r).copyTo(mat);
+                success = true;
+            }
+        }
+        if( success && swap_rb )
+            swapRB( mat );
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "readROI_('" << filename << "'): can't read data: " << e.what() << std::endl << std::flush;
+    }
+    catch (...)
+    {
+        std::cerr << "readROI_('" << filename << "'): can't read data: unknown exception" << std::endl << std::flush;
+    }
+    return success;
+}
+
+Mat imreadROI( const String& filename, const Rect& roi, int flags, int level )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat img;
+    MappedFile file;
+    ImageDecoder decoder = findDecoder( filename );
+    if( !decoder )
+        return img;
+
+    setFileSource_( decoder, filename, file );
+    if( !readROI_( decoder, filename, roi, flags, level, img ) )
+        img.release();
+    return img;
+}
+
+/**
+ * Sets the buffer as the source of the decoder. The decoders without the memory input read
+ * a temporary file with the buffer contents; its name is returned to be removed by the caller.
+ */
+static String setBufSource_( ImageDecoder& decoder, const Mat& buf )
+{
+    String filename;
+    if( decoder->setSource(buf) )
+        return filename;
+
+    filename = tempfile();
+    FILE* f = fopen( filename.c_str(), "wb" );
+    if( !f )
+        CV_Error( CV_StsError, "failed to open temporary file" );
+    size_t bufSize = buf.cols*buf.rows*buf.elemSize();
+    bool written = fwrite( buf.ptr(), 1, bufSize, f ) == bufSize;
+    if( fclose(f) != 0 || !written )
+    {
+        remove(filename.c_str());
+        CV_Error( CV_StsError, "failed to write image data to temporary file" );
+    }
+    decoder->setSource(filename);
+    return filename;
+}
+
+Mat imdecodeROI( InputArray _buf, const Rect& roi, int flags, int level )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat buf = _buf.getMat(), img;
+    CV_Assert(!buf.empty() && buf.isContinuous());
+    String filename;
+
+    ImageDecoder decoder = findDecoder(buf);
+    if( !decoder )
+        return img;
+
+    filename = setBufSource_( decoder, buf );
+
+    bool success = readROI_( decoder, filename, roi, flags, level, img );
+    decoder.release();
+    if( !filename.empty() && 0 != remove(filename.c_str()) )
+        std::cerr << "unable to remove temporary file:" << filename << std::endl << std::flush;
+
+    if( !success )
+        img.release();
+    return img;
+}
+
+/**
+ * Decoder instances of a single thread, one per registered codec. The instances are created
+ * on the first use and reused for the following images of the same format.
+ */
+class DecoderCache
+{
+public:
+    DecoderCache() : decoders(codecs.decoders.size()) {}
+
+    ImageDecoder get( int idx )
+    {
+        if( idx < 0 )
+            return ImageDecoder();
+        if( !decoders[idx] )
+            decoders[idx] = codecs.decoders[idx]->newDecoder();
+        return decoders[idx];
+    }
+
+private:
+    std::vector<ImageDecoder> decoders;
+};
+
+/**
+ * Returns the size of the image scaled to fit into maxSize with the same aspect ratio.
+ * The images smaller than maxSize are not enlarged.
+ */
+static Size fitSize( Size size, Size maxSize )
+{
+    double scale = std::min((double)maxSize.width/size.width, (double)maxSize.height/size.height);
+    if( scale >= 1 )
+        return size;
+    return Size(std::max(cvRound(size.width*scale), 1), std::max(cvRound(size.height*scale), 1));
+}
+
+/**
+ * Decodes the image from the source set in the decoder. If dsize is not empty, the image
+ * is resized to it (or to fit into it, if fit is set), and the decoders that can downscale
+ * while decoding (JPEG DCT scaling, WebP shrink on load) are asked for the smallest power
+ * of 2 reduction that still covers the destination size.
+ */
+static bool
+decodeResized_( ImageDecoder& decoder, const String& filename, int flags, Size dsize, bool fit,
+                Mat& mat, Mat& temp )
+{
+    bool success = false;
+    try
+    {
+        decoder->setScale( 1 );
+        if( !decoder->readHeader() )
+            return false;
+
+        if( fit && dsize.area() > 0 )
+            dsize = fitSize( Size(decoder->width(), decoder->height()), dsize );
+
+        // only the decoders that take the scale read the header again
+        if( dsize.area() > 0 && decoder->scaleSupported() )
+        {
+            int scale_denom = 1;
+            Size size(decoder->width(), decoder->height());
+            // the decoders round the reduced size up or down, the smaller one is checked
+            while( scale_denom < 8 &&
+                   size.width/(scale_denom*2) >= dsize.width &&
+                   size.height/(scale_denom*2) >= dsize.height )
+                scale_denom *= 2;
+            if( scale_denom > 1 )
+            {
+                decoder->setScale( scale_denom );
+                if( !decoder->readHeader() )
+                    return false;
+                CV_Assert( decoder->setScale( 1 ) == 1 ); // the scale has been applied, see imread_
+            }
+        }
+
+        Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
+        int type = getDecodedType( decoder->type(), flags );
+        Mat& dst = dsize.area() > 0 && size != dsize ? temp : mat;
+        dst.create( size, type );
+        bool swap_rb = requestRGB( decoder, flags );
+        success = decoder->readData( dst );
+        if( success && swap_rb )
+            swapRB( dst );
+        if( success && &dst == &temp )
+            resize( temp, mat, dsize, 0, 0, INTER_AREA );
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "decodeResized_('" << filename << "'): can't read data: " << e.what() << std::endl << std::flush;
+    }
+    catch (...)
+    {
+        std::cerr << "decodeResized_('" << filename << "'): can't read data: unknown exception" << std::endl << std::flush;
+    }
+    return success;
+}
+
+class DecodeBatchInvoker : public ParallelLoopBody
+{
+public:
+    DecodeBatchInvoker( const std::vector<String>* _filenames, const std::vector<Mat>* _bufs,
+                        std::vector<Mat>& _mats, int _flags, Size _dsize, uchar* _status )
+        : filenames(_filenames), bufs(_bufs), mats(&_mats), flags(_flags), dsize(_dsize), status(_status) {}
+
+    virtual void operator()( const Range& range ) const
+    {
+        MappedFile file;
+        DecoderCache cache;
+        Mat temp;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            Mat& mat = (*mats)[i];
+            bool success = false;
+
+            if( filenames )
+            {
+                const String& filename = (*filenames)[i];
+                ImageDecoder decoder = cache.get( findDecoderIndex(filename) );
+                if( decoder )
+                {
+                    setFileSource_( decoder, filename, file );
+                    success = decodeResized_( decoder, filename, flags, dsize, false, mat, temp );
+                }
+                if( success && (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+                    ApplyExifOrientation(filename, mat);
+            }
+            else
+            {
+                const Mat& buf = (*bufs)[i];
+                ImageDecoder decoder = cache.get( findDecoderIndex(buf) );
+                if( decoder && decoder->setSource(buf) )
+                    success = decodeResized_( decoder, String(), flags, dsize, false, mat, temp );
+                else if( decoder )
+                {
+                    // the decoders without the memory input go through the temporary file
+                    success = imdecode_( buf, flags, LOAD_MAT, &mat ) != 0;
+                    if( success && dsize.area() > 0 && mat.size() != dsize )
+                        resize( mat, mat, dsize, 0, 0, INTER_AREA );
+                }
+                if( success && (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+                    ApplyExifOrientation(buf, mat);
+            }
+
+            if( !success )
+                mat.release();
+            status[i] = (uchar)success;
+        }
+    }
+
+private:
+    const std::vector<String>* filenames;
+    const std::vector<Mat>* bufs;
+    std::vector<Mat>* mats;
+    int flags;
+    Size dsize;
+    uchar* status;
+};
+
+static bool decodeBatch_( const std::vector<String>* filenames, const std::vector<Mat>* bufs,
+                          std::vector<Mat>& mats, int flags, Size dsize )
+{
+    CV_Assert( flags == IMREAD_UNCHANGED || (flags & (IMREAD_REDUCED_GRAYSCALE_2 |
+               IMREAD_REDUCED_GRAYSCALE_4 | IMREAD_REDUCED_GRAYSCALE_8)) == 0 );
+    CV_Assert( dsize.width >= 0 && dsize.height >= 0 );
+
+    int n = (int)(filenames ? filenames->size() : bufs->size());
+    // the matrices already in mats are reused when they have the decoded size and type
+    mats.resize(n);
+    if( n == 0 )
+        return true;
+
+    AutoBuffer<uchar> status(n);
+    // a few images per stripe, so that the decoders are reused within the stripes
+    double nstripes = std::min((double)n, std::max(getNumThreads(), 1)*4.);
+    parallel_for_(Range(0, n), DecodeBatchInvoker(filenames, bufs, mats, flags, dsize, status), nstripes);
+
+    for( int i = 0; i < n; i++ )
+        if( !status[i] )
+            return false;
+    return true;
+}
+
+bool imreadBatch( const std::vector<String>& filenames, std::vector<Mat>& mats, int flags, Size dsize )
+{
+    CV_TRACE_FUNCTION();
+
+    return decodeBatch_( &filenames, 0, mats, flags, dsize );
+}
+
+bool imdecodeBatch( InputArrayOfArrays _bufs, std::vector<Mat>& mats, int flags, Size dsize )
+{
+    CV_TRACE_FUNCTION();
+
+    std::vector<Mat> bufs;
+    _bufs.getMatVector(bufs);
+    for( size_t i = 0; i < bufs.size(); i++ )
+        CV_Assert( bufs[i].empty() || bufs[i].isContinuous() );
+    return decodeBatch_( 0, &bufs, mats, flags, dsize );
+}
+
+/**
+ * Decodes the image downscaled to fit into maxSize. The maximum size is given for the image
+ * with the applied EXIF orientation, so it is transposed for the rotated images.
+ */
+static bool
+readThumbnail_( ImageDecoder& decoder, const String& filename, Size maxSize, int flags,
+                int orientation, Mat& mat )
+{
+    CV_Assert( flags == IMREAD_UNCHANGED || (flags & (IMREAD_REDUCED_GRAYSCALE_2 |
+               IMREAD_REDUCED_GRAYSCALE_4 | IMREAD_REDUCED_GRAYSCALE_8)) == 0 );
+    CV_Assert( maxSize.width > 0 && maxSize.height > 0 );
+
+    if( orientation >= IMAGE_ORIENTATION_LT )
+        std::swap( maxSize.width, maxSize.height );
+
+    Mat temp;
+    if( !decodeResized_( decoder, filename, flags, maxSize, true, mat, temp ) )
+        return false;
+    ExifTransform( orientation, mat );
+    return true;
+}
+
+Mat imreadThumbnail( const String& filename, Size maxSize, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat img;
+    MappedFile file;
+    ImageDecoder decoder = findDecoder( filename );
+    if( !decoder )
+        return img;
+
+    int orientation = IMAGE_ORIENTATION_TL;
+    if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+        orientation = GetExifOrientation( filename );
+
+    setFileSource_( decoder, filename, file );
+    if( !readThumbnail_( decoder, filename, maxSize, flags, orientation, img ) )
+        img.release();
+    return img;
+}
+
+Mat imdecodeThumbnail( InputArray _buf, Size maxSize, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat buf = _buf.getMat(), img;
+    CV_Assert(!buf.empty() && buf.isContinuous());
+
+    ImageDecoder decoder = findDecoder(buf);
+    if( !decoder )
+        return img;
+
+    int orientation = IMAGE_ORIENTATION_TL;
+    if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+        orientation = GetExifOrientation( buf );
+
+    String filename = setBufSource_( decoder, buf );
+    bool success = readThumbnail_( decoder, filename, maxSize, flags, orientation, img );
+    decoder.release();
+    if( !filename.empty() && 0 != remove(filename.c_str()) )
+        std::cerr << "unable to remove temporary file:" << filename << std::endl << std::flush;
+
+    if( !success )
+        img.release();
+    return img;
+}
+
+ImageHeader::ImageHeader()
+    : width(0), height(0), type(-1), pages(0), orientation(IMAGE_ORIENTATION_TL)
+{
+}
+
+/**
+ * Reads the header of the first page and counts the pages, the pixels are not decoded.
+ */
+static bool
+readHeader_( ImageDecoder& decoder, const String& filename, ImageHeader& header )
+{
+    try
+    {
+        if( !decoder->readHeader() )
+            return false;
+        header.width = decoder->width();
+        header.height = decoder->height();
+        header.type = decoder->type();
+        header.pages = 1;
+        while( decoder->nextPage() )
+            header.pages++;
+        return true;
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "readHeader_('" << filename << "'): can't read header: " << e.what() << std::endl << std::flush;
+    }
+    catch (...)
+    {
+        std::cerr << "readHeader_('" << filename << "'): can't read header: unknown exception" << std::endl << std::flush;
+    }
+    return false;
+}
+
+static bool readFileHeader_( ImageDecoder decoder, const String& filename, ImageHeader& header )
+{
+    header = ImageHeader();
+    if( !decoder )
+        return false;
+
+    MappedFile file;
+    setFileSource_( decoder, filename, file );
+    if( !readHeader_(decoder, filename, header) )
+    {
+        header = ImageHeader();
+        return false;
+    }
+    Mat data = file.data();
+    header.orientation = data.empty() ? GetExifOrientation( filename ) : GetExifOrientation( data );
+    return true;
+}
+
+static bool readBufHeader_( ImageDecoder decoder, const Mat& buf, ImageHeader& header )
+{
+    header = ImageHeader();
+    if( !decoder )
+        return false;
+
+    String filename = setBufSource_( decoder, buf );
+    bool success = readHeader_( decoder, filename, header );
+    if( !filename.empty() && 0 != remove(filename.c_str()) )
+        std::cerr << "unable to remove temporary file:" << filename << std::endl << std::flush;
+
+    if( !success )
+    {
+        header = ImageHeader();
+        return false;
+    }
+    header.orientation = GetExifOrientation( buf );
+    return true;
+}
+
+bool imreadHeader( const String& filename, ImageHeader& header )
+{
+    CV_TRACE_FUNCTION();
+
+    return readFileHeader_( findDecoder(filename), filename, header );
+}
+
+bool imdecodeHeader( InputArray _buf, ImageHeader& header )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat buf = _buf.getMat();
+    CV_Assert(!buf.empty() && buf.isContinuous());
+    return readBufHeader_( findDecoder(buf), buf, header );
+}
+
+class ReadHeaderBatchInvoker : public ParallelLoopBody
+{
+public:
+    ReadHeaderBatchInvoker( const std::vector<String>* _filenames, const std::vector<Mat>* _bufs,
+                            std::vector<ImageHeader>& _headers, uchar* _status )
+        : filenames(_filenames), bufs(_bufs), headers(&_headers), status(_status) {}
+
+    virtual void operator()( const Range& range ) const
+    {
+        DecoderCache cache;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            ImageHeader& header = (*headers)[i];
+            if( filenames )
+            {
+                const String& filename = (*filenames)[i];
+                status[i] = (uchar)readFileHeader_( cache.get(findDecoderIndex(filename)), filename, header );
+            }
+            else
+            {
+                const Mat& buf = (*bufs)[i];
+                status[i] = (uchar)readBufHeader_( cache.get(findDecoderIndex(buf)), buf, header );
+            }
+        }
+    }
+
+private:
+    const std::vector<String>* filenames;
+    const std::vector<Mat>* bufs;
+    std::vector<ImageHeader>* headers;
+    uchar* status;
+};
+
+static bool readHeaderBatch_( const std::vector<String>* filenames, const std::vector<Mat>* bufs,
+                              std::vector<ImageHeader>& headers )
+{
+    int n = (int)(filenames ? filenames->size() : bufs->size());
+    headers.resize(n);
+    if( n == 0 )
+        return true;
+
+    AutoBuffer<uchar> status(n);
+    double nstripes = std::min((double)n, std::max(getNumThreads(), 1)*4.);
+    parallel_for_(Range(0, n), ReadHeaderBatchInvoker(filenames, bufs, headers, status), nstripes);
+
+    for( int i = 0; i < n; i++ )
+        if( !status[i] )
+            return false;
+    return true;
+}
+
+bool imreadHeaderBatch( const std::vector<String>& filenames, std::vector<ImageHeader>& headers )
+{
+    CV_TRACE_FUNCTION();
+
+    return readHeaderBatch_( &filenames, 0, headers );
+}
+
+bool imdecodeHeaderBatch( InputArrayOfArrays _bufs, std::vector<ImageHeader>& headers )
+{
+    CV_TRACE_FUNCTION();
+
+    std::vector<Mat> bufs;
+    _bufs.getMatVector(bufs);
+    for( size_t i = 0; i < bufs.size(); i++ )
+        CV_Assert( !bufs[i].empty() && bufs[i].isContinuous() );
+    return readHeaderBatch_( 0, &bufs, headers );
+}
+
+PageReader::~PageReader()
+{
+}
+
+/**
+ * A decoder with the header of the given page read. The decoders that can not seek are
+ * restarted from the first page and advanced with nextPage.
+ */
+struct PageCursor
+{
+    PageCursor() : page(-1), decoded(false) {}
+
+    ImageDecoder decoder;
+    int page;     // the page which header is read, -1 if the decoder has to be restarted
+    bool decoded; // readData has been called for the page
+};
+
+class PageReaderImpl : public PageReader
+{
+public:
+    PageReaderImpl( const ImageDecoder& decoder, const String& _filename, const Mat& buf,
+                    bool _tempFile, int _flags )
+        : filename(_filename), tempFile(_tempFile), flags(_flags), orientation(IMAGE_ORIENTATION_TL),
+          seekable(false), pos(0), npages(-1), prefetch(false), prefetched(-1)
+    {
+        cursors[0].decoder = decoder;
+        data = buf;
+        if( data.empty() && !tempFile && MappedFile::isEnabled() && file.open(filename) )
+            data = file.data();
+    }
+
+    ~PageReaderImpl()
+    {
+        waitPrefetch();
+        for( int i = 0; i < 2; i++ )
+            cursors[i].decoder.release();
+        file.close();
+        if( tempFile && 0 != remove(filename.c_str()) )
+            std::cerr << "unable to remove temporary file:" << filename << std::endl << std::flush;
+    }
+
+    bool open()
+    {
+        if( !gotoPage(cursors[0], 0, false) )
+            return false;
+        try
+        {
+            seekable = cursors[0].decoder->setPage(0);
+        }
+        catch (...)
+        {
+            seekable = false;
+        }
+        if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+            orientation = tempFile || data.empty() ? GetExifOrientation(filename) : GetExifOrientation(data);
+        return true;
+    }
+
+    bool read( OutputArray page )
+    {
+        waitPrefetch();
+
+        Mat result;
+        bool success;
+        if( prefetched == pos )
+        {
+            result = next;
+            next.release(); // the page belongs to the caller now
+            success = true;
+        }
+        else
+            success = decodePage(0, pos, result);
+
+        prefetched = -1;
+        if( !success )
+            return false;
+        page.assign(result);
+        pos++;
+        startPrefetch();
+        return true;
+    }
+
+    bool seek( int index )
+    {
+        if( index < 0 || (npages >= 0 && index >= npages) )
+            return false;
+        waitPrefetch();
+        if( index != prefetched && !gotoPage(cursors[0], index, seekable) )
+            return false;
+        pos = index;
+        return true;
+    }
+
+    int position() const
+    {
+        return pos;
+    }
+
+    int count()
+    {
+        if( npages < 0 )
+        {
+            // the headers are read one after another by a separate decoder
+            PageCursor cursor;
+            cursor.decoder = cursors[0].decoder->newDecoder();
+            npages = gotoPage(cursor, 0, false) ? 1 : 0;
+            while( npages > 0 && gotoPage(cursor, npages, false) )
+                npages++;
+        }
+        return npages;
+    }
+
+    void setPrefetch( bool _prefetch )
+    {
+        waitPrefetch();
+        prefetch = _prefetch;
+        if( !prefetch )
+        {
+            prefetched = -1;
+            next.release();
+        }
+    }
+
+    bool decodePage( int cursorIdx, int index, Mat& dst )
+    {
+        PageCursor& c = cursors[cursorIdx];
+        if( !c.decoder )
+            c.decoder = cursors[0].decoder->newDecoder();
+        if( !gotoPage(c, index, seekable) )
+            return false;
+
+        bool success = false;
+        try
+        {
+            Size size = validateInputImageSize(Size(c.decoder->width(), c.decoder->height()));
+            dst.create( size, getDecodedType(c.decoder->type(), flags) );
+            bool swap_rb = requestRGB( c.decoder, flags );
+            c.decoded = true;
+            success = c.decoder->readData( dst );
+            if( success && swap_rb )
+                swapRB( dst );
+        }
+        catch (const cv::Exception& e)
+        {
+            std::cerr << "PageReader('" << filename << "'): can't read data: " << e.what() << std::endl << std::flush;
+        }
+        catch (...)
+        {
+            std::cerr << "PageReader('" << filename << "'): can't read data: unknown exception" << std::endl << std::flush;
+        }
+        if( !success )
+        {
+            c.page = -1;
+            return false;
+        }
+        ExifTransform( orientation, dst );
+        return true;
+    }
+
+private:
+    // Starts decoding the page at the current position by the second cursor in the background.
+    // Without the C++11 threads the pages are decoded on demand.
+    void startPrefetch()
+    {
+        if( !prefetch || (npages >= 0 && pos >= npages) )
+            return;
+#ifdef CV_CXX11
+        if( !cursors[1].decoder )
+            cursors[1].decoder = cursors[0].decoder->newDecoder();
+        if( !cursors[1].decoder )
+            return;
+        prefetched = pos;
+        worker = std::thread(&PageReaderImpl::prefetchPage, this);
+#endif
+    }
+
+    void prefetchPage()
+    {
+        bool success = false;
+        try
+        {
+            success = decodePage(1, prefetched, next);
+        }
+        catch (...)
+        {
+        }
+        if( !success )
+        {
+            prefetched = -1;
+            next.release();
+        }
+    }
+
+    // Waits until the page started by startPrefetch is decoded
+    void waitPrefetch()
+    {
+#ifdef CV_CXX11
+        if( worker.joinable() )
+            worker.join();
+#endif
+    }
+
+    void setSource( PageCursor& c )
+    {
+        if( data.empty() || !c.decoder->setSource(data) )
+            c.decoder->setSource( filename );
+    }
+
+    // Reads the header of the page, with setPage if the decoder supports it or with nextPage
+    bool gotoPage( PageCursor& c, int index, bool useSetPage )
+    {
+        if( c.page == index && !c.decoded )
+            return true;
+        try
+        {
+            if( c.page < 0 || (!useSetPage && (index < c.page || (index == c.page && c.decoded))) )
+            {
+                c.page = -1;
+                setSource( c );
+                if( !c.decoder->readHeader() )
+                    return false;
+                c.page = 0;
+                c.decoded = false;
+                if( index == 0 )
+                    return true;
+            }
+            c.decoded = false;
+            if( useSetPage )
+            {
+                bool found = c.decoder->setPage(index);
+                c.page = found ? index : -1;
+                return found;
+            }
+            while( c.page < index )
+            {
+                if( !c.decoder->nextPage() )
+                {
+                    c.page = -1;
+                    return false;
+                }
+                c.page++;
+            }
+            return true;
+        }
+        catch (const cv::Exception& e)
+        {
+            std::cerr << "PageReader('" << filename << "'): can't read header: " << e.what() << std::endl << std::flush;
+        }
+        catch (...)
+        {
+            std::cerr << "PageReader('" << filename << "'): can't read header: unknown exception" << std::endl << std::flush;
+        }
+        c.page = -1;
+        return false;
+    }
+
+    String filename;
+    bool tempFile;
+    Mat data;
+    MappedFile file;
+    int flags;
+    int orientation;
+    bool seekable;
+    PageCursor cursors[2]; // the second one decodes the prefetched pages
+    int pos, npages;
+    bool prefetch;
+    Mat next;
+    int prefetched; // the page decoded into next, -1 if there is none
+#ifdef CV_CXX11
+    std::thread worker;
+#endif
+};
+
+Ptr<PageReader> imreadPages( const String& filename, int flags )
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert( flags == IMREAD_UNCHANGED || (flags & (IMREAD_REDUCED_GRAYSCALE_2 |
+               IMREAD_REDUCED_GRAYSCALE_4 | IMREAD_REDUCED_GRAYSCALE_8)) == 0 );
+
+    ImageDecoder decoder = findDecoder( filename );
+    if( !decoder )
+        return Ptr<PageReader>();
+
+    Ptr<PageReaderImpl> reader = makePtr<PageReaderImpl>( decoder, filename, Mat(), false, flags );
+    if( !reader->open() )
+        return Ptr<PageReader>();
+    return reader;
+}
+
+Ptr<PageReader> imdecodePages( InputArray _buf, int flags )
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert( flags == IMREAD_UNCHANGED || (flags & (IMREAD_REDUCED_GRAYSCALE_2 |
+               IMREAD_REDUCED_GRAYSCALE_4 | IMREAD_REDUCED_GRAYSCALE_8)) == 0 );
+
+    Mat buf = _buf.getMat();
+    CV_Assert(!buf.empty() && buf.isContinuous());
+
+    ImageDecoder decoder = findDecoder( buf );
+    if( !decoder )
+        return Ptr<PageReader>();
+
+    // the decoders without the memory input read the temporary file, removed with the reader
+    String filename = setBufSource_( decoder, buf );
+    bool tempFile = !filename.empty();
+    Ptr<PageReaderImpl> reader = makePtr<PageReaderImpl>( decoder, filename, tempFile ? Mat() : buf,
+                                                          tempFile, flags );
+    if( !reader->open() )
+        return Ptr<PageReader>();
+    return reader;
+}
+
 bool imencode( const String& ext, InputArray _image,
                std::vector<uchar>& buf, const std::vector<int>& params )
 {
@@ -46,6 +46,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdarg.h>
 
 // This file contains code to read and write four byte rgbe file format
 // developed by Greg Ward.  It handles the conversions between rgbe and
@@ -66,6 +67,66 @@
 
 #define INLINE inline
 
+RGBEStream::RGBEStream(FILE *fp)
+  : m_fp(fp), m_data(NULL), m_size(0), m_pos(0), m_buf(NULL) {}
+
+RGBEStream::RGBEStream(const unsigned char *data, size_t size)
+  : m_fp(NULL), m_data(data), m_size(size), m_pos(0), m_buf(NULL) {}
+
+RGBEStream::RGBEStream(std::vector<unsigned char> *buf)
+  : m_fp(NULL), m_data(NULL), m_size(0), m_pos(0), m_buf(buf) {}
+
+size_t RGBEStream::read(void *ptr, size_t size)
+{
+  if (m_fp)
+    return fread(ptr, size, 1, m_fp);
+  if (!m_data || size > m_size - m_pos)
+    return 0;
+  memcpy(ptr, m_data + m_pos, size);
+  m_pos += size;
+  return 1;
+}
+
+size_t RGBEStream::write(const void *ptr, size_t size)
+{
+  if (m_fp)
+    return fwrite(ptr, size, 1, m_fp);
+  if (!m_buf)
+    return 0;
+  const unsigned char *p = (const unsigned char *)ptr;
+  m_buf->insert(m_buf->end(), p, p + size);
+  return 1;
+}
+
+char *RGBEStream::gets(char *str, int n)
+{
+  if (m_fp)
+    return fgets(str, n, m_fp);
+  if (!m_data || m_pos >= m_size || n <= 0)
+    return NULL;
+  int i = 0;
+  while (i < n - 1 && m_pos < m_size) {
+    char c = (char)m_data[m_pos++];
+    str[i++] = c;
+    if (c == '\n')
+      break;
+  }
+  str[i] = 0;
+  return str;
+}
+
+int RGBEStream::print(const char *fmt, ...)
+{
+  char buf[256];
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (len < 0 || len >= (int)sizeof(buf) || write(buf, len) < 1)
+    return -1;
+  return len;
+}
+
 /* offsets to red, green, and blue components in a data (float) pixel */
 #define RGBE_DATA_RED    2
 #define RGBE_DATA_GREEN  1
@@ -144,32 +205,32 @@ rgbe2float(float *red, float *green, float *blue, unsigned char rgbe[4])
 }
 
 /* default minimal header. modify if you want more information in header */
-int RGBE_WriteHeader(FILE *fp, int width, int height, rgbe_header_info *info)
+int RGBE_WriteHeader(RGBEStream *fp, int width, int height, rgbe_header_info *info)
 {
   const char *programtype = "RGBE";
 
   if (info && (info->valid & RGBE_VALID_PROGRAMTYPE))
     programtype = info->programtype;
-  if (fprintf(fp,"#?%s\n",programtype) < 0)
+  if (fp->print("#?%s\n",programtype) < 0)
     return rgbe_error(rgbe_write_error,NULL);
   /* The #? is to identify file type, the programtype is optional. */
   if (info && (info->valid & RGBE_VALID_GAMMA)) {
-    if (fprintf(fp,"GAMMA=%g\n",info->gamma) < 0)
+    if (fp->print("GAMMA=%g\n",info->gamma) < 0)
       return rgbe_error(rgbe_write_error,NULL);
   }
   if (info && (info->valid & RGBE_VALID_EXPOSURE)) {
-    if (fprintf(fp,"EXPOSURE=%g\n",info->exposure) < 0)
+    if (fp->print("EXPOSURE=%g\n",info->exposure) < 0)
       return rgbe_error(rgbe_write_error,NULL);
   }
-  if (fprintf(fp,"FORMAT=32-bit_rle_rgbe\n\n") < 0)
+  if (fp->print("FORMAT=32-bit_rle_rgbe\n\n") < 0)
     return rgbe_error(rgbe_write_error,NULL);
-  if (fprintf(fp, "-Y %d +X %d\n", height, width) < 0)
+  if (fp->print("-Y %d +X %d\n", height, width) < 0)
     return rgbe_error(rgbe_write_error,NULL);
   return RGBE_RETURN_SUCCESS;
 }
 
 /* minimal header reading.  modify if you want to parse more information */
-int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
+int RGBE_ReadHeader(RGBEStream *fp, int *width, int *height, rgbe_header_info *info)
 {
   char buf[128];
   float tempf;
@@ -182,7 +243,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
   }
 
   // 1. read first line
-  if (fgets(buf,sizeof(buf)/sizeof(buf[0]),fp) == NULL)
+  if (fp->gets(buf,sizeof(buf)/sizeof(buf[0])) == NULL)
     return rgbe_error(rgbe_read_error,NULL);
   if ((buf[0] != '#')||(buf[1] != '?')) {
     /* if you want to require the magic token then uncomment the next line */
@@ -201,7 +262,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
   // 2. reading other header lines
   bool hasFormat = false;
   for(;;) {
-    if (fgets(buf,sizeof(buf)/sizeof(buf[0]),fp) == 0)
+    if (fp->gets(buf,sizeof(buf)/sizeof(buf[0])) == 0)
       return rgbe_error(rgbe_read_error,NULL);
     if (buf[0] == '\n') // end of the header
       break;
@@ -225,7 +286,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
       return rgbe_error(rgbe_format_error, "missing FORMAT specifier");
 
   // 3. reading resolution string
-  if (fgets(buf,sizeof(buf)/sizeof(buf[0]),fp) == 0)
+  if (fp->gets(buf,sizeof(buf)/sizeof(buf[0])) == 0)
     return rgbe_error(rgbe_read_error,NULL);
   if (sscanf(buf,"-Y %d +X %d",height,width) < 2)
     return rgbe_error(rgbe_format_error,"missing image size specifier");
@@ -235,7 +296,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
 /* simple write routine that does not use run length encoding */
 /* These routines can be made faster by allocating a larger buffer and
    fread-ing and fwrite-ing the data in larger chunks */
-int RGBE_WritePixels(FILE *fp, float *data, int numpixels)
+int RGBE_WritePixels(RGBEStream *fp, float *data, int numpixels)
 {
   unsigned char rgbe[4];
 
@@ -243,19 +304,19 @@ int RGBE_WritePixels(FILE *fp, float *data, int numpixels)
     float2rgbe(rgbe,data[RGBE_DATA_RED],
          data[RGBE_DATA_GREEN],data[RGBE_DATA_BLUE]);
     data += RGBE_DATA_SIZE;
-    if (fwrite(rgbe, sizeof(rgbe), 1, fp) < 1)
+    if (fp->write(rgbe, sizeof(rgbe)) < 1)
       return rgbe_error(rgbe_write_error,NULL);
   }
   return RGBE_RETURN_SUCCESS;
 }
 
 /* simple read routine.  will not correctly handle run length encoding */
-int RGBE_ReadPixels(FILE *fp, float *data, int numpixels)
+int RGBE_ReadPixels(RGBEStream *fp, float *data, int numpixels)
 {
   unsigned char rgbe[4];
 
   while(numpixels-- > 0) {
-    if (fread(rgbe, sizeof(rgbe), 1, fp) < 1)
+    if (fp->read(rgbe, sizeof(rgbe)) < 1)
       return rgbe_error(rgbe_read_error,NULL);
     rgbe2float(&data[RGBE_DATA_RED],&data[RGBE_DATA_GREEN],
          &data[RGBE_DATA_BLUE],rgbe);
@@ -269,7 +330,7 @@ int RGBE_ReadPixels(FILE *fp, float *data, int numpixels)
 /* save some space.  For each scanline, each channel (r,g,b,e) is */
 /* encoded separately for better compression. */
 
-static int RGBE_WriteBytes_RLE(FILE *fp, unsigned char *data, int numbytes)
+static int RGBE_WriteBytes_RLE(RGBEStream *fp, unsigned char *data, int numbytes)
 {
 #define MINRUNLENGTH 4
   int cur, beg_run, run_count, old_run_count, nonrun_count;
@@ -292,7 +353,7 @@ static int RGBE_WriteBytes_RLE(FILE *fp, unsigned char *data, int numbytes)
     if ((old_run_count > 1)&&(old_run_count == beg_run - cur)) {
       buf[0] = static_cast<unsigned char>(128 + old_run_count);   /*write short run*/
       buf[1] = data[cur];
-      if (fwrite(buf,sizeof(buf[0])*2,1,fp) < 1)
+      if (fp->write(buf,sizeof(buf[0])*2) < 1)
   return rgbe_error(rgbe_write_error,NULL);
       cur = beg_run;
     }
@@ -302,9 +363,9 @@ static int RGBE_WriteBytes_RLE(FILE *fp, unsigned char *data, int numbytes)
       if (nonrun_count > 128)
   nonrun_count = 128;
       buf[0] = static_cast<unsigned char>(nonrun_count);
-      if (fwrite(buf,sizeof(buf[0]),1,fp) < 1)
+      if (fp->write(buf,sizeof(buf[0])) < 1)
   return rgbe_error(rgbe_write_error,NULL);
-      if (fwrite(&data[cur],sizeof(data[0])*nonrun_count,1,fp) < 1)
+      if (fp->write(&data[cur],sizeof(data[0])*nonrun_count) < 1)
   return rgbe_error(rgbe_write_error,NULL);
       cur += nonrun_count;
     }
@@ -312,7 +373,7 @@ static int RGBE_WriteBytes_RLE(FILE *fp, unsigned char *data, int numbytes)
     if (run_count >= MINRUNLENGTH) {
       buf[0] = static_cast<unsigned char>(128 + run_count);
       buf[1] = data[beg_run];
-      if (fwrite(buf,sizeof(buf[0])*2,1,fp) < 1)
+      if (fp->write(buf,sizeof(buf[0])*2) < 1)
   return rgbe_error(rgbe_write_error,NULL);
       cur += run_count;
     }
@@ -321,7 +382,7 @@ static int RGBE_WriteBytes_RLE(FILE *fp, unsigned char *data, int numbytes)
 #undef MINRUNLENGTH
 }
 
-int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_WritePixels_RLE(RGBEStream *fp, float *data, int scanline_width,
        int num_scanlines)
 {
   unsigned char rgbe[4];
@@ -340,7 +401,7 @@ int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
     rgbe[1] = 2;
     rgbe[2] = static_cast<unsigned char>(scanline_width >> 8);
     rgbe[3] = scanline_width & 0xFF;
-    if (fwrite(rgbe, sizeof(rgbe), 1, fp) < 1) {
+    if (fp->write(rgbe, sizeof(rgbe)) < 1) {
       free(buffer);
       return rgbe_error(rgbe_write_error,NULL);
     }
@@ -367,7 +428,7 @@ int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
   return RGBE_RETURN_SUCCESS;
 }
 
-int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_ReadPixels_RLE(RGBEStream *fp, float *data, int scanline_width,
       int num_scanlines)
 {
   unsigned char rgbe[4], *scanline_buffer, *ptr, *ptr_end;
@@ -380,7 +441,7 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
   scanline_buffer = NULL;
   /* read in each successive scanline */
   while(num_scanlines > 0) {
-    if (fread(rgbe,sizeof(rgbe),1,fp) < 1) {
+    if (fp->read(rgbe,sizeof(rgbe)) < 1) {
       free(scanline_buffer);
       return rgbe_error(rgbe_read_error,NULL);
     }
@@ -406,7 +467,7 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
     for(i=0;i<4;i++) {
       ptr_end = &scanline_buffer[(i+1)*scanline_width];
       while(ptr < ptr_end) {
-  if (fread(buf,sizeof(buf[0])*2,1,fp) < 1) {
+  if (fp->read(buf,sizeof(buf[0])*2) < 1) {
     free(scanline_buffer);
     return rgbe_error(rgbe_read_error,NULL);
   }
@@ -429,7 +490,7 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
     }
     *ptr++ = buf[1];
     if (--count > 0) {
-      if (fread(ptr,sizeof(*ptr)*count,1,fp) < 1) {
+      if (fp->read(ptr,sizeof(*ptr)*count) < 1) {
         free(scanline_buffer);
         return rgbe_error(rgbe_read_error,NULL);
       }
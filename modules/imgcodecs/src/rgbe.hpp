@@ -48,6 +48,28 @@
 // based on code written by Greg Ward
 
 #include <stdio.h>
+#include <vector>
+
+/* the file, the memory buffer or the vector the routines read from or write to */
+class RGBEStream
+{
+public:
+  explicit RGBEStream(FILE *fp);
+  RGBEStream(const unsigned char *data, size_t size);
+  explicit RGBEStream(std::vector<unsigned char> *buf);
+
+  /* the same as fread/fwrite of a single item of the given size */
+  size_t read(void *ptr, size_t size);
+  size_t write(const void *ptr, size_t size);
+  char *gets(char *str, int n);
+  int print(const char *fmt, ...);
+
+private:
+  FILE *m_fp;
+  const unsigned char *m_data;
+  size_t m_size, m_pos;
+  std::vector<unsigned char> *m_buf;
+};
 
 typedef struct {
   int valid;            /* indicate which fields are valid */
@@ -71,19 +93,19 @@ typedef struct {
 
 /* read or write headers */
 /* you may set rgbe_header_info to null if you want to */
-int RGBE_WriteHeader(FILE *fp, int width, int height, rgbe_header_info *info);
-int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info);
+int RGBE_WriteHeader(RGBEStream *fp, int width, int height, rgbe_header_info *info);
+int RGBE_ReadHeader(RGBEStream *fp, int *width, int *height, rgbe_header_info *info);
 
 /* read or write pixels */
 /* can read or write pixels in chunks of any size including single pixels*/
-int RGBE_WritePixels(FILE *fp, float *data, int numpixels);
-int RGBE_ReadPixels(FILE *fp, float *data, int numpixels);
+int RGBE_WritePixels(RGBEStream *fp, float *data, int numpixels);
+int RGBE_ReadPixels(RGBEStream *fp, float *data, int numpixels);
 
 /* read or write run length encoded files */
 /* must be called to read or write whole scanlines */
-int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_WritePixels_RLE(RGBEStream *fp, float *data, int scanline_width,
        int num_scanlines);
-int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_ReadPixels_RLE(RGBEStream *fp, float *data, int scanline_width,
       int num_scanlines);
 
 #endif/*_RGBE_HDR_H_*/
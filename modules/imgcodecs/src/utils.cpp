@@ -41,6 +41,9 @@
 
 #include "precomp.hpp"
 #include "utils.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+using namespace cv;
 
 int validateToInt(size_t sz)
 {
@@ -223,9 +226,24 @@ void icvCvt_BGR2RGB_8u_C3R( const uchar* bgr, int bgr_step,
                             uchar* rgb, int rgb_step, CvSize size )
 {
     int i;
+#if CV_SIMD128
+    bool haveSIMD = hasSIMD128();
+#endif
     for( ; size.height--; )
     {
-        for( i = 0; i < size.width; i++, bgr += 3, rgb += 3 )
+        i = 0;
+#if CV_SIMD128
+        if( haveSIMD )
+        {
+            for( ; i <= size.width - 16; i += 16, bgr += 48, rgb += 48 )
+            {
+                v_uint8x16 b, g, r;
+                v_load_deinterleave(bgr, b, g, r);
+                v_store_interleave(rgb, r, g, b);
+            }
+        }
+#endif
+        for( ; i < size.width; i++, bgr += 3, rgb += 3 )
         {
             uchar t0 = bgr[0], t1 = bgr[1], t2 = bgr[2];
             rgb[2] = t0; rgb[1] = t1; rgb[0] = t2;
@@ -240,21 +258,73 @@ void icvCvt_BGR2RGB_16u_C3R( const ushort* bgr, int bgr_step,
                              ushort* rgb, int rgb_step, CvSize size )
 {
     int i;
+#if CV_SIMD128
+    bool haveSIMD = hasSIMD128();
+#endif
     for( ; size.height--; )
     {
-        for( i = 0; i < size.width; i++, bgr += 3, rgb += 3 )
+        i = 0;
+#if CV_SIMD128
+        if( haveSIMD )
+        {
+            for( ; i <= size.width - 8; i += 8, bgr += 24, rgb += 24 )
+            {
+                v_uint16x8 b, g, r;
+                v_load_deinterleave(bgr, b, g, r);
+                v_store_interleave(rgb, r, g, b);
+            }
+        }
+#endif
+        for( ; i < size.width; i++, bgr += 3, rgb += 3 )
         {
             ushort t0 = bgr[0], t1 = bgr[1], t2 = bgr[2];
             rgb[2] = t0; rgb[1] = t1; rgb[0] = t2;
         }
-        bgr += bgr_step - size.width*3;
-        rgb += rgb_step - size.width*3;
+        bgr += bgr_step/sizeof(bgr[0]) - size.width*3;
+        rgb += rgb_step/sizeof(rgb[0]) - size.width*3;
     }
 }
 
 
 typedef unsigned short ushort;
 
+// Converts 16-bit samples between the big-endian file order and the native one.
+// Works in-place as well.
+void icvCvt_SwapBytes_16u_C1R( const ushort* src, int src_step,
+                               ushort* dst, int dst_step, CvSize size )
+{
+    int i;
+#if CV_SIMD128
+    bool haveSIMD = hasSIMD128();
+#endif
+    for( ; size.height--; src += src_step/sizeof(src[0]), dst += dst_step/sizeof(dst[0]) )
+    {
+        i = 0;
+#if CV_SIMD128
+        if( haveSIMD )
+        {
+            for( ; i <= size.width - 16; i += 16 )
+            {
+                v_uint16x8 v0 = v_load(src + i), v1 = v_load(src + i + 8);
+                v_store(dst + i, (v0 << 8) | (v0 >> 8));
+                v_store(dst + i + 8, (v1 << 8) | (v1 >> 8));
+            }
+            for( ; i <= size.width - 8; i += 8 )
+            {
+                v_uint16x8 v = v_load(src + i);
+                v_store(dst + i, (v << 8) | (v >> 8));
+            }
+        }
+#endif
+        for( ; i < size.width; i++ )
+        {
+            ushort v = src[i];
+            dst[i] = (ushort)((v << 8) | (v >> 8));
+        }
+    }
+}
+
+
 void icvCvt_BGR5552Gray_8u_C2C1R( const uchar* bgr555, int bgr555_step,
                                   uchar* gray, int gray_step, CvSize size )
 {
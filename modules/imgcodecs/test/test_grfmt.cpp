@@ -273,3 +273,701 @@ TEST(Imgcodecs_Pam, read_write)
     remove(writefile.c_str());
     remove(writefile_no_param.c_str());
 }
+
+typedef tuple<string, int> Ext_Type;
+typedef testing::TestWithParam<Ext_Type> Imgcodecs_RawFormats;
+
+TEST_P(Imgcodecs_RawFormats, write_read)
+{
+    const string ext = get<0>(GetParam());
+    const int type = get<1>(GetParam());
+
+    // the odd width leaves the tails after the vectorized loops, the ROI is not continuous
+    Mat big(100, 140, type);
+    randu(big, 0, CV_MAT_DEPTH(type) == CV_8U ? 256 : 65536);
+    Mat roi = big(Rect(3, 1, 131, 97));
+
+    for (int i = 0; i < 2; i++)
+    {
+        SCOPED_TRACE(i == 0 ? "ROI" : "continuous");
+        Mat img = i == 0 ? roi : roi.clone();
+
+        vector<uchar> buf;
+        ASSERT_TRUE(imencode(ext, img, buf));
+        Mat decoded = imdecode(buf, IMREAD_UNCHANGED);
+        ASSERT_EQ(type, decoded.type());
+        EXPECT_EQ(0, cvtest::norm(img, decoded, NORM_INF));
+
+        // the 16-bit samples are stored big-endian
+        if (type == CV_16UC1)
+        {
+            ushort v = img.at<ushort>(img.rows - 1, img.cols - 1);
+            EXPECT_EQ(v >> 8, buf[buf.size() - 2]);
+            EXPECT_EQ(v & 255, buf[buf.size() - 1]);
+        }
+
+        string filename = cv::tempfile(ext.c_str());
+        ASSERT_TRUE(imwrite(filename, img));
+        Mat loaded = imread(filename, IMREAD_UNCHANGED);
+        EXPECT_EQ(0, cvtest::norm(img, loaded, NORM_INF));
+        EXPECT_EQ(0, remove(filename.c_str()));
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(All, Imgcodecs_RawFormats, testing::Values(
+    make_tuple(string(".pgm"), (int)CV_8UC1),
+    make_tuple(string(".pgm"), (int)CV_16UC1),
+    make_tuple(string(".ppm"), (int)CV_8UC3),
+    make_tuple(string(".ppm"), (int)CV_16UC3),
+    make_tuple(string(".pam"), (int)CV_8UC1),
+    make_tuple(string(".pam"), (int)CV_8UC3),
+    make_tuple(string(".pam"), (int)CV_16UC1),
+    make_tuple(string(".pam"), (int)CV_16UC3),
+    make_tuple(string(".bmp"), (int)CV_8UC1),
+    make_tuple(string(".bmp"), (int)CV_8UC3),
+    make_tuple(string(".bmp"), (int)CV_8UC4)));
+
+//==================================================================================================
+
+typedef testing::TestWithParam<string> Imgcodecs_Memory;
+
+TEST_P(Imgcodecs_Memory, encode_decode)
+{
+    const string ext = GetParam();
+    const bool isHdr = ext == ".exr" || ext == ".hdr";
+
+    Mat img(120, 160, isHdr ? CV_32FC3 : CV_8UC3);
+    if (isHdr)
+        randu(img, 0.f, 4.f);
+    else
+        randu(img, 0, 256);
+    GaussianBlur(img, img, Size(5, 5), 0);
+
+    // the encoders write the same data to the memory buffer as to the file
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(ext, img, buf));
+    ASSERT_FALSE(buf.empty());
+
+    string filename = cv::tempfile(ext.c_str());
+    ASSERT_TRUE(imwrite(filename, img));
+    FILE* f = fopen(filename.c_str(), "rb");
+    ASSERT_TRUE(f != NULL);
+    vector<uchar> filebuf(buf.size() + 1);
+    size_t filesize = fread(&filebuf[0], 1, filebuf.size(), f);
+    fclose(f);
+    filebuf.resize(filesize);
+    EXPECT_TRUE(buf == filebuf);
+
+    Mat decoded = imdecode(buf, IMREAD_UNCHANGED);
+    Mat loaded = imread(filename, IMREAD_UNCHANGED);
+    ASSERT_FALSE(decoded.empty());
+    ASSERT_FALSE(loaded.empty());
+    EXPECT_EQ(loaded.type(), decoded.type());
+    EXPECT_EQ(0, cvtest::norm(loaded, decoded, NORM_INF));
+    EXPECT_LE(cvtest::norm(img, decoded, NORM_INF), isHdr ? 0.05 : 0.);
+
+    // truncated data is rejected without crashing
+    vector<uchar> truncated(buf.begin(), buf.begin() + buf.size()/2);
+    EXPECT_NO_THROW(imdecode(truncated, IMREAD_UNCHANGED));
+
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+const string memory_exts[] =
+{
+#ifdef HAVE_OPENEXR
+    ".exr",
+#endif
+#ifdef HAVE_JASPER
+    ".jp2",
+#endif
+#ifdef HAVE_TIFF
+    ".tiff",
+#endif
+    ".hdr",
+    ".ras"
+};
+
+INSTANTIATE_TEST_CASE_P(All, Imgcodecs_Memory, testing::ValuesIn(memory_exts));
+
+//==================================================================================================
+
+typedef testing::TestWithParam<string> Imgcodecs_ROI;
+
+TEST_P(Imgcodecs_ROI, decode)
+{
+    const string ext = GetParam();
+    Mat img(203, 317, CV_8UC3);
+    randu(img, 0, 256);
+    GaussianBlur(img, img, Size(5, 5), 0);
+
+    // TIFF is written by the strips of 8 rows, so the ROI starts and ends inside them
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(ext, img, buf));
+    string filename = cv::tempfile(ext.c_str());
+    ASSERT_TRUE(imwrite(filename, img));
+
+    const Rect rois[] =
+    {
+        Rect(0, 0, 317, 203), Rect(10, 20, 100, 50), Rect(0, 15, 317, 1), Rect(250, 150, 100, 100),
+        Rect(-5, -5, 10, 10), Rect(316, 202, 1, 1)
+    };
+    const int modes[] = { IMREAD_UNCHANGED, IMREAD_GRAYSCALE, IMREAD_COLOR };
+    for (size_t i = 0; i < sizeof(rois)/sizeof(rois[0]); i++)
+        for (size_t j = 0; j < sizeof(modes)/sizeof(modes[0]); j++)
+        {
+            SCOPED_TRACE(cv::format("roi=(%d, %d, %d, %d) mode=%d", rois[i].x, rois[i].y,
+                                    rois[i].width, rois[i].height, modes[j]));
+            Mat whole = imdecode(buf, modes[j]);
+            ASSERT_FALSE(whole.empty());
+            Mat expected = whole(rois[i] & Rect(0, 0, whole.cols, whole.rows));
+
+            Mat decoded = imdecodeROI(buf, rois[i], modes[j]);
+            Mat loaded = imreadROI(filename, rois[i], modes[j]);
+            ASSERT_EQ(expected.type(), decoded.type());
+            ASSERT_EQ(expected.size(), decoded.size());
+            EXPECT_EQ(0, cvtest::norm(expected, decoded, NORM_INF));
+            ASSERT_EQ(expected.size(), loaded.size());
+            EXPECT_EQ(0, cvtest::norm(expected, loaded, NORM_INF));
+        }
+
+    EXPECT_TRUE(imdecodeROI(buf, Rect(400, 0, 10, 10)).empty());
+    EXPECT_TRUE(imdecodeROI(buf, Rect(0, 0, 10, 10), IMREAD_COLOR, 1).empty());
+    EXPECT_THROW(imdecodeROI(buf, Rect(0, 0, 10, 10), IMREAD_REDUCED_COLOR_2), cv::Exception);
+
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+const string roi_exts[] =
+{
+#ifdef HAVE_JPEG
+    ".jpg",
+#endif
+#ifdef HAVE_PNG
+    ".png",
+#endif
+#ifdef HAVE_TIFF
+    ".tiff",
+#endif
+    ".bmp"
+};
+
+INSTANTIATE_TEST_CASE_P(All, Imgcodecs_ROI, testing::ValuesIn(roi_exts));
+
+//==================================================================================================
+
+TEST(Imgcodecs_Batch, decode)
+{
+    const string exts[] =
+    {
+#ifdef HAVE_JPEG
+        ".jpg",
+#endif
+#ifdef HAVE_PNG
+        ".png",
+#endif
+#ifdef HAVE_TIFF
+        ".tiff",
+#endif
+        ".bmp", ".ppm"
+    };
+    const int nexts = (int)(sizeof(exts)/sizeof(exts[0]));
+
+    vector<String> filenames;
+    vector<vector<uchar> > bufs;
+    for (int i = 0; i < nexts*3; i++)
+    {
+        Mat img(100 + i*7, 150 - i*3, CV_8UC3);
+        randu(img, 0, 256);
+        GaussianBlur(img, img, Size(5, 5), 0);
+        filenames.push_back(cv::tempfile(exts[i % nexts].c_str()));
+        ASSERT_TRUE(imwrite(filenames.back(), img));
+        bufs.push_back(vector<uchar>());
+        ASSERT_TRUE(imencode(exts[i % nexts], img, bufs.back()));
+    }
+
+    const int modes[] = { IMREAD_UNCHANGED, IMREAD_GRAYSCALE, IMREAD_COLOR };
+    int nthreads = getNumThreads();
+    for (int m = 0; m < 3; m++)
+        for (int t = 0; t < 2; t++)
+        {
+            SCOPED_TRACE(cv::format("mode=%d threads=%d", modes[m], t == 0 ? 1 : 4));
+            setNumThreads(t == 0 ? 1 : 4);
+            vector<Mat> loaded, decoded;
+            EXPECT_TRUE(imreadBatch(filenames, loaded, modes[m]));
+            EXPECT_TRUE(imdecodeBatch(bufs, decoded, modes[m]));
+            ASSERT_EQ(filenames.size(), loaded.size());
+            ASSERT_EQ(filenames.size(), decoded.size());
+            for (size_t i = 0; i < filenames.size(); i++)
+            {
+                SCOPED_TRACE(filenames[i]);
+                Mat expected = imread(filenames[i], modes[m]);
+                ASSERT_FALSE(expected.empty());
+                ASSERT_EQ(expected.type(), loaded[i].type());
+                ASSERT_EQ(expected.size(), loaded[i].size());
+                EXPECT_EQ(0, cvtest::norm(expected, loaded[i], NORM_INF));
+                ASSERT_EQ(expected.type(), decoded[i].type());
+                ASSERT_EQ(expected.size(), decoded[i].size());
+                EXPECT_EQ(0, cvtest::norm(expected, decoded[i], NORM_INF));
+            }
+        }
+    setNumThreads(nthreads);
+
+    // the output matrices of the same size and type are reused
+    vector<Mat> mats;
+    ASSERT_TRUE(imdecodeBatch(bufs, mats));
+    vector<uchar*> data;
+    for (size_t i = 0; i < mats.size(); i++)
+        data.push_back(mats[i].data);
+    ASSERT_TRUE(imdecodeBatch(bufs, mats));
+    for (size_t i = 0; i < mats.size(); i++)
+        EXPECT_EQ(data[i], mats[i].data);
+
+    // the missing and broken images are empty, the others are still decoded
+    vector<String> names(filenames);
+    names.insert(names.begin() + 1, cv::tempfile(".png"));
+    vector<Mat> loaded;
+    EXPECT_FALSE(imreadBatch(names, loaded));
+    ASSERT_EQ(names.size(), loaded.size());
+    EXPECT_TRUE(loaded[1].empty());
+    EXPECT_FALSE(loaded[0].empty());
+    EXPECT_FALSE(loaded[2].empty());
+
+    bufs[0].resize(10);
+    bufs[1].clear();
+    vector<Mat> decoded;
+    EXPECT_FALSE(imdecodeBatch(bufs, decoded));
+    EXPECT_TRUE(decoded[0].empty());
+    EXPECT_TRUE(decoded[1].empty());
+    EXPECT_FALSE(decoded[2].empty());
+
+    for (size_t i = 0; i < filenames.size(); i++)
+        EXPECT_EQ(0, remove(filenames[i].c_str()));
+}
+
+TEST(Imgcodecs_Batch, resize)
+{
+    Mat img(480, 640, CV_8UC3);
+    randu(img, 0, 256);
+    GaussianBlur(img, img, Size(7, 7), 0);
+    const Size dsize(100, 80);
+
+    const string exts[] =
+    {
+#ifdef HAVE_JPEG
+        ".jpg",
+#endif
+        ".png", ".bmp"
+    };
+    vector<String> filenames;
+    for (size_t i = 0; i < sizeof(exts)/sizeof(exts[0]); i++)
+    {
+        filenames.push_back(cv::tempfile(exts[i].c_str()));
+        ASSERT_TRUE(imwrite(filenames[i], img));
+    }
+
+    vector<Mat> mats;
+    ASSERT_TRUE(imreadBatch(filenames, mats, IMREAD_COLOR, dsize));
+    for (size_t i = 0; i < filenames.size(); i++)
+    {
+        SCOPED_TRACE(exts[i]);
+        // JPEG is decoded at 1/4 of the size, 1/8 would be smaller than dsize
+        Mat expected;
+        resize(imread(filenames[i], exts[i] == ".jpg" ? IMREAD_REDUCED_COLOR_4 : IMREAD_COLOR),
+               expected, dsize, 0, 0, INTER_AREA);
+        ASSERT_EQ(dsize, mats[i].size());
+        EXPECT_EQ(0, cvtest::norm(expected, mats[i], NORM_INF));
+        EXPECT_EQ(0, remove(filenames[i].c_str()));
+    }
+}
+
+#ifdef HAVE_OPENEXR
+TEST(Imgcodecs_Batch, resize_exr)
+{
+    Mat img(240, 320, CV_32FC3);
+    randu(img, 0.f, 4.f);
+    const Size dsize(100, 80);
+
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(".exr", img, buf));
+    vector<vector<uchar> > bufs(8, buf);
+    Mat expected;
+    resize(imdecode(buf, IMREAD_UNCHANGED), expected, dsize, 0, 0, INTER_AREA);
+
+    // the cached decoders are reused for every batch, they must not keep the previous files open
+    for (int iter = 0; iter < 50; iter++)
+    {
+        vector<Mat> mats;
+        ASSERT_TRUE(imdecodeBatch(bufs, mats, IMREAD_UNCHANGED, dsize));
+        ASSERT_EQ(bufs.size(), mats.size());
+        for (size_t i = 0; i < mats.size(); i++)
+        {
+            ASSERT_EQ(dsize, mats[i].size());
+            ASSERT_EQ(0, cvtest::norm(expected, mats[i], NORM_INF));
+        }
+    }
+}
+#endif
+
+//==================================================================================================
+
+typedef testing::TestWithParam<string> Imgcodecs_DecodeInto;
+
+TEST_P(Imgcodecs_DecodeInto, decode)
+{
+    const string ext = GetParam();
+    Mat img(97, 131, CV_8UC3);
+    randu(img, 0, 256);
+    GaussianBlur(img, img, Size(5, 5), 0);
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(ext, img, buf));
+
+    Mat bgr = imdecode(buf, IMREAD_COLOR), rgb, gray = imdecode(buf, IMREAD_GRAYSCALE);
+    ASSERT_FALSE(bgr.empty());
+    cvtColor(bgr, rgb, COLOR_BGR2RGB);
+    EXPECT_EQ(0, cvtest::norm(rgb, imdecode(buf, IMREAD_COLOR | IMREAD_RGB), NORM_INF));
+
+    // the image is decoded into a part of a bigger matrix, the rest of it is not touched
+    Mat big(300, 400, CV_8UC3, Scalar::all(7));
+    Mat part = big(Rect(50, 60, img.cols, img.rows));
+    ASSERT_TRUE(imdecodeInto(buf, part, IMREAD_COLOR | IMREAD_RGB));
+    EXPECT_EQ(big.ptr(60, 50), part.data);
+    EXPECT_EQ(0, cvtest::norm(rgb, part, NORM_INF));
+    part.setTo(Scalar::all(7));
+    EXPECT_EQ(0, countNonZero(big.reshape(1) != 7));
+
+    Mat bigGray(200, 200, CV_8UC1);
+    Mat partGray = bigGray(Rect(1, 2, img.cols, img.rows));
+    ASSERT_TRUE(imdecodeInto(buf, partGray, IMREAD_GRAYSCALE, true));
+    EXPECT_EQ(bigGray.ptr(2, 1), partGray.data);
+    EXPECT_EQ(0, cvtest::norm(gray, partGray, NORM_INF));
+
+    // the planes one under another, as a part of a batch
+    for (int useRGB = 0; useRGB < 2; useRGB++)
+    {
+        SCOPED_TRACE(useRGB ? "RGB" : "BGR");
+        Mat batch(img.rows*3*2, img.cols + 10, CV_8UC1, Scalar::all(7));
+        Mat planar = batch(Rect(5, img.rows*3, img.cols, img.rows*3));
+        ASSERT_TRUE(imdecodeInto(buf, planar, IMREAD_COLOR | (useRGB ? IMREAD_RGB : 0), true));
+        EXPECT_EQ(batch.ptr(img.rows*3, 5), planar.data);
+        vector<Mat> planes;
+        split(useRGB ? rgb : bgr, planes);
+        for (int c = 0; c < 3; c++)
+            EXPECT_EQ(0, cvtest::norm(planes[c], planar.rowRange(img.rows*c, img.rows*(c + 1)), NORM_INF));
+        EXPECT_EQ(0, countNonZero(batch.rowRange(0, img.rows*3) != 7));
+    }
+
+    Mat empty;
+    ASSERT_TRUE(imdecodeInto(buf, empty, IMREAD_COLOR));
+    EXPECT_EQ(0, cvtest::norm(bgr, empty, NORM_INF));
+
+    Mat wrong(img.rows, img.cols + 1, CV_8UC3);
+    EXPECT_THROW(imdecodeInto(buf, wrong), cv::Exception);
+}
+
+const string decode_into_exts[] =
+{
+#ifdef HAVE_JPEG
+    ".jpg",
+#endif
+#ifdef HAVE_PNG
+    ".png",
+#endif
+#ifdef HAVE_WEBP
+    ".webp",
+#endif
+#ifdef HAVE_TIFF
+    ".tiff",
+#endif
+    ".bmp"
+};
+
+INSTANTIATE_TEST_CASE_P(All, Imgcodecs_DecodeInto, testing::ValuesIn(decode_into_exts));
+
+typedef string Ext;
+typedef testing::TestWithParam<Ext> Imgcodecs_ParallelEncode;
+
+TEST_P(Imgcodecs_ParallelEncode, regression)
+{
+    const string ext = GetParam();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_16UC3 };
+    RNG& rng = theRNG();
+
+    for (int ti = 0; ti < 5; ti++)
+    {
+        // smooth enough to be compressed, large enough to be split into several chunks
+        Mat img(1000, 800, types[ti]);
+        rng.fill(img, RNG::UNIFORM, 0, CV_MAT_DEPTH(types[ti]) == CV_8U ? 256 : 65536);
+        GaussianBlur(img, img, Size(7, 7), 0);
+
+        for (int level = -1; level <= 9; level += 5)
+        {
+            SCOPED_TRACE(cv::format("type=%d level=%d", types[ti], level));
+            vector<int> params;
+            params.push_back(IMWRITE_PARALLEL);
+            params.push_back(1);
+            if (level >= 0)
+            {
+                // TIFFTAG_COMPRESSION with no compression or Deflate for TIFF
+                params.push_back(ext == ".png" ? (int)IMWRITE_PNG_COMPRESSION : 259);
+                params.push_back(ext == ".png" ? level : level == 4 ? 1 : 8);
+            }
+
+            vector<uchar> buf[2];
+            int nthreads = getNumThreads();
+            for (int i = 0; i < 2; i++)
+            {
+                setNumThreads(i == 0 ? 1 : 4);
+                ASSERT_TRUE(imencode(ext, img, buf[i], params));
+            }
+            setNumThreads(nthreads);
+
+            // the output does not depend on the number of threads
+            EXPECT_TRUE(buf[0] == buf[1]);
+            Mat dst = imdecode(buf[1], IMREAD_UNCHANGED);
+            ASSERT_EQ(img.type(), dst.type());
+            EXPECT_EQ(0, cvtest::norm(img, dst, NORM_INF));
+        }
+    }
+}
+
+const string parallel_encode_exts[] =
+{
+#ifdef HAVE_PNG
+    ".png",
+#endif
+#ifdef HAVE_TIFF
+    ".tiff",
+#endif
+};
+
+INSTANTIATE_TEST_CASE_P(All, Imgcodecs_ParallelEncode, testing::ValuesIn(parallel_encode_exts));
+
+typedef testing::TestWithParam<string> Imgcodecs_Thumbnail;
+
+TEST_P(Imgcodecs_Thumbnail, regression)
+{
+    const string ext = GetParam();
+    Mat img(480, 640, CV_8UC3);
+    randu(img, 0, 256);
+    GaussianBlur(img, img, Size(15, 15), 0);
+
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(ext, img, buf));
+    Mat full = imdecode(buf, IMREAD_COLOR);
+    ASSERT_FALSE(full.empty());
+
+    // the aspect ratio is kept, the larger size does not enlarge the image
+    const Size maxSizes[] = { Size(100, 100), Size(320, 1000), Size(50, 20), Size(1000, 1000) };
+    const Size sizes[] = { Size(100, 75), Size(320, 240), Size(27, 20), Size(640, 480) };
+    for (int i = 0; i < 4; i++)
+    {
+        SCOPED_TRACE(cv::format("maxSize=%dx%d", maxSizes[i].width, maxSizes[i].height));
+        Mat thumb = imdecodeThumbnail(buf, maxSizes[i]);
+        ASSERT_EQ(sizes[i], thumb.size());
+        ASSERT_EQ(CV_8UC3, thumb.type());
+
+        Mat expected;
+        resize(full, expected, sizes[i], 0, 0, INTER_AREA);
+        EXPECT_LE(cvtest::norm(expected, thumb, NORM_L1)/thumb.total()/3, 2.);
+
+        Mat gray = imdecodeThumbnail(buf, maxSizes[i], IMREAD_GRAYSCALE);
+        ASSERT_EQ(sizes[i], gray.size());
+        ASSERT_EQ(CV_8UC1, gray.type());
+    }
+
+    string filename = cv::tempfile(ext.c_str());
+    ASSERT_TRUE(imwrite(filename, img));
+    Mat thumb = imreadThumbnail(filename, Size(160, 160));
+    EXPECT_EQ(Size(160, 120), thumb.size());
+    EXPECT_EQ(0, cvtest::norm(imdecodeThumbnail(buf, Size(160, 160)), thumb, NORM_INF));
+    EXPECT_TRUE(imreadThumbnail(filename + ".missing", Size(160, 160)).empty());
+    remove(filename.c_str());
+}
+
+const string thumbnail_exts[] =
+{
+#ifdef HAVE_JPEG
+    ".jpg",
+#endif
+#ifdef HAVE_PNG
+    ".png",
+#endif
+#ifdef HAVE_WEBP
+    ".webp",
+#endif
+    ".bmp"
+};
+
+INSTANTIATE_TEST_CASE_P(All, Imgcodecs_Thumbnail, testing::ValuesIn(thumbnail_exts));
+
+#ifdef HAVE_OPENEXR
+TEST(Imgcodecs_Thumbnail, exr)
+{
+    Mat img(480, 640, CV_32FC3);
+    randu(img, 0.f, 4.f);
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(".exr", img, buf));
+
+    Mat expected;
+    resize(imdecode(buf, IMREAD_UNCHANGED), expected, Size(160, 120), 0, 0, INTER_AREA);
+
+    // the EXR decoder does not scale, the header is read once per thumbnail
+    for (int iter = 0; iter < 50; iter++)
+    {
+        Mat thumb = imdecodeThumbnail(buf, Size(160, 160), IMREAD_UNCHANGED);
+        ASSERT_EQ(Size(160, 120), thumb.size());
+        ASSERT_EQ(CV_32FC3, thumb.type());
+        ASSERT_EQ(0, cvtest::norm(expected, thumb, NORM_INF));
+    }
+}
+#endif
+
+TEST(Imgcodecs_Header, regression)
+{
+    const string exts[] = { ".png", ".jpg", ".bmp", ".tiff", ".webp" };
+    const int types[] = { CV_16UC3, CV_8UC1, CV_8UC3, CV_16UC4, CV_8UC4 };
+    const Size size(123, 45);
+
+    vector<String> filenames;
+    vector<vector<uchar> > bufs;
+    vector<int> expectedTypes;
+    for (int i = 0; i < 5; i++)
+    {
+        vector<uchar> buf;
+        Mat img(size, types[i], Scalar::all(100));
+        if (!imencode(exts[i], img, buf))
+            continue; // the codec is not built
+        bufs.push_back(buf);
+        expectedTypes.push_back(types[i]);
+        filenames.push_back(cv::tempfile(exts[i].c_str()));
+        ASSERT_TRUE(imwrite(filenames.back(), img));
+    }
+
+    for (size_t i = 0; i < filenames.size(); i++)
+    {
+        SCOPED_TRACE(filenames[i]);
+        ImageHeader header;
+        ASSERT_TRUE(imreadHeader(filenames[i], header));
+        EXPECT_EQ(size.width, header.width);
+        EXPECT_EQ(size.height, header.height);
+        EXPECT_EQ(expectedTypes[i], header.type);
+        EXPECT_EQ(1, header.pages);
+        EXPECT_EQ(1, header.orientation);
+        EXPECT_EQ(imread(filenames[i], IMREAD_UNCHANGED).type(), header.type);
+
+        ImageHeader bufHeader;
+        ASSERT_TRUE(imdecodeHeader(bufs[i], bufHeader));
+        EXPECT_EQ(header.width, bufHeader.width);
+        EXPECT_EQ(header.height, bufHeader.height);
+        EXPECT_EQ(header.type, bufHeader.type);
+    }
+
+    vector<ImageHeader> headers;
+    ASSERT_TRUE(imreadHeaderBatch(filenames, headers));
+    ASSERT_EQ(filenames.size(), headers.size());
+    for (size_t i = 0; i < headers.size(); i++)
+        EXPECT_EQ(expectedTypes[i], headers[i].type);
+
+    ASSERT_TRUE(imdecodeHeaderBatch(bufs, headers));
+    ASSERT_EQ(bufs.size(), headers.size());
+    for (size_t i = 0; i < headers.size(); i++)
+        EXPECT_EQ(size, Size(headers[i].width, headers[i].height));
+
+    // the failed entries have the default values
+    filenames.push_back(filenames[0] + ".missing");
+    EXPECT_FALSE(imreadHeaderBatch(filenames, headers));
+    EXPECT_EQ(0, headers.back().width);
+    EXPECT_EQ(-1, headers.back().type);
+    EXPECT_EQ(expectedTypes[0], headers[0].type);
+
+    for (size_t i = 0; i + 1 < filenames.size(); i++)
+        remove(filenames[i].c_str());
+}
+
+#ifdef HAVE_OPENEXR
+TEST(Imgcodecs_Header, batch_exr)
+{
+    Mat img(45, 123, CV_32FC3, Scalar::all(0.5));
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(".exr", img, buf));
+    vector<vector<uchar> > bufs(8, buf);
+
+    // the cached decoders probe many images, they must not keep the previous files open
+    for (int iter = 0; iter < 200; iter++)
+    {
+        vector<ImageHeader> headers;
+        ASSERT_TRUE(imdecodeHeaderBatch(bufs, headers));
+        ASSERT_EQ(bufs.size(), headers.size());
+        for (size_t i = 0; i < headers.size(); i++)
+        {
+            ASSERT_EQ(img.size(), Size(headers[i].width, headers[i].height));
+            ASSERT_EQ(CV_32FC3, headers[i].type);
+        }
+    }
+}
+#endif
+
+TEST(Imgcodecs_Image, read_file_as_buffer)
+{
+    const string exts[] = { ".png", ".jpg", ".bmp", ".tiff", ".webp", ".ppm" };
+    Mat img(97, 131, CV_8UC3);
+    randu(img, 0, 256);
+
+    for (int i = 0; i < 6; i++)
+    {
+        SCOPED_TRACE(exts[i]);
+        vector<uchar> buf;
+        if (!imencode(exts[i], img, buf))
+            continue; // the codec is not built
+        string filename = cv::tempfile(exts[i].c_str());
+        FILE* f = fopen(filename.c_str(), "wb");
+        ASSERT_TRUE(f != NULL);
+        ASSERT_EQ(buf.size(), fwrite(&buf[0], 1, buf.size(), f));
+        fclose(f);
+
+        // the file may be mapped and decoded from memory, the result is the same
+        Mat fromFile = imread(filename, IMREAD_UNCHANGED);
+        Mat fromBuf = imdecode(buf, IMREAD_UNCHANGED);
+        ASSERT_FALSE(fromFile.empty());
+        EXPECT_EQ(0, cvtest::norm(fromBuf, fromFile, NORM_INF));
+
+        // the truncated file can not be decoded
+        f = fopen(filename.c_str(), "wb");
+        ASSERT_TRUE(f != NULL);
+        ASSERT_EQ((size_t)8, fwrite(&buf[0], 1, 8, f));
+        fclose(f);
+        EXPECT_TRUE(imread(filename).empty());
+
+        // the empty file can not be mapped
+        fclose(fopen(filename.c_str(), "wb"));
+        EXPECT_TRUE(imread(filename).empty());
+        remove(filename.c_str());
+    }
+}
+
+TEST(Imgcodecs_Image, page_reader_single_page)
+{
+    Mat img(60, 80, CV_8UC3);
+    randu(img, 0, 256);
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(".png", img, buf));
+
+    Ptr<PageReader> reader = imdecodePages(buf, IMREAD_COLOR);
+    ASSERT_FALSE(reader.empty());
+    EXPECT_EQ(1, reader->count());
+    reader->setPrefetch(true);
+
+    Mat page;
+    ASSERT_TRUE(reader->read(page));
+    EXPECT_EQ(0, cvtest::norm(img, page, NORM_INF));
+    EXPECT_FALSE(reader->read(page));
+    EXPECT_FALSE(reader->seek(1));
+
+    // the decoder is restarted for the page already decoded
+    ASSERT_TRUE(reader->seek(0));
+    ASSERT_TRUE(reader->read(page));
+    EXPECT_EQ(0, cvtest::norm(img, page, NORM_INF));
+
+    EXPECT_TRUE(imreadPages(cv::tempfile(".png")).empty());
+}
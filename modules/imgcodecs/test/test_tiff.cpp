@@ -199,4 +199,247 @@ TEST(Imgcodecs_Tiff, imdecode_no_exception_temporary_file_removed)
     EXPECT_NO_THROW(cv::imdecode(buf, IMREAD_UNCHANGED));
 }
 
+//==================================================================================================
+
+static void putTiffValue(vector<uchar>& buf, size_t pos, unsigned value, int nbytes)
+{
+    for (int i = 0; i < nbytes; i++)
+        buf[pos + i] = (uchar)(value >> (i*8));
+}
+
+// Writes the uncompressed little-endian tiled TIFF, one directory per level
+static void writeTiledTiff(vector<uchar>& buf, const vector<Mat>& levels, int tileSize)
+{
+    buf.assign(8, 0);
+    buf[0] = buf[1] = 'I';
+    putTiffValue(buf, 2, 42, 2);
+    size_t nextIfdPos = 4;
+
+    for (size_t l = 0; l < levels.size(); l++)
+    {
+        const Mat& img = levels[l];
+        int cn = img.channels(), bits = (int)img.elemSize1()*8;
+        int tilesX = (img.cols + tileSize - 1)/tileSize, tilesY = (img.rows + tileSize - 1)/tileSize;
+        int ntiles = tilesX*tilesY;
+        size_t tileBytes = (size_t)tileSize*tileSize*img.elemSize();
+        vector<unsigned> offsets;
+
+        for (int ty = 0; ty < tilesY; ty++)
+            for (int tx = 0; tx < tilesX; tx++)
+            {
+                // the tiles on the right and bottom edges are padded with zeros
+                offsets.push_back((unsigned)buf.size());
+                buf.resize(buf.size() + tileBytes, 0);
+                Rect r = Rect(tx*tileSize, ty*tileSize, tileSize, tileSize) & Rect(0, 0, img.cols, img.rows);
+                for (int y = 0; y < r.height; y++)
+                    memcpy(&buf[offsets.back() + y*tileSize*img.elemSize()], img.ptr(r.y + y, r.x),
+                           r.width*img.elemSize());
+            }
+
+        size_t arraysPos = buf.size();
+        buf.resize(arraysPos + ntiles*8 + cn*2, 0);
+        for (int i = 0; i < ntiles; i++)
+        {
+            putTiffValue(buf, arraysPos + i*4, offsets[i], 4);
+            putTiffValue(buf, arraysPos + ntiles*4 + i*4, (unsigned)tileBytes, 4);
+        }
+        for (int c = 0; c < cn; c++)
+            putTiffValue(buf, arraysPos + ntiles*8 + c*2, bits, 2);
+
+        const unsigned entries[][4] =
+        {
+            // tag, type (3 - SHORT, 4 - LONG), count, value or offset
+            { 256, 4, 1, (unsigned)img.cols },
+            { 257, 4, 1, (unsigned)img.rows },
+            { 258, 3, (unsigned)cn, cn == 1 ? (unsigned)bits : (unsigned)(arraysPos + ntiles*8) },
+            { 259, 3, 1, 1 },
+            { 262, 3, 1, cn == 1 ? 1u : 2u },
+            { 277, 3, 1, (unsigned)cn },
+            { 284, 3, 1, 1 },
+            { 322, 4, 1, (unsigned)tileSize },
+            { 323, 4, 1, (unsigned)tileSize },
+            { 324, 4, (unsigned)ntiles, ntiles == 1 ? offsets[0] : (unsigned)arraysPos },
+            { 325, 4, (unsigned)ntiles, ntiles == 1 ? (unsigned)tileBytes : (unsigned)(arraysPos + ntiles*4) }
+        };
+        const int nentries = sizeof(entries)/sizeof(entries[0]);
+
+        size_t ifdPos = buf.size();
+        putTiffValue(buf, nextIfdPos, (unsigned)ifdPos, 4);
+        buf.resize(ifdPos + 2 + nentries*12 + 4, 0);
+        putTiffValue(buf, ifdPos, nentries, 2);
+        for (int i = 0; i < nentries; i++)
+        {
+            size_t pos = ifdPos + 2 + i*12;
+            putTiffValue(buf, pos, entries[i][0], 2);
+            putTiffValue(buf, pos + 2, entries[i][1], 2);
+            putTiffValue(buf, pos + 4, entries[i][2], 4);
+            putTiffValue(buf, pos + 8, entries[i][3], entries[i][1] == 3 && entries[i][2] == 1 ? 2 : 4);
+        }
+        nextIfdPos = ifdPos + 2 + nentries*12;
+    }
+}
+
+TEST(Imgcodecs_Tiff, decode_roi_tiled_levels)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_16UC3 };
+    for (int t = 0; t < 4; t++)
+    {
+        SCOPED_TRACE(cv::format("type=%d", types[t]));
+        vector<Mat> levels(3);
+        levels[0].create(300, 230, types[t]);
+        randu(levels[0], 0, CV_MAT_DEPTH(types[t]) == CV_8U ? 256 : 65536);
+        for (size_t l = 1; l < levels.size(); l++)
+            pyrDown(levels[l - 1], levels[l]);
+
+        vector<uchar> buf;
+        writeTiledTiff(buf, levels, 64);
+
+        string filename = cv::tempfile(".tiff");
+        FILE* f = fopen(filename.c_str(), "wb");
+        ASSERT_TRUE(f != NULL);
+        ASSERT_EQ(buf.size(), fwrite(&buf[0], 1, buf.size(), f));
+        fclose(f);
+        vector<Mat> pages;
+        ASSERT_TRUE(imreadmulti(filename, pages, IMREAD_UNCHANGED));
+        ASSERT_EQ(levels.size(), pages.size());
+        if (levels[0].channels() == 1)
+        {
+            EXPECT_EQ(0, cvtest::norm(levels[0], pages[0], NORM_INF));
+        }
+
+        const Rect rois[] = { Rect(0, 0, 230, 300), Rect(70, 10, 100, 150), Rect(63, 64, 2, 1),
+                              Rect(40, 50, 500, 500) };
+        for (int level = 0; level < (int)levels.size(); level++)
+            for (size_t i = 0; i < sizeof(rois)/sizeof(rois[0]); i++)
+            {
+                SCOPED_TRACE(cv::format("level=%d roi=%d", level, (int)i));
+                Rect r = rois[i] & Rect(0, 0, pages[level].cols, pages[level].rows);
+                if (r.empty())
+                {
+                    EXPECT_TRUE(imdecodeROI(buf, rois[i], IMREAD_UNCHANGED, level).empty());
+                    continue;
+                }
+                Mat decoded = imdecodeROI(buf, rois[i], IMREAD_UNCHANGED, level);
+                ASSERT_EQ(r.size(), decoded.size());
+                EXPECT_EQ(0, cvtest::norm(pages[level](r), decoded, NORM_INF));
+
+                Mat loaded = imreadROI(filename, rois[i], IMREAD_UNCHANGED, level);
+                ASSERT_EQ(r.size(), loaded.size());
+                EXPECT_EQ(0, cvtest::norm(pages[level](r), loaded, NORM_INF));
+
+                Mat gray = imdecodeROI(buf, rois[i], IMREAD_GRAYSCALE, level);
+                ASSERT_EQ(CV_8UC1, gray.type());
+                ASSERT_EQ(r.size(), gray.size());
+            }
+
+        EXPECT_TRUE(imdecodeROI(buf, Rect(0, 0, 10, 10), IMREAD_UNCHANGED, (int)levels.size()).empty());
+        EXPECT_EQ(0, remove(filename.c_str()));
+    }
+}
+
+TEST(Imgcodecs_Tiff, read_header_levels)
+{
+    vector<Mat> levels(3);
+    levels[0].create(200, 150, CV_8UC3);
+    randu(levels[0], 0, 256);
+    for (size_t l = 1; l < levels.size(); l++)
+        pyrDown(levels[l - 1], levels[l]);
+
+    vector<uchar> buf;
+    writeTiledTiff(buf, levels, 64);
+
+    ImageHeader header;
+    ASSERT_TRUE(imdecodeHeader(buf, header));
+    EXPECT_EQ(150, header.width);
+    EXPECT_EQ(200, header.height);
+    EXPECT_EQ(CV_8UC3, header.type);
+    EXPECT_EQ(3, header.pages);
+}
+
+TEST(Imgcodecs_Tiff, page_reader)
+{
+    vector<Mat> pages(7);
+    for (size_t i = 0; i < pages.size(); i++)
+    {
+        pages[i].create(40 + (int)i*7, 50 + (int)i*3, i % 2 ? CV_16UC1 : CV_8UC1);
+        randu(pages[i], 0, i % 2 ? 65536 : 256);
+    }
+    vector<uchar> buf;
+    writeTiledTiff(buf, pages, 32);
+
+    string filename = cv::tempfile(".tiff");
+    FILE* f = fopen(filename.c_str(), "wb");
+    ASSERT_TRUE(f != NULL);
+    ASSERT_EQ(buf.size(), fwrite(&buf[0], 1, buf.size(), f));
+    fclose(f);
+
+    for (int k = 0; k < 4; k++)
+    {
+        bool prefetch = (k & 1) != 0;
+        SCOPED_TRACE(cv::format("%s prefetch=%d", k < 2 ? "file" : "buffer", prefetch));
+        Ptr<PageReader> reader = k < 2 ? imreadPages(filename, IMREAD_UNCHANGED) :
+                                         imdecodePages(buf, IMREAD_UNCHANGED);
+        ASSERT_FALSE(reader.empty());
+        reader->setPrefetch(prefetch);
+        EXPECT_FALSE(reader->seek(7)); // before the pages are counted
+        EXPECT_EQ(0, reader->position());
+
+        // the pages in order
+        Mat page;
+        for (size_t i = 0; i < pages.size(); i++)
+        {
+            ASSERT_EQ((int)i, reader->position());
+            ASSERT_TRUE(reader->read(page));
+            ASSERT_EQ(pages[i].type(), page.type());
+            EXPECT_EQ(0, cvtest::norm(pages[i], page, NORM_INF));
+        }
+        EXPECT_FALSE(reader->read(page));
+        EXPECT_EQ((int)pages.size(), reader->count());
+
+        // random access, the page can be read again
+        const int order[] = { 3, 1, 1, 6, 0, 5 };
+        for (int j = 0; j < 6; j++)
+        {
+            ASSERT_TRUE(reader->seek(order[j]));
+            ASSERT_TRUE(reader->read(page));
+            EXPECT_EQ(0, cvtest::norm(pages[order[j]], page, NORM_INF));
+            EXPECT_EQ(order[j] + 1, reader->position());
+        }
+        EXPECT_FALSE(reader->seek(7));
+        EXPECT_FALSE(reader->seek(-1));
+        EXPECT_EQ(6, reader->position());
+    }
+
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+TEST(Imgcodecs_Tiff, page_reader_same_size)
+{
+    vector<Mat> pages(5);
+    for (size_t i = 0; i < pages.size(); i++)
+    {
+        pages[i].create(48, 64, CV_8UC1);
+        randu(pages[i], 0, 256);
+    }
+    vector<uchar> buf;
+    writeTiledTiff(buf, pages, 32);
+
+    for (int prefetch = 0; prefetch < 2; prefetch++)
+    {
+        SCOPED_TRACE(cv::format("prefetch=%d", prefetch));
+        Ptr<PageReader> reader = imdecodePages(buf, IMREAD_UNCHANGED);
+        ASSERT_FALSE(reader.empty());
+        reader->setPrefetch(prefetch != 0);
+
+        // every page is decoded into a new buffer, so the collected pages stay distinct
+        vector<Mat> all;
+        Mat page;
+        while (reader->read(page))
+            all.push_back(page);
+        ASSERT_EQ(pages.size(), all.size());
+        for (size_t i = 0; i < pages.size(); i++)
+            EXPECT_EQ(0, cvtest::norm(pages[i], all[i], NORM_INF)) << "page " << i;
+    }
+}
+
 #endif
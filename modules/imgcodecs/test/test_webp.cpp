@@ -103,4 +103,24 @@ TEST(Imgcodecs_WebP, encode_decode_with_alpha_webp)
     EXPECT_EQ(512, img_webp.rows);
 }
 
+TEST(Imgcodecs_WebP, imread_reduced_odd_size)
+{
+    cv::Mat img(101, 203, CV_8UC3);
+    cv::randu(img, 0, 256);
+    string output = cv::tempfile(".webp");
+    ASSERT_TRUE(cv::imwrite(output, img));
+
+    // the size is rounded down, as when the full image was resized
+    const int flags[] = { cv::IMREAD_REDUCED_COLOR_2, cv::IMREAD_REDUCED_COLOR_4, cv::IMREAD_REDUCED_GRAYSCALE_8 };
+    const int denoms[] = { 2, 4, 8 };
+    for (int i = 0; i < 3; i++)
+    {
+        cv::Mat reduced = cv::imread(output, flags[i]);
+        ASSERT_FALSE(reduced.empty());
+        EXPECT_EQ(img.cols / denoms[i], reduced.cols);
+        EXPECT_EQ(img.rows / denoms[i], reduced.rows);
+    }
+    EXPECT_EQ(0, remove(output.c_str()));
+}
+
 #endif // HAVE_WEBP
@@ -373,7 +373,10 @@ enum GrabCutModes {
     automatically initialized with GC_BGD .*/
     GC_INIT_WITH_MASK  = 1,
     /** The value means that the algorithm should just resume. */
-    GC_EVAL            = 2
+    GC_EVAL            = 2,
+    /** The flag can be combined with the modes above. The graph edge weights are stored in single
+    precision, which halves the memory footprint of the algorithm; the result may slightly differ. */
+    GC_FLOAT_WEIGHTS   = 8
 };
 
 //! distanceTransform algorithm flags
@@ -393,7 +396,11 @@ enum FloodFillFlags {
     /** If set, the function does not change the image ( newVal is ignored), and only fills the
     mask with the value specified in bits 8-16 of flags as described above. This option only make
     sense in function variants that have the mask parameter. */
-    FLOODFILL_MASK_ONLY   = 1 << 17
+    FLOODFILL_MASK_ONLY   = 1 << 17,
+    /** If set, the filled region is found by labeling all the pixels that satisfy the range
+    condition in parallel instead of the sequential scan-line fill. It pays off for very large
+    regions. The result is the same. The flag is ignored in the floating range mode. */
+    FLOODFILL_PARALLEL    = 1 << 18
 };
 
 //! @} imgproc_misc
@@ -923,6 +930,58 @@ public:
 };
 
 
+/** @brief Histogram, mean and standard deviation of a window sliding over a single-channel 8-bit image.
+
+The statistics are updated incrementally: when the window is moved by setWindow, only the pixels
+that leave or enter the window are processed. For a window that moves by a few pixels this takes
+O(perimeter) operations instead of O(area) needed by calcHist and meanStdDev. The results are
+exactly the same as calcHist with the uniform ranges passed to createSlidingHistogram gives for the
+window, and the same as meanStdDev up to the floating-point rounding.
+
+@sa createSlidingHistogram, calcHist, meanStdDev
+ */
+class CV_EXPORTS_W SlidingHistogram : public Algorithm
+{
+public:
+    /** @brief Sets the image the window slides over.
+
+    The image data is not copied, so it must not be released or modified while the object is used.
+    The current window is kept (clipped by the image), its statistics are recomputed on the next
+    query.
+    @param image Single-channel 8-bit image.
+     */
+    CV_WRAP virtual void setImage(InputArray image) = 0;
+
+    /** @brief Moves the window, updating the statistics incrementally.
+    @param window New window. It must lie inside the image.
+     */
+    CV_WRAP virtual void setWindow(const Rect& window) = 0;
+    CV_WRAP virtual Rect getWindow() const = 0;
+
+    /** @brief Returns the histogram of the current window as a histSize x 1 CV_32F matrix. */
+    CV_WRAP virtual void getHist(OutputArray hist) = 0;
+
+    /** @brief Returns the mean and the standard deviation of the pixels of the current window. */
+    CV_WRAP virtual void getMeanStdDev(CV_OUT double& mean, CV_OUT double& stddev) = 0;
+
+    /** @brief Computes the statistics for a batch of windows.
+
+    The windows are processed in parallel, consecutive windows handled by the same thread are
+    updated incrementally, so the batch is processed faster when the neighbouring windows overlap.
+    The current window of the object is not changed.
+    @param windows Windows, each of them must lie inside the image.
+    @param hists Output windows.size() x histSize CV_32F matrix, one histogram per row.
+    @param means Optional output windows.size() x 1 CV_64F matrix of the means.
+    @param stddevs Optional output windows.size() x 1 CV_64F matrix of the standard deviations.
+     */
+    CV_WRAP virtual void calcWindows(const std::vector<Rect>& windows, OutputArray hists,
+                                     OutputArray means = noArray(),
+                                     OutputArray stddevs = noArray()) = 0;
+
+    CV_WRAP virtual int getHistSize() const = 0;
+};
+
+
 //! @addtogroup imgproc_subdiv2d
 //! @{
 
@@ -1361,14 +1420,32 @@ In-place operation is supported.
 
 @note The median filter uses BORDER_REPLICATE internally to cope with border pixels, see cv::BorderTypes
 
-@param src input 1-, 3-, or 4-channel image; when ksize is 3 or 5, the image depth should be
-CV_8U, CV_16U, or CV_32F, for larger aperture sizes, it can only be CV_8U.
+@param src input 1-, 3-, or 4-channel image; the image depth should be CV_8U, CV_16U, CV_16S or
+CV_32F. For aperture sizes larger than 5, 16-bit and floating-point images are processed with a
+sliding-window histogram.
 @param dst destination array of the same size and type as src.
 @param ksize aperture linear size; it must be odd and greater than 1, for example: 3, 5, 7 ...
-@sa  bilateralFilter, blur, boxFilter, GaussianBlur
+@sa  bilateralFilter, blur, boxFilter, GaussianBlur, rankFilter
  */
 CV_EXPORTS_W void medianBlur( InputArray src, OutputArray dst, int ksize );
 
+/** @brief Replaces each pixel with the given percentile of its neighbourhood.
+
+The function computes, for every pixel and every channel independently, the value of the specified
+rank in the sorted \f$\texttt{ksize} \times \texttt{ksize}\f$ neighbourhood. Percentile 50 gives
+the median filter, 0 and 100 give the minimum and the maximum filters respectively. The rank is
+computed as cvRound(percentile*(ksize*ksize - 1)/100). The function uses BORDER_REPLICATE for the
+border pixels, in-place operation is supported.
+
+@param src input image with any number of channels; the depth should be CV_8U, CV_16U, CV_16S or
+CV_32F.
+@param dst destination array of the same size and type as src.
+@param ksize aperture linear size; it must be odd, for example: 3, 5, 7 ...
+@param percentile percentile of the neighbourhood values, in the [0, 100] range.
+@sa medianBlur, erode, dilate
+ */
+CV_EXPORTS_W void rankFilter( InputArray src, OutputArray dst, int ksize, double percentile );
+
 /** @brief Blurs an image using a Gaussian filter.
 
 The function convolves the source image with the specified Gaussian kernel. In-place filtering is
@@ -2261,6 +2338,60 @@ CV_EXPORTS_W void resize( InputArray src, OutputArray dst,
                           Size dsize, double fx = 0, double fy = 0,
                           int interpolation = INTER_LINEAR );
 
+/** @brief Converts color, resizes and normalizes an image into a planar floating-point blob.
+
+The function is an equivalent of the sequence
+@code
+    cvtColor(src, tmp, code);
+    resize(tmp, tmp, dsize, 0, 0, interpolation);
+    tmp.convertTo(tmp, CV_32F);
+    // for each channel c: (tmp_c - mean[c])*scale[c], stored as a separate plane
+@endcode
+but it makes a single pass over the image and does not allocate full-size temporary images.
+The result is a 4-dimensional CV_32F array of the 1 x channels x dsize.height x dsize.width
+shape (NCHW layout), as used by deep learning frameworks. Resizing is done in floating-point, so the
+result may slightly differ from resizing an 8-bit image first.
+
+@param src input image: 8-bit, 16-bit unsigned or 32-bit floating-point. Any source format
+supported by cvtColor can be used, including YUV 4:2:0 (NV12, NV21, YV12, I420) and Bayer images.
+@param blob output blob.
+@param dsize spatial size of the output blob.
+@param code color space conversion code (see cv::ColorConversionCodes), or -1 if the channels
+should be used as is.
+@param mean values subtracted from the corresponding channels after resizing.
+@param scale multipliers applied to the corresponding channels after the mean subtraction.
+@param interpolation interpolation method; INTER_NEAREST, INTER_LINEAR and INTER_AREA are supported.
+
+@sa cvtColor, resize
+ */
+CV_EXPORTS_W void colorResizeNormalize( InputArray src, OutputArray blob, Size dsize, int code = -1,
+                                        const Scalar& mean = Scalar(), const Scalar& scale = Scalar::all(1),
+                                        int interpolation = INTER_LINEAR );
+
+/** @brief Converts a YUV image directly into a planar floating-point RGB or BGR blob.
+
+The function computes the same ITU-R BT.601 conversion as cvtColor, but in floating-point, without
+rounding to 8 bits and without producing an intermediate interleaved image. The result is a
+4-dimensional CV_32F array of the 1 x 3 x roi.height x roi.width shape where every plane contains
+\f[(\texttt{value}_c - \texttt{mean}_c) \cdot \texttt{scale}_c\f]
+with values in the [0, 255] range.
+
+@param src input image: a single-channel 8-bit image with the height of 3/2 of the picture height
+for the 4:2:0 formats or a 2-channel 8-bit image for the packed 4:2:2 formats.
+@param dst output blob.
+@param code conversion code: COLOR_YUV2RGB_NV12, COLOR_YUV2BGR_NV12, COLOR_YUV2RGB_NV21,
+COLOR_YUV2BGR_NV21, COLOR_YUV2RGB_YV12, COLOR_YUV2BGR_YV12, COLOR_YUV2RGB_IYUV, COLOR_YUV2BGR_IYUV,
+COLOR_YUV2RGB_UYVY, COLOR_YUV2BGR_UYVY, COLOR_YUV2RGB_YUY2, COLOR_YUV2BGR_YUY2, COLOR_YUV2RGB_YVYU
+or COLOR_YUV2BGR_YVYU.
+@param roi region of the picture to convert, in pixels; the whole picture is converted if it is empty.
+@param mean values subtracted from the corresponding output channels.
+@param scale multipliers applied to the corresponding output channels after the mean subtraction.
+
+@sa cvtColor, colorResizeNormalize
+ */
+CV_EXPORTS_W void cvtColorYUV2Planar( InputArray src, OutputArray dst, int code, const Rect& roi = Rect(),
+                                      const Scalar& mean = Scalar(), const Scalar& scale = Scalar::all(1) );
+
 /** @brief Applies an affine transformation to an image.
 
 The function warpAffine transforms the source image using the specified matrix:
@@ -3478,9 +3609,12 @@ distinct labels. When labelType==DIST_LABEL_CCOMP, the function scans through th
 marks all the zero pixels with distinct labels.
 
 In this mode, the complexity is still linear. That is, the function provides a very fast way to
-compute the Voronoi diagram for a binary image. Currently, the second variant can use only the
-approximate distance transform algorithm, i.e. maskSize=DIST_MASK_PRECISE is not supported
-yet.
+compute the Voronoi diagram for a binary image. With distanceType == DIST_L2 and
+maskSize == DIST_MASK_PRECISE the labels are computed together with the exact euclidean distance;
+in all other cases the \f$5\times 5\f$ mask is used.
+
+When several threads are available, the mask based transform without labels is computed in
+parallel. The result is the same as the one of the sequential algorithm.
 
 @param src 8-bit, single-channel (binary) source image.
 @param dst Output image with calculated distances. It is a 8-bit or 32-bit floating-point,
@@ -3489,9 +3623,8 @@ single-channel image of the same size as src.
 CV_32SC1 and the same size as src.
 @param distanceType Type of distance, see cv::DistanceTypes
 @param maskSize Size of the distance transform mask, see cv::DistanceTransformMasks.
-DIST_MASK_PRECISE is not supported by this variant. In case of the DIST_L1 or DIST_C distance type,
-the parameter is forced to 3 because a \f$3\times 3\f$ mask gives the same result as \f$5\times
-5\f$ or any larger aperture.
+DIST_MASK_PRECISE is supported by this variant only for the DIST_L2 distance type, otherwise the
+parameter is forced to 5.
 @param labelType Type of the label array to build, see cv::DistanceTransformLabelTypes.
  */
 CV_EXPORTS_AS(distanceTransformWithLabels) void distanceTransform( InputArray src, OutputArray dst,
@@ -3512,6 +3645,23 @@ the first variant of the function and distanceType == DIST_L1.
 CV_EXPORTS_W void distanceTransform( InputArray src, OutputArray dst,
                                      int distanceType, int maskSize, int dstType=CV_32F);
 
+/** @brief Calculates the distance to the closest zero voxel for each voxel of a volume.
+
+The function computes the exact distance with the separable algorithm @cite Felzenszwalb04 applied
+along each of the three axes, the lines of each axis are processed in parallel. The voxels may be
+anisotropic, as the slices of CT or MRI scans usually are.
+
+@param src 8-bit, single-channel (binary) 3-dimensional continuous matrix. Its dimensions are the
+slices, the rows and the columns.
+@param dst Output 3-dimensional matrix of the same size as src with the calculated distances. It
+has the type CV_32FC1.
+@param distanceType Type of distance, DIST_L1 or DIST_L2.
+@param spacing Size of the voxel along x (columns), y (rows) and z (slices). The distances are
+measured in the same units.
+*/
+CV_EXPORTS void distanceTransform3D( InputArray src, OutputArray dst, int distanceType = DIST_L2,
+                                     const Vec3f& spacing = Vec3f(1, 1, 1) );
+
 /** @example ffilldemo.cpp
   An example using the FloodFill technique
 */
@@ -3600,6 +3750,34 @@ CV_EXPORTS_W int floodFill( InputOutputArray image, InputOutputArray mask,
                             Scalar loDiff = Scalar(), Scalar upDiff = Scalar(),
                             int flags = 4 );
 
+/** @brief Fills a number of connected components, one per seed point.
+
+The function gives the same result as calling floodFill for each of the seed points in turn, but
+the parameters are validated, the mask border is initialized and the internal buffers are allocated
+only once. When no mask is passed, the internal mask is cleared only within the bounding rectangle
+of each filled component. This makes the function much cheaper than a loop over floodFill when
+many small components are filled.
+
+@param image Input/output 1- or 3-channel, 8-bit, or floating-point image, see floodFill.
+@param mask Operation mask or an empty matrix, see floodFill.
+@param seedPoints Starting points.
+@param newVals New values of the repainted domain pixels. Either one value for all the seeds or
+one value per seed.
+@param areas Optional output vector of the numbers of filled pixels, one per seed.
+@param rects Optional output vector of the bounding rectangles of the repainted domains.
+@param loDiff Maximal lower brightness/color difference, see floodFill.
+@param upDiff Maximal upper brightness/color difference, see floodFill.
+@param flags Operation flags, see floodFill and cv::FloodFillFlags.
+
+@sa floodFill
+ */
+CV_EXPORTS void floodFillBatch( InputOutputArray image, InputOutputArray mask,
+                                const std::vector<Point>& seedPoints,
+                                const std::vector<Scalar>& newVals,
+                                std::vector<int>* areas = 0, std::vector<Rect>* rects = 0,
+                                Scalar loDiff = Scalar(), Scalar upDiff = Scalar(),
+                                int flags = 4 );
+
 /** @brief Converts an image from one color space to another.
 
 The function converts an input image from one color space to another. In case of a transformation
@@ -3739,6 +3917,22 @@ not set by default. Currently, only the TM_SQDIFF and TM_CCORR_NORMED methods ar
 CV_EXPORTS_W void matchTemplate( InputArray image, InputArray templ,
                                  OutputArray result, int method, InputArray mask = noArray() );
 
+/** @brief Compares several templates against overlapped image regions.
+
+The function is equivalent to calling matchTemplate for every template, but it computes the
+spectrum of every image block and the integral images of the source only once, sharing them
+between all the templates. Small templates are matched directly in the spatial domain.
+
+@param image Image where the search is running. It must be 8-bit or 32-bit floating-point.
+@param templs Searched templates. Each must be not greater than the source image and have the
+same data type.
+@param results Output vector of comparison maps, one per template. Each is single-channel 32-bit
+floating-point of size \f$(W-w_i+1) \times (H-h_i+1)\f$ .
+@param method Parameter specifying the comparison method, see cv::TemplateMatchModes
+ */
+CV_EXPORTS_W void matchTemplateBatch( InputArray image, InputArrayOfArrays templs,
+                                      OutputArrayOfArrays results, int method );
+
 //! @}
 
 //! @addtogroup imgproc_shape
@@ -4222,6 +4416,16 @@ CV_EXPORTS_W int rotatedRectangleIntersection( const RotatedRect& rect1, const R
 
 CV_EXPORTS_W Ptr<CLAHE> createCLAHE(double clipLimit = 40.0, Size tileGridSize = Size(8, 8));
 
+/** @brief Creates a SlidingHistogram object.
+
+@param histSize Number of the histogram bins.
+@param rangeMin Inclusive lower boundary of the histogram range.
+@param rangeMax Exclusive upper boundary of the histogram range. The pixels outside of the range
+are not counted in the histogram but contribute to the mean and the standard deviation.
+ */
+CV_EXPORTS_W Ptr<SlidingHistogram> createSlidingHistogram(int histSize = 256, float rangeMin = 0.f,
+                                                          float rangeMax = 256.f);
+
 //! Ballard, D.H. (1981). Generalizing the Hough transform to detect arbitrary shapes. Pattern Recognition 13 (2): 111-122.
 //! Detects position only without translation and rotation
 CV_EXPORTS Ptr<GeneralizedHoughBallard> createGeneralizedHoughBallard();
@@ -4279,6 +4483,59 @@ CV_EXPORTS_W void applyColorMap(InputArray src, OutputArray dst, int colormap);
 */
 CV_EXPORTS_W void applyColorMap(InputArray src, OutputArray dst, InputArray userColor);
 
+//! Interpolation methods of applyLUT3D
+enum LUT3DInterpolationTypes
+{
+    LUT3D_INTER_TRILINEAR   = 0, //!< interpolation between the 8 nodes of the lattice cell
+    LUT3D_INTER_TETRAHEDRAL = 1  //!< interpolation between the 4 nodes of the tetrahedron of the cell that contains the color
+};
+
+/** @brief Callback function defining the color transformation baked by cv::bakeLUT3D.
+
+@param src Input color, 3 components in [0, 1].
+@param dst Output color, 3 components in the same scale.
+@param userdata The optional parameter.
+ */
+typedef void (*LUT3DCallback)(const float* src, float* dst, void* userdata);
+
+/** @brief Applies a 3D lookup table to a color image.
+
+The pixel color \f$(c_0, c_1, c_2)\f$ is normalized to [0, 1] (the 8-bit and 16-bit values are divided
+by 255 and 65535 respectively, the floating-point values are clipped) and mapped to the lattice of the
+LUT nodes. The output color is interpolated between the nodes of the lattice cell containing the
+input color and scaled back to the range of the image depth. The fourth channel, if any, is copied
+as is. The colors are processed in the channel order of the image, no BGR/RGB swapping is done.
+
+@param src Source 3- or 4-channel image of CV_8U, CV_16U or CV_32F depth.
+@param lut Lookup table of \f$N^3\f$ CV_32FC3 nodes, \f$N \ge 2\f$ (the common sizes are 17, 33 and
+65). It is either a 3-dimensional N x N x N matrix or a 2D matrix with N*N rows and N columns. The node
+for the input color \f$(i, j, k)/(N-1)\f$ is stored at (i, j, k) or (i*N + j, k) respectively. The node
+values are normally in [0, 1].
+@param dst Destination image of the same size and type as src.
+@param interpolation Interpolation method, see cv::LUT3DInterpolationTypes.
+
+@sa bakeLUT3D, LUT
+ */
+CV_EXPORTS_W void applyLUT3D(InputArray src, InputArray lut, OutputArray dst,
+                             int interpolation = LUT3D_INTER_TETRAHEDRAL);
+
+/** @brief Bakes a per-pixel color transformation into a 3D lookup table.
+
+The transformation is evaluated once per lattice node, after that applyLUT3D applies it to an image at
+a fixed cost per pixel that does not depend on the complexity of the transformation. The nodes are
+computed in parallel, so the callback must be thread-safe.
+
+When func is NULL the identity table is created. Since it is a regular CV_32FC3 image, an existing
+per-pixel floating-point pipeline (for example cvtColor followed by a tone curve) can be run on it
+instead of the callback to bake the whole pipeline into the table.
+
+@param size Number of the lattice nodes along each axis, N >= 2.
+@param lut Output N*N x N CV_32FC3 lookup table in the format of applyLUT3D.
+@param func Color transformation or NULL.
+@param userdata The optional parameter passed to the callback.
+ */
+CV_EXPORTS void bakeLUT3D(int size, OutputArray lut, LUT3DCallback func = 0, void* userdata = 0);
+
 //! @} imgproc_colormap
 
 //! @addtogroup imgproc_draw
@@ -4513,6 +4770,69 @@ CV_EXPORTS_W void polylines(InputOutputArray img, InputArrayOfArrays pts,
                             bool isClosed, const Scalar& color,
                             int thickness = 1, int lineType = LINE_8, int shift = 0 );
 
+/** @brief Records drawing operations to render them at once.
+
+Drawing many shapes with the separate functions like line or fillPoly is done in a single thread,
+one shape after another. DrawingBatch collects the shapes, with the same parameters as the
+corresponding drawing functions, and draw renders all of them in one call: the image is split into
+horizontal bands, which are rendered in parallel. Every band draws the shapes intersecting it in the
+order of addition, so the result is identical to calling the drawing functions one by one.
+
+@code{.cpp}
+DrawingBatch batch;
+for( size_t i = 0; i < boxes.size(); i++ )
+    batch.rectangle(boxes[i], Scalar(0, 255, 0), 2);
+batch.fillPoly(regions, Scalar(0, 0, 255));
+batch.draw(frame);
+@endcode
+ */
+class CV_EXPORTS DrawingBatch
+{
+public:
+    DrawingBatch();
+    ~DrawingBatch();
+
+    /** @brief Adds a line segment. See cv::line. */
+    void line(Point pt1, Point pt2, const Scalar& color,
+              int thickness = 1, int lineType = LINE_8, int shift = 0);
+    /** @brief Adds a rectangle. See cv::rectangle. */
+    void rectangle(Point pt1, Point pt2, const Scalar& color,
+                   int thickness = 1, int lineType = LINE_8, int shift = 0);
+    /** @overload */
+    void rectangle(Rect rec, const Scalar& color,
+                   int thickness = 1, int lineType = LINE_8, int shift = 0);
+    /** @brief Adds a circle. See cv::circle. */
+    void circle(Point center, int radius, const Scalar& color,
+                int thickness = 1, int lineType = LINE_8, int shift = 0);
+    /** @brief Adds one or more polygonal curves. See cv::polylines. */
+    void polylines(InputArrayOfArrays pts, bool isClosed, const Scalar& color,
+                   int thickness = 1, int lineType = LINE_8, int shift = 0);
+    /** @brief Adds an area bounded by one or more polygons. See cv::fillPoly. */
+    void fillPoly(InputArrayOfArrays pts, const Scalar& color,
+                  int lineType = LINE_8, int shift = 0, Point offset = Point());
+    /** @brief Adds a filled convex polygon. See cv::fillConvexPoly. */
+    void fillConvexPoly(InputArray points, const Scalar& color,
+                        int lineType = LINE_8, int shift = 0);
+
+    /** @brief Draws all the recorded operations in the image.
+
+    The operations are kept, so the same batch can be drawn in several images.
+    @param img Image. The colors are converted to its type as in the drawing functions.
+     */
+    void draw(InputOutputArray img) const;
+
+    //! removes all the recorded operations
+    void clear();
+    //! returns the number of recorded operations
+    size_t size() const;
+    //! returns true if there are no recorded operations
+    bool empty() const;
+
+    struct Impl;
+protected:
+    Ptr<Impl> p;
+};
+
 /** @example contours2.cpp
   An example program illustrates the use of cv::findContours and cv::drawContours
   \image html WindowsQtContoursOutput.png "Screenshot of the program"
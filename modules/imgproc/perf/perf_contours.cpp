@@ -0,0 +1,48 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using namespace testing;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(RetrMode, RETR_EXTERNAL, RETR_LIST, RETR_CCOMP, RETR_TREE)
+CV_ENUM(ApproxMode, CHAIN_APPROX_NONE, CHAIN_APPROX_SIMPLE, CHAIN_APPROX_TC89_L1, CHAIN_APPROX_TC89_KCOS)
+
+typedef std::tr1::tuple<Size, RetrMode, ApproxMode, int> TestFindContours_t;
+typedef perf::TestBaseWithParam<TestFindContours_t> TestFindContours;
+
+PERF_TEST_P(TestFindContours, findContours,
+            Combine(
+                Values(szVGA, sz1080p, Size(8192, 8192)),
+                RetrMode::all(),
+                Values((int)CHAIN_APPROX_NONE, (int)CHAIN_APPROX_SIMPLE),
+                Values(32, 128) // number of blobs per 1024x1024 block
+            )
+)
+{
+    Size img_size = get<0>(GetParam());
+    int retr_mode = get<1>(GetParam());
+    int approx_method = get<2>(GetParam());
+    int density = get<3>(GetParam());
+
+    Mat img = Mat::zeros(img_size, CV_8UC1);
+    RNG rng(0xFFFFFFFF);
+    int blobs = (int)((double)img_size.area()*density/(1024*1024));
+    for( int i = 0; i < blobs; i++ )
+    {
+        Point center(rng.uniform(0, img.cols), rng.uniform(0, img.rows));
+        Size axes(rng.uniform(2, 40), rng.uniform(2, 40));
+        ellipse(img, center, axes, rng.uniform(0, 180), 0, 360, Scalar::all(255), rng.uniform(-1, 5));
+    }
+
+    vector<vector<Point> > contours;
+    TEST_CYCLE() findContours(img, contours, retr_mode, approx_method);
+
+    SANITY_CHECK_NOTHING();
+}
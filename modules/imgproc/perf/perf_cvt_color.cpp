@@ -109,6 +109,13 @@ CV_ENUM(CvtModeBayer,
     COLOR_BayerRG2BGR, COLOR_BayerRG2BGRA, COLOR_BayerRG2BGR_VNG, COLOR_BayerRG2GRAY
     )
 
+CV_ENUM(DemosaicingCode,
+    COLOR_BayerBG2BGR, COLOR_BayerBG2BGRA, COLOR_BayerBG2BGR_VNG, COLOR_BayerBG2BGR_EA, COLOR_BayerBG2GRAY,
+    COLOR_BayerGB2BGR, COLOR_BayerGB2BGRA, COLOR_BayerGB2BGR_VNG, COLOR_BayerGB2BGR_EA, COLOR_BayerGB2GRAY,
+    COLOR_BayerGR2BGR, COLOR_BayerGR2BGRA, COLOR_BayerGR2BGR_VNG, COLOR_BayerGR2BGR_EA, COLOR_BayerGR2GRAY,
+    COLOR_BayerRG2BGR, COLOR_BayerRG2BGRA, COLOR_BayerRG2BGR_VNG, COLOR_BayerRG2BGR_EA, COLOR_BayerRG2GRAY
+    )
+
 
 CV_ENUM(CvtMode2, COLOR_YUV2BGR_NV12, COLOR_YUV2BGRA_NV12, COLOR_YUV2RGB_NV12, COLOR_YUV2RGBA_NV12, COLOR_YUV2BGR_NV21, COLOR_YUV2BGRA_NV21, COLOR_YUV2RGB_NV21, COLOR_YUV2RGBA_NV21,
                   COLOR_YUV2BGR_YV12, COLOR_YUV2BGRA_YV12, COLOR_YUV2RGB_YV12, COLOR_YUV2RGBA_YV12, COLOR_YUV2BGR_IYUV, COLOR_YUV2BGRA_IYUV, COLOR_YUV2RGB_IYUV, COLOR_YUV2RGBA_IYUV,
@@ -301,6 +308,36 @@ PERF_TEST_P(Size_CvtMode_Bayer, cvtColorBayer8u,
     SANITY_CHECK(dst, 1);
 }
 
+typedef std::tr1::tuple<Size, MatDepth, DemosaicingCode> Size_Depth_DemosaicingCode_t;
+typedef perf::TestBaseWithParam<Size_Depth_DemosaicingCode_t> Size_Depth_DemosaicingCode;
+
+PERF_TEST_P(Size_Depth_DemosaicingCode, demosaicing,
+            testing::Combine(
+                testing::Values(::perf::szVGA, ::perf::sz1080p),
+                testing::Values(CV_8U, CV_16U),
+                DemosaicingCode::all()
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int depth = get<1>(GetParam());
+    int code = get<2>(GetParam());
+    int dcn = code == COLOR_BayerBG2GRAY || code == COLOR_BayerGB2GRAY ||
+              code == COLOR_BayerGR2GRAY || code == COLOR_BayerRG2GRAY ? 1 :
+              code == COLOR_BayerBG2BGRA || code == COLOR_BayerGB2BGRA ||
+              code == COLOR_BayerGR2BGRA || code == COLOR_BayerRG2BGRA ? 4 : 3;
+
+    Mat src(sz, CV_MAKETYPE(depth, 1));
+    Mat dst(sz, CV_MAKETYPE(depth, dcn));
+
+    declare.time(100);
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() demosaicing(src, dst, code, dcn);
+
+    SANITY_CHECK_NOTHING();
+}
+
 typedef std::tr1::tuple<Size, CvtMode2> Size_CvtMode2_t;
 typedef perf::TestBaseWithParam<Size_CvtMode2_t> Size_CvtMode2;
 
@@ -376,3 +413,52 @@ PERF_TEST_P(EdgeAwareDemosaicingTest, demosaicingEA,
 
     SANITY_CHECK(dst, 1);
 }
+
+CV_ENUM(YUV2PlanarMode, COLOR_YUV2RGB_NV12, COLOR_YUV2BGR_IYUV, COLOR_YUV2RGB_YUY2)
+
+typedef std::tr1::tuple<Size, YUV2PlanarMode, bool> YUV2PlanarParams;
+typedef perf::TestBaseWithParam<YUV2PlanarParams> Size_YUV2PlanarMode_Direct;
+
+PERF_TEST_P(Size_YUV2PlanarMode_Direct, cvtColorYUV2Planar,
+            testing::Combine(
+                testing::Values(szVGA, sz1080p),
+                YUV2PlanarMode::all(),
+                testing::Bool()
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int mode = get<1>(GetParam());
+    bool direct = get<2>(GetParam());
+
+    Mat src;
+    if (mode == COLOR_YUV2RGB_YUY2)
+        src.create(sz, CV_8UC2);
+    else
+        src.create(sz.height + sz.height / 2, sz.width, CV_8UC1);
+    declare.in(src, WARMUP_RNG);
+
+    Scalar mean(127.5, 127.5, 127.5), scale(1/127.5, 1/127.5, 1/127.5);
+    int blobSize[] = { 1, 3, sz.height, sz.width };
+    Mat blob(4, blobSize, CV_32F);
+
+    if (direct)
+    {
+        TEST_CYCLE() cvtColorYUV2Planar(src, blob, mode, Rect(), mean, scale);
+    }
+    else
+    {
+        // interleaved 8-bit conversion followed by repacking into float planes
+        TEST_CYCLE()
+        {
+            Mat rgb, planes[3];
+            cvtColor(src, rgb, mode);
+            for (int c = 0; c < 3; c++)
+                planes[c] = Mat(sz, CV_32F, blob.ptr<float>(0, c));
+            rgb.convertTo(rgb, CV_32F, scale[0], -mean[0] * scale[0]);
+            split(rgb, planes);
+        }
+    }
+
+    SANITY_CHECK_NOTHING();
+}
@@ -100,3 +100,30 @@ PERF_TEST_P(DistanceTransform_NeedLabels_Test, distanceTransform_NeedLabels,
     SANITY_CHECK(label, eps);
     SANITY_CHECK(dst, eps);
 }
+
+typedef std::tr1::tuple<int, DistanceType> VolumeSize_DistType;
+typedef perf::TestBaseWithParam<VolumeSize_DistType> DistanceTransform3D_Test;
+
+PERF_TEST_P(DistanceTransform3D_Test, distanceTransform3D,
+            testing::Combine(
+                testing::Values(64, 128, 256),
+                testing::Values((int)DIST_L1, (int)DIST_L2)
+                )
+            )
+{
+    int n = get<0>(GetParam());
+    int distanceType = get<1>(GetParam());
+    int sizes[] = { n, n, n };
+
+    Mat src(3, sizes, CV_8U), noise(3, sizes, CV_32F);
+    randu(noise, 0., 1.);
+    src.setTo(Scalar::all(255));
+    src.setTo(Scalar::all(0), noise < 0.001);
+    Mat dst(3, sizes, CV_32F, Scalar::all(0));
+
+    declare.in(src).out(dst).time(60);
+
+    TEST_CYCLE() distanceTransform3D(src, dst, distanceType, Vec3f(0.5f, 0.5f, 1.25f));
+
+    SANITY_CHECK_NOTHING();
+}
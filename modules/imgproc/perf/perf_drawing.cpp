@@ -0,0 +1,110 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using namespace testing;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+enum { DRAW_SEQUENTIAL = 0, DRAW_BATCH = 1 };
+CV_ENUM(DrawMode, DRAW_SEQUENTIAL, DRAW_BATCH)
+CV_ENUM(DrawLineType, LINE_8, LINE_AA)
+
+typedef std::tr1::tuple<Size, DrawLineType, DrawMode> Size_LineType_Mode_t;
+typedef perf::TestBaseWithParam<Size_LineType_Mode_t> Size_LineType_Mode;
+
+PERF_TEST_P(Size_LineType_Mode, drawOverlay,
+            Combine(Values(sz1080p, sz2160p), DrawLineType::all(), DrawMode::all()))
+{
+    Size sz = get<0>(GetParam());
+    int lineType = get<1>(GetParam());
+    int mode = get<2>(GetParam());
+    const int N = 5000;
+
+    // boxes with labels' background, lines and polygons spread over the frame
+    RNG rng(0x12345);
+    vector<Rect> boxes(N), labels(N);
+    vector<Point> lines(2*N);
+    vector<vector<Point> > polys(N);
+    vector<Scalar> colors(N);
+    for (int i = 0; i < N; i++)
+    {
+        Point p(rng.uniform(0, sz.width), rng.uniform(0, sz.height));
+        boxes[i] = Rect(p, Size(rng.uniform(10, 150), rng.uniform(10, 150)));
+        labels[i] = Rect(p - Point(0, 12), Size(rng.uniform(30, 80), 12));
+        lines[2*i] = p;
+        lines[2*i + 1] = p + Point(rng.uniform(-100, 100), rng.uniform(-100, 100));
+        for (int k = 0; k < 5; k++)
+            polys[i].push_back(p + Point(rng.uniform(-40, 40), rng.uniform(-40, 40)));
+        colors[i] = Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+    }
+
+    Mat img(sz, CV_8UC3, Scalar::all(0));
+    declare.in(img).time(60);
+
+    if (mode == DRAW_SEQUENTIAL)
+    {
+        TEST_CYCLE()
+        {
+            for (int i = 0; i < N; i++)
+            {
+                rectangle(img, boxes[i], colors[i], 2, lineType);
+                rectangle(img, labels[i], colors[i], FILLED, lineType);
+                line(img, lines[2*i], lines[2*i + 1], colors[i], 1, lineType);
+                polylines(img, polys[i], true, colors[i], 1, lineType);
+                fillPoly(img, vector<vector<Point> >(1, polys[i]), colors[i], lineType);
+            }
+        }
+    }
+    else
+    {
+        TEST_CYCLE()
+        {
+            DrawingBatch batch;
+            for (int i = 0; i < N; i++)
+            {
+                batch.rectangle(boxes[i], colors[i], 2, lineType);
+                batch.rectangle(labels[i], colors[i], FILLED, lineType);
+                batch.line(lines[2*i], lines[2*i + 1], colors[i], 1, lineType);
+                batch.polylines(polys[i], true, colors[i], 1, lineType);
+                batch.fillPoly(vector<vector<Point> >(1, polys[i]), colors[i], lineType);
+            }
+            batch.draw(img);
+        }
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef std::tr1::tuple<Size, MatType> Size_MatType_t;
+typedef perf::TestBaseWithParam<Size_MatType_t> Size_MatType_Draw;
+
+PERF_TEST_P(Size_MatType_Draw, fillRectangles,
+            Combine(Values(sz1080p), Values(CV_8UC1, CV_8UC3, CV_8UC4)))
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    const int N = 20000;
+
+    RNG rng(0x12345);
+    vector<Rect> boxes(N);
+    for (int i = 0; i < N; i++)
+        boxes[i] = Rect(Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)),
+                        Size(rng.uniform(4, 64), rng.uniform(4, 64)));
+
+    Mat img(sz, type, Scalar::all(0));
+    declare.in(img);
+
+    TEST_CYCLE()
+    {
+        for (int i = 0; i < N; i++)
+            rectangle(img, boxes[i], Scalar(10, 20, 30, 40), FILLED);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
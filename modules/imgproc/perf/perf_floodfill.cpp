@@ -71,3 +71,107 @@ PERF_TEST_P(Size_Source_Fl, floodFill1, Combine(
     EXPECT_EQ(image0.rows, source.rows);
     SANITY_CHECK_NOTHING();
 }
+
+static Mat makeSegmentationImage(Size sz, int nregions)
+{
+    // square cells labeled in a checkerboard-like fashion, each one is a separate component
+    Mat img(sz, CV_8UC1);
+    int cell = std::max(cvRound(std::sqrt((double)sz.area()/nregions)), 2);
+    for (int y = 0; y < sz.height; y++)
+    {
+        uchar* row = img.ptr<uchar>(y);
+        for (int x = 0; x < sz.width; x++)
+            row[x] = (uchar)(((x/cell + y/cell) & 1)*100 + 50);
+    }
+    return img;
+}
+
+CV_ENUM(FloodFillMode, 0, FLOODFILL_FIXED_RANGE, FLOODFILL_MASK_ONLY)
+
+typedef std::tr1::tuple<Size, FloodFillMode, bool> Size_FloodFillMode_Batch_t;
+typedef perf::TestBaseWithParam<Size_FloodFillMode_Batch_t> Size_FloodFillMode_Batch;
+
+PERF_TEST_P(Size_FloodFillMode_Batch, floodFillBatch, Combine(
+    testing::Values(szVGA, sz1080p),
+    FloodFillMode::all(),
+    testing::Bool() // floodFillBatch or a loop of floodFill
+    ))
+{
+    Size sz = get<0>(GetParam());
+    int mode = get<1>(GetParam());
+    bool batch = get<2>(GetParam());
+    const int nseeds = 2000;
+
+    Mat image0 = makeSegmentationImage(sz, nseeds), image, mask;
+    Scalar diff = mode == 0 ? Scalar() : Scalar::all(10);
+    int flags = 4 | mode;
+
+    RNG rng(0);
+    vector<Point> seeds(nseeds);
+    vector<Scalar> vals(nseeds);
+    for (int i = 0; i < nseeds; i++)
+    {
+        seeds[i] = Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height));
+        vals[i] = Scalar(rng.uniform(0, 256));
+    }
+    vector<int> areas;
+
+    image0.copyTo(image);
+    declare.in(image0).out(image);
+
+    for (; next(); )
+    {
+        image0.copyTo(image);
+        if (mode == FLOODFILL_MASK_ONLY)
+            mask = Mat::zeros(sz.height + 2, sz.width + 2, CV_8UC1);
+        startTimer();
+        if (batch)
+            cv::floodFillBatch(image, mask, seeds, vals, &areas, 0, diff, diff, flags);
+        else
+            for (int i = 0; i < nseeds; i++)
+                cv::floodFill(image, mask, seeds[i], vals[i], 0, diff, diff, flags);
+        stopTimer();
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef std::tr1::tuple<Size, FloodFillMode, bool> Size_FloodFillMode_Parallel_t;
+typedef perf::TestBaseWithParam<Size_FloodFillMode_Parallel_t> Size_FloodFillMode_Parallel;
+
+PERF_TEST_P(Size_FloodFillMode_Parallel, floodFillLargeRegion, Combine(
+    testing::Values(sz1080p, Size(4096, 4096)),
+    FloodFillMode::all(),
+    testing::Bool() // FLOODFILL_PARALLEL
+    ))
+{
+    Size sz = get<0>(GetParam());
+    int mode = get<1>(GetParam());
+    bool parallel = get<2>(GetParam());
+
+    // one big region with a few holes
+    Mat image0(sz, CV_8UC1, Scalar(50)), image, mask;
+    RNG rng(0);
+    for (int i = 0; i < 100; i++)
+        circle(image0, Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)),
+               rng.uniform(5, 50), Scalar(200), -1);
+    Scalar diff = mode == 0 ? Scalar() : Scalar::all(10);
+    int flags = 8 | mode | (parallel ? FLOODFILL_PARALLEL : 0);
+    Point seed(0, 0);
+    image0.at<uchar>(seed) = 50;
+
+    image0.copyTo(image);
+    declare.in(image0).out(image);
+
+    for (; next(); )
+    {
+        image0.copyTo(image);
+        if (mode == FLOODFILL_MASK_ONLY)
+            mask = Mat::zeros(sz.height + 2, sz.width + 2, CV_8UC1);
+        startTimer();
+        cv::floodFill(image, mask, seed, Scalar(100), 0, diff, diff, flags);
+        stopTimer();
+    }
+
+    SANITY_CHECK_NOTHING();
+}
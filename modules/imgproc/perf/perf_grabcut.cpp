@@ -0,0 +1,49 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using namespace testing;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(GrabCutWeights, 0, GC_FLOAT_WEIGHTS)
+
+typedef std::tr1::tuple<Size, GrabCutWeights> Size_GrabCutWeights_t;
+typedef perf::TestBaseWithParam<Size_GrabCutWeights_t> Size_GrabCutWeights;
+
+PERF_TEST_P(Size_GrabCutWeights, grabCut,
+            Combine(Values(szVGA, sz720p), GrabCutWeights::all()))
+{
+    Size sz = get<0>(GetParam());
+    int weights = get<1>(GetParam());
+
+    Mat objects = Mat::zeros(sz, CV_8U);
+    circle(objects, Point(sz.width/3, sz.height/2), sz.height/4, Scalar(255), FILLED);
+    rectangle(objects, Rect(sz.width/2, sz.height/4, sz.width/4, sz.height/2), Scalar(255), FILLED);
+
+    Mat img(sz, CV_8UC3), fg(sz, CV_8UC3);
+    RNG rng(0x12345);
+    rng.fill(img, RNG::NORMAL, Scalar(140, 110, 60), Scalar(20, 20, 20));
+    rng.fill(fg, RNG::NORMAL, Scalar(40, 70, 200), Scalar(20, 20, 20));
+    fg.copyTo(img, objects);
+
+    Rect rect(sz.width/8, sz.height/8, sz.width*3/4, sz.height*3/4);
+    Mat mask, bgdModel, fgdModel;
+
+    declare.in(img);
+
+    TEST_CYCLE()
+    {
+        theRNG().state = 0x54321;
+        bgdModel.release();
+        fgdModel.release();
+        grabCut(img, mask, rect, bgdModel, fgdModel, 2, GC_INIT_WITH_RECT | weights);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
@@ -139,3 +139,76 @@ PERF_TEST_P(Sz_ClipLimit, CLAHE,
 
     SANITY_CHECK(dst);
 }
+
+typedef tr1::tuple<int, bool> WinSize_Incremental_t;
+typedef TestBaseWithParam<WinSize_Incremental_t> WinSize_Incremental;
+
+PERF_TEST_P(WinSize_Incremental, SlidingHistogram,
+            testing::Combine(testing::Values(32, 64, 128),
+                             testing::Bool())
+            )
+{
+    const int winSize = get<0>(GetParam());
+    const bool incremental = get<1>(GetParam());
+
+    Mat src(::perf::szVGA, CV_8UC1);
+    declare.in(src, WARMUP_RNG);
+
+    // the window moves over the image by 2 pixels, the statistics are queried on every move
+    vector<Rect> windows;
+    for (int x = 0; x + winSize <= src.cols; x += 2)
+        windows.push_back(Rect(x, (src.rows - winSize)/2, winSize, winSize));
+
+    Ptr<SlidingHistogram> sh = createSlidingHistogram();
+    sh->setImage(src);
+    Mat hist;
+    double mean = 0, stddev = 0;
+    Scalar mean0, stddev0;
+    const int histSize = 256;
+    const float range[] = { rangeLow, rangeHight };
+    const float* ranges[] = { range };
+    const int channels[] = { 0 };
+
+    TEST_CYCLE()
+    {
+        for (size_t i = 0; i < windows.size(); i++)
+        {
+            if (incremental)
+            {
+                sh->setWindow(windows[i]);
+                sh->getHist(hist);
+                sh->getMeanStdDev(mean, stddev);
+            }
+            else
+            {
+                Mat roi = src(windows[i]);
+                calcHist(&roi, 1, channels, Mat(), hist, 1, &histSize, ranges);
+                meanStdDev(roi, mean0, stddev0);
+            }
+        }
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(TestMatSize, SlidingHistogram_calcWindows,
+            testing::Values(::perf::szVGA, ::perf::sz1080p))
+{
+    const Size size = GetParam();
+
+    Mat src(size, CV_8UC1);
+    declare.in(src, WARMUP_RNG);
+
+    vector<Rect> windows;
+    for (int y = 0; y + 64 <= size.height; y += 8)
+        for (int x = 0; x + 64 <= size.width; x += 4)
+            windows.push_back(Rect(x, y, 64, 64));
+
+    Ptr<SlidingHistogram> sh = createSlidingHistogram(64);
+    sh->setImage(src);
+    Mat hists, means, stddevs;
+
+    TEST_CYCLE() sh->calcWindows(windows, hists, means, stddevs);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -71,3 +71,63 @@ PERF_TEST_P(Image_RhoStep_ThetaStep_Threshold, HoughLines,
 
     SANITY_CHECK_NOTHING();
 }
+
+typedef std::tr1::tuple<Size, int> Size_Threads_t;
+typedef perf::TestBaseWithParam<Size_Threads_t> Size_Threads;
+
+PERF_TEST_P(Size_Threads, HoughLines_threads,
+            testing::Combine(
+                testing::Values( sz720p, sz1080p ),
+                testing::Values( 1, 2, 4, 8 )
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    Mat image(sz, CV_8UC1, Scalar::all(0));
+    RNG rng(12345);
+    for (int i = 0; i < 50; i++)
+        line(image, Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)),
+             Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)), Scalar::all(255), 1);
+
+    vector<Vec2f> lines;
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+
+    TEST_CYCLE() HoughLines(image, lines, 1, CV_PI/180, 100);
+
+    setNumThreads(nthreads);
+    EXPECT_GE(lines.size(), 10u);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Size_Threads, HoughCircles,
+            testing::Combine(
+                testing::Values( sz720p, sz1080p ),
+                testing::Values( 1, 2, 4, 8 )
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    Mat image(sz, CV_8UC1, Scalar::all(30));
+    RNG rng(12345);
+    for (int i = 0; i < 20; i++)
+        circle(image, Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)),
+               rng.uniform(20, 100), Scalar::all(rng.uniform(100, 255)), -1);
+    GaussianBlur(image, image, Size(5, 5), 1.5);
+
+    vector<Vec3f> circles;
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+
+    TEST_CYCLE() HoughCircles(image, circles, HOUGH_GRADIENT, 1, 20, 100, 30, 10, 120);
+
+    setNumThreads(nthreads);
+    EXPECT_GT(circles.size(), 0u);
+
+    SANITY_CHECK_NOTHING();
+}
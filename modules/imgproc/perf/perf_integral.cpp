@@ -82,3 +82,64 @@ PERF_TEST_P( Size_MatType_OutMatDepth, integral_sqsum_tilted,
     SANITY_CHECK(sqsum, 1e-6);
     SANITY_CHECK(tilted, 1e-6, tilted.depth() > CV_32S ? ERROR_RELATIVE : ERROR_ABSOLUTE);
 }
+
+typedef std::tr1::tuple<Size, MatType, MatDepth, int> Size_MatType_OutMatDepth_Threads_t;
+typedef perf::TestBaseWithParam<Size_MatType_OutMatDepth_Threads_t> Size_MatType_OutMatDepth_Threads;
+
+PERF_TEST_P(Size_MatType_OutMatDepth_Threads, integral_threads,
+            testing::Combine(
+                testing::Values(::perf::sz1080p, ::perf::sz2160p),
+                testing::Values(CV_8UC1, CV_8UC4, CV_32FC1),
+                testing::Values(CV_32S, CV_32F, CV_64F),
+                testing::Values(1, 2, 4, 8)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int matType = get<1>(GetParam());
+    int sdepth = get<2>(GetParam());
+    int threads = get<3>(GetParam());
+
+    if( CV_MAT_DEPTH(matType) == CV_32F && sdepth == CV_32S )
+        throw ::perf::TestBase::PerfSkipTestException();
+
+    Mat src(sz, matType);
+    Mat sum(sz, sdepth);
+
+    declare.in(src, WARMUP_RNG).out(sum);
+
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() integral(src, sum, sdepth);
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Size_MatType_OutMatDepth_Threads, integral_sqsum_threads,
+            testing::Combine(
+                testing::Values(::perf::sz1080p, ::perf::sz2160p),
+                testing::Values(CV_8UC1, CV_8UC4),
+                testing::Values(CV_32S, CV_32F),
+                testing::Values(1, 2, 4, 8)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int matType = get<1>(GetParam());
+    int sdepth = get<2>(GetParam());
+    int threads = get<3>(GetParam());
+
+    Mat src(sz, matType);
+    Mat sum(sz, sdepth);
+    Mat sqsum(sz, sdepth);
+
+    declare.in(src, WARMUP_RNG).out(sum, sqsum);
+
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() integral(src, sum, sqsum, sdepth, CV_64F);
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
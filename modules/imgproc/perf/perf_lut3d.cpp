@@ -0,0 +1,67 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using namespace testing;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(LUT3DInterpolation, LUT3D_INTER_TRILINEAR, LUT3D_INTER_TETRAHEDRAL)
+
+typedef std::tr1::tuple<Size, MatType, int, LUT3DInterpolation> Size_MatType_LutSize_Inter_t;
+typedef perf::TestBaseWithParam<Size_MatType_LutSize_Inter_t> Size_MatType_LutSize_Inter;
+
+PERF_TEST_P(Size_MatType_LutSize_Inter, applyLUT3D,
+            testing::Combine(testing::Values(szVGA, sz1080p),
+                             testing::Values(CV_8UC3, CV_16UC3, CV_32FC3),
+                             testing::Values(17, 33, 65),
+                             LUT3DInterpolation::all())
+            )
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int lutSize = get<2>(GetParam());
+    int interpolation = get<3>(GetParam());
+
+    Mat src(sz, type), dst(sz, type);
+    Mat lut(lutSize*lutSize, lutSize, CV_32FC3);
+    if (CV_MAT_DEPTH(type) == CV_32F)
+        randu(src, 0., 1.);
+    else
+        declare.in(src, WARMUP_RNG);
+    randu(lut, 0., 1.);
+    declare.in(src).out(dst);
+
+    TEST_CYCLE() applyLUT3D(src, lut, dst, interpolation);
+
+    SANITY_CHECK_NOTHING();
+}
+
+static void gradeColor(const float* src, float* dst, void*)
+{
+    // a few nonlinear steps of a typical grading pipeline
+    float l = 0.299f*src[2] + 0.587f*src[1] + 0.114f*src[0];
+    for (int k = 0; k < 3; k++)
+    {
+        float v = l + (src[k] - l)*1.2f;
+        v = std::pow(std::min(std::max(v, 0.f), 1.f), 1.f/2.2f);
+        dst[k] = v*v*(3 - 2*v);
+    }
+}
+
+typedef perf::TestBaseWithParam<int> LutSize;
+
+PERF_TEST_P(LutSize, bakeLUT3D, testing::Values(17, 33, 65))
+{
+    int lutSize = GetParam();
+    Mat lut;
+
+    TEST_CYCLE() bakeLUT3D(lutSize, lut, gradeColor);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -81,3 +81,37 @@ PERF_TEST_P(ImgSize_TmplSize_Method, matchTemplateBig,
 
     SANITY_CHECK(result, eps);
 }
+
+typedef std::tr1::tuple<Size, MatType, int, MethodType> ImgSize_Type_TmplCount_Method_t;
+typedef perf::TestBaseWithParam<ImgSize_Type_TmplCount_Method_t> ImgSize_Type_TmplCount_Method;
+
+PERF_TEST_P(ImgSize_Type_TmplCount_Method, matchTemplateBatch,
+            testing::Combine(
+                testing::Values(cv::Size(640, 480), cv::Size(1280, 1024)),
+                testing::Values(CV_8UC1, CV_8UC3),
+                testing::Values(4, 16),
+                testing::Values(TM_CCORR, TM_CCOEFF_NORMED)
+                )
+            )
+{
+    Size imgSz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int count = get<2>(GetParam());
+    int method = get<3>(GetParam());
+
+    Mat img(imgSz, type);
+    declare.in(img, WARMUP_RNG).time(60);
+
+    RNG& rng = theRNG();
+    vector<Mat> templs;
+    for( int i = 0; i < count; i++ )
+    {
+        int w = rng.uniform(8, 48), h = rng.uniform(8, 48);
+        templs.push_back(img(Rect(rng.uniform(0, imgSz.width - w), rng.uniform(0, imgSz.height - h), w, h)).clone());
+    }
+
+    vector<Mat> results;
+    TEST_CYCLE() matchTemplateBatch(img, templs, results, method);
+
+    SANITY_CHECK_NOTHING();
+}
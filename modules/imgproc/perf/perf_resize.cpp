@@ -148,3 +148,61 @@ PERF_TEST_P(MatInfo_Size_Scale_NN, ResizeNN,
     EXPECT_GT(countNonZero(dst.reshape(1)), 0);
     SANITY_CHECK_NOTHING();
 }
+
+CV_ENUM(PreprocessCode, -1, COLOR_BGR2RGB, COLOR_YUV2RGB_NV12, COLOR_BayerBG2RGB)
+
+typedef tr1::tuple<PreprocessCode, Size, bool> PreprocessCode_Size_Fused_t;
+typedef TestBaseWithParam<PreprocessCode_Size_Fused_t> PreprocessCode_Size_Fused;
+
+PERF_TEST_P(PreprocessCode_Size_Fused, colorResizeNormalize,
+            testing::Combine(
+                PreprocessCode::all(),
+                testing::Values(Size(224, 224), Size(300, 300), szVGA),
+                testing::Bool()
+                )
+            )
+{
+    int code = get<0>(GetParam());
+    Size dsize = get<1>(GetParam());
+    bool fused = get<2>(GetParam());
+
+    Mat src;
+    if (code == COLOR_YUV2RGB_NV12)
+        src.create(sz1080p.height*3/2, sz1080p.width, CV_8UC1);
+    else if (code == COLOR_BayerBG2RGB)
+        src.create(sz1080p, CV_8UC1);
+    else
+        src.create(sz1080p, CV_8UC3);
+    declare.in(src, WARMUP_RNG);
+
+    Scalar mean(104, 117, 123), scale(1/58., 1/57., 1/57.4);
+    Mat blob;
+
+    if (fused)
+    {
+        TEST_CYCLE() colorResizeNormalize(src, blob, dsize, code, mean, scale, INTER_LINEAR);
+    }
+    else
+    {
+        // the chain of calls the fused function replaces
+        TEST_CYCLE()
+        {
+            Mat converted, resized, planes[3];
+            if (code >= 0)
+                cvtColor(src, converted, code);
+            else
+                converted = src;
+            resize(converted, resized, dsize, 0, 0, INTER_LINEAR);
+            resized.convertTo(resized, CV_32F);
+            subtract(resized, mean, resized);
+            multiply(resized, scale, resized);
+            int sz[] = { 1, 3, dsize.height, dsize.width };
+            blob.create(4, sz, CV_32F);
+            for (int c = 0; c < 3; c++)
+                planes[c] = Mat(dsize, CV_32F, blob.ptr<float>(0, c));
+            split(resized, planes);
+        }
+    }
+
+    SANITY_CHECK_NOTHING();
+}
@@ -0,0 +1,48 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using namespace testing;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<Size, int> Size_CellSize_t;
+typedef perf::TestBaseWithParam<Size_CellSize_t> Size_CellSize;
+
+PERF_TEST_P(Size_CellSize, watershed,
+            Combine(Values(sz720p, sz2160p), Values(32, 128)))
+{
+    Size sz = get<0>(GetParam());
+    int cell = get<1>(GetParam());
+
+    Mat src(sz, CV_8UC3);
+    RNG rng(0x12345);
+    rng.fill(src, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(src, src, Size(9, 9), 3);
+
+    // "cells": a seed in the center of every unknown area, the background marker between them
+    Mat markers0(sz, CV_32S, Scalar(1));
+    int label = 2;
+    for (int y = cell/2; y < sz.height; y += cell)
+        for (int x = cell/2; x < sz.width; x += cell)
+        {
+            circle(markers0, Point(x, y), cell*2/5, Scalar(0), FILLED);
+            circle(markers0, Point(x, y), 2, Scalar(label++), FILLED);
+        }
+
+    Mat markers;
+    declare.in(src);
+
+    TEST_CYCLE()
+    {
+        markers0.copyTo(markers);
+        watershed(src, markers);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
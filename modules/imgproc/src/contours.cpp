@@ -1882,6 +1882,149 @@ cvFindContours( void*  img,  CvMemStorage*  storage,
     return cvFindContours_Impl(img, storage, firstContour, cntHeaderSize, mode, method, offset, 1);
 }
 
+namespace cv
+{
+
+/*
+   Parallel contour retrieval for RETR_EXTERNAL and RETR_LIST.
+
+   The (already bordered) image is cut into horizontal bands at rows that contain
+   no non-zero pixels. No border can cross such a row, so every band can be traced
+   independently with the regular sequential scanner, and the resulting contour lists
+   are simply concatenated. The scanner pushes every new contour in front of the list,
+   so bands are merged bottom-up to reproduce the sequential output order exactly.
+*/
+class FindContoursEmptyRowsInvoker : public ParallelLoopBody
+{
+public:
+    FindContoursEmptyRowsInvoker(const Mat& _image, uchar* _isEmpty) :
+        image(_image), isEmpty(_isEmpty) {}
+
+    void operator()(const Range& range) const
+    {
+        for( int y = range.start; y < range.end; y++ )
+            isEmpty[y] = (uchar)(countNonZero(image.row(y)) == 0);
+    }
+
+private:
+    const Mat& image;
+    uchar* isEmpty;
+};
+
+class FindContoursBandInvoker : public ParallelLoopBody
+{
+public:
+    FindContoursBandInvoker(const Mat& _image, const std::vector<Range>& _bands,
+                            std::vector<std::vector<std::vector<Point> > >& _results,
+                            int _mode, int _method, Point _offset) :
+        image(_image), bands(_bands), results(_results),
+        mode(_mode), method(_method), offset(_offset) {}
+
+    void operator()(const Range& range) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const Range& band = bands[i];
+            // rows band.start - 1 and band.end are empty and play the role of the zero border
+            Mat bandImage = image.rowRange(band.start - 1, band.end + 1).clone();
+            MemStorage storage(cvCreateMemStorage());
+            CvMat _cimage = bandImage;
+            CvSeq* _ccontours = 0;
+            cvFindContours_Impl(&_cimage, storage, &_ccontours, sizeof(CvContour), mode, method,
+                                offset + Point(-1, band.start - 2), 0);
+
+            std::vector<std::vector<Point> >& contours = results[i];
+            for( CvSeq* c = _ccontours; c != 0; c = c->h_next )
+            {
+                contours.push_back(std::vector<Point>(c->total));
+                cvCvtSeqToArray(c, &contours.back()[0]);
+            }
+        }
+    }
+
+private:
+    const Mat& image;
+    const std::vector<Range>& bands;
+    std::vector<std::vector<std::vector<Point> > >& results;
+    int mode, method;
+    Point offset;
+};
+
+static bool findContoursParallel( const Mat& image, OutputArrayOfArrays _contours,
+                                  OutputArray _hierarchy, int mode, int method, Point offset )
+{
+    const int minBandRows = 32;
+    int nthreads = getNumThreads();
+    if( nthreads <= 1 || (mode != RETR_EXTERNAL && mode != RETR_LIST) ||
+        method == CV_CHAIN_CODE || method == CV_LINK_RUNS || image.type() != CV_8UC1 ||
+        image.total() < (size_t)(1 << 20) || image.rows < minBandRows*2 )
+        return false;
+
+    std::vector<uchar> isEmpty(image.rows, (uchar)1);
+    parallel_for_(Range(1, image.rows - 1), FindContoursEmptyRowsInvoker(image, &isEmpty[0]),
+                  image.total()/(double)(1 << 16));
+
+    // split the image into bands of roughly equal height that start and end next to empty rows
+    int bandRows = std::max(minBandRows, (image.rows - 2)/(nthreads*4));
+    std::vector<Range> bands;
+    int start = 1;
+    for( int y = 1; y < image.rows - 1; y++ )
+    {
+        if( !isEmpty[y] )
+            continue;
+        if( y - start >= bandRows )
+        {
+            bands.push_back(Range(start, y));
+            start = y + 1;
+        }
+    }
+    if( start < image.rows - 1 )
+        bands.push_back(Range(start, image.rows - 1));
+
+    if( bands.size() < 2 )
+        return false;
+
+    std::vector<std::vector<std::vector<Point> > > results(bands.size());
+    parallel_for_(Range(0, (int)bands.size()),
+                  FindContoursBandInvoker(image, bands, results, mode, method, offset));
+
+    int i, total = 0;
+    for( i = 0; i < (int)results.size(); i++ )
+        total += (int)results[i].size();
+
+    if( total == 0 )
+    {
+        _contours.clear();
+        return true;
+    }
+
+    _contours.create(total, 1, 0, -1, true);
+    int idx = 0;
+    for( int b = (int)results.size() - 1; b >= 0; b-- )
+    {
+        const std::vector<std::vector<Point> >& contours = results[b];
+        for( i = 0; i < (int)contours.size(); i++, idx++ )
+        {
+            _contours.create((int)contours[i].size(), 1, CV_32SC2, idx, true);
+            Mat ci = _contours.getMat(idx);
+            CV_Assert( ci.isContinuous() );
+            memcpy(ci.ptr(), &contours[i][0], contours[i].size()*sizeof(Point));
+        }
+    }
+
+    if( _hierarchy.needed() )
+    {
+        // both modes produce a flat list of contours
+        _hierarchy.create(1, total, CV_32SC4, -1, true);
+        Vec4i* hierarchy = _hierarchy.getMat().ptr<Vec4i>();
+        for( i = 0; i < total; i++ )
+            hierarchy[i] = Vec4i(i + 1 < total ? i + 1 : -1, i - 1, -1, -1);
+    }
+    return true;
+}
+
+}
+
 void cv::findContours( InputOutputArray _image, OutputArrayOfArrays _contours,
                    OutputArray _hierarchy, int mode, int method, Point offset )
 {
@@ -1900,6 +2043,8 @@ void cv::findContours( InputOutputArray _image, OutputArrayOfArrays _contours,
     CvSeq* _ccontours = 0;
     if( _hierarchy.needed() )
         _hierarchy.clear();
+    if( findContoursParallel(image, _contours, _hierarchy, mode, method, offset) )
+        return;
     cvFindContours_Impl(&_cimage, storage, &_ccontours, sizeof(CvContour), mode, method, offset + Point(-1, -1), 0);
     if( !_ccontours )
     {
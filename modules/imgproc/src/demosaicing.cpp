@@ -42,6 +42,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include <limits>
 
@@ -76,6 +77,18 @@ public:
     {
         return 0;
     }
+
+    template<typename WT>
+    int bayer2RGB_VNG_grad(const T*, int, WT*, int, int) const
+    {
+        return 0;
+    }
+
+    template<typename WT>
+    int bayer2RGB_VNG(const T*, int, const WT*, const WT*, const WT*, int, T*, int, int) const
+    {
+        return 0;
+    }
 };
 
 #if CV_SSE2
@@ -332,6 +345,310 @@ public:
         return int(bayer - (bayer_end - width));
     }
 
+    int bayer2RGB_VNG_grad(const uchar* srow, int bstep, ushort* brow, int N, int width) const
+    {
+        if( !use_simd )
+            return 0;
+
+        #define _mm_absdiff_epu16(a,b) _mm_adds_epu16(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a))
+
+        int N2 = N*2, N3 = N*3, N4 = N*4, N5 = N*5, N6 = N*6;
+        __m128i z = _mm_setzero_si128();
+        int x = 0;
+
+        for( ; x <= width - 8; x += 8, srow += 8, brow += 8 )
+        {
+            __m128i s1, s2, s3, s4, s6, s7, s8, s9;
+
+            s1 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1-bstep)),z);
+            s2 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep)),z);
+            s3 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1-bstep)),z);
+
+            s4 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1)),z);
+            s6 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1)),z);
+
+            s7 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1+bstep)),z);
+            s8 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep)),z);
+            s9 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1+bstep)),z);
+
+            __m128i b0, b1, b2, b3, b4, b5, b6;
+
+            b0 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s2,s8),1),
+                                _mm_adds_epu16(_mm_absdiff_epu16(s1, s7),
+                                               _mm_absdiff_epu16(s3, s9)));
+            b1 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s4,s6),1),
+                                _mm_adds_epu16(_mm_absdiff_epu16(s1, s3),
+                                               _mm_absdiff_epu16(s7, s9)));
+            b2 = _mm_slli_epi16(_mm_absdiff_epu16(s3,s7),1);
+            b3 = _mm_slli_epi16(_mm_absdiff_epu16(s1,s9),1);
+
+            _mm_storeu_si128((__m128i*)brow, b0);
+            _mm_storeu_si128((__m128i*)(brow + N), b1);
+            _mm_storeu_si128((__m128i*)(brow + N2), b2);
+            _mm_storeu_si128((__m128i*)(brow + N3), b3);
+
+            b4 = _mm_adds_epu16(b2,_mm_adds_epu16(_mm_absdiff_epu16(s2, s4),
+                                                  _mm_absdiff_epu16(s6, s8)));
+            b5 = _mm_adds_epu16(b3,_mm_adds_epu16(_mm_absdiff_epu16(s2, s6),
+                                                  _mm_absdiff_epu16(s4, s8)));
+            b6 = _mm_adds_epu16(_mm_adds_epu16(s2, s4), _mm_adds_epu16(s6, s8));
+            b6 = _mm_srli_epi16(b6, 1);
+
+            _mm_storeu_si128((__m128i*)(brow + N4), b4);
+            _mm_storeu_si128((__m128i*)(brow + N5), b5);
+            _mm_storeu_si128((__m128i*)(brow + N6), b6);
+        }
+
+        return x;
+    }
+
+    int bayer2RGB_VNG(const uchar* srow, int bstep, const ushort* brow0, const ushort* brow1,
+                      const ushort* brow2, int N, uchar* dstrow, int width, int blueIdx) const
+    {
+        if( !use_simd )
+            return 0;
+
+        int N2 = N*2, N3 = N*3, N4 = N*4, N5 = N*5, N6 = N*6;
+
+        __m128i emask    = _mm_set1_epi32(0x0000ffff),
+                omask    = _mm_set1_epi32(0xffff0000),
+                z        = _mm_setzero_si128(),
+                one      = _mm_set1_epi16(1);
+        __m128 _0_5      = _mm_set1_ps(0.5f);
+
+        #define _mm_merge_epi16(a, b) _mm_or_si128(_mm_and_si128(a, emask), _mm_and_si128(b, omask)) //(aA_aA_aA_aA) * (bB_bB_bB_bB) => (bA_bA_bA_bA)
+        #define _mm_cvtloepi16_ps(a)  _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(a,a), 16))   //(1,2,3,4,5,6,7,8) => (1f,2f,3f,4f)
+        #define _mm_cvthiepi16_ps(a)  _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(a,a), 16))   //(1,2,3,4,5,6,7,8) => (5f,6f,7f,8f)
+        #define _mm_loadl_u8_s16(ptr, offset) _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)((ptr) + (offset))), z) //load 8 uchars to 8 shorts
+
+        int x = 0;
+
+        // process 8 pixels at once
+        for( ; x <= width - 8; x += 8, srow += 8, brow0 += 8, brow1 += 8, brow2 += 8 )
+        {
+            //int gradN = brow0[0] + brow1[0];
+            __m128i gradN = _mm_adds_epi16(_mm_loadu_si128((__m128i*)brow0), _mm_loadu_si128((__m128i*)brow1));
+
+            //int gradS = brow1[0] + brow2[0];
+            __m128i gradS = _mm_adds_epi16(_mm_loadu_si128((__m128i*)brow1), _mm_loadu_si128((__m128i*)brow2));
+
+            //int gradW = brow1[N-1] + brow1[N];
+            __m128i gradW = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N-1)), _mm_loadu_si128((__m128i*)(brow1+N)));
+
+            //int gradE = brow1[N+1] + brow1[N];
+            __m128i gradE = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N+1)), _mm_loadu_si128((__m128i*)(brow1+N)));
+
+            //int minGrad = std::min(std::min(std::min(gradN, gradS), gradW), gradE);
+            //int maxGrad = std::max(std::max(std::max(gradN, gradS), gradW), gradE);
+            __m128i minGrad = _mm_min_epi16(_mm_min_epi16(gradN, gradS), _mm_min_epi16(gradW, gradE));
+            __m128i maxGrad = _mm_max_epi16(_mm_max_epi16(gradN, gradS), _mm_max_epi16(gradW, gradE));
+
+            __m128i grad0, grad1;
+
+            //int gradNE = brow0[N4+1] + brow1[N4];
+            //int gradNE = brow0[N2] + brow0[N2+1] + brow1[N2] + brow1[N2+1];
+            grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N4+1)), _mm_loadu_si128((__m128i*)(brow1+N4)));
+            grad1 = _mm_adds_epi16( _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N2)), _mm_loadu_si128((__m128i*)(brow0+N2+1))),
+                                    _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N2)), _mm_loadu_si128((__m128i*)(brow1+N2+1))));
+            __m128i gradNE = _mm_merge_epi16(grad0, grad1);
+
+            //int gradSW = brow1[N4] + brow2[N4-1];
+            //int gradSW = brow1[N2] + brow1[N2-1] + brow2[N2] + brow2[N2-1];
+            grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N4-1)), _mm_loadu_si128((__m128i*)(brow1+N4)));
+            grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N2)), _mm_loadu_si128((__m128i*)(brow2+N2-1))),
+                                   _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N2)), _mm_loadu_si128((__m128i*)(brow1+N2-1))));
+            __m128i gradSW = _mm_merge_epi16(grad0, grad1);
+
+            minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNE), gradSW);
+            maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNE), gradSW);
+
+            //int gradNW = brow0[N5-1] + brow1[N5];
+            //int gradNW = brow0[N3] + brow0[N3-1] + brow1[N3] + brow1[N3-1];
+            grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N5-1)), _mm_loadu_si128((__m128i*)(brow1+N5)));
+            grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N3)), _mm_loadu_si128((__m128i*)(brow0+N3-1))),
+                                   _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N3)), _mm_loadu_si128((__m128i*)(brow1+N3-1))));
+            __m128i gradNW = _mm_merge_epi16(grad0, grad1);
+
+            //int gradSE = brow1[N5] + brow2[N5+1];
+            //int gradSE = brow1[N3] + brow1[N3+1] + brow2[N3] + brow2[N3+1];
+            grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N5+1)), _mm_loadu_si128((__m128i*)(brow1+N5)));
+            grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N3)), _mm_loadu_si128((__m128i*)(brow2+N3+1))),
+                                   _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N3)), _mm_loadu_si128((__m128i*)(brow1+N3+1))));
+            __m128i gradSE = _mm_merge_epi16(grad0, grad1);
+
+            minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNW), gradSE);
+            maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNW), gradSE);
+
+            //int T = minGrad + maxGrad/2;
+            __m128i T = _mm_adds_epi16(_mm_max_epi16(_mm_srli_epi16(maxGrad, 1), one), minGrad);
+
+            __m128i RGs = z, GRs = z, Bs = z, ng = z;
+
+            __m128i x0  = _mm_loadl_u8_s16(srow, +0          );
+            __m128i x1  = _mm_loadl_u8_s16(srow, -1 - bstep  );
+            __m128i x2  = _mm_loadl_u8_s16(srow, -1 - bstep*2);
+            __m128i x3  = _mm_loadl_u8_s16(srow,    - bstep  );
+            __m128i x4  = _mm_loadl_u8_s16(srow, +1 - bstep*2);
+            __m128i x5  = _mm_loadl_u8_s16(srow, +1 - bstep  );
+            __m128i x6  = _mm_loadl_u8_s16(srow, +2 - bstep  );
+            __m128i x7  = _mm_loadl_u8_s16(srow, +1          );
+            __m128i x8  = _mm_loadl_u8_s16(srow, +2 + bstep  );
+            __m128i x9  = _mm_loadl_u8_s16(srow, +1 + bstep  );
+            __m128i x10 = _mm_loadl_u8_s16(srow, +1 + bstep*2);
+            __m128i x11 = _mm_loadl_u8_s16(srow,    + bstep  );
+            __m128i x12 = _mm_loadl_u8_s16(srow, -1 + bstep*2);
+            __m128i x13 = _mm_loadl_u8_s16(srow, -1 + bstep  );
+            __m128i x14 = _mm_loadl_u8_s16(srow, -2 + bstep  );
+            __m128i x15 = _mm_loadl_u8_s16(srow, -1          );
+            __m128i x16 = _mm_loadl_u8_s16(srow, -2 - bstep  );
+
+            __m128i t0, t1, mask;
+
+            // gradN ***********************************************
+            mask = _mm_cmpgt_epi16(T, gradN); // mask = T>gradN
+            ng = _mm_sub_epi16(ng, mask);     // ng += (T>gradN)
+
+            t0 = _mm_slli_epi16(x3, 1);                                 // srow[-bstep]*2
+            t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -bstep*2), x0);  // srow[-bstep*2] + srow[0]
+
+            // RGs += (srow[-bstep*2] + srow[0]) * (T>gradN)
+            RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
+            // GRs += {srow[-bstep]*2; (srow[-bstep*2-1] + srow[-bstep*2+1])} * (T>gradN)
+            GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epi16(x2,x4)), mask));
+            // Bs  += {(srow[-bstep-1]+srow[-bstep+1]); srow[-bstep]*2 } * (T>gradN)
+            Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x1,x5), t0), mask));
+
+            // gradNE **********************************************
+            mask = _mm_cmpgt_epi16(T, gradNE); // mask = T>gradNE
+            ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradNE)
+
+            t0 = _mm_slli_epi16(x5, 1);                                    // srow[-bstep+1]*2
+            t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -bstep*2+2), x0);   // srow[-bstep*2+2] + srow[0]
+
+            // RGs += {(srow[-bstep*2+2] + srow[0]); srow[-bstep+1]*2} * (T>gradNE)
+            RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+            // GRs += {brow0[N6+1]; (srow[-bstep*2+1] + srow[1])} * (T>gradNE)
+            GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6+1)), _mm_adds_epi16(x4,x7)), mask));
+            // Bs  += {srow[-bstep+1]*2; (srow[-bstep] + srow[-bstep+2])}  * (T>gradNE)
+            Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epi16(x3,x6)), mask));
+
+            // gradE ***********************************************
+            mask = _mm_cmpgt_epi16(T, gradE);  // mask = T>gradE
+            ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradE)
+
+            t0 = _mm_slli_epi16(x7, 1);                         // srow[1]*2
+            t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, 2), x0); // srow[2] + srow[0]
+
+            // RGs += (srow[2] + srow[0]) * (T>gradE)
+            RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
+            // GRs += (srow[1]*2) * (T>gradE)
+            GRs = _mm_adds_epi16(GRs, _mm_and_si128(t0, mask));
+            // Bs  += {(srow[-bstep+1]+srow[bstep+1]); (srow[-bstep+2]+srow[bstep+2])} * (T>gradE)
+            Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x5,x9), _mm_adds_epi16(x6,x8)), mask));
+
+            // gradSE **********************************************
+            mask = _mm_cmpgt_epi16(T, gradSE);  // mask = T>gradSE
+            ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradSE)
+
+            t0 = _mm_slli_epi16(x9, 1);                                 // srow[bstep+1]*2
+            t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, bstep*2+2), x0); // srow[bstep*2+2] + srow[0]
+
+            // RGs += {(srow[bstep*2+2] + srow[0]); srow[bstep+1]*2} * (T>gradSE)
+            RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+            // GRs += {brow2[N6+1]; (srow[1]+srow[bstep*2+1])} * (T>gradSE)
+            GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6+1)), _mm_adds_epi16(x7,x10)), mask));
+            // Bs  += {srow[-bstep+1]*2; (srow[bstep+2]+srow[bstep])} * (T>gradSE)
+            Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_slli_epi16(x5, 1), _mm_adds_epi16(x8,x11)), mask));
+
+            // gradS ***********************************************
+            mask = _mm_cmpgt_epi16(T, gradS);  // mask = T>gradS
+            ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradS)
+
+            t0 = _mm_slli_epi16(x11, 1);                             // srow[bstep]*2
+            t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow,bstep*2), x0); // srow[bstep*2]+srow[0]
+
+            // RGs += (srow[bstep*2]+srow[0]) * (T>gradS)
+            RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
+            // GRs += {srow[bstep]*2; (srow[bstep*2+1]+srow[bstep*2-1])} * (T>gradS)
+            GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epi16(x10,x12)), mask));
+            // Bs  += {(srow[bstep+1]+srow[bstep-1]); srow[bstep]*2} * (T>gradS)
+            Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x9,x13), t0), mask));
+
+            // gradSW **********************************************
+            mask = _mm_cmpgt_epi16(T, gradSW);  // mask = T>gradSW
+            ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradSW)
+
+            t0 = _mm_slli_epi16(x13, 1);                                // srow[bstep-1]*2
+            t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, bstep*2-2), x0); // srow[bstep*2-2]+srow[0]
+
+            // RGs += {(srow[bstep*2-2]+srow[0]); srow[bstep-1]*2} * (T>gradSW)
+            RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+            // GRs += {brow2[N6-1]; (srow[bstep*2-1]+srow[-1])} * (T>gradSW)
+            GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6-1)), _mm_adds_epi16(x12,x15)), mask));
+            // Bs  += {srow[bstep-1]*2; (srow[bstep]+srow[bstep-2])} * (T>gradSW)
+            Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epi16(x11,x14)), mask));
+
+            // gradW ***********************************************
+            mask = _mm_cmpgt_epi16(T, gradW);  // mask = T>gradW
+            ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradW)
+
+            t0 = _mm_slli_epi16(x15, 1);                         // srow[-1]*2
+            t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -2), x0); // srow[-2]+srow[0]
+
+            // RGs += (srow[-2]+srow[0]) * (T>gradW)
+            RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
+            // GRs += (srow[-1]*2) * (T>gradW)
+            GRs = _mm_adds_epi16(GRs, _mm_and_si128(t0, mask));
+            // Bs  += {(srow[-bstep-1]+srow[bstep-1]); (srow[bstep-2]+srow[-bstep-2])} * (T>gradW)
+            Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x1,x13), _mm_adds_epi16(x14,x16)), mask));
+
+            // gradNW **********************************************
+            mask = _mm_cmpgt_epi16(T, gradNW);  // mask = T>gradNW
+            ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradNW)
+
+            t0 = _mm_slli_epi16(x1, 1);                                 // srow[-bstep-1]*2
+            t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow,-bstep*2-2), x0); // srow[-bstep*2-2]+srow[0]
+
+            // RGs += {(srow[-bstep*2-2]+srow[0]); srow[-bstep-1]*2} * (T>gradNW)
+            RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+            // GRs += {brow0[N6-1]; (srow[-bstep*2-1]+srow[-1])} * (T>gradNW)
+            GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6-1)), _mm_adds_epi16(x2,x15)), mask));
+            // Bs  += {srow[-bstep-1]*2; (srow[-bstep]+srow[-bstep-2])} * (T>gradNW)
+            Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_slli_epi16(x5, 1),_mm_adds_epi16(x3,x16)), mask));
+
+            __m128 ngf0 = _mm_div_ps(_0_5, _mm_cvtloepi16_ps(ng));
+            __m128 ngf1 = _mm_div_ps(_0_5, _mm_cvthiepi16_ps(ng));
+
+            // now interpolate r, g & b
+            t0 = _mm_subs_epi16(GRs, RGs);
+            t1 = _mm_subs_epi16(Bs, RGs);
+
+            t0 = _mm_add_epi16(x0, _mm_packs_epi32(
+                                                   _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t0), ngf0)),
+                                                   _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t0), ngf1))));
+
+            t1 = _mm_add_epi16(x0, _mm_packs_epi32(
+                                                   _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t1), ngf0)),
+                                                   _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t1), ngf1))));
+
+            x1 = _mm_merge_epi16(x0, t0);
+            x2 = _mm_merge_epi16(t0, x0);
+
+            uchar R[8], G[8], B[8];
+
+            _mm_storel_epi64(blueIdx ? (__m128i*)B : (__m128i*)R, _mm_packus_epi16(x1, z));
+            _mm_storel_epi64((__m128i*)G, _mm_packus_epi16(x2, z));
+            _mm_storel_epi64(blueIdx ? (__m128i*)R : (__m128i*)B, _mm_packus_epi16(t1, z));
+
+            for( int j = 0; j < 8; j++, dstrow += 3 )
+            {
+                dstrow[0] = B[j]; dstrow[1] = G[j]; dstrow[2] = R[j];
+            }
+        }
+
+        return x;
+    }
+
     bool use_simd;
 };
 #elif CV_NEON
@@ -493,11 +810,248 @@ public:
     {
         return 0;
     }
+
+    int bayer2RGB_VNG_grad(const uchar*, int, ushort*, int, int) const
+    {
+        return 0;
+    }
+
+    int bayer2RGB_VNG(const uchar*, int, const ushort*, const ushort*, const ushort*, int, uchar*, int, int) const
+    {
+        return 0;
+    }
 };
 #else
 typedef SIMDBayerStubInterpolator_<uchar> SIMDBayerInterpolator_8u;
 #endif
 
+// reciprocals of 2*ng, used to average the VNG color differences over ng directions
+static const float vngScale[] = { 0.f, 0.5f, 0.25f, 0.1666666666667f, 0.125f, 0.1f, 0.08333333333f, 0.0714286f, 0.0625f };
+
+#if CV_SIMD128
+class SIMDBayerInterpolator_16u :
+    public SIMDBayerStubInterpolator_<ushort>
+{
+public:
+    SIMDBayerInterpolator_16u()
+    {
+        use_simd = hasSIMD128();
+    }
+
+    int bayer2RGB_EA(const ushort* bayer, int bayer_step, ushort* dst, int width, int blue) const
+    {
+        if( !use_simd )
+            return 0;
+
+        /*
+         B G B G | B G B G
+         G R G R | G R G R
+         B G B G | B G B G
+
+         8 pixels starting from a non-green one are processed at once;
+         even lanes hold the non-green pixels, odd lanes hold the green ones.
+         */
+        const ushort* bayer_end = bayer + width;
+        v_uint16x8 emask(0xffff, 0, 0xffff, 0, 0xffff, 0, 0xffff, 0);
+        v_uint16x8 one = v_setall_u16(1), three = v_setall_u16(3), delta2 = v_setall_u16(2);
+
+        for( ; bayer <= bayer_end - 10; bayer += 8, dst += 24 )
+        {
+            v_uint16x8 u_1 = v_load(bayer), u0 = v_load(bayer + 1), u1 = v_load(bayer + 2);
+            v_uint16x8 c_1 = v_load(bayer + bayer_step), c0 = v_load(bayer + bayer_step + 1),
+                       c1 = v_load(bayer + bayer_step + 2);
+            v_uint16x8 d_1 = v_load(bayer + bayer_step*2), d0 = v_load(bayer + bayer_step*2 + 1),
+                       d1 = v_load(bayer + bayer_step*2 + 2);
+
+            // (a + b + 1) >> 1 and (a + b + c + d) >> 2 without overflowing 16 bits
+            #define v_avg_u16(a, b) (((a) >> 1) + ((b) >> 1) + (((a) | (b)) & one))
+            v_uint16x8 qsum = (u_1 >> 2) + (u1 >> 2) + (d_1 >> 2) + (d1 >> 2);
+            v_uint16x8 rsum = (u_1 & three) + (u1 & three) + (d_1 & three) + (d1 & three);
+
+            // green at the non-green pixels, chosen along the smaller gradient
+            v_uint16x8 gmask = v_absdiff(c_1, c1) > v_absdiff(d0, u0);
+            v_uint16x8 g = v_select(emask, v_avg_u16(v_select(gmask, d0, c_1), v_select(gmask, u0, c1)), c0);
+            // the neighbours of the green pixels
+            v_uint16x8 horiz = v_avg_u16(c_1, c1), vert = v_avg_u16(u0, d0);
+            #undef v_avg_u16
+
+            if( blue )
+            {
+                v_uint16x8 diag = qsum + (rsum >> 2);
+                v_store_interleave(dst, v_select(emask, c0, horiz), g, v_select(emask, diag, vert));
+            }
+            else
+            {
+                v_uint16x8 diag = qsum + ((rsum + delta2) >> 2);
+                v_store_interleave(dst, v_select(emask, diag, vert), g, v_select(emask, c0, horiz));
+            }
+        }
+
+        return int(bayer - (bayer_end - width));
+    }
+
+    int bayer2RGB_VNG_grad(const ushort* srow, int bstep, int* brow, int N, int width) const
+    {
+        if( !use_simd )
+            return 0;
+
+        int N2 = N*2, N3 = N*3, N4 = N*4, N5 = N*5, N6 = N*6;
+        int x = 0;
+
+        for( ; x <= width - 4; x += 4, srow += 4, brow += 4 )
+        {
+            v_uint32x4 s1 = v_load_expand(srow - 1 - bstep), s2 = v_load_expand(srow - bstep),
+                       s3 = v_load_expand(srow + 1 - bstep), s4 = v_load_expand(srow - 1),
+                       s6 = v_load_expand(srow + 1), s7 = v_load_expand(srow - 1 + bstep),
+                       s8 = v_load_expand(srow + bstep), s9 = v_load_expand(srow + 1 + bstep);
+
+            v_uint32x4 b0 = (v_absdiff(s2, s8) << 1) + v_absdiff(s1, s7) + v_absdiff(s3, s9);
+            v_uint32x4 b1 = (v_absdiff(s4, s6) << 1) + v_absdiff(s1, s3) + v_absdiff(s7, s9);
+            v_uint32x4 b2 = v_absdiff(s3, s7) << 1;
+            v_uint32x4 b3 = v_absdiff(s1, s9) << 1;
+            v_uint32x4 b4 = b2 + v_absdiff(s2, s4) + v_absdiff(s6, s8);
+            v_uint32x4 b5 = b3 + v_absdiff(s2, s6) + v_absdiff(s4, s8);
+            v_uint32x4 b6 = (s2 + s4 + s6 + s8) >> 1;
+
+            v_store(brow, v_reinterpret_as_s32(b0));
+            v_store(brow + N, v_reinterpret_as_s32(b1));
+            v_store(brow + N2, v_reinterpret_as_s32(b2));
+            v_store(brow + N3, v_reinterpret_as_s32(b3));
+            v_store(brow + N4, v_reinterpret_as_s32(b4));
+            v_store(brow + N5, v_reinterpret_as_s32(b5));
+            v_store(brow + N6, v_reinterpret_as_s32(b6));
+        }
+
+        return x;
+    }
+
+    int bayer2RGB_VNG(const ushort* srow, int bstep, const int* brow0, const int* brow1,
+                      const int* brow2, int N, ushort* dstrow, int width, int blueIdx) const
+    {
+        if( !use_simd )
+            return 0;
+
+        int x = 0;
+
+        // process 8 pixels at once, starting from a non-green one
+        for( ; x <= width - 8; x += 8, srow += 8, brow0 += 8, brow1 += 8, brow2 += 8, dstrow += 24 )
+        {
+            v_int32x4 r[2], g[2], b[2];
+
+            interpolateVNG(srow, bstep, brow0, brow1, brow2, N, r[0], g[0], b[0]);
+            interpolateVNG(srow + 4, bstep, brow0 + 4, brow1 + 4, brow2 + 4, N, r[1], g[1], b[1]);
+
+            v_uint16x8 R = v_pack_u(r[0], r[1]), G = v_pack_u(g[0], g[1]), B = v_pack_u(b[0], b[1]);
+            if( blueIdx )
+                v_store_interleave(dstrow, R, G, B);
+            else
+                v_store_interleave(dstrow, B, G, R);
+        }
+
+        return x;
+    }
+
+    bool use_simd;
+
+private:
+    static inline v_int32x4 load(const ushort* ptr)
+    {
+        return v_reinterpret_as_s32(v_load_expand(ptr));
+    }
+
+    // VNG for 4 pixels; the even lanes are the non-green pixels, the odd ones are green.
+    // Follows the scalar code of Bayer2RGB_VNG_Invoker exactly.
+    static void interpolateVNG(const ushort* srow, int bstep, const int* brow0, const int* brow1,
+                               const int* brow2, int N, v_int32x4& R, v_int32x4& G, v_int32x4& B)
+    {
+        int N2 = N*2, N3 = N*3, N4 = N*4, N5 = N*5, N6 = N*6;
+        v_int32x4 emask(-1, 0, -1, 0), one = v_setall_s32(1);
+
+        v_int32x4 gradN = v_load(brow0) + v_load(brow1);
+        v_int32x4 gradS = v_load(brow1) + v_load(brow2);
+        v_int32x4 gradW = v_load(brow1 + N - 1) + v_load(brow1 + N);
+        v_int32x4 gradE = v_load(brow1 + N + 1) + v_load(brow1 + N);
+        v_int32x4 gradNE = v_select(emask, v_load(brow0 + N4 + 1) + v_load(brow1 + N4),
+                                    v_load(brow0 + N2) + v_load(brow0 + N2 + 1) + v_load(brow1 + N2) + v_load(brow1 + N2 + 1));
+        v_int32x4 gradSW = v_select(emask, v_load(brow1 + N4) + v_load(brow2 + N4 - 1),
+                                    v_load(brow1 + N2) + v_load(brow1 + N2 - 1) + v_load(brow2 + N2) + v_load(brow2 + N2 - 1));
+        v_int32x4 gradNW = v_select(emask, v_load(brow0 + N5 - 1) + v_load(brow1 + N5),
+                                    v_load(brow0 + N3) + v_load(brow0 + N3 - 1) + v_load(brow1 + N3) + v_load(brow1 + N3 - 1));
+        v_int32x4 gradSE = v_select(emask, v_load(brow1 + N5) + v_load(brow2 + N5 + 1),
+                                    v_load(brow1 + N3) + v_load(brow1 + N3 + 1) + v_load(brow2 + N3) + v_load(brow2 + N3 + 1));
+
+        v_int32x4 minGrad = v_min(v_min(v_min(gradN, gradS), v_min(gradW, gradE)),
+                                  v_min(v_min(gradNE, gradSW), v_min(gradNW, gradSE)));
+        v_int32x4 maxGrad = v_max(v_max(v_max(gradN, gradS), v_max(gradW, gradE)),
+                                  v_max(v_max(gradNE, gradSW), v_max(gradNW, gradSE)));
+        v_int32x4 T = minGrad + v_max(maxGrad >> 1, one);
+
+        // RGs accumulates the own color of the pixel, GRs the other one of R and G
+        v_int32x4 x0 = load(srow), z = v_setzero_s32();
+        v_int32x4 RGs = z, GRs = z, Bs = z, ng = z, mask;
+
+        mask = T > gradN;
+        ng -= mask;
+        RGs += (load(srow - bstep*2) + x0) & mask;
+        GRs += v_select(emask, load(srow - bstep) << 1, load(srow - bstep*2 - 1) + load(srow - bstep*2 + 1)) & mask;
+        Bs += v_select(emask, load(srow - bstep - 1) + load(srow - bstep + 1), load(srow - bstep) << 1) & mask;
+
+        mask = T > gradS;
+        ng -= mask;
+        RGs += (load(srow + bstep*2) + x0) & mask;
+        GRs += v_select(emask, load(srow + bstep) << 1, load(srow + bstep*2 - 1) + load(srow + bstep*2 + 1)) & mask;
+        Bs += v_select(emask, load(srow + bstep - 1) + load(srow + bstep + 1), load(srow + bstep) << 1) & mask;
+
+        mask = T > gradW;
+        ng -= mask;
+        RGs += (load(srow - 2) + x0) & mask;
+        GRs += (load(srow - 1) << 1) & mask;
+        Bs += v_select(emask, load(srow - bstep - 1) + load(srow + bstep - 1), load(srow - bstep - 2) + load(srow + bstep - 2)) & mask;
+
+        mask = T > gradE;
+        ng -= mask;
+        RGs += (load(srow + 2) + x0) & mask;
+        GRs += (load(srow + 1) << 1) & mask;
+        Bs += v_select(emask, load(srow - bstep + 1) + load(srow + bstep + 1), load(srow - bstep + 2) + load(srow + bstep + 2)) & mask;
+
+        mask = T > gradNE;
+        ng -= mask;
+        RGs += v_select(emask, load(srow - bstep*2 + 2) + x0, load(srow - bstep + 1) << 1) & mask;
+        GRs += v_select(emask, v_load(brow0 + N6 + 1), load(srow - bstep*2 + 1) + load(srow + 1)) & mask;
+        Bs += v_select(emask, load(srow - bstep + 1) << 1, load(srow - bstep) + load(srow - bstep + 2)) & mask;
+
+        mask = T > gradSW;
+        ng -= mask;
+        RGs += v_select(emask, load(srow + bstep*2 - 2) + x0, load(srow + bstep - 1) << 1) & mask;
+        GRs += v_select(emask, v_load(brow2 + N6 - 1), load(srow + bstep*2 - 1) + load(srow - 1)) & mask;
+        Bs += v_select(emask, load(srow + bstep - 1) << 1, load(srow + bstep) + load(srow + bstep - 2)) & mask;
+
+        mask = T > gradNW;
+        ng -= mask;
+        RGs += v_select(emask, load(srow - bstep*2 - 2) + x0, load(srow - bstep - 1) << 1) & mask;
+        GRs += v_select(emask, v_load(brow0 + N6 - 1), load(srow - bstep*2 - 1) + load(srow - 1)) & mask;
+        Bs += v_select(emask, load(srow - bstep + 1) << 1, load(srow - bstep - 2) + load(srow - bstep)) & mask;
+
+        mask = T > gradSE;
+        ng -= mask;
+        RGs += v_select(emask, load(srow + bstep*2 + 2) + x0, load(srow + bstep + 1) << 1) & mask;
+        GRs += v_select(emask, v_load(brow2 + N6 + 1), load(srow + bstep*2 + 1) + load(srow + 1)) & mask;
+        Bs += v_select(emask, load(srow - bstep + 1) << 1, load(srow + bstep + 2) + load(srow + bstep)) & mask;
+
+        v_float32x4 scale = v_setall_f32(vngScale[1]);
+        for( int k = 2; k <= 8; k++ )
+            scale = v_select(v_reinterpret_as_f32(ng == v_setall_s32(k)), v_setall_f32(vngScale[k]), scale);
+
+        v_int32x4 t0 = x0 + v_round(v_cvt_f32(GRs - RGs) * scale);
+        B = x0 + v_round(v_cvt_f32(Bs - RGs) * scale);
+        R = v_select(emask, x0, t0);
+        G = v_select(emask, t0, x0);
+    }
+};
+#else
+typedef SIMDBayerStubInterpolator_<ushort> SIMDBayerInterpolator_16u;
+#endif
+
 
 template<typename T, class SIMDInterpolator>
 class Bayer2Gray_Invoker :
@@ -910,549 +1464,306 @@ static void Bayer2RGB_( const Mat& srcmat, Mat& dstmat, int code )
 
 /////////////////// Demosaicing using Variable Number of Gradients ///////////////////////
 
-static void Bayer2RGB_VNG_8u( const Mat& srcmat, Mat& dstmat, int code )
+template<typename T, typename WT, class SIMDInterpolator>
+class Bayer2RGB_VNG_Invoker :
+    public ParallelLoopBody
 {
-    const uchar* bayer = srcmat.ptr();
-    int bstep = (int)srcmat.step;
-    uchar* dst = dstmat.ptr();
-    int dststep = (int)dstmat.step;
-    Size size = srcmat.size();
-
-    int blueIdx = code == CV_BayerBG2BGR_VNG || code == CV_BayerGB2BGR_VNG ? 0 : 2;
-    bool greenCell0 = code != CV_BayerBG2BGR_VNG && code != CV_BayerRG2BGR_VNG;
-
-    // for too small images use the simple interpolation algorithm
-    if( MIN(size.width, size.height) < 8 )
+public:
+    Bayer2RGB_VNG_Invoker(const Mat& _srcmat, Mat& _dstmat, int _blueIdx, bool _greenCell0) :
+        ParallelLoopBody(), srcmat(_srcmat), dstmat(_dstmat), BlueIdx(_blueIdx), GreenCell0(_greenCell0)
     {
-        Bayer2RGB_<uchar, SIMDBayerInterpolator_8u>( srcmat, dstmat, code );
-        return;
     }
 
-    const int brows = 3, bcn = 7;
-    int N = size.width, N2 = N*2, N3 = N*3, N4 = N*4, N5 = N*5, N6 = N*6, N7 = N*7;
-    int i, bufstep = N7*bcn;
-    cv::AutoBuffer<ushort> _buf(bufstep*brows);
-    ushort* buf = (ushort*)_buf;
+    virtual void operator()(const Range& range) const
+    {
+        SIMDInterpolator vecOp;
+        const T* bayer = srcmat.ptr<T>();
+        int bstep = (int)(srcmat.step/sizeof(T));
+        T* dst = (T*)dstmat.data;
+        int dststep = (int)(dstmat.step/sizeof(T));
+        Size size = srcmat.size();
 
-    bayer += bstep*2;
+        int blueIdx = BlueIdx;
+        bool greenCell0 = GreenCell0;
 
-#if CV_SSE2
-    bool haveSSE = cv::checkHardwareSupport(CV_CPU_SSE2);
-    #define _mm_absdiff_epu16(a,b) _mm_adds_epu16(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a))
-#endif
+        // the first processed row is 2
+        if( range.start % 2 )
+        {
+            greenCell0 = !greenCell0;
+            blueIdx ^= 2;
+        }
 
-    for( int y = 2; y < size.height - 4; y++ )
-    {
-        uchar* dstrow = dst + dststep*y + 6;
-        const uchar* srow;
+        const int brows = 3, bcn = 7;
+        int N = size.width, N2 = N*2, N3 = N*3, N4 = N*4, N5 = N*5, N6 = N*6, N7 = N*7;
+        int i, bufstep = N7*bcn;
+        cv::AutoBuffer<WT> _buf(bufstep*brows);
+        WT* buf = (WT*)_buf;
 
-        for( int dy = (y == 2 ? -1 : 1); dy <= 1; dy++ )
+        bayer += bstep*2;
+
+        for( int y = range.start; y < range.end; y++ )
         {
-            ushort* brow = buf + ((y + dy - 1)%brows)*bufstep + 1;
-            srow = bayer + (y+dy)*bstep + 1;
+            T* dstrow = dst + dststep*y + 6;
+            const T* srow;
 
-            for( i = 0; i < bcn; i++ )
-                brow[N*i-1] = brow[(N-2) + N*i] = 0;
+            // each stripe computes the gradients of the rows above and below it by itself
+            for( int dy = (y == range.start ? -1 : 1); dy <= 1; dy++ )
+            {
+                WT* brow = buf + ((y + dy - 1)%brows)*bufstep + 1;
+                srow = bayer + (y+dy)*bstep + 1;
 
-            i = 1;
+                for( i = 0; i < bcn; i++ )
+                    brow[N*i-1] = brow[(N-2) + N*i] = 0;
 
-#if CV_SSE2
-            if( haveSSE )
-            {
-                __m128i z = _mm_setzero_si128();
-                for( ; i <= N-9; i += 8, srow += 8, brow += 8 )
-                {
-                    __m128i s1, s2, s3, s4, s6, s7, s8, s9;
-
-                    s1 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1-bstep)),z);
-                    s2 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep)),z);
-                    s3 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1-bstep)),z);
-
-                    s4 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1)),z);
-                    s6 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1)),z);
-
-                    s7 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1+bstep)),z);
-                    s8 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep)),z);
-                    s9 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1+bstep)),z);
-
-                    __m128i b0, b1, b2, b3, b4, b5, b6;
-
-                    b0 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s2,s8),1),
-                                        _mm_adds_epu16(_mm_absdiff_epu16(s1, s7),
-                                                       _mm_absdiff_epu16(s3, s9)));
-                    b1 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s4,s6),1),
-                                        _mm_adds_epu16(_mm_absdiff_epu16(s1, s3),
-                                                       _mm_absdiff_epu16(s7, s9)));
-                    b2 = _mm_slli_epi16(_mm_absdiff_epu16(s3,s7),1);
-                    b3 = _mm_slli_epi16(_mm_absdiff_epu16(s1,s9),1);
-
-                    _mm_storeu_si128((__m128i*)brow, b0);
-                    _mm_storeu_si128((__m128i*)(brow + N), b1);
-                    _mm_storeu_si128((__m128i*)(brow + N2), b2);
-                    _mm_storeu_si128((__m128i*)(brow + N3), b3);
-
-                    b4 = _mm_adds_epu16(b2,_mm_adds_epu16(_mm_absdiff_epu16(s2, s4),
-                                                          _mm_absdiff_epu16(s6, s8)));
-                    b5 = _mm_adds_epu16(b3,_mm_adds_epu16(_mm_absdiff_epu16(s2, s6),
-                                                          _mm_absdiff_epu16(s4, s8)));
-                    b6 = _mm_adds_epu16(_mm_adds_epu16(s2, s4), _mm_adds_epu16(s6, s8));
-                    b6 = _mm_srli_epi16(b6, 1);
-
-                    _mm_storeu_si128((__m128i*)(brow + N4), b4);
-                    _mm_storeu_si128((__m128i*)(brow + N5), b5);
-                    _mm_storeu_si128((__m128i*)(brow + N6), b6);
-                }
-            }
-#endif
+                i = 1;
 
-            for( ; i < N-1; i++, srow++, brow++ )
-            {
-                brow[0] = (ushort)(std::abs(srow[-1-bstep] - srow[-1+bstep]) +
+                int delta = vecOp.bayer2RGB_VNG_grad(srow, bstep, brow, N, N - 1 - i);
+                i += delta;
+                srow += delta;
+                brow += delta;
+
+                for( ; i < N-1; i++, srow++, brow++ )
+                {
+                    brow[0] = (WT)(std::abs(srow[-1-bstep] - srow[-1+bstep]) +
                                    std::abs(srow[-bstep] - srow[+bstep])*2 +
                                    std::abs(srow[1-bstep] - srow[1+bstep]));
-                brow[N] = (ushort)(std::abs(srow[-1-bstep] - srow[1-bstep]) +
+                    brow[N] = (WT)(std::abs(srow[-1-bstep] - srow[1-bstep]) +
                                    std::abs(srow[-1] - srow[1])*2 +
                                    std::abs(srow[-1+bstep] - srow[1+bstep]));
-                brow[N2] = (ushort)(std::abs(srow[+1-bstep] - srow[-1+bstep])*2);
-                brow[N3] = (ushort)(std::abs(srow[-1-bstep] - srow[1+bstep])*2);
-                brow[N4] = (ushort)(brow[N2] + std::abs(srow[-bstep] - srow[-1]) +
+                    brow[N2] = (WT)(std::abs(srow[+1-bstep] - srow[-1+bstep])*2);
+                    brow[N3] = (WT)(std::abs(srow[-1-bstep] - srow[1+bstep])*2);
+                    brow[N4] = (WT)(brow[N2] + std::abs(srow[-bstep] - srow[-1]) +
                                     std::abs(srow[+bstep] - srow[1]));
-                brow[N5] = (ushort)(brow[N3] + std::abs(srow[-bstep] - srow[1]) +
+                    brow[N5] = (WT)(brow[N3] + std::abs(srow[-bstep] - srow[1]) +
                                     std::abs(srow[+bstep] - srow[-1]));
-                brow[N6] = (ushort)((srow[-bstep] + srow[-1] + srow[1] + srow[+bstep])>>1);
+                    brow[N6] = (WT)((srow[-bstep] + srow[-1] + srow[1] + srow[+bstep])>>1);
+                }
             }
-        }
 
-        const ushort* brow0 = buf + ((y - 2) % brows)*bufstep + 2;
-        const ushort* brow1 = buf + ((y - 1) % brows)*bufstep + 2;
-        const ushort* brow2 = buf + (y % brows)*bufstep + 2;
-        static const float scale[] = { 0.f, 0.5f, 0.25f, 0.1666666666667f, 0.125f, 0.1f, 0.08333333333f, 0.0714286f, 0.0625f };
-        srow = bayer + y*bstep + 2;
-        bool greenCell = greenCell0;
+            const WT* brow0 = buf + ((y - 2) % brows)*bufstep + 2;
+            const WT* brow1 = buf + ((y - 1) % brows)*bufstep + 2;
+            const WT* brow2 = buf + (y % brows)*bufstep + 2;
+            srow = bayer + y*bstep + 2;
+            bool greenCell = greenCell0;
 
-        i = 2;
-#if CV_SSE2
-        int limit = !haveSSE ? N-2 : greenCell ? std::min(3, N-2) : 2;
-#else
-        int limit = N - 2;
-#endif
+            // the vectorized part starts from a non-green pixel
+            i = 2;
+            int limit = greenCell ? std::min(3, N-2) : 2;
 
-        do
-        {
-            for( ; i < limit; i++, srow++, brow0++, brow1++, brow2++, dstrow += 3 )
+            do
             {
-                int gradN = brow0[0] + brow1[0];
-                int gradS = brow1[0] + brow2[0];
-                int gradW = brow1[N-1] + brow1[N];
-                int gradE = brow1[N] + brow1[N+1];
-                int minGrad = std::min(std::min(std::min(gradN, gradS), gradW), gradE);
-                int maxGrad = std::max(std::max(std::max(gradN, gradS), gradW), gradE);
-                int R, G, B;
-
-                if( !greenCell )
+                for( ; i < limit; i++, srow++, brow0++, brow1++, brow2++, dstrow += 3 )
                 {
-                    int gradNE = brow0[N4+1] + brow1[N4];
-                    int gradSW = brow1[N4] + brow2[N4-1];
-                    int gradNW = brow0[N5-1] + brow1[N5];
-                    int gradSE = brow1[N5] + brow2[N5+1];
-
-                    minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
-                    maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
-                    int T = minGrad + MAX(maxGrad/2, 1);
-
-                    int Rs = 0, Gs = 0, Bs = 0, ng = 0;
-                    if( gradN < T )
-                    {
-                        Rs += srow[-bstep*2] + srow[0];
-                        Gs += srow[-bstep]*2;
-                        Bs += srow[-bstep-1] + srow[-bstep+1];
-                        ng++;
-                    }
-                    if( gradS < T )
-                    {
-                        Rs += srow[bstep*2] + srow[0];
-                        Gs += srow[bstep]*2;
-                        Bs += srow[bstep-1] + srow[bstep+1];
-                        ng++;
-                    }
-                    if( gradW < T )
-                    {
-                        Rs += srow[-2] + srow[0];
-                        Gs += srow[-1]*2;
-                        Bs += srow[-bstep-1] + srow[bstep-1];
-                        ng++;
-                    }
-                    if( gradE < T )
-                    {
-                        Rs += srow[2] + srow[0];
-                        Gs += srow[1]*2;
-                        Bs += srow[-bstep+1] + srow[bstep+1];
-                        ng++;
-                    }
-                    if( gradNE < T )
+                    int gradN = brow0[0] + brow1[0];
+                    int gradS = brow1[0] + brow2[0];
+                    int gradW = brow1[N-1] + brow1[N];
+                    int gradE = brow1[N] + brow1[N+1];
+                    int minGrad = std::min(std::min(std::min(gradN, gradS), gradW), gradE);
+                    int maxGrad = std::max(std::max(std::max(gradN, gradS), gradW), gradE);
+                    int R, G, B;
+
+                    if( !greenCell )
                     {
-                        Rs += srow[-bstep*2+2] + srow[0];
-                        Gs += brow0[N6+1];
-                        Bs += srow[-bstep+1]*2;
-                        ng++;
+                        int gradNE = brow0[N4+1] + brow1[N4];
+                        int gradSW = brow1[N4] + brow2[N4-1];
+                        int gradNW = brow0[N5-1] + brow1[N5];
+                        int gradSE = brow1[N5] + brow2[N5+1];
+
+                        minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
+                        maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
+                        int thresh = minGrad + MAX(maxGrad/2, 1);
+
+                        int Rs = 0, Gs = 0, Bs = 0, ng = 0;
+                        if( gradN < thresh )
+                        {
+                            Rs += srow[-bstep*2] + srow[0];
+                            Gs += srow[-bstep]*2;
+                            Bs += srow[-bstep-1] + srow[-bstep+1];
+                            ng++;
+                        }
+                        if( gradS < thresh )
+                        {
+                            Rs += srow[bstep*2] + srow[0];
+                            Gs += srow[bstep]*2;
+                            Bs += srow[bstep-1] + srow[bstep+1];
+                            ng++;
+                        }
+                        if( gradW < thresh )
+                        {
+                            Rs += srow[-2] + srow[0];
+                            Gs += srow[-1]*2;
+                            Bs += srow[-bstep-1] + srow[bstep-1];
+                            ng++;
+                        }
+                        if( gradE < thresh )
+                        {
+                            Rs += srow[2] + srow[0];
+                            Gs += srow[1]*2;
+                            Bs += srow[-bstep+1] + srow[bstep+1];
+                            ng++;
+                        }
+                        if( gradNE < thresh )
+                        {
+                            Rs += srow[-bstep*2+2] + srow[0];
+                            Gs += brow0[N6+1];
+                            Bs += srow[-bstep+1]*2;
+                            ng++;
+                        }
+                        if( gradSW < thresh )
+                        {
+                            Rs += srow[bstep*2-2] + srow[0];
+                            Gs += brow2[N6-1];
+                            Bs += srow[bstep-1]*2;
+                            ng++;
+                        }
+                        if( gradNW < thresh )
+                        {
+                            Rs += srow[-bstep*2-2] + srow[0];
+                            Gs += brow0[N6-1];
+                            Bs += srow[-bstep+1]*2;
+                            ng++;
+                        }
+                        if( gradSE < thresh )
+                        {
+                            Rs += srow[bstep*2+2] + srow[0];
+                            Gs += brow2[N6+1];
+                            Bs += srow[-bstep+1]*2;
+                            ng++;
+                        }
+                        R = srow[0];
+                        G = R + cvRound((Gs - Rs)*vngScale[ng]);
+                        B = R + cvRound((Bs - Rs)*vngScale[ng]);
                     }
-                    if( gradSW < T )
+                    else
                     {
-                        Rs += srow[bstep*2-2] + srow[0];
-                        Gs += brow2[N6-1];
-                        Bs += srow[bstep-1]*2;
-                        ng++;
+                        int gradNE = brow0[N2] + brow0[N2+1] + brow1[N2] + brow1[N2+1];
+                        int gradSW = brow1[N2] + brow1[N2-1] + brow2[N2] + brow2[N2-1];
+                        int gradNW = brow0[N3] + brow0[N3-1] + brow1[N3] + brow1[N3-1];
+                        int gradSE = brow1[N3] + brow1[N3+1] + brow2[N3] + brow2[N3+1];
+
+                        minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
+                        maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
+                        int thresh = minGrad + MAX(maxGrad/2, 1);
+
+                        int Rs = 0, Gs = 0, Bs = 0, ng = 0;
+                        if( gradN < thresh )
+                        {
+                            Rs += srow[-bstep*2-1] + srow[-bstep*2+1];
+                            Gs += srow[-bstep*2] + srow[0];
+                            Bs += srow[-bstep]*2;
+                            ng++;
+                        }
+                        if( gradS < thresh )
+                        {
+                            Rs += srow[bstep*2-1] + srow[bstep*2+1];
+                            Gs += srow[bstep*2] + srow[0];
+                            Bs += srow[bstep]*2;
+                            ng++;
+                        }
+                        if( gradW < thresh )
+                        {
+                            Rs += srow[-1]*2;
+                            Gs += srow[-2] + srow[0];
+                            Bs += srow[-bstep-2]+srow[bstep-2];
+                            ng++;
+                        }
+                        if( gradE < thresh )
+                        {
+                            Rs += srow[1]*2;
+                            Gs += srow[2] + srow[0];
+                            Bs += srow[-bstep+2]+srow[bstep+2];
+                            ng++;
+                        }
+                        if( gradNE < thresh )
+                        {
+                            Rs += srow[-bstep*2+1] + srow[1];
+                            Gs += srow[-bstep+1]*2;
+                            Bs += srow[-bstep] + srow[-bstep+2];
+                            ng++;
+                        }
+                        if( gradSW < thresh )
+                        {
+                            Rs += srow[bstep*2-1] + srow[-1];
+                            Gs += srow[bstep-1]*2;
+                            Bs += srow[bstep] + srow[bstep-2];
+                            ng++;
+                        }
+                        if( gradNW < thresh )
+                        {
+                            Rs += srow[-bstep*2-1] + srow[-1];
+                            Gs += srow[-bstep-1]*2;
+                            Bs += srow[-bstep-2]+srow[-bstep];
+                            ng++;
+                        }
+                        if( gradSE < thresh )
+                        {
+                            Rs += srow[bstep*2+1] + srow[1];
+                            Gs += srow[bstep+1]*2;
+                            Bs += srow[bstep+2]+srow[bstep];
+                            ng++;
+                        }
+                        G = srow[0];
+                        R = G + cvRound((Rs - Gs)*vngScale[ng]);
+                        B = G + cvRound((Bs - Gs)*vngScale[ng]);
                     }
-                    if( gradNW < T )
-                    {
-                        Rs += srow[-bstep*2-2] + srow[0];
-                        Gs += brow0[N6-1];
-                        Bs += srow[-bstep+1]*2;
-                        ng++;
-                    }
-                    if( gradSE < T )
-                    {
-                        Rs += srow[bstep*2+2] + srow[0];
-                        Gs += brow2[N6+1];
-                        Bs += srow[-bstep+1]*2;
-                        ng++;
-                    }
-                    R = srow[0];
-                    G = R + cvRound((Gs - Rs)*scale[ng]);
-                    B = R + cvRound((Bs - Rs)*scale[ng]);
+                    dstrow[blueIdx] = cv::saturate_cast<T>(B);
+                    dstrow[1] = cv::saturate_cast<T>(G);
+                    dstrow[blueIdx^2] = cv::saturate_cast<T>(R);
+                    greenCell = !greenCell;
                 }
-                else
-                {
-                    int gradNE = brow0[N2] + brow0[N2+1] + brow1[N2] + brow1[N2+1];
-                    int gradSW = brow1[N2] + brow1[N2-1] + brow2[N2] + brow2[N2-1];
-                    int gradNW = brow0[N3] + brow0[N3-1] + brow1[N3] + brow1[N3-1];
-                    int gradSE = brow1[N3] + brow1[N3+1] + brow2[N3] + brow2[N3+1];
 
-                    minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
-                    maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
-                    int T = minGrad + MAX(maxGrad/2, 1);
+                int delta = vecOp.bayer2RGB_VNG(srow, bstep, brow0, brow1, brow2, N, dstrow, N - 2 - i, blueIdx);
+                i += delta;
+                srow += delta;
+                brow0 += delta;
+                brow1 += delta;
+                brow2 += delta;
+                dstrow += delta*3;
 
-                    int Rs = 0, Gs = 0, Bs = 0, ng = 0;
-                    if( gradN < T )
-                    {
-                        Rs += srow[-bstep*2-1] + srow[-bstep*2+1];
-                        Gs += srow[-bstep*2] + srow[0];
-                        Bs += srow[-bstep]*2;
-                        ng++;
-                    }
-                    if( gradS < T )
-                    {
-                        Rs += srow[bstep*2-1] + srow[bstep*2+1];
-                        Gs += srow[bstep*2] + srow[0];
-                        Bs += srow[bstep]*2;
-                        ng++;
-                    }
-                    if( gradW < T )
-                    {
-                        Rs += srow[-1]*2;
-                        Gs += srow[-2] + srow[0];
-                        Bs += srow[-bstep-2]+srow[bstep-2];
-                        ng++;
-                    }
-                    if( gradE < T )
-                    {
-                        Rs += srow[1]*2;
-                        Gs += srow[2] + srow[0];
-                        Bs += srow[-bstep+2]+srow[bstep+2];
-                        ng++;
-                    }
-                    if( gradNE < T )
-                    {
-                        Rs += srow[-bstep*2+1] + srow[1];
-                        Gs += srow[-bstep+1]*2;
-                        Bs += srow[-bstep] + srow[-bstep+2];
-                        ng++;
-                    }
-                    if( gradSW < T )
-                    {
-                        Rs += srow[bstep*2-1] + srow[-1];
-                        Gs += srow[bstep-1]*2;
-                        Bs += srow[bstep] + srow[bstep-2];
-                        ng++;
-                    }
-                    if( gradNW < T )
-                    {
-                        Rs += srow[-bstep*2-1] + srow[-1];
-                        Gs += srow[-bstep-1]*2;
-                        Bs += srow[-bstep-2]+srow[-bstep];
-                        ng++;
-                    }
-                    if( gradSE < T )
-                    {
-                        Rs += srow[bstep*2+1] + srow[1];
-                        Gs += srow[bstep+1]*2;
-                        Bs += srow[bstep+2]+srow[bstep];
-                        ng++;
-                    }
-                    G = srow[0];
-                    R = G + cvRound((Rs - Gs)*scale[ng]);
-                    B = G + cvRound((Bs - Gs)*scale[ng]);
-                }
-                dstrow[blueIdx] = cv::saturate_cast<uchar>(B);
-                dstrow[1] = cv::saturate_cast<uchar>(G);
-                dstrow[blueIdx^2] = cv::saturate_cast<uchar>(R);
-                greenCell = !greenCell;
+                limit = N - 2;
             }
+            while( i < N - 2 );
 
-#if CV_SSE2
-            if( !haveSSE )
-                break;
-
-            __m128i emask    = _mm_set1_epi32(0x0000ffff),
-                    omask    = _mm_set1_epi32(0xffff0000),
-                    z        = _mm_setzero_si128(),
-                    one      = _mm_set1_epi16(1);
-            __m128 _0_5      = _mm_set1_ps(0.5f);
-
-            #define _mm_merge_epi16(a, b) _mm_or_si128(_mm_and_si128(a, emask), _mm_and_si128(b, omask)) //(aA_aA_aA_aA) * (bB_bB_bB_bB) => (bA_bA_bA_bA)
-            #define _mm_cvtloepi16_ps(a)  _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(a,a), 16))   //(1,2,3,4,5,6,7,8) => (1f,2f,3f,4f)
-            #define _mm_cvthiepi16_ps(a)  _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(a,a), 16))   //(1,2,3,4,5,6,7,8) => (5f,6f,7f,8f)
-            #define _mm_loadl_u8_s16(ptr, offset) _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)((ptr) + (offset))), z) //load 8 uchars to 8 shorts
-
-            // process 8 pixels at once
-            for( ; i <= N - 10; i += 8, srow += 8, brow0 += 8, brow1 += 8, brow2 += 8 )
+            for( i = 0; i < 6; i++ )
             {
-                //int gradN = brow0[0] + brow1[0];
-                __m128i gradN = _mm_adds_epi16(_mm_loadu_si128((__m128i*)brow0), _mm_loadu_si128((__m128i*)brow1));
-
-                //int gradS = brow1[0] + brow2[0];
-                __m128i gradS = _mm_adds_epi16(_mm_loadu_si128((__m128i*)brow1), _mm_loadu_si128((__m128i*)brow2));
-
-                //int gradW = brow1[N-1] + brow1[N];
-                __m128i gradW = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N-1)), _mm_loadu_si128((__m128i*)(brow1+N)));
-
-                //int gradE = brow1[N+1] + brow1[N];
-                __m128i gradE = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N+1)), _mm_loadu_si128((__m128i*)(brow1+N)));
-
-                //int minGrad = std::min(std::min(std::min(gradN, gradS), gradW), gradE);
-                //int maxGrad = std::max(std::max(std::max(gradN, gradS), gradW), gradE);
-                __m128i minGrad = _mm_min_epi16(_mm_min_epi16(gradN, gradS), _mm_min_epi16(gradW, gradE));
-                __m128i maxGrad = _mm_max_epi16(_mm_max_epi16(gradN, gradS), _mm_max_epi16(gradW, gradE));
-
-                __m128i grad0, grad1;
-
-                //int gradNE = brow0[N4+1] + brow1[N4];
-                //int gradNE = brow0[N2] + brow0[N2+1] + brow1[N2] + brow1[N2+1];
-                grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N4+1)), _mm_loadu_si128((__m128i*)(brow1+N4)));
-                grad1 = _mm_adds_epi16( _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N2)), _mm_loadu_si128((__m128i*)(brow0+N2+1))),
-                                        _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N2)), _mm_loadu_si128((__m128i*)(brow1+N2+1))));
-                __m128i gradNE = _mm_merge_epi16(grad0, grad1);
-
-                //int gradSW = brow1[N4] + brow2[N4-1];
-                //int gradSW = brow1[N2] + brow1[N2-1] + brow2[N2] + brow2[N2-1];
-                grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N4-1)), _mm_loadu_si128((__m128i*)(brow1+N4)));
-                grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N2)), _mm_loadu_si128((__m128i*)(brow2+N2-1))),
-                                       _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N2)), _mm_loadu_si128((__m128i*)(brow1+N2-1))));
-                __m128i gradSW = _mm_merge_epi16(grad0, grad1);
-
-                minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNE), gradSW);
-                maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNE), gradSW);
-
-                //int gradNW = brow0[N5-1] + brow1[N5];
-                //int gradNW = brow0[N3] + brow0[N3-1] + brow1[N3] + brow1[N3-1];
-                grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N5-1)), _mm_loadu_si128((__m128i*)(brow1+N5)));
-                grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N3)), _mm_loadu_si128((__m128i*)(brow0+N3-1))),
-                                       _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N3)), _mm_loadu_si128((__m128i*)(brow1+N3-1))));
-                __m128i gradNW = _mm_merge_epi16(grad0, grad1);
-
-                //int gradSE = brow1[N5] + brow2[N5+1];
-                //int gradSE = brow1[N3] + brow1[N3+1] + brow2[N3] + brow2[N3+1];
-                grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N5+1)), _mm_loadu_si128((__m128i*)(brow1+N5)));
-                grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N3)), _mm_loadu_si128((__m128i*)(brow2+N3+1))),
-                                       _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N3)), _mm_loadu_si128((__m128i*)(brow1+N3+1))));
-                __m128i gradSE = _mm_merge_epi16(grad0, grad1);
-
-                minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNW), gradSE);
-                maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNW), gradSE);
-
-                //int T = minGrad + maxGrad/2;
-                __m128i T = _mm_adds_epi16(_mm_max_epi16(_mm_srli_epi16(maxGrad, 1), one), minGrad);
-
-                __m128i RGs = z, GRs = z, Bs = z, ng = z;
-
-                __m128i x0  = _mm_loadl_u8_s16(srow, +0          );
-                __m128i x1  = _mm_loadl_u8_s16(srow, -1 - bstep  );
-                __m128i x2  = _mm_loadl_u8_s16(srow, -1 - bstep*2);
-                __m128i x3  = _mm_loadl_u8_s16(srow,    - bstep  );
-                __m128i x4  = _mm_loadl_u8_s16(srow, +1 - bstep*2);
-                __m128i x5  = _mm_loadl_u8_s16(srow, +1 - bstep  );
-                __m128i x6  = _mm_loadl_u8_s16(srow, +2 - bstep  );
-                __m128i x7  = _mm_loadl_u8_s16(srow, +1          );
-                __m128i x8  = _mm_loadl_u8_s16(srow, +2 + bstep  );
-                __m128i x9  = _mm_loadl_u8_s16(srow, +1 + bstep  );
-                __m128i x10 = _mm_loadl_u8_s16(srow, +1 + bstep*2);
-                __m128i x11 = _mm_loadl_u8_s16(srow,    + bstep  );
-                __m128i x12 = _mm_loadl_u8_s16(srow, -1 + bstep*2);
-                __m128i x13 = _mm_loadl_u8_s16(srow, -1 + bstep  );
-                __m128i x14 = _mm_loadl_u8_s16(srow, -2 + bstep  );
-                __m128i x15 = _mm_loadl_u8_s16(srow, -1          );
-                __m128i x16 = _mm_loadl_u8_s16(srow, -2 - bstep  );
-
-                __m128i t0, t1, mask;
-
-                // gradN ***********************************************
-                mask = _mm_cmpgt_epi16(T, gradN); // mask = T>gradN
-                ng = _mm_sub_epi16(ng, mask);     // ng += (T>gradN)
-
-                t0 = _mm_slli_epi16(x3, 1);                                 // srow[-bstep]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -bstep*2), x0);  // srow[-bstep*2] + srow[0]
-
-                // RGs += (srow[-bstep*2] + srow[0]) * (T>gradN)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
-                // GRs += {srow[-bstep]*2; (srow[-bstep*2-1] + srow[-bstep*2+1])} * (T>gradN)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epi16(x2,x4)), mask));
-                // Bs  += {(srow[-bstep-1]+srow[-bstep+1]); srow[-bstep]*2 } * (T>gradN)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x1,x5), t0), mask));
-
-                // gradNE **********************************************
-                mask = _mm_cmpgt_epi16(T, gradNE); // mask = T>gradNE
-                ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradNE)
-
-                t0 = _mm_slli_epi16(x5, 1);                                    // srow[-bstep+1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -bstep*2+2), x0);   // srow[-bstep*2+2] + srow[0]
-
-                // RGs += {(srow[-bstep*2+2] + srow[0]); srow[-bstep+1]*2} * (T>gradNE)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                // GRs += {brow0[N6+1]; (srow[-bstep*2+1] + srow[1])} * (T>gradNE)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6+1)), _mm_adds_epi16(x4,x7)), mask));
-                // Bs  += {srow[-bstep+1]*2; (srow[-bstep] + srow[-bstep+2])}  * (T>gradNE)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epi16(x3,x6)), mask));
-
-                // gradE ***********************************************
-                mask = _mm_cmpgt_epi16(T, gradE);  // mask = T>gradE
-                ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradE)
-
-                t0 = _mm_slli_epi16(x7, 1);                         // srow[1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, 2), x0); // srow[2] + srow[0]
-
-                // RGs += (srow[2] + srow[0]) * (T>gradE)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
-                // GRs += (srow[1]*2) * (T>gradE)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(t0, mask));
-                // Bs  += {(srow[-bstep+1]+srow[bstep+1]); (srow[-bstep+2]+srow[bstep+2])} * (T>gradE)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x5,x9), _mm_adds_epi16(x6,x8)), mask));
-
-                // gradSE **********************************************
-                mask = _mm_cmpgt_epi16(T, gradSE);  // mask = T>gradSE
-                ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradSE)
-
-                t0 = _mm_slli_epi16(x9, 1);                                 // srow[bstep+1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, bstep*2+2), x0); // srow[bstep*2+2] + srow[0]
-
-                // RGs += {(srow[bstep*2+2] + srow[0]); srow[bstep+1]*2} * (T>gradSE)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                // GRs += {brow2[N6+1]; (srow[1]+srow[bstep*2+1])} * (T>gradSE)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6+1)), _mm_adds_epi16(x7,x10)), mask));
-                // Bs  += {srow[-bstep+1]*2; (srow[bstep+2]+srow[bstep])} * (T>gradSE)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_slli_epi16(x5, 1), _mm_adds_epi16(x8,x11)), mask));
-
-                // gradS ***********************************************
-                mask = _mm_cmpgt_epi16(T, gradS);  // mask = T>gradS
-                ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradS)
-
-                t0 = _mm_slli_epi16(x11, 1);                             // srow[bstep]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow,bstep*2), x0); // srow[bstep*2]+srow[0]
-
-                // RGs += (srow[bstep*2]+srow[0]) * (T>gradS)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
-                // GRs += {srow[bstep]*2; (srow[bstep*2+1]+srow[bstep*2-1])} * (T>gradS)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epi16(x10,x12)), mask));
-                // Bs  += {(srow[bstep+1]+srow[bstep-1]); srow[bstep]*2} * (T>gradS)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x9,x13), t0), mask));
-
-                // gradSW **********************************************
-                mask = _mm_cmpgt_epi16(T, gradSW);  // mask = T>gradSW
-                ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradSW)
-
-                t0 = _mm_slli_epi16(x13, 1);                                // srow[bstep-1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, bstep*2-2), x0); // srow[bstep*2-2]+srow[0]
-
-                // RGs += {(srow[bstep*2-2]+srow[0]); srow[bstep-1]*2} * (T>gradSW)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                // GRs += {brow2[N6-1]; (srow[bstep*2-1]+srow[-1])} * (T>gradSW)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6-1)), _mm_adds_epi16(x12,x15)), mask));
-                // Bs  += {srow[bstep-1]*2; (srow[bstep]+srow[bstep-2])} * (T>gradSW)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epi16(x11,x14)), mask));
-
-                // gradW ***********************************************
-                mask = _mm_cmpgt_epi16(T, gradW);  // mask = T>gradW
-                ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradW)
-
-                t0 = _mm_slli_epi16(x15, 1);                         // srow[-1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -2), x0); // srow[-2]+srow[0]
-
-                // RGs += (srow[-2]+srow[0]) * (T>gradW)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
-                // GRs += (srow[-1]*2) * (T>gradW)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(t0, mask));
-                // Bs  += {(srow[-bstep-1]+srow[bstep-1]); (srow[bstep-2]+srow[-bstep-2])} * (T>gradW)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x1,x13), _mm_adds_epi16(x14,x16)), mask));
-
-                // gradNW **********************************************
-                mask = _mm_cmpgt_epi16(T, gradNW);  // mask = T>gradNW
-                ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradNW)
-
-                t0 = _mm_slli_epi16(x1, 1);                                 // srow[-bstep-1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow,-bstep*2-2), x0); // srow[-bstep*2-2]+srow[0]
-
-                // RGs += {(srow[-bstep*2-2]+srow[0]); srow[-bstep-1]*2} * (T>gradNW)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                // GRs += {brow0[N6-1]; (srow[-bstep*2-1]+srow[-1])} * (T>gradNW)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6-1)), _mm_adds_epi16(x2,x15)), mask));
-                // Bs  += {srow[-bstep-1]*2; (srow[-bstep]+srow[-bstep-2])} * (T>gradNW)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_slli_epi16(x5, 1),_mm_adds_epi16(x3,x16)), mask));
-
-                __m128 ngf0 = _mm_div_ps(_0_5, _mm_cvtloepi16_ps(ng));
-                __m128 ngf1 = _mm_div_ps(_0_5, _mm_cvthiepi16_ps(ng));
-
-                // now interpolate r, g & b
-                t0 = _mm_subs_epi16(GRs, RGs);
-                t1 = _mm_subs_epi16(Bs, RGs);
-
-                t0 = _mm_add_epi16(x0, _mm_packs_epi32(
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t0), ngf0)),
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t0), ngf1))));
-
-                t1 = _mm_add_epi16(x0, _mm_packs_epi32(
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t1), ngf0)),
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t1), ngf1))));
-
-                x1 = _mm_merge_epi16(x0, t0);
-                x2 = _mm_merge_epi16(t0, x0);
-
-                uchar R[8], G[8], B[8];
-
-                _mm_storel_epi64(blueIdx ? (__m128i*)B : (__m128i*)R, _mm_packus_epi16(x1, z));
-                _mm_storel_epi64((__m128i*)G, _mm_packus_epi16(x2, z));
-                _mm_storel_epi64(blueIdx ? (__m128i*)R : (__m128i*)B, _mm_packus_epi16(t1, z));
-
-                for( int j = 0; j < 8; j++, dstrow += 3 )
-                {
-                    dstrow[0] = B[j]; dstrow[1] = G[j]; dstrow[2] = R[j];
-                }
+                dst[dststep*y + 5 - i] = dst[dststep*y + 8 - i];
+                dst[dststep*y + (N - 2)*3 + i] = dst[dststep*y + (N - 3)*3 + i];
             }
-#endif
 
-            limit = N - 2;
+            greenCell0 = !greenCell0;
+            blueIdx ^= 2;
         }
-        while( i < N - 2 );
+    }
 
-        for( i = 0; i < 6; i++ )
-        {
-            dst[dststep*y + 5 - i] = dst[dststep*y + 8 - i];
-            dst[dststep*y + (N - 2)*3 + i] = dst[dststep*y + (N - 3)*3 + i];
-        }
+private:
+    Mat srcmat;
+    Mat dstmat;
+    int BlueIdx;
+    bool GreenCell0;
+};
+
+template<typename T, typename WT, class SIMDInterpolator>
+static void Bayer2RGB_VNG_T( const Mat& srcmat, Mat& dstmat, int code )
+{
+    Size size = srcmat.size();
 
-        greenCell0 = !greenCell0;
-        blueIdx ^= 2;
+    int blueIdx = code == CV_BayerBG2BGR_VNG || code == CV_BayerGB2BGR_VNG ? 0 : 2;
+    bool greenCell0 = code != CV_BayerBG2BGR_VNG && code != CV_BayerRG2BGR_VNG;
+
+    // for too small images use the simple interpolation algorithm
+    if( MIN(size.width, size.height) < 8 )
+    {
+        Bayer2RGB_<T, SIMDInterpolator>( srcmat, dstmat, code );
+        return;
     }
 
-    for( i = 0; i < size.width*3; i++ )
+    Bayer2RGB_VNG_Invoker<T, WT, SIMDInterpolator> invoker(srcmat, dstmat, blueIdx, greenCell0);
+    parallel_for_(Range(2, size.height - 4), invoker, dstmat.total()/static_cast<double>(1<<16));
+
+    T* dst = dstmat.ptr<T>();
+    int dststep = (int)(dstmat.step/sizeof(T));
+
+    for( int i = 0; i < size.width*3; i++ )
     {
         dst[i] = dst[i + dststep] = dst[i + dststep*2];
         dst[i + dststep*(size.height-4)] =
@@ -1637,7 +1948,7 @@ void cv::demosaicing(InputArray _src, OutputArray _dst, int code, int dcn)
         if( depth == CV_8U )
             Bayer2Gray_<uchar, SIMDBayerInterpolator_8u>(src, dst, code);
         else if( depth == CV_16U )
-            Bayer2Gray_<ushort, SIMDBayerStubInterpolator_<ushort> >(src, dst, code);
+            Bayer2Gray_<ushort, SIMDBayerInterpolator_16u>(src, dst, code);
         else
             CV_Error(CV_StsUnsupportedFormat, "Bayer->Gray demosaicing only supports 8u and 16u types");
         break;
@@ -1661,14 +1972,18 @@ void cv::demosaicing(InputArray _src, OutputArray _dst, int code, int dcn)
                 if( depth == CV_8U )
                     Bayer2RGB_<uchar, SIMDBayerInterpolator_8u>(src, dst_, code);
                 else if( depth == CV_16U )
-                    Bayer2RGB_<ushort, SIMDBayerStubInterpolator_<ushort> >(src, dst_, code);
+                    Bayer2RGB_<ushort, SIMDBayerInterpolator_16u>(src, dst_, code);
                 else
                     CV_Error(CV_StsUnsupportedFormat, "Bayer->RGB demosaicing only supports 8u and 16u types");
             }
             else
             {
-                CV_Assert( depth == CV_8U );
-                Bayer2RGB_VNG_8u(src, dst_, code);
+                if( depth == CV_8U )
+                    Bayer2RGB_VNG_T<uchar, ushort, SIMDBayerInterpolator_8u>(src, dst_, code);
+                else if( depth == CV_16U )
+                    Bayer2RGB_VNG_T<ushort, int, SIMDBayerInterpolator_16u>(src, dst_, code);
+                else
+                    CV_Error(CV_StsUnsupportedFormat, "Bayer->RGB VNG demosaicing only supports 8u and 16u types");
             }
         }
         break;
@@ -1684,7 +1999,7 @@ void cv::demosaicing(InputArray _src, OutputArray _dst, int code, int dcn)
         if (depth == CV_8U)
             Bayer2RGB_EdgeAware_T<uchar, SIMDBayerInterpolator_8u>(src, dst, code);
         else if (depth == CV_16U)
-            Bayer2RGB_EdgeAware_T<ushort, SIMDBayerStubInterpolator_<ushort> >(src, dst, code);
+            Bayer2RGB_EdgeAware_T<ushort, SIMDBayerInterpolator_16u>(src, dst, code);
         else
             CV_Error(CV_StsUnsupportedFormat, "Bayer->RGB Edge-Aware demosaicing only currently supports 8u and 16u types");
 
@@ -40,6 +40,7 @@
 //
 //M*/
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -399,6 +400,170 @@ distanceTransformEx_5x5( const Mat& _src, Mat& _temp, Mat& _dist, Mat& _labels,
 }
 
 
+/****************************************************************************************\
+                       Parallel 3x3 and 5x5 mask distance transform
+\****************************************************************************************/
+
+// The distance computed with a mask is the cost of the cheapest path made of the mask shifts.
+// For the masks used here such a path can always be made of at most two kinds of shifts lying
+// in the same quadrant, so the same distances are obtained by the independent 1D propagations
+// along the lines of every shift direction, one direction after another. Every line is processed
+// by a single thread; the lines are grouped into stripes so that each stripe covers a contiguous
+// span of every row, which keeps the memory access sequential and lets the update be vectorized.
+
+struct DTShift
+{
+    int dy, dx, cost;
+};
+
+static inline int floorDiv( int a, int b )
+{
+    return a >= 0 ? a/b : -((b - 1 - a)/b);
+}
+
+static inline void
+minShifted( int* d, const int* p, int j, int jend, int w )
+{
+#if CV_SIMD128
+    if( hasSIMD128() )
+    {
+        v_int32x4 vw = v_setall_s32(w);
+        for( ; j <= jend - 4; j += 4 )
+            v_store(d + j, v_min(v_load(d + j), v_load(p + j) + vw));
+    }
+#endif
+    for( ; j < jend; j++ )
+        d[j] = std::min(d[j], p[j] + w);
+}
+
+class DTLineInvoker : public ParallelLoopBody
+{
+public:
+    // the lines of the shift (dy, dx), dy > 0, are the sets of pixels with dx*i - dy*j == t
+    DTLineInvoker( Mat& _temp, const DTShift& _shift, int _tmin )
+        : temp(&_temp), shift(_shift), tmin(_tmin) {}
+
+    void operator()( const Range& range ) const
+    {
+        int rows = temp->rows, cols = temp->cols;
+        int dy = shift.dy, dx = shift.dx, w = shift.cost;
+        int i, j;
+
+        if( dy == 0 )
+        {
+            // horizontal lines are just the rows
+            for( i = range.start; i < range.end; i++ )
+            {
+                int* d = temp->ptr<int>(i);
+                for( j = 1; j < cols; j++ )
+                    d[j] = std::min(d[j], d[j-1] + w);
+                for( j = cols - 2; j >= 0; j-- )
+                    d[j] = std::min(d[j], d[j+1] + w);
+            }
+            return;
+        }
+
+        int t0 = range.start + tmin, t1 = range.end + tmin;
+
+        for( i = dy; i < rows; i++ )
+        {
+            int jlo = std::max(floorDiv(dx*i - t1 + dy, dy), std::max(dx, 0));
+            int jhi = std::min(floorDiv(dx*i - t0, dy) + 1, cols + std::min(dx, 0));
+            minShifted(temp->ptr<int>(i), temp->ptr<int>(i - dy) - dx, jlo, jhi, w);
+        }
+
+        for( i = rows - 1 - dy; i >= 0; i-- )
+        {
+            int jlo = std::max(floorDiv(dx*i - t1 + dy, dy), std::max(-dx, 0));
+            int jhi = std::min(floorDiv(dx*i - t0, dy) + 1, cols - std::max(dx, 0));
+            minShifted(temp->ptr<int>(i), temp->ptr<int>(i + dy) + dx, jlo, jhi, w);
+        }
+    }
+
+private:
+    Mat* temp;
+    DTShift shift;
+    int tmin;
+};
+
+static void
+distanceTransformMaskParallel( const Mat& src, Mat& dst, int maskSize, const float* metrics )
+{
+    const int HV_DIST = CV_FLT_TO_FIX( metrics[0], DIST_SHIFT );
+    const int DIAG_DIST = CV_FLT_TO_FIX( metrics[1], DIST_SHIFT );
+    const int LONG_DIST = maskSize == CV_DIST_MASK_5 ? CV_FLT_TO_FIX( metrics[2], DIST_SHIFT ) : 0;
+    const DTShift shifts[] =
+    {
+        { 0, 1, HV_DIST }, { 1, 0, HV_DIST }, { 1, 1, DIAG_DIST }, { 1, -1, DIAG_DIST },
+        { 1, 2, LONG_DIST }, { 1, -2, LONG_DIST }, { 2, 1, LONG_DIST }, { 2, -1, LONG_DIST }
+    };
+    int nshifts = maskSize == CV_DIST_MASK_5 ? 8 : 4;
+    int rows = src.rows, cols = src.cols;
+    double nstripes = src.total()/(double)(1 << 16);
+
+    Mat temp(src.size(), CV_32S, Scalar::all(INIT_DIST0));
+    temp.setTo(Scalar::all(0), src == 0);
+
+    for( int k = 0; k < nshifts; k++ )
+    {
+        const DTShift& s = shifts[k];
+        if( s.dy == 0 )
+        {
+            parallel_for_(Range(0, rows), DTLineInvoker(temp, s, 0), nstripes);
+            continue;
+        }
+        int c[] = { 0, -s.dy*(cols - 1), s.dx*(rows - 1), s.dx*(rows - 1) - s.dy*(cols - 1) };
+        int tmin = std::min(std::min(c[0], c[1]), std::min(c[2], c[3]));
+        int tmax = std::max(std::max(c[0], c[1]), std::max(c[2], c[3]));
+        parallel_for_(Range(0, tmax - tmin + 1), DTLineInvoker(temp, s, tmin), nstripes);
+    }
+
+    temp.convertTo(dst, CV_32F, 1./(1 << DIST_SHIFT));
+}
+
+// The numbering of zero pixels for DIST_LABEL_PIXEL, row by row
+class DTZeroLabelInvoker : public ParallelLoopBody
+{
+public:
+    DTZeroLabelInvoker( const Mat& _src, Mat& _labels, const int* _ofs )
+        : src(&_src), labels(&_labels), ofs(_ofs) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const uchar* srcptr = src->ptr(i);
+            int* labelptr = labels->ptr<int>(i);
+            int k = ofs[i];
+
+            for( int j = 0; j < src->cols; j++ )
+                labelptr[j] = srcptr[j] == 0 ? ++k : 0;
+        }
+    }
+
+private:
+    const Mat* src;
+    Mat* labels;
+    const int* ofs;
+};
+
+static void
+labelZeroPixels( const Mat& src, Mat& labels )
+{
+    AutoBuffer<int> _ofs(src.rows);
+    int* ofs = _ofs;
+    int k = 0;
+
+    for( int i = 0; i < src.rows; i++ )
+    {
+        ofs[i] = k;
+        k += src.cols - countNonZero(src.row(i));
+    }
+
+    parallel_for_(Range(0, src.rows), DTZeroLabelInvoker(src, labels, ofs),
+                  src.total()/(double)(1 << 16));
+}
+
 static void getDistanceTransformMask( int maskType, float *metrics )
 {
     CV_Assert( metrics != 0 );
@@ -444,12 +609,15 @@ static void getDistanceTransformMask( int maskType, float *metrics )
 
 struct DTColumnInvoker : ParallelLoopBody
 {
-    DTColumnInvoker( const Mat* _src, Mat* _dst, const int* _sat_tab, const float* _sqr_tab)
+    DTColumnInvoker( const Mat* _src, Mat* _dst, const int* _sat_tab, const float* _sqr_tab,
+                     const Mat* _labels = 0, Mat* _clabels = 0 )
     {
         src = _src;
         dst = _dst;
         sat_tab = _sat_tab + src->rows*2 + 1;
         sqr_tab = _sqr_tab;
+        labels = _labels;
+        clabels = _clabels;
     }
 
     void operator()( const Range& range ) const
@@ -457,9 +625,47 @@ struct DTColumnInvoker : ParallelLoopBody
         int i, i1 = range.start, i2 = range.end;
         int m = src->rows;
         size_t sstep = src->step, dstep = dst->step/sizeof(float);
-        AutoBuffer<int> _d(m);
+        AutoBuffer<int> _d(m*2);
         int* d = _d;
 
+        if( labels )
+        {
+            // the same distances, plus the label of the closest zero pixel in the column
+            int* l = d + m;
+            size_t lstep = labels->step/sizeof(int), clstep = clabels->step/sizeof(int);
+            for( i = i1; i < i2; i++ )
+            {
+                const uchar* sptr = src->ptr(m-1) + i;
+                const int* lptr = labels->ptr<int>(m-1) + i;
+                float* dptr = dst->ptr<float>() + i;
+                int* cptr = clabels->ptr<int>() + i;
+                int j, dist = m-1, label = 0;
+
+                for( j = m-1; j >= 0; j--, sptr -= sstep, lptr -= lstep )
+                {
+                    if( sptr[0] == 0 )
+                        dist = 0, label = lptr[0];
+                    else
+                        dist++;
+                    d[j] = dist;
+                    l[j] = label;
+                }
+
+                dist = m-1;
+                label = 0;
+                for( j = 0; j < m; j++, dptr += dstep, cptr += clstep )
+                {
+                    if( d[j] <= dist + 1 )
+                        dist = d[j], label = l[j];
+                    else
+                        dist++;
+                    dptr[0] = sqr_tab[dist];
+                    cptr[0] = label;
+                }
+            }
+            return;
+        }
+
         for( i = i1; i < i2; i++ )
         {
             const uchar* sptr = src->ptr(m-1) + i;
@@ -486,15 +692,20 @@ struct DTColumnInvoker : ParallelLoopBody
     Mat* dst;
     const int* sat_tab;
     const float* sqr_tab;
+    const Mat* labels;
+    Mat* clabels;
 };
 
 struct DTRowInvoker : ParallelLoopBody
 {
-    DTRowInvoker( Mat* _dst, const float* _sqr_tab, const float* _inv_tab )
+    DTRowInvoker( Mat* _dst, const float* _sqr_tab, const float* _inv_tab,
+                  const Mat* _clabels = 0, Mat* _labels = 0 )
     {
         dst = _dst;
         sqr_tab = _sqr_tab;
         inv_tab = _inv_tab;
+        clabels = _clabels;
+        labels = _labels;
     }
 
     void operator()( const Range& range ) const
@@ -537,12 +748,16 @@ struct DTRowInvoker : ParallelLoopBody
                 }
             }
 
+            const int* cl = clabels ? clabels->ptr<int>(i) : 0;
+            int* l = labels ? labels->ptr<int>(i) : 0;
             for( q = 0, k = 0; q < n; q++ )
             {
                 while( z[k+1] < q )
                     k++;
                 p = v[k];
                 d[q] = std::sqrt(sqr_tab[std::abs(q - p)] + f[p]);
+                if( l )
+                    l[q] = cl[p];
             }
         }
     }
@@ -550,10 +765,14 @@ struct DTRowInvoker : ParallelLoopBody
     Mat* dst;
     const float* sqr_tab;
     const float* inv_tab;
+    const Mat* clabels;
+    Mat* labels;
 };
 
+// When labels are passed, they contain the labels of the zero pixels on input
+// and the labels of the closest zero pixels on output
 static void
-trueDistTrans( const Mat& src, Mat& dst )
+trueDistTrans( const Mat& src, Mat& dst, Mat* labels = 0 )
 {
     const float inf = 1e15f;
 
@@ -577,7 +796,11 @@ trueDistTrans( const Mat& src, Mat& dst )
     for( ; i <= m*3; i++ )
         sat_tab[i] = i - shift;
 
-    cv::parallel_for_(cv::Range(0, n), cv::DTColumnInvoker(&src, &dst, sat_tab, sqr_tab), src.total()/(double)(1<<16));
+    Mat clabels;
+    if( labels )
+        clabels.create(src.size(), CV_32S);
+    cv::parallel_for_(cv::Range(0, n), cv::DTColumnInvoker(&src, &dst, sat_tab, sqr_tab,
+                      labels, labels ? &clabels : 0), src.total()/(double)(1<<16));
 
     // stage 2: compute modified distance transform for each row
     float* inv_tab = sqr_tab + n;
@@ -589,7 +812,8 @@ trueDistTrans( const Mat& src, Mat& dst )
         sqr_tab[i] = (float)(i*i);
     }
 
-    cv::parallel_for_(cv::Range(0, m), cv::DTRowInvoker(&dst, sqr_tab, inv_tab));
+    cv::parallel_for_(cv::Range(0, m), cv::DTRowInvoker(&dst, sqr_tab, inv_tab,
+                      labels ? &clabels : 0, labels));
 }
 
 
@@ -728,7 +952,18 @@ void cv::distanceTransform( InputArray _src, OutputArray _dst, OutputArray _labe
 
         _labels.create(src.size(), CV_32S);
         labels = _labels.getMat();
-        maskSize = CV_DIST_MASK_5;
+
+        if( labelType == CV_DIST_LABEL_CCOMP )
+        {
+            Mat zpix = src == 0;
+            connectedComponents(zpix, labels, 8, CV_32S, CCL_WU);
+        }
+        else
+            labelZeroPixels(src, labels);
+
+        // only the exact euclidean transform can compute the labels besides the 5x5 mask
+        if( distType != CV_DIST_L2 || maskSize != CV_DIST_MASK_PRECISE )
+            maskSize = CV_DIST_MASK_5;
     }
 
     float _mask[5] = {0};
@@ -736,13 +971,16 @@ void cv::distanceTransform( InputArray _src, OutputArray _dst, OutputArray _labe
     if( maskSize != CV_DIST_MASK_3 && maskSize != CV_DIST_MASK_5 && maskSize != CV_DIST_MASK_PRECISE )
         CV_Error( CV_StsBadSize, "Mask size should be 3 or 5 or 0 (precise)" );
 
-    if( distType == CV_DIST_C || distType == CV_DIST_L1 )
-        maskSize = !need_labels ? CV_DIST_MASK_3 : CV_DIST_MASK_5;
-    else if( distType == CV_DIST_L2 && need_labels )
-        maskSize = CV_DIST_MASK_5;
+    if( (distType == CV_DIST_C || distType == CV_DIST_L1) && !need_labels )
+        maskSize = CV_DIST_MASK_3;
 
     if( maskSize == CV_DIST_MASK_PRECISE )
     {
+        if( need_labels )
+        {
+            trueDistTrans( src, dst, &labels );
+            return;
+        }
 
 #ifdef HAVE_IPP
         CV_IPP_CHECK()
@@ -785,7 +1023,13 @@ void cv::distanceTransform( InputArray _src, OutputArray _dst, OutputArray _labe
     Size size = src.size();
 
     int border = maskSize == CV_DIST_MASK_3 ? 1 : 2;
-    Mat temp( size.height + border*2, size.width + border*2, CV_32SC1 );
+    Mat temp;
+
+    // the parallel version needs more passes, so it only pays off with several threads
+    // the sequential scans give the pixels that no zero pixel reaches the growing distances
+    // from the image border, which the line propagation does not reproduce
+    bool useParallel = !need_labels && getNumThreads() > 1 && src.total() >= (size_t)(1 << 16) &&
+                       countNonZero(src) < (int)src.total();
 
     if( !need_labels )
     {
@@ -804,7 +1048,13 @@ void cv::distanceTransform( InputArray _src, OutputArray _dst, OutputArray _labe
             }
 #endif
 
-            distanceTransform_3x3(src, temp, dst, _mask);
+            if( useParallel )
+                distanceTransformMaskParallel(src, dst, maskSize, _mask);
+            else
+            {
+                temp.create( size.height + border*2, size.width + border*2, CV_32SC1 );
+                distanceTransform_3x3(src, temp, dst, _mask);
+            }
         }
         else
         {
@@ -821,33 +1071,20 @@ void cv::distanceTransform( InputArray _src, OutputArray _dst, OutputArray _labe
             }
 #endif
 
-            distanceTransform_5x5(src, temp, dst, _mask);
+            if( useParallel )
+                distanceTransformMaskParallel(src, dst, maskSize, _mask);
+            else
+            {
+                temp.create( size.height + border*2, size.width + border*2, CV_32SC1 );
+                distanceTransform_5x5(src, temp, dst, _mask);
+            }
         }
     }
     else
     {
-        labels.setTo(Scalar::all(0));
-
-        if( labelType == CV_DIST_LABEL_CCOMP )
-        {
-            Mat zpix = src == 0;
-            connectedComponents(zpix, labels, 8, CV_32S, CCL_WU);
-        }
-        else
-        {
-            int k = 1;
-            for( int i = 0; i < src.rows; i++ )
-            {
-                const uchar* srcptr = src.ptr(i);
-                int* labelptr = labels.ptr<int>(i);
-
-                for( int j = 0; j < src.cols; j++ )
-                    if( srcptr[j] == 0 )
-                        labelptr[j] = k++;
-            }
-        }
-
-       distanceTransformEx_5x5( src, temp, dst, labels, _mask );
+        // the label of the ties depends on the scan order, so this one stays sequential
+        temp.create( size.height + border*2, size.width + border*2, CV_32SC1 );
+        distanceTransformEx_5x5( src, temp, dst, labels, _mask );
     }
 }
 
@@ -863,6 +1100,137 @@ void cv::distanceTransform( InputArray _src, OutputArray _dst,
 
 }
 
+/****************************************************************************************\
+                             Distance transform of a volume
+\****************************************************************************************/
+
+namespace cv
+{
+
+static const float DT3D_INF = 1e20f;
+
+// The transform is separable, so it is computed by the 1D transforms along x, y and z.
+// Every thread takes a group of the lines parallel to the axis.
+class DT3DInvoker : public ParallelLoopBody
+{
+public:
+    DT3DInvoker( Mat& _vol, int _axis, float _w, int _distType )
+        : vol(&_vol), axis(_axis), w(_w), distType(_distType) {}
+
+    void operator()( const Range& range ) const
+    {
+        int height = vol->size[1], width = vol->size[2];
+        int n = vol->size[axis];
+        size_t stride = axis == 2 ? 1 : axis == 1 ? (size_t)width : (size_t)width*height;
+        float* data = vol->ptr<float>();
+
+        AutoBuffer<float> _buf(n*2 + 1);
+        AutoBuffer<int> _v(n);
+        float *f = _buf, *z = f + n;
+        int* v = _v;
+
+        for( int l = range.start; l < range.end; l++ )
+        {
+            size_t base = axis == 2 ? (size_t)l*width :
+                          axis == 1 ? (size_t)(l/width)*width*height + l%width : (size_t)l;
+            float* d = data + base;
+            int q;
+
+            for( q = 0; q < n; q++ )
+                f[q] = d[q*stride];
+
+            if( distType == DIST_L1 )
+            {
+                for( q = 1; q < n; q++ )
+                    f[q] = std::min(f[q], f[q-1] + w);
+                for( q = n - 2; q >= 0; q-- )
+                    f[q] = std::min(f[q], f[q+1] + w);
+                for( q = 0; q < n; q++ )
+                    d[q*stride] = f[q];
+                continue;
+            }
+
+            // the lower envelope of the parabolas w^2*(q - p)^2 + f[p], the positions are
+            // measured in the units of the axis, so the intersections are q*w based
+            int k = -1;
+            for( q = 0; q < n; q++ )
+            {
+                if( f[q] >= DT3D_INF )
+                    continue;
+                float fq = f[q] + (q*w)*(q*w), s = 0.f;
+                while( k >= 0 )
+                {
+                    int p = v[k];
+                    s = (fq - f[p] - (p*w)*(p*w))/(2*w*(q - p));
+                    if( s > z[k] )
+                        break;
+                    k--;
+                }
+                k++;
+                v[k] = q;
+                z[k] = k == 0 ? -FLT_MAX : s;
+            }
+
+            if( k < 0 )
+            {
+                for( q = 0; q < n; q++ )
+                    d[q*stride] = DT3D_INF;
+                continue;
+            }
+
+            z[k+1] = FLT_MAX;
+            for( q = 0, k = 0; q < n; q++ )
+            {
+                while( z[k+1] < q*w )
+                    k++;
+                int p = v[k];
+                float t = (q - p)*w;
+                d[q*stride] = t*t + f[p];
+            }
+        }
+    }
+
+private:
+    Mat* vol;
+    int axis;
+    float w;
+    int distType;
+};
+
+}
+
+void cv::distanceTransform3D( InputArray _src, OutputArray _dst, int distanceType, const Vec3f& spacing )
+{
+    CV_INSTRUMENT_REGION()
+
+    Mat src = _src.getMat();
+
+    CV_Assert( src.dims == 3 && src.type() == CV_8UC1 && src.isContinuous() );
+    CV_Assert( distanceType == DIST_L1 || distanceType == DIST_L2 );
+    CV_Assert( spacing[0] > 0 && spacing[1] > 0 && spacing[2] > 0 );
+
+    _dst.create(src.dims, src.size.p, CV_32F);
+    Mat dst = _dst.getMat();
+    CV_Assert( dst.isContinuous() );
+
+    const uchar* sptr = src.ptr();
+    float* dptr = dst.ptr<float>();
+    size_t i, total = src.total();
+    for( i = 0; i < total; i++ )
+        dptr[i] = sptr[i] == 0 ? 0.f : DT3D_INF;
+
+    // the spacing is given in the x, y, z order, that is from the last dimension to the first one
+    double nstripes = total/(double)(1 << 16);
+    for( int axis = 2; axis >= 0; axis-- )
+    {
+        int nlines = (int)(total/src.size[axis]);
+        parallel_for_(Range(0, nlines), DT3DInvoker(dst, axis, spacing[2 - axis], distanceType), nstripes);
+    }
+
+    if( distanceType == DIST_L2 )
+        sqrt(dst, dst);
+}
+
 CV_IMPL void
 cvDistTransform( const void* srcarr, void* dstarr,
                 int distType, int maskSize,
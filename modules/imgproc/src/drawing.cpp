@@ -39,6 +39,7 @@
 //
 //M*/
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include <stdint.h>
 
@@ -59,21 +60,34 @@ struct PolyEdge
     PolyEdge *next;
 };
 
+// The drawing functions below take the optional range of image rows, which they are allowed
+// to modify. The shapes are rasterized exactly as without it, only the pixels outside of
+// the range are not touched. This is used to render a shape by several threads.
+
 static void
 CollectPolyEdges( Mat& img, const Point2l* v, int npts,
                   std::vector<PolyEdge>& edges, const void* color, int line_type,
-                  int shift, Point offset=Point() );
+                  int shift, Point offset=Point(), const Range& rows=Range::all() );
 
 static void
-FillEdgeCollection( Mat& img, std::vector<PolyEdge>& edges, const void* color );
+FillEdgeCollection( Mat& img, std::vector<PolyEdge>& edges, const void* color,
+                    const Range& rows=Range::all() );
 
 static void
 PolyLine( Mat& img, const Point2l* v, int npts, bool closed,
-          const void* color, int thickness, int line_type, int shift );
+          const void* color, int thickness, int line_type, int shift,
+          const Range& rows=Range::all() );
 
 static void
 FillConvexPoly( Mat& img, const Point2l* v, int npts,
-                const void* color, int line_type, int shift );
+                const void* color, int line_type, int shift,
+                const Range& rows=Range::all() );
+
+static inline Range clipRows( const Range& rows, int height )
+{
+    int start = std::max(rows.start, 0);
+    return Range( start, std::max(std::min(rows.end, height), start) );
+}
 
 /****************************************************************************************\
 *                                   Lines                                                *
@@ -252,7 +266,7 @@ LineIterator::LineIterator(const Mat& img, Point pt1, Point pt2,
 
 static void
 Line( Mat& img, Point pt1, Point pt2,
-      const void* _color, int connectivity = 8 )
+      const void* _color, int connectivity = 8, const Range& rows = Range::all() )
 {
     if( connectivity == 0 )
         connectivity = 8;
@@ -263,10 +277,15 @@ Line( Mat& img, Point pt1, Point pt2,
     int i, count = iterator.count;
     int pix_size = (int)img.elemSize();
     const uchar* color = (const uchar*)_color;
+    Range r = clipRows( rows, img.rows );
+    const uchar* rows_ptr = img.ptr() + r.start*img.step;
+    size_t rows_size = r.size()*img.step;
 
     for( i = 0; i < count; i++, ++iterator )
     {
         uchar* ptr = *iterator;
+        if( (size_t)(ptr - rows_ptr) >= rows_size )
+            continue;
         if( pix_size == 1 )
             ptr[0] = color[0];
         else if( pix_size == 3 )
@@ -296,7 +315,7 @@ static const int FilterTable[] = {
 };
 
 static void
-LineAA( Mat& img, Point2l pt1, Point2l pt2, const void* color )
+LineAA( Mat& img, Point2l pt1, Point2l pt2, const void* color, const Range& rows = Range::all() )
 {
     int64 dx, dy;
     int ecount, scount = 0;
@@ -311,10 +330,13 @@ LineAA( Mat& img, Point2l pt1, Point2l pt2, const void* color )
     uchar* ptr = img.ptr();
     size_t step = img.step;
     Size2l size(img.size());
+    Range r = clipRows( rows, img.rows );
+    const uchar* rows_ptr = img.ptr() + r.start*step;
+    size_t rows_size = r.size()*step;
 
     if( !((nch == 1 || nch == 3 || nch == 4) && img.depth() == CV_8U) )
     {
-        Line(img, Point((int)(pt1.x>>XY_SHIFT), (int)(pt1.y>>XY_SHIFT)), Point((int)(pt2.x>>XY_SHIFT), (int)(pt2.y>>XY_SHIFT)), color);
+        Line(img, Point((int)(pt1.x>>XY_SHIFT), (int)(pt1.y>>XY_SHIFT)), Point((int)(pt2.x>>XY_SHIFT), (int)(pt2.y>>XY_SHIFT)), color, 8, rows);
         return;
     }
 
@@ -408,6 +430,7 @@ LineAA( Mat& img, Point2l pt1, Point2l pt2, const void* color )
     if( nch == 3 )
     {
         #define  ICV_PUT_POINT()            \
+        if( (size_t)(tptr - rows_ptr) < rows_size ) \
         {                                   \
             _cb = tptr[0];                  \
             _cb += ((cb - _cb)*a + 127)>> 8;\
@@ -488,6 +511,7 @@ LineAA( Mat& img, Point2l pt1, Point2l pt2, const void* color )
     else if(nch == 1)
     {
         #define  ICV_PUT_POINT()            \
+        if( (size_t)(tptr - rows_ptr) < rows_size ) \
         {                                   \
             _cb = tptr[0];                  \
             _cb += ((cb - _cb)*a + 127)>> 8;\
@@ -563,6 +587,7 @@ LineAA( Mat& img, Point2l pt1, Point2l pt2, const void* color )
     else
     {
         #define  ICV_PUT_POINT()            \
+        if( (size_t)(tptr - rows_ptr) < rows_size ) \
         {                                   \
             _cb = tptr[0];                  \
             _cb += ((cb - _cb)*a + 127)>> 8;\
@@ -647,7 +672,7 @@ LineAA( Mat& img, Point2l pt1, Point2l pt2, const void* color )
 
 
 static void
-Line2( Mat& img, Point2l pt1, Point2l pt2, const void* color)
+Line2( Mat& img, Point2l pt1, Point2l pt2, const void* color, const Range& rows = Range::all() )
 {
     int64 dx, dy;
     int ecount;
@@ -662,6 +687,7 @@ Line2( Mat& img, Point2l pt1, Point2l pt2, const void* color)
     uchar *ptr = img.ptr(), *tptr;
     size_t step = img.step;
     Size size = img.size();
+    Range r = clipRows( rows, size.height );
 
     //assert( img && (nch == 1 || nch == 3) && img.depth() == CV_8U );
 
@@ -716,7 +742,7 @@ Line2( Mat& img, Point2l pt1, Point2l pt2, const void* color)
         #define  ICV_PUT_POINT(_x,_y)   \
         x = (_x); y = (_y);             \
         if( 0 <= x && x < size.width && \
-            0 <= y && y < size.height ) \
+            r.start <= y && y < r.end ) \
         {                               \
             tptr = ptr + y*step + x*3;  \
             tptr[0] = (uchar)cb;        \
@@ -759,7 +785,7 @@ Line2( Mat& img, Point2l pt1, Point2l pt2, const void* color)
         #define  ICV_PUT_POINT(_x,_y) \
         x = (_x); y = (_y);           \
         if( 0 <= x && x < size.width && \
-            0 <= y && y < size.height ) \
+            r.start <= y && y < r.end ) \
         {                           \
             tptr = ptr + y*step + x;\
             tptr[0] = (uchar)cb;    \
@@ -800,7 +826,7 @@ Line2( Mat& img, Point2l pt1, Point2l pt2, const void* color)
         #define  ICV_PUT_POINT(_x,_y)   \
         x = (_x); y = (_y);             \
         if( 0 <= x && x < size.width && \
-            0 <= y && y < size.height ) \
+            r.start <= y && y < r.end ) \
         {                               \
             tptr = ptr + y*step + x*pix_size;\
             for( j = 0; j < pix_size; j++ ) \
@@ -1026,7 +1052,8 @@ void ellipse2Poly( Point2d center, Size2d axes, int angle,
 static void
 EllipseEx( Mat& img, Point2l center, Size2l axes,
            int angle, int arc_start, int arc_end,
-           const void* color, int thickness, int line_type )
+           const void* color, int thickness, int line_type,
+           const Range& rows = Range::all() )
 {
     axes.width = std::abs(axes.width), axes.height = std::abs(axes.height);
     int delta = (int)((std::max(axes.width,axes.height)+(XY_ONE>>1))>>XY_SHIFT);
@@ -1057,15 +1084,15 @@ EllipseEx( Mat& img, Point2l center, Size2l axes,
     }
 
     if( thickness >= 0 )
-        PolyLine( img, &v[0], (int)v.size(), false, color, thickness, line_type, XY_SHIFT );
+        PolyLine( img, &v[0], (int)v.size(), false, color, thickness, line_type, XY_SHIFT, rows );
     else if( arc_end - arc_start >= 360 )
-        FillConvexPoly( img, &v[0], (int)v.size(), color, line_type, XY_SHIFT );
+        FillConvexPoly( img, &v[0], (int)v.size(), color, line_type, XY_SHIFT, rows );
     else
     {
         v.push_back(center);
         std::vector<PolyEdge> edges;
-        CollectPolyEdges( img,  &v[0], (int)v.size(), edges, color, line_type, XY_SHIFT );
-        FillEdgeCollection( img, edges, color );
+        CollectPolyEdges( img,  &v[0], (int)v.size(), edges, color, line_type, XY_SHIFT, Point(), rows );
+        FillEdgeCollection( img, edges, color, rows );
     }
 }
 
@@ -1081,7 +1108,55 @@ static inline void ICV_HLINE_X(uchar* ptr, int xl, int xr, const uchar* color, i
     uchar* hline_ptr = hline_min_ptr;
     if (pix_size == 1)
       memset(hline_min_ptr, *color, hline_end_ptr-hline_min_ptr);
-    else//if (pix_size != 1)
+    else if (pix_size == 3 || pix_size == 4)
+    {
+#if CV_SIMD128
+      // 48 bytes hold a whole number of pixels of both sizes
+      if (hline_end_ptr - hline_ptr >= 48)
+      {
+        // 12 bytes of the pattern as 3 words, repeated as w0 w1 w2 w0 | w1 w2 w0 w1 | w2 w0 w1 w2
+        uchar c0 = color[0], c1 = color[1], c2 = color[2], c3 = color[pix_size - 1];
+        uchar pattern[12] = { c0, c1, c2, c3, c0, c1, c2, c3, c0, c1, c2, c3 };
+        if (pix_size == 3)
+        {
+          pattern[3] = pattern[6] = pattern[9] = c0;
+          pattern[4] = pattern[7] = pattern[10] = c1;
+          pattern[5] = pattern[8] = pattern[11] = c2;
+        }
+        unsigned w0, w1, w2;
+        memcpy(&w0, pattern, 4);
+        memcpy(&w1, pattern + 4, 4);
+        memcpy(&w2, pattern + 8, 4);
+        v_uint8x16 v_p0 = v_reinterpret_as_u8(v_uint32x4(w0, w1, w2, w0));
+        v_uint8x16 v_p1 = v_reinterpret_as_u8(v_uint32x4(w1, w2, w0, w1));
+        v_uint8x16 v_p2 = v_reinterpret_as_u8(v_uint32x4(w2, w0, w1, w2));
+        for (; hline_ptr <= hline_end_ptr - 48; hline_ptr += 48)
+        {
+          v_store(hline_ptr, v_p0);
+          v_store(hline_ptr + 16, v_p1);
+          v_store(hline_ptr + 32, v_p2);
+        }
+        // the rest is covered by the last 48 bytes, which start at a pixel boundary as well
+        if (hline_ptr < hline_end_ptr)
+        {
+          hline_ptr = hline_end_ptr - 48;
+          v_store(hline_ptr, v_p0);
+          v_store(hline_ptr + 16, v_p1);
+          v_store(hline_ptr + 32, v_p2);
+        }
+        return;
+      }
+#endif
+      for (; hline_ptr < hline_end_ptr; hline_ptr += pix_size)
+      {
+        hline_ptr[0] = color[0];
+        hline_ptr[1] = color[1];
+        hline_ptr[2] = color[2];
+        if (pix_size == 4)
+          hline_ptr[3] = color[3];
+      }
+    }
+    else
     {
       if (hline_min_ptr < hline_end_ptr)
       {
@@ -1107,7 +1182,8 @@ static inline void ICV_HLINE(uchar* ptr, int xl, int xr, const void* color, int
 
 /* filling convex polygon. v - array of vertices, ntps - number of points */
 static void
-FillConvexPoly( Mat& img, const Point2l* v, int npts, const void* color, int line_type, int shift )
+FillConvexPoly( Mat& img, const Point2l* v, int npts, const void* color, int line_type, int shift,
+                const Range& rows )
 {
     struct
     {
@@ -1123,6 +1199,7 @@ FillConvexPoly( Mat& img, const Point2l* v, int npts, const void* color, int lin
     int64 xmin, xmax, ymin, ymax;
     uchar* ptr = img.ptr();
     Size size = img.size();
+    Range r = clipRows( rows, size.height );
     int pix_size = (int)img.elemSize();
     Point2l p0;
     int delta1, delta2;
@@ -1165,13 +1242,13 @@ FillConvexPoly( Mat& img, const Point2l* v, int npts, const void* color, int lin
                 pt0.y = (int)(p0.y >> XY_SHIFT);
                 pt1.x = (int)(p.x >> XY_SHIFT);
                 pt1.y = (int)(p.y >> XY_SHIFT);
-                Line( img, pt0, pt1, color, line_type );
+                Line( img, pt0, pt1, color, line_type, rows );
             }
             else
-                Line2( img, p0, p, color );
+                Line2( img, p0, p, color, rows );
         }
         else
-            LineAA( img, p0, p, color );
+            LineAA( img, p0, p, color, rows );
         p0 = p;
     }
 
@@ -1180,10 +1257,11 @@ FillConvexPoly( Mat& img, const Point2l* v, int npts, const void* color, int lin
     ymin = (ymin + delta) >> shift;
     ymax = (ymax + delta) >> shift;
 
-    if( npts < 3 || (int)xmax < 0 || (int)ymax < 0 || (int)xmin >= size.width || (int)ymin >= size.height )
+    if( npts < 3 || (int)xmax < 0 || (int)ymax < r.start || (int)xmin >= size.width || (int)ymin >= r.end )
         return;
 
     ymax = MIN( ymax, size.height - 1 );
+    int yend = MIN( (int)ymax, r.end - 1 );
     edge[0].idx = edge[1].idx = imin;
 
     edge[0].ye = edge[1].ye = y = (int)ymin;
@@ -1238,7 +1316,7 @@ FillConvexPoly( Mat& img, const Point2l* v, int npts, const void* color, int lin
         if (edges < 0)
             break;
 
-        if (y >= 0)
+        if (y >= r.start)
         {
             int left = 0, right = 1;
             if (edge[0].x > edge[1].x)
@@ -1267,7 +1345,7 @@ FillConvexPoly( Mat& img, const Point2l* v, int npts, const void* color, int lin
         edge[1].x += edge[1].dx;
         ptr += img.step;
     }
-    while( ++y <= (int)ymax );
+    while( ++y <= yend );
 }
 
 
@@ -1275,7 +1353,7 @@ FillConvexPoly( Mat& img, const Point2l* v, int npts, const void* color, int lin
 
 static void
 CollectPolyEdges( Mat& img, const Point2l* v, int count, std::vector<PolyEdge>& edges,
-                  const void* color, int line_type, int shift, Point offset )
+                  const void* color, int line_type, int shift, Point offset, const Range& rows )
 {
     int i, delta = offset.y + ((1 << shift) >> 1);
     Point2l pt0 = v[count-1], pt1;
@@ -1298,14 +1376,14 @@ CollectPolyEdges( Mat& img, const Point2l* v, int count, std::vector<PolyEdge>&
             t0.y = pt0.y; t1.y = pt1.y;
             t0.x = (pt0.x + (XY_ONE >> 1)) >> XY_SHIFT;
             t1.x = (pt1.x + (XY_ONE >> 1)) >> XY_SHIFT;
-            Line( img, t0, t1, color, line_type );
+            Line( img, t0, t1, color, line_type, rows );
         }
         else
         {
             t0.x = pt0.x; t1.x = pt1.x;
             t0.y = pt0.y << XY_SHIFT;
             t1.y = pt1.y << XY_SHIFT;
-            LineAA( img, t0, t1, color );
+            LineAA( img, t0, t1, color, rows );
         }
 
         if( pt0.y == pt1.y )
@@ -1340,11 +1418,12 @@ struct CmpEdges
 /**************** helper macros and functions for sequence/contour processing ***********/
 
 static void
-FillEdgeCollection( Mat& img, std::vector<PolyEdge>& edges, const void* color )
+FillEdgeCollection( Mat& img, std::vector<PolyEdge>& edges, const void* color, const Range& rows )
 {
     PolyEdge tmp;
     int i, y, total = (int)edges.size();
     Size size = img.size();
+    Range r = clipRows( rows, size.height );
     PolyEdge* e;
     int y_max = INT_MIN, y_min = INT_MAX;
     int64 x_max = 0xFFFFFFFFFFFFFFFF, x_min = 0x7FFFFFFFFFFFFFFF;
@@ -1368,7 +1447,7 @@ FillEdgeCollection( Mat& img, std::vector<PolyEdge>& edges, const void* color )
         x_max = std::max( x_max, x1 );
     }
 
-    if( y_max < 0 || y_min >= size.height || x_max < 0 || x_min >= ((int64)size.width<<XY_SHIFT) )
+    if( y_max < r.start || y_min >= r.end || x_max < 0 || x_min >= ((int64)size.width<<XY_SHIFT) )
         return;
 
     std::sort( edges.begin(), edges.end(), CmpEdges() );
@@ -1380,14 +1459,14 @@ FillEdgeCollection( Mat& img, std::vector<PolyEdge>& edges, const void* color )
     i = 0;
     tmp.next = 0;
     e = &edges[i];
-    y_max = MIN( y_max, size.height );
+    y_max = MIN( y_max, r.end );
 
     for( y = e->y0; y < y_max; y++ )
     {
         PolyEdge *last, *prelast, *keep_prelast;
         int sort_flag = 0;
         int draw = 0;
-        int clipline = y < 0;
+        int clipline = y < r.start;
 
         prelast = &tmp;
         last = tmp.next;
@@ -1489,15 +1568,17 @@ FillEdgeCollection( Mat& img, std::vector<PolyEdge>& edges, const void* color )
 
 /* draws simple or filled circle */
 static void
-Circle( Mat& img, Point center, int radius, const void* color, int fill )
+Circle( Mat& img, Point center, int radius, const void* color, int fill,
+        const Range& rows = Range::all() )
 {
     Size size = img.size();
+    Range r = clipRows( rows, size.height );
     size_t step = img.step;
     int pix_size = (int)img.elemSize();
     uchar* ptr = img.ptr();
     int err = 0, dx = radius, dy = 0, plus = 1, minus = (radius << 1) - 1;
     int inside = center.x >= radius && center.x < size.width - radius &&
-        center.y >= radius && center.y < size.height - radius;
+        center.y >= r.start + radius && center.y < r.end - radius;
 
     #define ICV_PUT_POINT( ptr, x )     \
         memcpy( ptr + (x)*pix_size, color, pix_size );
@@ -1542,7 +1623,7 @@ Circle( Mat& img, Point center, int radius, const void* color, int fill )
                 ICV_HLINE( tptr1, x21, x22, color, pix_size );
             }
         }
-        else if( x11 < size.width && x12 >= 0 && y21 < size.height && y22 >= 0 )
+        else if( x11 < size.width && x12 >= 0 && y21 < r.end && y22 >= r.start )
         {
             if( fill )
             {
@@ -1550,7 +1631,7 @@ Circle( Mat& img, Point center, int radius, const void* color, int fill )
                 x12 = MIN( x12, size.width - 1 );
             }
 
-            if( (unsigned)y11 < (unsigned)size.height )
+            if( (unsigned)(y11 - r.start) < (unsigned)r.size() )
             {
                 uchar *tptr = ptr + y11 * step;
 
@@ -1565,7 +1646,7 @@ Circle( Mat& img, Point center, int radius, const void* color, int fill )
                     ICV_HLINE( tptr, x11, x12, color, pix_size );
             }
 
-            if( (unsigned)y12 < (unsigned)size.height )
+            if( (unsigned)(y12 - r.start) < (unsigned)r.size() )
             {
                 uchar *tptr = ptr + y12 * step;
 
@@ -1588,7 +1669,7 @@ Circle( Mat& img, Point center, int radius, const void* color, int fill )
                     x22 = MIN( x22, size.width - 1 );
                 }
 
-                if( (unsigned)y21 < (unsigned)size.height )
+                if( (unsigned)(y21 - r.start) < (unsigned)r.size() )
                 {
                     uchar *tptr = ptr + y21 * step;
 
@@ -1603,7 +1684,7 @@ Circle( Mat& img, Point center, int radius, const void* color, int fill )
                         ICV_HLINE( tptr, x21, x22, color, pix_size );
                 }
 
-                if( (unsigned)y22 < (unsigned)size.height )
+                if( (unsigned)(y22 - r.start) < (unsigned)r.size() )
                 {
                     uchar *tptr = ptr + y22 * step;
 
@@ -1636,7 +1717,8 @@ Circle( Mat& img, Point center, int radius, const void* color, int fill )
 
 static void
 ThickLine( Mat& img, Point2l p0, Point2l p1, const void* color,
-           int thickness, int line_type, int flags, int shift )
+           int thickness, int line_type, int flags, int shift,
+           const Range& rows = Range::all() )
 {
     static const double INV_XY_ONE = 1./XY_ONE;
 
@@ -1655,13 +1737,13 @@ ThickLine( Mat& img, Point2l p0, Point2l p1, const void* color,
                 p0.y = (p0.y + (XY_ONE>>1)) >> XY_SHIFT;
                 p1.x = (p1.x + (XY_ONE>>1)) >> XY_SHIFT;
                 p1.y = (p1.y + (XY_ONE>>1)) >> XY_SHIFT;
-                Line( img, p0, p1, color, line_type );
+                Line( img, p0, p1, color, line_type, rows );
             }
             else
-                Line2( img, p0, p1, color );
+                Line2( img, p0, p1, color, rows );
         }
         else
-            LineAA( img, p0, p1, color );
+            LineAA( img, p0, p1, color, rows );
     }
     else
     {
@@ -1686,7 +1768,7 @@ ThickLine( Mat& img, Point2l p0, Point2l p1, const void* color,
             pt[3].x = p1.x + dp.x;
             pt[3].y = p1.y + dp.y;
 
-            FillConvexPoly( img, pt, 4, color, line_type, XY_SHIFT );
+            FillConvexPoly( img, pt, 4, color, line_type, XY_SHIFT, rows );
         }
 
         for( i = 0; i < 2; i++ )
@@ -1698,12 +1780,12 @@ ThickLine( Mat& img, Point2l p0, Point2l p1, const void* color,
                     Point center;
                     center.x = (int)((p0.x + (XY_ONE>>1)) >> XY_SHIFT);
                     center.y = (int)((p0.y + (XY_ONE>>1)) >> XY_SHIFT);
-                    Circle( img, center, (thickness + (XY_ONE>>1)) >> XY_SHIFT, color, 1 );
+                    Circle( img, center, (thickness + (XY_ONE>>1)) >> XY_SHIFT, color, 1, rows );
                 }
                 else
                 {
                     EllipseEx( img, p0, Size2l(thickness, thickness),
-                               0, 0, 360, color, -1, line_type );
+                               0, 0, 360, color, -1, line_type, rows );
                 }
             }
             p0 = p1;
@@ -1715,7 +1797,7 @@ ThickLine( Mat& img, Point2l p0, Point2l p1, const void* color,
 static void
 PolyLine( Mat& img, const Point2l* v, int count, bool is_closed,
           const void* color, int thickness,
-          int line_type, int shift )
+          int line_type, int shift, const Range& rows )
 {
     if( !v || count <= 0 )
         return;
@@ -1729,7 +1811,7 @@ PolyLine( Mat& img, const Point2l* v, int count, bool is_closed,
     for( i = !is_closed; i < count; i++ )
     {
         Point2l p = v[i];
-        ThickLine( img, p0, p, color, thickness, line_type, flags, shift );
+        ThickLine( img, p0, p, color, thickness, line_type, flags, shift, rows );
         p0 = p;
         flags = 2;
     }
@@ -2436,6 +2518,365 @@ void cv::polylines(InputOutputArray _img, InputArrayOfArrays pts,
     polylines(img, (const Point**)ptsptr, npts, (int)ncontours, isClosed, color, thickness, lineType, shift);
 }
 
+/****************************************************************************************\
+*                                  Batched drawing                                       *
+\****************************************************************************************/
+
+namespace cv
+{
+
+struct DrawingBatch::Impl
+{
+    enum { OP_LINE = 0, OP_RECTANGLE = 1, OP_CIRCLE = 2, OP_POLYLINES = 3,
+           OP_FILL_POLY = 4, OP_FILL_CONVEX_POLY = 5 };
+
+    struct Op
+    {
+        int type;
+        Scalar color;
+        int thickness, lineType, shift;
+        int radius;
+        bool isClosed;
+        Point offset;
+        int contour0, ncontours;    // range in the contours array
+    };
+
+    void addContour( const Point* pts, int npts )
+    {
+        contours.push_back( Range((int)points.size(), (int)points.size() + npts) );
+        points.insert( points.end(), pts, pts + npts );
+    }
+
+    Op& addOp( int type, const Scalar& color, int thickness, int lineType, int shift )
+    {
+        CV_Assert( 0 <= shift && shift <= XY_SHIFT && thickness <= MAX_THICKNESS );
+        Op op;
+        op.type = type;
+        op.color = color;
+        op.thickness = thickness;
+        op.lineType = lineType;
+        op.shift = shift;
+        op.radius = 0;
+        op.isClosed = false;
+        op.contour0 = (int)contours.size();
+        op.ncontours = 0;
+        ops.push_back(op);
+        return ops.back();
+    }
+
+    void addContours( Op& op, InputArrayOfArrays pts, bool manyContours )
+    {
+        int ncontours = manyContours ? (int)pts.total() : 1;
+        for( int i = 0; i < ncontours; i++ )
+        {
+            Mat p = pts.getMat(manyContours ? i : -1);
+            int npts = 0;
+            if( p.total() != 0 )
+            {
+                CV_Assert( p.checkVector(2, CV_32S) >= 0 );
+                npts = p.rows*p.cols*p.channels()/2;
+            }
+            addContour( npts > 0 ? p.ptr<Point>() : 0, npts );
+        }
+        op.ncontours = ncontours;
+    }
+
+    // conservative range of rows, which can be modified by the operation
+    Range getRows( const Op& op ) const
+    {
+        int64 ymin = std::numeric_limits<int64>::max(), ymax = std::numeric_limits<int64>::min();
+        for( int i = op.contour0; i < op.contour0 + op.ncontours; i++ )
+            for( int j = contours[i].start; j < contours[i].end; j++ )
+            {
+                ymin = std::min( ymin, (int64)points[j].y );
+                ymax = std::max( ymax, (int64)points[j].y );
+            }
+        if( ymin > ymax )
+            return Range(0, 0);
+
+        ymin += op.offset.y - op.radius;
+        ymax += op.offset.y + op.radius;
+        int64 margin = std::max( op.thickness, 0 )/2 + 3;
+        return Range( (int)std::max( (ymin >> op.shift) - margin, (int64)INT_MIN/2 ),
+                      (int)std::min( (ymax >> op.shift) + margin + 1, (int64)INT_MAX/2 ) );
+    }
+
+    void drawOp( Mat& img, const Op& op, const void* buf, const Range& rows ) const
+    {
+        int lineType = op.lineType;
+        if( lineType == CV_AA && img.depth() != CV_8U )
+            lineType = 8;
+        const Range* c = &contours[op.contour0];
+        const Point* pts0 = points.empty() ? 0 : &points[0];
+
+        switch( op.type )
+        {
+        case OP_LINE:
+            ThickLine( img, pts0[c->start], pts0[c->start + 1], buf, op.thickness, lineType, 3, op.shift, rows );
+            break;
+        case OP_RECTANGLE:
+        {
+            Point pt1 = pts0[c->start], pt2 = pts0[c->start + 1];
+            Point2l pt[4];
+            pt[0] = pt1;
+            pt[1].x = pt2.x;
+            pt[1].y = pt1.y;
+            pt[2] = pt2;
+            pt[3].x = pt1.x;
+            pt[3].y = pt2.y;
+
+            if( op.thickness >= 0 )
+                PolyLine( img, pt, 4, true, buf, op.thickness, lineType, op.shift, rows );
+            else
+                FillConvexPoly( img, pt, 4, buf, lineType, op.shift, rows );
+            break;
+        }
+        case OP_CIRCLE:
+        {
+            Point center = pts0[c->start];
+            if( op.thickness > 1 || lineType != LINE_8 || op.shift > 0 )
+            {
+                Point2l _center(center);
+                int64 _radius(op.radius);
+                _center.x <<= XY_SHIFT - op.shift;
+                _center.y <<= XY_SHIFT - op.shift;
+                _radius <<= XY_SHIFT - op.shift;
+                EllipseEx( img, _center, Size2l(_radius, _radius),
+                           0, 0, 360, buf, op.thickness, lineType, rows );
+            }
+            else
+                Circle( img, center, op.radius, buf, op.thickness < 0, rows );
+            break;
+        }
+        case OP_POLYLINES:
+            for( int i = 0; i < op.ncontours; i++ )
+            {
+                std::vector<Point2l> _pts(pts0 + c[i].start, pts0 + c[i].end);
+                PolyLine( img, _pts.data(), c[i].size(), op.isClosed, buf, op.thickness, lineType, op.shift, rows );
+            }
+            break;
+        case OP_FILL_POLY:
+        {
+            std::vector<PolyEdge> edges;
+            edges.reserve( contours[op.contour0 + op.ncontours - 1].end - c->start + 1 );
+            for( int i = 0; i < op.ncontours; i++ )
+            {
+                if( c[i].empty() )
+                    continue;
+                std::vector<Point2l> _pts(pts0 + c[i].start, pts0 + c[i].end);
+                CollectPolyEdges( img, _pts.data(), c[i].size(), edges, buf, lineType, op.shift, op.offset, rows );
+            }
+            FillEdgeCollection( img, edges, buf, rows );
+            break;
+        }
+        case OP_FILL_CONVEX_POLY:
+        {
+            std::vector<Point2l> _pts(pts0 + c->start, pts0 + c->end);
+            FillConvexPoly( img, _pts.data(), c->size(), buf, lineType, op.shift, rows );
+            break;
+        }
+        default:
+            CV_Error( CV_StsBadArg, "Unknown drawing operation" );
+        }
+    }
+
+    std::vector<Op> ops;
+    std::vector<Range> contours;
+    std::vector<Point> points;
+};
+
+/*
+  The image is split into horizontal bands with about the same amount of work. Every band
+  draws, in the order of addition, all the operations which intersect it, and modifies only
+  its own rows. So every pixel is written by the same sequence of operations as without
+  the split, and the result is identical to drawing the operations one by one.
+*/
+class DrawingBatch_Invoker : public ParallelLoopBody
+{
+public:
+    DrawingBatch_Invoker( Mat& _img, const DrawingBatch::Impl& _impl, const std::vector<Vec4d>& _colors,
+                          const std::vector<int>& _bandRows, const std::vector<std::vector<int> >& _bandOps )
+        : img(_img), impl(_impl), colors(_colors), bandRows(_bandRows), bandOps(_bandOps)
+    {
+    }
+
+    virtual void operator()( const Range& range ) const
+    {
+        for( int b = range.start; b < range.end; b++ )
+        {
+            Range rows( bandRows[b], bandRows[b + 1] );
+            const std::vector<int>& ops = bandOps[b];
+            for( size_t i = 0; i < ops.size(); i++ )
+                impl.drawOp( img, impl.ops[ops[i]], colors[ops[i]].val, rows );
+        }
+    }
+
+private:
+    Mat& img;
+    const DrawingBatch::Impl& impl;
+    const std::vector<Vec4d>& colors;
+    const std::vector<int>& bandRows;
+    const std::vector<std::vector<int> >& bandOps;
+};
+
+DrawingBatch::DrawingBatch() : p(makePtr<Impl>())
+{
+}
+
+DrawingBatch::~DrawingBatch()
+{
+}
+
+void DrawingBatch::line( Point pt1, Point pt2, const Scalar& color, int thickness, int lineType, int shift )
+{
+    CV_Assert( 0 < thickness );
+    Impl::Op& op = p->addOp( Impl::OP_LINE, color, thickness, lineType, shift );
+    Point pts[] = { pt1, pt2 };
+    p->addContour( pts, 2 );
+    op.ncontours = 1;
+}
+
+void DrawingBatch::rectangle( Point pt1, Point pt2, const Scalar& color, int thickness, int lineType, int shift )
+{
+    Impl::Op& op = p->addOp( Impl::OP_RECTANGLE, color, thickness, lineType, shift );
+    Point pts[] = { pt1, pt2 };
+    p->addContour( pts, 2 );
+    op.ncontours = 1;
+}
+
+void DrawingBatch::rectangle( Rect rec, const Scalar& color, int thickness, int lineType, int shift )
+{
+    CV_Assert( 0 <= shift && shift <= XY_SHIFT );
+    if( rec.area() > 0 )
+        rectangle( rec.tl(), rec.br() - Point(1<<shift,1<<shift), color, thickness, lineType, shift );
+}
+
+void DrawingBatch::circle( Point center, int radius, const Scalar& color, int thickness, int lineType, int shift )
+{
+    CV_Assert( radius >= 0 );
+    Impl::Op& op = p->addOp( Impl::OP_CIRCLE, color, thickness, lineType, shift );
+    op.radius = radius;
+    p->addContour( &center, 1 );
+    op.ncontours = 1;
+}
+
+void DrawingBatch::polylines( InputArrayOfArrays pts, bool isClosed, const Scalar& color,
+                              int thickness, int lineType, int shift )
+{
+    CV_Assert( 0 < thickness );
+    bool manyContours = pts.kind() == _InputArray::STD_VECTOR_VECTOR ||
+                        pts.kind() == _InputArray::STD_VECTOR_MAT;
+    if( manyContours && pts.total() == 0 )
+        return;
+    Impl::Op& op = p->addOp( Impl::OP_POLYLINES, color, thickness, lineType, shift );
+    op.isClosed = isClosed;
+    p->addContours( op, pts, manyContours );
+}
+
+void DrawingBatch::fillPoly( InputArrayOfArrays pts, const Scalar& color, int lineType, int shift, Point offset )
+{
+    if( pts.total() == 0 )
+        return;
+    Impl::Op& op = p->addOp( Impl::OP_FILL_POLY, color, 0, lineType, shift );
+    op.offset = offset;
+    p->addContours( op, pts, true );
+}
+
+void DrawingBatch::fillConvexPoly( InputArray points, const Scalar& color, int lineType, int shift )
+{
+    Mat pts = points.getMat();
+    CV_Assert( pts.checkVector(2, CV_32S) >= 0 );
+    int npts = pts.rows*pts.cols*pts.channels()/2;
+    if( npts <= 0 )
+        return;
+    Impl::Op& op = p->addOp( Impl::OP_FILL_CONVEX_POLY, color, 0, lineType, shift );
+    p->addContour( pts.ptr<Point>(), npts );
+    op.ncontours = 1;
+}
+
+void DrawingBatch::clear()
+{
+    p->ops.clear();
+    p->contours.clear();
+    p->points.clear();
+}
+
+size_t DrawingBatch::size() const
+{
+    return p->ops.size();
+}
+
+bool DrawingBatch::empty() const
+{
+    return p->ops.empty();
+}
+
+void DrawingBatch::draw( InputOutputArray _img ) const
+{
+    CV_INSTRUMENT_REGION()
+
+    Mat img = _img.getMat();
+    const Impl& impl = *p;
+    int i, nops = (int)impl.ops.size(), height = img.rows;
+    if( nops == 0 || img.empty() )
+        return;
+
+    std::vector<Vec4d> colors(nops);
+    std::vector<Range> opRows(nops);
+    // estimated amount of work per row, as the differences between the adjacent rows
+    std::vector<double> rowWork(height + 1, 0.);
+    for( i = 0; i < nops; i++ )
+    {
+        const Impl::Op& op = impl.ops[i];
+        scalarToRawData( op.color, colors[i].val, img.type(), 0 );
+        Range r = clipRows( impl.getRows(op), height );
+        opRows[i] = r;
+        if( r.empty() )
+            continue;
+        double w = op.type >= Impl::OP_FILL_POLY || op.thickness < 0 || op.thickness > 1 ? 4. : 1.;
+        rowWork[r.start] += w;
+        rowWork[r.end] -= w;
+    }
+
+    double totalWork = 0;
+    for( i = 0; i < height; i++ )
+    {
+        if( i > 0 )
+            rowWork[i] += rowWork[i - 1];
+        totalWork += rowWork[i] + 1;
+    }
+
+    const int minBandHeight = 16;
+    int nbands = std::min( getNumThreads()*4, std::max(height / minBandHeight, 1) );
+    std::vector<int> bandRows(1, 0);
+    double work = 0;
+    for( i = 0; i < height && (int)bandRows.size() < nbands; i++ )
+    {
+        work += rowWork[i] + 1;
+        if( work >= totalWork*(int)bandRows.size()/nbands && i + 1 - bandRows.back() >= minBandHeight )
+            bandRows.push_back(i + 1);
+    }
+    if( bandRows.back() < height )
+        bandRows.push_back(height);
+    nbands = (int)bandRows.size() - 1;
+
+    std::vector<std::vector<int> > bandOps(nbands);
+    for( i = 0; i < nops; i++ )
+    {
+        const Range& r = opRows[i];
+        if( r.empty() )
+            continue;
+        int b = (int)(std::upper_bound(bandRows.begin(), bandRows.end(), r.start) - bandRows.begin()) - 1;
+        for( ; b < nbands && bandRows[b] < r.end; b++ )
+            bandOps[b].push_back(i);
+    }
+
+    parallel_for_( Range(0, nbands), DrawingBatch_Invoker(img, impl, colors, bandRows, bandOps), nbands );
+}
+
+}
+
+
 namespace
 {
 using namespace cv;
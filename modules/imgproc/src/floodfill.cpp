@@ -449,54 +449,226 @@ floodFillGrad_CnIR( Mat& image, Mat& msk,
     }
 }
 
-}
-
 /****************************************************************************************\
-*                                    External Functions                                  *
+*                                   Parallel Floodfill                                   *
 \****************************************************************************************/
 
-int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
-                  Point seedPoint, Scalar newVal, Rect* rect,
-                  Scalar loDiff, Scalar upDiff, int flags )
+// In the simple and the fixed range modes every pixel is compared with the seed value only,
+// so the filled region is the connected component of the "pixel matches" map that contains
+// the seed. The map and the final repainting are built in parallel, the labeling is done
+// by the parallel connectedComponents implementation.
+
+template<typename _Tp>
+struct FFillEqual
 {
-    CV_INSTRUMENT_REGION()
+    FFillEqual(const _Tp& _val0) : val0(_val0) {}
+    bool operator()(const _Tp* a) const { return *a == val0; }
+    _Tp val0;
+};
 
-    ConnectedComp comp;
-    std::vector<FFillSegment> buffer;
+template<typename _Tp, class Diff>
+struct FFillFixedRange
+{
+    FFillFixedRange(const _Tp& _val0, const Diff& _diff) : val0(_val0), diff(_diff) {}
+    bool operator()(const _Tp* a) const { return diff(a, &val0); }
+    _Tp val0;
+    Diff diff;
+};
 
-    if( rect )
-        *rect = Rect();
+template<typename _Tp, class Pred>
+class FloodFillMark_Invoker : public ParallelLoopBody
+{
+public:
+    FloodFillMark_Invoker(const Mat& _image, const Mat& _mask, Mat& _marks, const Pred& _pred)
+        : image(_image), mask(_mask), marks(_marks), pred(_pred) {}
 
-    int i, connectivity = flags & 255;
-    union {
-        uchar b[4];
-        int i[4];
-        float f[4];
-        double _[4];
-    } nv_buf;
-    nv_buf._[0] = nv_buf._[1] = nv_buf._[2] = nv_buf._[3] = 0;
+    virtual void operator()(const Range& range) const
+    {
+        int width = image.cols;
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const _Tp* img = image.ptr<_Tp>(y);
+            const uchar* msk = mask.empty() ? 0 : mask.ptr(y + 1) + 1;
+            uchar* dst = marks.data + marks.step*y;
+
+            for( int x = 0; x < width; x++ )
+                dst[x] = (!msk || !msk[x]) && pred(img + x) ? (uchar)255 : (uchar)0;
+        }
+    }
 
+private:
+    Mat image, mask, marks;
+    Pred pred;
+};
+
+template<typename _Tp>
+class FloodFillPaint_Invoker : public ParallelLoopBody
+{
+public:
+    FloodFillPaint_Invoker(Mat& _image, Mat& _mask, const Mat& _labels, int _label,
+                           const _Tp& _newVal, uchar _newMaskVal, bool _fillImage,
+                           ConnectedComp* _region)
+        : image(_image), mask(_mask), labels(_labels), label(_label), newVal(_newVal),
+          newMaskVal(_newMaskVal), fillImage(_fillImage), region(_region) {}
+
+    virtual void operator()(const Range& range) const
+    {
+        int width = image.cols, area = 0;
+        int XMin = width, XMax = -1, YMin = range.end, YMax = -1;
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const int* lab = labels.ptr<int>(y);
+            _Tp* img = (_Tp*)(image.data + image.step*y);
+            uchar* msk = mask.empty() ? 0 : mask.data + mask.step*(y + 1) + 1;
+            int rowArea = 0;
+
+            for( int x = 0; x < width; x++ )
+            {
+                if( lab[x] != label )
+                    continue;
+                if( fillImage )
+                    img[x] = newVal;
+                if( msk )
+                    msk[x] = newMaskVal;
+                XMin = std::min(XMin, x);
+                XMax = std::max(XMax, x);
+                rowArea++;
+            }
+
+            if( rowArea > 0 )
+            {
+                YMin = std::min(YMin, y);
+                YMax = y;
+                area += rowArea;
+            }
+        }
+
+        if( area > 0 )
+        {
+            AutoLock lock(mutex);
+            region->area += area;
+            region->rect |= Rect(XMin, YMin, XMax - XMin + 1, YMax - YMin + 1);
+        }
+    }
+
+private:
+    Mat image, mask, labels;
+    int label;
+    _Tp newVal;
+    uchar newMaskVal;
+    bool fillImage;
+    ConnectedComp* region;
+    mutable Mutex mutex;
+};
+
+template<typename _Tp, class Pred>
+static void
+floodFillParallel_CnIR( Mat& image, Mat& mask, Point seed, const Pred& pred,
+                        _Tp newVal, uchar newMaskVal, bool fillImage,
+                        ConnectedComp* region, int connectivity )
+{
+    Mat marks(image.size(), CV_8U), labels;
+    double nstripes = image.total()/(double)(1 << 16);
+
+    parallel_for_(Range(0, image.rows),
+                  FloodFillMark_Invoker<_Tp, Pred>(image, mask, marks, pred), nstripes);
+    // the seed always belongs to the region, even if it does not match itself (NaN)
+    marks.at<uchar>(seed) = (uchar)255;
+    connectedComponents(marks, labels, connectivity, CV_32S);
+
+    region->pt = seed;
+    region->area = 0;
+    region->rect = Rect();
+    parallel_for_(Range(0, image.rows),
+                  FloodFillPaint_Invoker<_Tp>(image, mask, labels, labels.at<int>(seed),
+                                              newVal, newMaskVal, fillImage, region), nstripes);
+}
+
+template<typename _Tp>
+static void
+floodFillSimple_( Mat& image, Point seed, _Tp newVal, ConnectedComp* region,
+                  int flags, std::vector<FFillSegment>* buffer )
+{
+    if( flags & FLOODFILL_PARALLEL )
+    {
+        Mat noMask;
+        floodFillParallel_CnIR(image, noMask, seed, FFillEqual<_Tp>(image.at<_Tp>(seed)),
+                               newVal, (uchar)0, true, region, flags & 255);
+    }
+    else
+        floodFill_CnIR(image, seed, newVal, region, flags, buffer);
+}
+
+template<typename _Tp, typename _MTp, typename _WTp, class Diff>
+static void
+floodFillGrad_( Mat& image, Mat& msk, Point seed, _Tp newVal, _MTp newMaskVal, Diff diff,
+                ConnectedComp* region, int flags, std::vector<FFillSegment>* buffer )
+{
+    if( (flags & FLOODFILL_PARALLEL) && (flags & FLOODFILL_FIXED_RANGE) )
+    {
+        if( msk.at<_MTp>(seed.y + 1, seed.x + 1) )
+            return;
+        floodFillParallel_CnIR(image, msk, seed,
+                               FFillFixedRange<_Tp, Diff>(image.at<_Tp>(seed), diff),
+                               newVal, newMaskVal, (flags & FLOODFILL_MASK_ONLY) == 0,
+                               region, flags & 255);
+        region->label = saturate_cast<int>(newMaskVal);
+    }
+    else
+        floodFillGrad_CnIR<_Tp, _MTp, _WTp, Diff>(image, msk, seed, newVal, newMaskVal,
+                                                  diff, region, flags, buffer);
+}
+
+// Validates the parameters and prepares the mask and the span buffer once,
+// so that they can be shared by all the fills of a floodFillBatch call.
+class FloodFiller
+{
+public:
+    FloodFiller( InputOutputArray _image, InputOutputArray _mask,
+                 Scalar loDiff, Scalar upDiff, int _flags );
+
+    int fill( Point seedPoint, Scalar newVal, Rect* rect );
+    // clears the internally allocated mask within the area touched by the last fill
+    void resetTempMask( const Rect& rect );
+
+private:
+    void initMaskBorder();
+
+    Mat img, mask;
+    int flags;
+    bool is_simple, tempMask;
+    uchar newMaskVal;
     struct { Vec3b b; Vec3i i; Vec3f f; } ld_buf, ud_buf;
-    Mat img = _image.getMat(), mask;
+    std::vector<FFillSegment> buffer;
+};
+
+FloodFiller::FloodFiller( InputOutputArray _image, InputOutputArray _mask,
+                          Scalar loDiff, Scalar upDiff, int _flags )
+    : flags(_flags), is_simple(false), tempMask(false)
+{
+    int i, connectivity = flags & 255;
+
+    img = _image.getMat();
     if( !_mask.empty() )
         mask = _mask.getMat();
     Size size = img.size();
 
-    int type = img.type();
     int depth = img.depth();
     int cn = img.channels();
 
     if ( (cn != 1) && (cn != 3) )
     {
-        CV_Error( CV_StsBadArg, "Number of channels in input image must be 1 or 3" );
+        CV_ErrorNoReturn( CV_StsBadArg, "Number of channels in input image must be 1 or 3" );
     }
 
     if( connectivity == 0 )
         connectivity = 4;
     else if( connectivity != 4 && connectivity != 8 )
         CV_Error( CV_StsBadFlag, "Connectivity must be 4, 0(=4) or 8" );
+    flags = (flags & ~255) | connectivity;
 
-    bool is_simple = mask.empty() && (flags & FLOODFILL_MASK_ONLY) == 0;
+    is_simple = mask.empty() && (flags & FLOODFILL_MASK_ONLY) == 0;
 
     for( i = 0; i < cn; i++ )
     {
@@ -505,13 +677,80 @@ int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
         is_simple = is_simple && fabs(loDiff[i]) < DBL_EPSILON && fabs(upDiff[i]) < DBL_EPSILON;
     }
 
-    if( (unsigned)seedPoint.x >= (unsigned)size.width ||
-       (unsigned)seedPoint.y >= (unsigned)size.height )
+    size_t buffer_size = MAX( size.width, size.height ) * 2;
+    buffer.resize( buffer_size );
+
+    if( !mask.empty() )
+    {
+        CV_Assert( mask.rows == size.height+2 && mask.cols == size.width+2 );
+        CV_Assert( mask.type() == CV_8U );
+        initMaskBorder();
+    }
+
+    // all 3 elements are set, only the first cn of them are used
+    if( depth == CV_8U )
+        for( i = 0; i < 3; i++ )
+        {
+            ld_buf.b[i] = saturate_cast<uchar>(cvFloor(loDiff[i]));
+            ud_buf.b[i] = saturate_cast<uchar>(cvFloor(upDiff[i]));
+        }
+    else if( depth == CV_32S )
+        for( i = 0; i < 3; i++ )
+        {
+            ld_buf.i[i] = cvFloor(loDiff[i]);
+            ud_buf.i[i] = cvFloor(upDiff[i]);
+        }
+    else if( depth == CV_32F )
+        for( i = 0; i < 3; i++ )
+        {
+            ld_buf.f[i] = (float)loDiff[i];
+            ud_buf.f[i] = (float)upDiff[i];
+        }
+    else
+        CV_Error( CV_StsUnsupportedFormat, "" );
+
+    newMaskVal = (uchar)((flags & 0xff00) == 0 ? 1 : ((flags >> 8) & 255));
+}
+
+void FloodFiller::initMaskBorder()
+{
+    memset( mask.ptr(), 1, mask.cols );
+    memset( mask.ptr(mask.rows-1), 1, mask.cols );
+
+    for( int i = 1; i < mask.rows - 1; i++ )
+    {
+        mask.at<uchar>(i, 0) = mask.at<uchar>(i, mask.cols-1) = (uchar)1;
+    }
+}
+
+void FloodFiller::resetTempMask( const Rect& rect )
+{
+    if( tempMask && !rect.empty() )
+        mask(Rect(rect.x + 1, rect.y + 1, rect.width, rect.height)).setTo(Scalar::all(0));
+}
+
+int FloodFiller::fill( Point seedPoint, Scalar newVal, Rect* rect )
+{
+    ConnectedComp comp;
+
+    if( rect )
+        *rect = Rect();
+
+    union {
+        uchar b[4];
+        int i[4];
+        float f[4];
+        double _[4];
+    } nv_buf;
+    nv_buf._[0] = nv_buf._[1] = nv_buf._[2] = nv_buf._[3] = 0;
+
+    int type = img.type();
+
+    if( (unsigned)seedPoint.x >= (unsigned)img.cols ||
+       (unsigned)seedPoint.y >= (unsigned)img.rows )
         CV_Error( CV_StsOutOfRange, "Seed point is outside of image" );
 
     scalarToRawData( newVal, &nv_buf, type, 0);
-    size_t buffer_size = MAX( size.width, size.height ) * 2;
-    buffer.resize( buffer_size );
 
     if( is_simple )
     {
@@ -526,17 +765,17 @@ int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
         if( k != elem_size )
         {
             if( type == CV_8UC1 )
-                floodFill_CnIR(img, seedPoint, nv_buf.b[0], &comp, flags, &buffer);
+                floodFillSimple_(img, seedPoint, nv_buf.b[0], &comp, flags, &buffer);
             else if( type == CV_8UC3 )
-                floodFill_CnIR(img, seedPoint, Vec3b(nv_buf.b), &comp, flags, &buffer);
+                floodFillSimple_(img, seedPoint, Vec3b(nv_buf.b), &comp, flags, &buffer);
             else if( type == CV_32SC1 )
-                floodFill_CnIR(img, seedPoint, nv_buf.i[0], &comp, flags, &buffer);
+                floodFillSimple_(img, seedPoint, nv_buf.i[0], &comp, flags, &buffer);
             else if( type == CV_32FC1 )
-                floodFill_CnIR(img, seedPoint, nv_buf.f[0], &comp, flags, &buffer);
+                floodFillSimple_(img, seedPoint, nv_buf.f[0], &comp, flags, &buffer);
             else if( type == CV_32SC3 )
-                floodFill_CnIR(img, seedPoint, Vec3i(nv_buf.i), &comp, flags, &buffer);
+                floodFillSimple_(img, seedPoint, Vec3i(nv_buf.i), &comp, flags, &buffer);
             else if( type == CV_32FC3 )
-                floodFill_CnIR(img, seedPoint, Vec3f(nv_buf.f), &comp, flags, &buffer);
+                floodFillSimple_(img, seedPoint, Vec3f(nv_buf.f), &comp, flags, &buffer);
             else
                 CV_Error( CV_StsUnsupportedFormat, "" );
             if( rect )
@@ -547,74 +786,39 @@ int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
 
     if( mask.empty() )
     {
-        Mat tempMask( size.height + 2, size.width + 2, CV_8UC1 );
-        tempMask.setTo(Scalar::all(0));
-        mask = tempMask;
-    }
-    else
-    {
-        CV_Assert( mask.rows == size.height+2 && mask.cols == size.width+2 );
-        CV_Assert( mask.type() == CV_8U );
+        mask.create( img.rows + 2, img.cols + 2, CV_8UC1 );
+        mask.setTo(Scalar::all(0));
+        initMaskBorder();
+        tempMask = true;
     }
 
-    memset( mask.ptr(), 1, mask.cols );
-    memset( mask.ptr(mask.rows-1), 1, mask.cols );
-
-    for( i = 1; i <= size.height; i++ )
-    {
-        mask.at<uchar>(i, 0) = mask.at<uchar>(i, mask.cols-1) = (uchar)1;
-    }
-
-    if( depth == CV_8U )
-        for( i = 0; i < cn; i++ )
-        {
-            ld_buf.b[i] = saturate_cast<uchar>(cvFloor(loDiff[i]));
-            ud_buf.b[i] = saturate_cast<uchar>(cvFloor(upDiff[i]));
-        }
-    else if( depth == CV_32S )
-        for( i = 0; i < cn; i++ )
-        {
-            ld_buf.i[i] = cvFloor(loDiff[i]);
-            ud_buf.i[i] = cvFloor(upDiff[i]);
-        }
-    else if( depth == CV_32F )
-        for( i = 0; i < cn; i++ )
-        {
-            ld_buf.f[i] = (float)loDiff[i];
-            ud_buf.f[i] = (float)upDiff[i];
-        }
-    else
-        CV_Error( CV_StsUnsupportedFormat, "" );
-
-    uchar newMaskVal = (uchar)((flags & 0xff00) == 0 ? 1 : ((flags >> 8) & 255));
-
     if( type == CV_8UC1 )
-        floodFillGrad_CnIR<uchar, uchar, int, Diff8uC1>(
+        floodFillGrad_<uchar, uchar, int, Diff8uC1>(
                 img, mask, seedPoint, nv_buf.b[0], newMaskVal,
                 Diff8uC1(ld_buf.b[0], ud_buf.b[0]),
                 &comp, flags, &buffer);
     else if( type == CV_8UC3 )
-        floodFillGrad_CnIR<Vec3b, uchar, Vec3i, Diff8uC3>(
+        floodFillGrad_<Vec3b, uchar, Vec3i, Diff8uC3>(
                 img, mask, seedPoint, Vec3b(nv_buf.b), newMaskVal,
                 Diff8uC3(ld_buf.b, ud_buf.b),
                 &comp, flags, &buffer);
     else if( type == CV_32SC1 )
-        floodFillGrad_CnIR<int, uchar, int, Diff32sC1>(
+        floodFillGrad_<int, uchar, int, Diff32sC1>(
                 img, mask, seedPoint, nv_buf.i[0], newMaskVal,
                 Diff32sC1(ld_buf.i[0], ud_buf.i[0]),
                 &comp, flags, &buffer);
     else if( type == CV_32SC3 )
-        floodFillGrad_CnIR<Vec3i, uchar, Vec3i, Diff32sC3>(
+        floodFillGrad_<Vec3i, uchar, Vec3i, Diff32sC3>(
                 img, mask, seedPoint, Vec3i(nv_buf.i), newMaskVal,
                 Diff32sC3(ld_buf.i, ud_buf.i),
                 &comp, flags, &buffer);
     else if( type == CV_32FC1 )
-        floodFillGrad_CnIR<float, uchar, float, Diff32fC1>(
+        floodFillGrad_<float, uchar, float, Diff32fC1>(
                 img, mask, seedPoint, nv_buf.f[0], newMaskVal,
                 Diff32fC1(ld_buf.f[0], ud_buf.f[0]),
                 &comp, flags, &buffer);
     else if( type == CV_32FC3 )
-        floodFillGrad_CnIR<Vec3f, uchar, Vec3f, Diff32fC3>(
+        floodFillGrad_<Vec3f, uchar, Vec3f, Diff32fC3>(
                 img, mask, seedPoint, Vec3f(nv_buf.f), newMaskVal,
                 Diff32fC3(ld_buf.f, ud_buf.f),
                 &comp, flags, &buffer);
@@ -626,6 +830,58 @@ int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
     return comp.area;
 }
 
+}
+
+/****************************************************************************************\
+*                                    External Functions                                  *
+\****************************************************************************************/
+
+int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
+                  Point seedPoint, Scalar newVal, Rect* rect,
+                  Scalar loDiff, Scalar upDiff, int flags )
+{
+    CV_INSTRUMENT_REGION()
+
+    if( rect )
+        *rect = Rect();
+
+    FloodFiller filler(_image, _mask, loDiff, upDiff, flags);
+    return filler.fill(seedPoint, newVal, rect);
+}
+
+
+void cv::floodFillBatch( InputOutputArray _image, InputOutputArray _mask,
+                         const std::vector<Point>& seedPoints,
+                         const std::vector<Scalar>& newVals,
+                         std::vector<int>* areas, std::vector<Rect>* rects,
+                         Scalar loDiff, Scalar upDiff, int flags )
+{
+    CV_INSTRUMENT_REGION()
+
+    size_t i, nseeds = seedPoints.size();
+    CV_Assert( newVals.size() == nseeds || newVals.size() == 1 );
+
+    if( areas )
+        areas->assign(nseeds, 0);
+    if( rects )
+        rects->assign(nseeds, Rect());
+    if( nseeds == 0 )
+        return;
+
+    FloodFiller filler(_image, _mask, loDiff, upDiff, flags);
+
+    for( i = 0; i < nseeds; i++ )
+    {
+        Rect rect;
+        int area = filler.fill(seedPoints[i], newVals[newVals.size() == 1 ? 0 : i], &rect);
+        filler.resetTempMask(rect);
+        if( areas )
+            (*areas)[i] = area;
+        if( rects )
+            (*rects)[i] = rect;
+    }
+}
+
 
 int cv::floodFill( InputOutputArray _image, Point seedPoint,
                   Scalar newVal, Rect* rect,
@@ -64,8 +64,22 @@ public:
     double operator()( int ci, const Vec3d color ) const;
     int whichComponent( const Vec3d color ) const;
 
+    // sample statistics; can be collected for parts of the image independently and merged
+    struct Stats
+    {
+        void reset();
+        void addSample( int ci, const Vec3d color );
+        void add( const Stats& other );
+
+        double sums[componentsCount][3];
+        double prods[componentsCount][3][3];
+        int sampleCounts[componentsCount];
+        int totalSampleCount;
+    };
+
     void initLearning();
     void addSample( int ci, const Vec3d color );
+    void addSamples( const Stats& _stats );
     void endLearning();
 
 private:
@@ -78,10 +92,7 @@ private:
     double inverseCovs[componentsCount][3][3];
     double covDeterms[componentsCount];
 
-    double sums[componentsCount][3];
-    double prods[componentsCount][3][3];
-    int sampleCounts[componentsCount];
-    int totalSampleCount;
+    Stats stats;
 };
 
 GMM::GMM( Mat& _model )
@@ -104,7 +115,7 @@ GMM::GMM( Mat& _model )
     for( int ci = 0; ci < componentsCount; ci++ )
         if( coefs[ci] > 0 )
              calcInverseCovAndDeterm( ci );
-    totalSampleCount = 0;
+    stats.reset();
 }
 
 double GMM::operator()( const Vec3d color ) const
@@ -149,7 +160,7 @@ int GMM::whichComponent( const Vec3d color ) const
     return k;
 }
 
-void GMM::initLearning()
+void GMM::Stats::reset()
 {
     for( int ci = 0; ci < componentsCount; ci++)
     {
@@ -162,7 +173,7 @@ void GMM::initLearning()
     totalSampleCount = 0;
 }
 
-void GMM::addSample( int ci, const Vec3d color )
+void GMM::Stats::addSample( int ci, const Vec3d color )
 {
     sums[ci][0] += color[0]; sums[ci][1] += color[1]; sums[ci][2] += color[2];
     prods[ci][0][0] += color[0]*color[0]; prods[ci][0][1] += color[0]*color[1]; prods[ci][0][2] += color[0]*color[2];
@@ -172,17 +183,49 @@ void GMM::addSample( int ci, const Vec3d color )
     totalSampleCount++;
 }
 
+void GMM::Stats::add( const Stats& other )
+{
+    for( int ci = 0; ci < componentsCount; ci++ )
+    {
+        for( int i = 0; i < 3; i++ )
+        {
+            sums[ci][i] += other.sums[ci][i];
+            for( int j = 0; j < 3; j++ )
+                prods[ci][i][j] += other.prods[ci][i][j];
+        }
+        sampleCounts[ci] += other.sampleCounts[ci];
+    }
+    totalSampleCount += other.totalSampleCount;
+}
+
+void GMM::initLearning()
+{
+    stats.reset();
+}
+
+void GMM::addSample( int ci, const Vec3d color )
+{
+    stats.addSample( ci, color );
+}
+
+void GMM::addSamples( const Stats& _stats )
+{
+    stats.add( _stats );
+}
+
 void GMM::endLearning()
 {
     const double variance = 0.01;
+    const double (*sums)[3] = stats.sums;
+    const double (*prods)[3][3] = stats.prods;
     for( int ci = 0; ci < componentsCount; ci++ )
     {
-        int n = sampleCounts[ci];
+        int n = stats.sampleCounts[ci];
         if( n == 0 )
             coefs[ci] = 0;
         else
         {
-            coefs[ci] = (double)n/totalSampleCount;
+            coefs[ci] = (double)n/stats.totalSampleCount;
 
             double* m = mean + 3*ci;
             m[0] = sums[ci][0]/n; m[1] = sums[ci][1]/n; m[2] = sums[ci][2]/n;
@@ -231,36 +274,57 @@ void GMM::calcInverseCovAndDeterm( int ci )
   Calculate beta - parameter of GrabCut algorithm.
   beta = 1/(2*avg(sqr(||color[i] - color[j]||)))
 */
-static double calcBeta( const Mat& img )
+class CalcBeta_Invoker : public ParallelLoopBody
 {
-    double beta = 0;
-    for( int y = 0; y < img.rows; y++ )
+public:
+    CalcBeta_Invoker( const Mat& _img, double& _beta ) : img(_img), beta(_beta) {}
+
+    virtual void operator()( const Range& range ) const
     {
-        for( int x = 0; x < img.cols; x++ )
+        // the sum consists of integers, so the result does not depend on the order of summation
+        double sum = 0;
+        for( int y = range.start; y < range.end; y++ )
         {
-            Vec3d color = img.at<Vec3b>(y,x);
-            if( x>0 ) // left
-            {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y,x-1);
-                beta += diff.dot(diff);
-            }
-            if( y>0 && x>0 ) // upleft
+            for( int x = 0; x < img.cols; x++ )
             {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x-1);
-                beta += diff.dot(diff);
-            }
-            if( y>0 ) // up
-            {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x);
-                beta += diff.dot(diff);
-            }
-            if( y>0 && x<img.cols-1) // upright
-            {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x+1);
-                beta += diff.dot(diff);
+                Vec3d color = img.at<Vec3b>(y,x);
+                if( x>0 ) // left
+                {
+                    Vec3d diff = color - (Vec3d)img.at<Vec3b>(y,x-1);
+                    sum += diff.dot(diff);
+                }
+                if( y>0 && x>0 ) // upleft
+                {
+                    Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x-1);
+                    sum += diff.dot(diff);
+                }
+                if( y>0 ) // up
+                {
+                    Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x);
+                    sum += diff.dot(diff);
+                }
+                if( y>0 && x<img.cols-1) // upright
+                {
+                    Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x+1);
+                    sum += diff.dot(diff);
+                }
             }
         }
+        AutoLock lock(mutex);
+        beta += sum;
     }
+
+private:
+    const Mat& img;
+    double& beta;
+    mutable Mutex mutex;
+};
+
+static double calcBeta( const Mat& img )
+{
+    double beta = 0;
+    parallel_for_( Range(0, img.rows), CalcBeta_Invoker(img, beta), img.total()/(double)(1 << 16) );
+
     if( beta <= std::numeric_limits<double>::epsilon() )
         beta = 0;
     else
@@ -273,48 +337,76 @@ static double calcBeta( const Mat& img )
   Calculate weights of noterminal vertices of graph.
   beta and gamma - parameters of GrabCut algorithm.
  */
-static void calcNWeights( const Mat& img, Mat& leftW, Mat& upleftW, Mat& upW, Mat& uprightW, double beta, double gamma )
+template<typename T> class CalcNWeights_Invoker : public ParallelLoopBody
 {
-    const double gammaDivSqrt2 = gamma / std::sqrt(2.0f);
-    leftW.create( img.rows, img.cols, CV_64FC1 );
-    upleftW.create( img.rows, img.cols, CV_64FC1 );
-    upW.create( img.rows, img.cols, CV_64FC1 );
-    uprightW.create( img.rows, img.cols, CV_64FC1 );
-    for( int y = 0; y < img.rows; y++ )
+public:
+    CalcNWeights_Invoker( const Mat& _img, Mat& _leftW, Mat& _upleftW, Mat& _upW, Mat& _uprightW,
+                          double _beta, double _gamma )
+        : img(_img), leftW(_leftW), upleftW(_upleftW), upW(_upW), uprightW(_uprightW),
+          beta(_beta), gamma(_gamma)
     {
-        for( int x = 0; x < img.cols; x++ )
+    }
+
+    virtual void operator()( const Range& range ) const
+    {
+        const double gammaDivSqrt2 = gamma / std::sqrt(2.0f);
+        for( int y = range.start; y < range.end; y++ )
         {
-            Vec3d color = img.at<Vec3b>(y,x);
-            if( x-1>=0 ) // left
+            for( int x = 0; x < img.cols; x++ )
             {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y,x-1);
-                leftW.at<double>(y,x) = gamma * exp(-beta*diff.dot(diff));
-            }
-            else
-                leftW.at<double>(y,x) = 0;
-            if( x-1>=0 && y-1>=0 ) // upleft
-            {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x-1);
-                upleftW.at<double>(y,x) = gammaDivSqrt2 * exp(-beta*diff.dot(diff));
-            }
-            else
-                upleftW.at<double>(y,x) = 0;
-            if( y-1>=0 ) // up
-            {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x);
-                upW.at<double>(y,x) = gamma * exp(-beta*diff.dot(diff));
-            }
-            else
-                upW.at<double>(y,x) = 0;
-            if( x+1<img.cols && y-1>=0 ) // upright
-            {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x+1);
-                uprightW.at<double>(y,x) = gammaDivSqrt2 * exp(-beta*diff.dot(diff));
+                Vec3d color = img.at<Vec3b>(y,x);
+                if( x-1>=0 ) // left
+                {
+                    Vec3d diff = color - (Vec3d)img.at<Vec3b>(y,x-1);
+                    leftW.at<T>(y,x) = (T)(gamma * exp(-beta*diff.dot(diff)));
+                }
+                else
+                    leftW.at<T>(y,x) = 0;
+                if( x-1>=0 && y-1>=0 ) // upleft
+                {
+                    Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x-1);
+                    upleftW.at<T>(y,x) = (T)(gammaDivSqrt2 * exp(-beta*diff.dot(diff)));
+                }
+                else
+                    upleftW.at<T>(y,x) = 0;
+                if( y-1>=0 ) // up
+                {
+                    Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x);
+                    upW.at<T>(y,x) = (T)(gamma * exp(-beta*diff.dot(diff)));
+                }
+                else
+                    upW.at<T>(y,x) = 0;
+                if( x+1<img.cols && y-1>=0 ) // upright
+                {
+                    Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x+1);
+                    uprightW.at<T>(y,x) = (T)(gammaDivSqrt2 * exp(-beta*diff.dot(diff)));
+                }
+                else
+                    uprightW.at<T>(y,x) = 0;
             }
-            else
-                uprightW.at<double>(y,x) = 0;
         }
     }
+
+private:
+    const Mat& img;
+    Mat &leftW, &upleftW, &upW, &uprightW;
+    double beta, gamma;
+};
+
+static void calcNWeights( const Mat& img, Mat& leftW, Mat& upleftW, Mat& upW, Mat& uprightW,
+                          double beta, double gamma, int depth )
+{
+    leftW.create( img.rows, img.cols, depth );
+    upleftW.create( img.rows, img.cols, depth );
+    upW.create( img.rows, img.cols, depth );
+    uprightW.create( img.rows, img.cols, depth );
+    double nstripes = img.total()/(double)(1 << 14);
+    if( depth == CV_32F )
+        parallel_for_( Range(0, img.rows),
+                       CalcNWeights_Invoker<float>(img, leftW, upleftW, upW, uprightW, beta, gamma), nstripes );
+    else
+        parallel_for_( Range(0, img.rows),
+                       CalcNWeights_Invoker<double>(img, leftW, upleftW, upW, uprightW, beta, gamma), nstripes );
 }
 
 /*
@@ -399,130 +491,314 @@ static void initGMMs( const Mat& img, const Mat& mask, GMM& bgdGMM, GMM& fgdGMM
 /*
   Assign GMMs components for each pixel.
 */
-static void assignGMMsComponents( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, Mat& compIdxs )
+class AssignGMMsComponents_Invoker : public ParallelLoopBody
 {
-    Point p;
-    for( p.y = 0; p.y < img.rows; p.y++ )
+public:
+    AssignGMMsComponents_Invoker( const Mat& _img, const Mat& _mask, const GMM& _bgdGMM, const GMM& _fgdGMM,
+                                  Mat& _compIdxs )
+        : img(_img), mask(_mask), bgdGMM(_bgdGMM), fgdGMM(_fgdGMM), compIdxs(_compIdxs)
     {
-        for( p.x = 0; p.x < img.cols; p.x++ )
+    }
+
+    virtual void operator()( const Range& range ) const
+    {
+        Point p;
+        for( p.y = range.start; p.y < range.end; p.y++ )
         {
-            Vec3d color = img.at<Vec3b>(p);
-            compIdxs.at<int>(p) = mask.at<uchar>(p) == GC_BGD || mask.at<uchar>(p) == GC_PR_BGD ?
-                bgdGMM.whichComponent(color) : fgdGMM.whichComponent(color);
+            for( p.x = 0; p.x < img.cols; p.x++ )
+            {
+                Vec3d color = img.at<Vec3b>(p);
+                compIdxs.at<int>(p) = mask.at<uchar>(p) == GC_BGD || mask.at<uchar>(p) == GC_PR_BGD ?
+                    bgdGMM.whichComponent(color) : fgdGMM.whichComponent(color);
+            }
         }
     }
+
+private:
+    const Mat& img;
+    const Mat& mask;
+    const GMM& bgdGMM;
+    const GMM& fgdGMM;
+    Mat& compIdxs;
+};
+
+static void assignGMMsComponents( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, Mat& compIdxs )
+{
+    parallel_for_( Range(0, img.rows), AssignGMMsComponents_Invoker(img, mask, bgdGMM, fgdGMM, compIdxs),
+                   img.total()/(double)(1 << 14) );
 }
 
 /*
   Learn GMMs parameters.
 */
+class LearnGMMs_Invoker : public ParallelLoopBody
+{
+public:
+    LearnGMMs_Invoker( const Mat& _img, const Mat& _mask, const Mat& _compIdxs, GMM& _bgdGMM, GMM& _fgdGMM )
+        : img(_img), mask(_mask), compIdxs(_compIdxs), bgdGMM(_bgdGMM), fgdGMM(_fgdGMM)
+    {
+    }
+
+    virtual void operator()( const Range& range ) const
+    {
+        GMM::Stats bgdStats, fgdStats;
+        bgdStats.reset();
+        fgdStats.reset();
+
+        Point p;
+        for( p.y = range.start; p.y < range.end; p.y++ )
+        {
+            for( p.x = 0; p.x < img.cols; p.x++ )
+            {
+                int ci = compIdxs.at<int>(p);
+                if( mask.at<uchar>(p) == GC_BGD || mask.at<uchar>(p) == GC_PR_BGD )
+                    bgdStats.addSample( ci, img.at<Vec3b>(p) );
+                else
+                    fgdStats.addSample( ci, img.at<Vec3b>(p) );
+            }
+        }
+
+        // the statistics are sums of integers, so merging them is exact
+        AutoLock lock(mutex);
+        bgdGMM.addSamples( bgdStats );
+        fgdGMM.addSamples( fgdStats );
+    }
+
+private:
+    const Mat& img;
+    const Mat& mask;
+    const Mat& compIdxs;
+    GMM& bgdGMM;
+    GMM& fgdGMM;
+    mutable Mutex mutex;
+};
+
 static void learnGMMs( const Mat& img, const Mat& mask, const Mat& compIdxs, GMM& bgdGMM, GMM& fgdGMM )
 {
     bgdGMM.initLearning();
     fgdGMM.initLearning();
-    Point p;
-    for( int ci = 0; ci < GMM::componentsCount; ci++ )
+    parallel_for_( Range(0, img.rows), LearnGMMs_Invoker(img, mask, compIdxs, bgdGMM, fgdGMM),
+                   img.total()/(double)(1 << 16) );
+    bgdGMM.endLearning();
+    fgdGMM.endLearning();
+}
+
+/*
+  Calculate terminal weights of the vertices with uncertain labels (GC_PR_BGD, GC_PR_FGD).
+*/
+template<typename TWeight> class CalcTWeights_Invoker : public ParallelLoopBody
+{
+public:
+    CalcTWeights_Invoker( const Mat& _img, const Mat& _mask, const GMM& _bgdGMM, const GMM& _fgdGMM, Mat& _tWeights )
+        : img(_img), mask(_mask), bgdGMM(_bgdGMM), fgdGMM(_fgdGMM), tWeights(_tWeights)
+    {
+    }
+
+    virtual void operator()( const Range& range ) const
     {
-        for( p.y = 0; p.y < img.rows; p.y++ )
+        Point p;
+        for( p.y = range.start; p.y < range.end; p.y++ )
         {
             for( p.x = 0; p.x < img.cols; p.x++ )
             {
-                if( compIdxs.at<int>(p) == ci )
+                if( mask.at<uchar>(p) == GC_PR_BGD || mask.at<uchar>(p) == GC_PR_FGD )
                 {
-                    if( mask.at<uchar>(p) == GC_BGD || mask.at<uchar>(p) == GC_PR_BGD )
-                        bgdGMM.addSample( ci, img.at<Vec3b>(p) );
-                    else
-                        fgdGMM.addSample( ci, img.at<Vec3b>(p) );
+                    Vec3b color = img.at<Vec3b>(p);
+                    TWeight* tw = tWeights.ptr<TWeight>(p.y) + p.x*2;
+                    tw[0] = (TWeight)-log( bgdGMM(color) );
+                    tw[1] = (TWeight)-log( fgdGMM(color) );
                 }
             }
         }
     }
-    bgdGMM.endLearning();
-    fgdGMM.endLearning();
+
+private:
+    const Mat& img;
+    const Mat& mask;
+    const GMM& bgdGMM;
+    const GMM& fgdGMM;
+    Mat& tWeights;
+};
+
+/*
+  Pixels labeled as GC_BGD or GC_FGD are never moved to the other segment: their terminal weight,
+  lambda, exceeds the sum of all their neighbour weights (4*gamma + 4*gamma/sqrt(2)). So they are
+  not added to the graph; instead, their edges are turned into terminal weights of the neighbouring
+  uncertain pixels. The remaining graph falls apart into independent regions (8-connected components
+  of the uncertain pixels), which are cut separately and in parallel. The segmentation is
+  the same as with the single full-image graph.
+*/
+struct GrabCutRegions
+{
+    Mat labels;                     // component index + 1 for uncertain pixels, 0 for the rest
+    Mat vtxIdxs;                    // vertex index of the pixel within the graph of its component
+    std::vector<Rect> rects;        // bounding boxes of the components
+    std::vector<int> sizes;         // number of pixels in the components
+    std::vector<int> order;         // components sorted by size, the largest ones first
+};
+
+struct CompareRegionSizes
+{
+    CompareRegionSizes( const std::vector<int>& _sizes ) : sizes(&_sizes) {}
+    bool operator()( int a, int b ) const { return (*sizes)[a] > (*sizes)[b] || ((*sizes)[a] == (*sizes)[b] && a < b); }
+    const std::vector<int>* sizes;
+};
+
+static void findRegions( const Mat& mask, GrabCutRegions& regions )
+{
+    Mat prMask = (mask == GC_PR_BGD) | (mask == GC_PR_FGD), stats, centroids;
+    int n = connectedComponentsWithStats( prMask, regions.labels, stats, centroids, 8, CV_32S ) - 1;
+
+    regions.rects.resize(n);
+    regions.sizes.resize(n);
+    regions.order.resize(n);
+    for( int i = 0; i < n; i++ )
+    {
+        const int* st = stats.ptr<int>(i + 1);
+        regions.rects[i] = Rect( st[CC_STAT_LEFT], st[CC_STAT_TOP], st[CC_STAT_WIDTH], st[CC_STAT_HEIGHT] );
+        regions.sizes[i] = st[CC_STAT_AREA];
+        regions.order[i] = i;
+    }
+    std::sort( regions.order.begin(), regions.order.end(), CompareRegionSizes(regions.sizes) );
+
+    std::vector<int> counters(n + 1, 0);
+    regions.vtxIdxs.create( mask.size(), CV_32S );
+    for( int y = 0; y < mask.rows; y++ )
+    {
+        const int* lrow = regions.labels.ptr<int>(y);
+        int* vrow = regions.vtxIdxs.ptr<int>(y);
+        for( int x = 0; x < mask.cols; x++ )
+            vrow[x] = counters[lrow[x]]++;
+    }
 }
 
 /*
-  Construct GCGraph
+  Construct GCGraph of a region and estimate its segmentation using MaxFlow algorithm
 */
-static void constructGCGraph( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, double lambda,
-                       const Mat& leftW, const Mat& upleftW, const Mat& upW, const Mat& uprightW,
-                       GCGraph<double>& graph )
+template<typename TWeight> class GrabCutRegions_Invoker : public ParallelLoopBody
 {
-    int vtxCount = img.cols*img.rows,
-        edgeCount = 2*(4*img.cols*img.rows - 3*(img.cols + img.rows) + 2);
-    graph.create(vtxCount, edgeCount);
-    Point p;
-    for( p.y = 0; p.y < img.rows; p.y++ )
+public:
+    GrabCutRegions_Invoker( const GrabCutRegions& _regions, const Mat& _tWeights,
+                            const Mat& _leftW, const Mat& _upleftW, const Mat& _upW, const Mat& _uprightW,
+                            Mat& _mask )
+        : regions(_regions), tWeights(_tWeights), leftW(_leftW), upleftW(_upleftW), upW(_upW),
+          uprightW(_uprightW), mask(_mask)
+    {
+    }
+
+    virtual void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+            segmentRegion( regions.order[i] );
+    }
+
+private:
+    // adds the edge to the neighbour q, or the terminal weight if q has a fixed label
+    inline void addNeighbour( GCGraph<TWeight>& graph, int vtxIdx, Point q, int label, TWeight w,
+                              bool backward, TWeight& fromSource, TWeight& toSink ) const
     {
-        for( p.x = 0; p.x < img.cols; p.x++)
+        int ql = regions.labels.at<int>(q);
+        if( ql == label )
         {
-            // add node
-            int vtxIdx = graph.addVtx();
-            Vec3b color = img.at<Vec3b>(p);
+            if( backward )
+                graph.addEdges( vtxIdx, regions.vtxIdxs.at<int>(q), w, w );
+        }
+        else if( mask.at<uchar>(q) == GC_BGD )
+            toSink += w;
+        else
+            fromSource += w;
+    }
 
-            // set t-weights
-            double fromSource, toSink;
-            if( mask.at<uchar>(p) == GC_PR_BGD || mask.at<uchar>(p) == GC_PR_FGD )
-            {
-                fromSource = -log( bgdGMM(color) );
-                toSink = -log( fgdGMM(color) );
-            }
-            else if( mask.at<uchar>(p) == GC_BGD )
-            {
-                fromSource = 0;
-                toSink = lambda;
-            }
-            else // GC_FGD
+    void segmentRegion( int r ) const
+    {
+        const Rect& rect = regions.rects[r];
+        const int label = r + 1, vtxCount = regions.sizes[r];
+        const int rows = mask.rows, cols = mask.cols;
+        GCGraph<TWeight> graph;
+        graph.create( vtxCount, 8*vtxCount );
+
+        Point p;
+        for( p.y = rect.y; p.y < rect.y + rect.height; p.y++ )
+        {
+            const int* lrow = regions.labels.ptr<int>(p.y);
+            for( p.x = rect.x; p.x < rect.x + rect.width; p.x++ )
             {
-                fromSource = lambda;
-                toSink = 0;
+                if( lrow[p.x] != label )
+                    continue;
+
+                // add node
+                int vtxIdx = graph.addVtx();
+                const TWeight* tw = tWeights.ptr<TWeight>(p.y) + p.x*2;
+                TWeight fromSource = tw[0], toSink = tw[1];
+
+                // set n-weights, the edges to the following neighbours are added by them
+                if( p.x>0 )
+                    addNeighbour( graph, vtxIdx, Point(p.x-1, p.y), label, leftW.at<TWeight>(p), true, fromSource, toSink );
+                if( p.x>0 && p.y>0 )
+                    addNeighbour( graph, vtxIdx, Point(p.x-1, p.y-1), label, upleftW.at<TWeight>(p), true, fromSource, toSink );
+                if( p.y>0 )
+                    addNeighbour( graph, vtxIdx, Point(p.x, p.y-1), label, upW.at<TWeight>(p), true, fromSource, toSink );
+                if( p.x<cols-1 && p.y>0 )
+                    addNeighbour( graph, vtxIdx, Point(p.x+1, p.y-1), label, uprightW.at<TWeight>(p), true, fromSource, toSink );
+                if( p.x<cols-1 )
+                    addNeighbour( graph, vtxIdx, Point(p.x+1, p.y), label, leftW.at<TWeight>(p.y, p.x+1), false, fromSource, toSink );
+                if( p.x<cols-1 && p.y<rows-1 )
+                    addNeighbour( graph, vtxIdx, Point(p.x+1, p.y+1), label, upleftW.at<TWeight>(p.y+1, p.x+1), false, fromSource, toSink );
+                if( p.y<rows-1 )
+                    addNeighbour( graph, vtxIdx, Point(p.x, p.y+1), label, upW.at<TWeight>(p.y+1, p.x), false, fromSource, toSink );
+                if( p.x>0 && p.y<rows-1 )
+                    addNeighbour( graph, vtxIdx, Point(p.x-1, p.y+1), label, uprightW.at<TWeight>(p.y+1, p.x-1), false, fromSource, toSink );
+
+                // set t-weights
+                graph.addTermWeights( vtxIdx, fromSource, toSink );
             }
-            graph.addTermWeights( vtxIdx, fromSource, toSink );
+        }
 
-            // set n-weights
-            if( p.x>0 )
-            {
-                double w = leftW.at<double>(p);
-                graph.addEdges( vtxIdx, vtxIdx-1, w, w );
-            }
-            if( p.x>0 && p.y>0 )
-            {
-                double w = upleftW.at<double>(p);
-                graph.addEdges( vtxIdx, vtxIdx-img.cols-1, w, w );
-            }
-            if( p.y>0 )
-            {
-                double w = upW.at<double>(p);
-                graph.addEdges( vtxIdx, vtxIdx-img.cols, w, w );
-            }
-            if( p.x<img.cols-1 && p.y>0 )
-            {
-                double w = uprightW.at<double>(p);
-                graph.addEdges( vtxIdx, vtxIdx-img.cols+1, w, w );
-            }
+        graph.maxFlow();
+
+        for( p.y = rect.y; p.y < rect.y + rect.height; p.y++ )
+        {
+            const int* lrow = regions.labels.ptr<int>(p.y);
+            const int* vrow = regions.vtxIdxs.ptr<int>(p.y);
+            uchar* mrow = mask.ptr<uchar>(p.y);
+            for( p.x = rect.x; p.x < rect.x + rect.width; p.x++ )
+                if( lrow[p.x] == label )
+                    mrow[p.x] = graph.inSourceSegment( vrow[p.x] ) ? GC_PR_FGD : GC_PR_BGD;
         }
     }
-}
+
+    const GrabCutRegions& regions;
+    const Mat& tWeights;
+    const Mat &leftW, &upleftW, &upW, &uprightW;
+    Mat& mask;
+};
 
 /*
   Estimate segmentation using MaxFlow algorithm
 */
-static void estimateSegmentation( GCGraph<double>& graph, Mat& mask )
+static void estimateSegmentation( const Mat& img, Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM,
+                                  const Mat& leftW, const Mat& upleftW, const Mat& upW, const Mat& uprightW )
 {
-    graph.maxFlow();
-    Point p;
-    for( p.y = 0; p.y < mask.rows; p.y++ )
+    GrabCutRegions regions;
+    findRegions( mask, regions );
+    int n = (int)regions.order.size();
+    if( n == 0 )
+        return;
+
+    // the terminal weights have the same depth as the n-weights
+    Mat tWeights( img.size(), CV_MAKETYPE(leftW.depth(), 2) );
+    double nstripes = img.total()/(double)(1 << 14);
+
+    // every region writes only its own pixels, the fixed labels read by the others do not change
+    if( leftW.depth() == CV_32F )
     {
-        for( p.x = 0; p.x < mask.cols; p.x++ )
-        {
-            if( mask.at<uchar>(p) == GC_PR_BGD || mask.at<uchar>(p) == GC_PR_FGD )
-            {
-                if( graph.inSourceSegment( p.y*mask.cols+p.x /*vertex index*/ ) )
-                    mask.at<uchar>(p) = GC_PR_FGD;
-                else
-                    mask.at<uchar>(p) = GC_PR_BGD;
-            }
-        }
+        parallel_for_( Range(0, img.rows), CalcTWeights_Invoker<float>(img, mask, bgdGMM, fgdGMM, tWeights), nstripes );
+        parallel_for_( Range(0, n), GrabCutRegions_Invoker<float>(regions, tWeights, leftW, upleftW, upW, uprightW, mask), n );
+    }
+    else
+    {
+        parallel_for_( Range(0, img.rows), CalcTWeights_Invoker<double>(img, mask, bgdGMM, fgdGMM, tWeights), nstripes );
+        parallel_for_( Range(0, n), GrabCutRegions_Invoker<double>(regions, tWeights, leftW, upleftW, upW, uprightW, mask), n );
     }
 }
 
@@ -542,6 +818,9 @@ void cv::grabCut( InputArray _img, InputOutputArray _mask, Rect rect,
     if( img.type() != CV_8UC3 )
         CV_Error( CV_StsBadArg, "image must have CV_8UC3 type" );
 
+    int weightDepth = (mode & GC_FLOAT_WEIGHTS) ? CV_32F : CV_64F;
+    mode &= ~GC_FLOAT_WEIGHTS;
+
     GMM bgdGMM( bgdModel ), fgdGMM( fgdModel );
     Mat compIdxs( img.size(), CV_32SC1 );
 
@@ -561,18 +840,15 @@ void cv::grabCut( InputArray _img, InputOutputArray _mask, Rect rect,
         checkMask( img, mask );
 
     const double gamma = 50;
-    const double lambda = 9*gamma;
     const double beta = calcBeta( img );
 
     Mat leftW, upleftW, upW, uprightW;
-    calcNWeights( img, leftW, upleftW, upW, uprightW, beta, gamma );
+    calcNWeights( img, leftW, upleftW, upW, uprightW, beta, gamma, weightDepth );
 
     for( int i = 0; i < iterCount; i++ )
     {
-        GCGraph<double> graph;
         assignGMMsComponents( img, mask, bgdGMM, fgdGMM, compIdxs );
         learnGMMs( img, mask, compIdxs, bgdGMM, fgdGMM );
-        constructGCGraph(img, mask, bgdGMM, fgdGMM, lambda, leftW, upleftW, upW, uprightW, graph );
-        estimateSegmentation( graph, mask );
+        estimateSegmentation( img, mask, bgdGMM, fgdGMM, leftW, upleftW, upW, uprightW );
     }
 }
@@ -43,6 +43,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_imgproc.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -66,6 +67,102 @@ struct hough_cmp_gt
 };
 
 
+class HoughLinesAccumInvoker : public ParallelLoopBody
+{
+public:
+    HoughLinesAccumInvoker(const std::vector<float>& _ptX, const std::vector<float>& _ptY,
+                           const float* _tabSin, const float* _tabCos, int* _accum, int _numrho)
+        : ptX(_ptX), ptY(_ptY), tabSin(_tabSin), tabCos(_tabCos), accum(_accum), numrho(_numrho)
+    {
+#if CV_SIMD128
+        haveSIMD = hasSIMD128();
+#endif
+    }
+
+    virtual void operator()(const Range& range) const
+    {
+        const float* xs = &ptX[0];
+        const float* ys = &ptY[0];
+        int count = (int)ptX.size();
+        int roffset = (numrho - 1) / 2;
+
+        for( int n = range.start; n < range.end; n++ )
+        {
+            int* arow = accum + (n+1) * (numrho+2) + roffset + 1;
+            float c = tabCos[n], s = tabSin[n];
+            int k = 0;
+#if CV_SIMD128
+            if( haveSIMD )
+            {
+                v_float32x4 vc = v_setall_f32(c), vs = v_setall_f32(s);
+                int CV_DECL_ALIGNED(16) rbuf[4];
+                for( ; k <= count - 4; k += 4 )
+                {
+                    v_int32x4 vr = v_round(v_load(xs + k) * vc + v_load(ys + k) * vs);
+                    v_store_aligned(rbuf, vr);
+                    arow[rbuf[0]]++; arow[rbuf[1]]++;
+                    arow[rbuf[2]]++; arow[rbuf[3]]++;
+                }
+            }
+#endif
+            for( ; k < count; k++ )
+                arow[cvRound(xs[k] * c + ys[k] * s)]++;
+        }
+    }
+
+private:
+    const std::vector<float>& ptX;
+    const std::vector<float>& ptY;
+    const float* tabSin;
+    const float* tabCos;
+    int* accum;
+    int numrho;
+#if CV_SIMD128
+    bool haveSIMD;
+#endif
+};
+
+
+class HoughLinesPeaksInvoker : public ParallelLoopBody
+{
+public:
+    HoughLinesPeaksInvoker(const int* _accum, int _numrho, int _threshold, std::vector<int>& _peaks)
+        : accum(_accum), numrho(_numrho), threshold(_threshold), peaks(_peaks)
+    {
+    }
+
+    virtual void operator()(const Range& range) const
+    {
+        std::vector<int> local;
+        for( int n = range.start; n < range.end; n++ )
+        {
+            for( int r = 0; r < numrho; r++ )
+            {
+                int base = (n+1) * (numrho+2) + r+1;
+                if( accum[base] > threshold &&
+                    accum[base] > accum[base - 1] && accum[base] >= accum[base + 1] &&
+                    accum[base] > accum[base - numrho - 2] && accum[base] >= accum[base + numrho + 2] )
+                    local.push_back(base);
+            }
+        }
+
+        if( !local.empty() )
+        {
+            // the order of the candidates does not matter, they are sorted afterwards
+            AutoLock lock(mutex);
+            peaks.insert(peaks.end(), local.begin(), local.end());
+        }
+    }
+
+private:
+    const int* accum;
+    int numrho;
+    int threshold;
+    std::vector<int>& peaks;
+    mutable Mutex mutex;
+};
+
+
 /*
 Here image is an input raster;
 step is it's step; size characterizes it's ROI;
@@ -139,28 +236,31 @@ HoughLinesStandard( const Mat& img, float rho, float theta,
     }
 
     // stage 1. fill accumulator
+    std::vector<float> ptX, ptY;
     for( i = 0; i < height; i++ )
+    {
+        const uchar* row = image + i * step;
         for( j = 0; j < width; j++ )
-        {
-            if( image[i * step + j] != 0 )
-                for(int n = 0; n < numangle; n++ )
-                {
-                    int r = cvRound( j * tabCos[n] + i * tabSin[n] );
-                    r += (numrho - 1) / 2;
-                    accum[(n+1) * (numrho+2) + r+1]++;
-                }
-        }
+            if( row[j] != 0 )
+            {
+                ptX.push_back((float)j);
+                ptY.push_back((float)i);
+            }
+    }
+
+    // every thread owns a range of angles, so the accumulator rows are
+    // filled independently and the result does not depend on the thread count
+    int nstripes = std::min(numangle, getNumThreads()*4);
+    if( !ptX.empty() && numangle > 0 )
+        parallel_for_(Range(0, numangle),
+                      HoughLinesAccumInvoker(ptX, ptY, tabSin, tabCos, accum, numrho),
+                      nstripes);
 
     // stage 2. find local maximums
-    for(int r = 0; r < numrho; r++ )
-        for(int n = 0; n < numangle; n++ )
-        {
-            int base = (n+1) * (numrho+2) + r+1;
-            if( accum[base] > threshold &&
-                accum[base] > accum[base - 1] && accum[base] >= accum[base + 1] &&
-                accum[base] > accum[base - numrho - 2] && accum[base] >= accum[base + numrho + 2] )
-                _sort_buf.push_back(base);
-        }
+    if( numangle > 0 )
+        parallel_for_(Range(0, numangle),
+                      HoughLinesPeaksInvoker(accum, numrho, threshold, _sort_buf),
+                      nstripes);
 
     // stage 3. sort the detected lines by accumulator value
     std::sort(_sort_buf.begin(), _sort_buf.end(), hough_cmp_gt(accum));
@@ -1001,13 +1101,172 @@ cvHoughLines2( CvArr* src_image, void* lineStorage, int method,
 *                                     Circle Detection                                   *
 \****************************************************************************************/
 
+namespace cv
+{
+
+class HoughCirclesAccumInvoker : public ParallelLoopBody
+{
+public:
+    HoughCirclesAccumInvoker(const CvMat* _edges, const CvMat* _dx, const CvMat* _dy,
+                             CvMat* _accum, float _idp, int _minRadius, int _maxRadius,
+                             std::vector<std::vector<Point> >& _stripePts)
+        : edges(_edges), dx(_dx), dy(_dy), accum(_accum), idp(_idp),
+          minRadius(_minRadius), maxRadius(_maxRadius), stripePts(_stripePts)
+    {
+    }
+
+    virtual void operator()(const Range& range) const
+    {
+        const int SHIFT = 10, ONE = 1 << SHIFT;
+        int rows = edges->rows, cols = edges->cols;
+        int nstripes = (int)stripePts.size();
+        int arows = accum->rows - 2, acols = accum->cols - 2;
+        int astep = accum->step/sizeof(int);
+        int total = accum->rows*astep;
+
+        // a single stripe votes straight into the shared accumulator,
+        // otherwise every chunk fills its own copy that is merged at the end
+        AutoBuffer<int> _local;
+        int* adata = accum->data.i;
+        if( nstripes > 1 )
+        {
+            _local.allocate(total);
+            adata = _local;
+            memset(adata, 0, total*sizeof(adata[0]));
+        }
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            std::vector<Point>& pts = stripePts[s];
+            int y_start = (int)((int64)rows*s/nstripes);
+            int y_end = (int)((int64)rows*(s+1)/nstripes);
+
+            for( int y = y_start; y < y_end; y++ )
+            {
+                const uchar* edges_row = edges->data.ptr + y*edges->step;
+                const short* dx_row = (const short*)(dx->data.ptr + y*dx->step);
+                const short* dy_row = (const short*)(dy->data.ptr + y*dy->step);
+
+                for( int x = 0; x < cols; x++ )
+                {
+                    float vx, vy;
+                    int sx, sy, x0, y0, x1, y1, r;
+
+                    vx = dx_row[x];
+                    vy = dy_row[x];
+
+                    if( !edges_row[x] || (vx == 0 && vy == 0) )
+                        continue;
+
+                    float mag = std::sqrt(vx*vx+vy*vy);
+                    assert( mag >= 1 );
+                    sx = cvRound((vx*idp)*ONE/mag);
+                    sy = cvRound((vy*idp)*ONE/mag);
+
+                    x0 = cvRound((x*idp)*ONE);
+                    y0 = cvRound((y*idp)*ONE);
+                    // Step from min_radius to max_radius in both directions of the gradient
+                    for(int k1 = 0; k1 < 2; k1++ )
+                    {
+                        x1 = x0 + minRadius * sx;
+                        y1 = y0 + minRadius * sy;
+
+                        for( r = minRadius; r <= maxRadius; x1 += sx, y1 += sy, r++ )
+                        {
+                            int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
+                            if( (unsigned)x2 >= (unsigned)acols ||
+                                (unsigned)y2 >= (unsigned)arows )
+                                break;
+                            adata[y2*astep + x2]++;
+                        }
+
+                        sx = -sx; sy = -sy;
+                    }
+
+                    pts.push_back(Point(x, y));
+                }
+            }
+        }
+
+        if( nstripes > 1 )
+        {
+            AutoLock lock(mutex);
+            int* dst = accum->data.i;
+            int i = 0;
+#if CV_SIMD128
+            if( hasSIMD128() )
+            {
+                for( ; i <= total - 8; i += 8 )
+                {
+                    v_store(dst + i, v_load(dst + i) + v_load(adata + i));
+                    v_store(dst + i + 4, v_load(dst + i + 4) + v_load(adata + i + 4));
+                }
+            }
+#endif
+            for( ; i < total; i++ )
+                dst[i] += adata[i];
+        }
+    }
+
+private:
+    const CvMat* edges;
+    const CvMat* dx;
+    const CvMat* dy;
+    CvMat* accum;
+    float idp;
+    int minRadius, maxRadius;
+    std::vector<std::vector<Point> >& stripePts;
+    mutable Mutex mutex;
+};
+
+
+class HoughCirclesCentersInvoker : public ParallelLoopBody
+{
+public:
+    HoughCirclesCentersInvoker(const int* _adata, int _acols, int _threshold, std::vector<int>& _centers)
+        : adata(_adata), acols(_acols), threshold(_threshold), centers(_centers)
+    {
+    }
+
+    virtual void operator()(const Range& range) const
+    {
+        std::vector<int> local;
+        for( int y = range.start; y < range.end; y++ )
+        {
+            for( int x = 1; x < acols - 1; x++ )
+            {
+                int base = y*(acols+2) + x;
+                if( adata[base] > threshold &&
+                    adata[base] > adata[base-1] && adata[base] >= adata[base+1] &&
+                    adata[base] > adata[base-acols-2] && adata[base] >= adata[base+acols+2] )
+                    local.push_back(base);
+            }
+        }
+
+        if( !local.empty() )
+        {
+            // candidates are sorted by hough_cmp_gt afterwards, so the order is irrelevant
+            AutoLock lock(mutex);
+            centers.insert(centers.end(), local.begin(), local.end());
+        }
+    }
+
+private:
+    const int* adata;
+    int acols;
+    int threshold;
+    std::vector<int>& centers;
+    mutable Mutex mutex;
+};
+
+}
+
 static void
 icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
                          int min_radius, int max_radius,
                          int canny_threshold, int acc_threshold,
                          CvSeq* circles, int circles_max )
 {
-    const int SHIFT = 10, ONE = 1 << SHIFT;
     cv::Ptr<CvMat> dx, dy;
     cv::Ptr<CvMat> edges, accum, dist_buf;
     std::vector<int> sort_buf;
@@ -1016,8 +1275,8 @@ icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
     int x, y, i, j, k, center_count, nz_count;
     float min_radius2 = (float)min_radius*min_radius;
     float max_radius2 = (float)max_radius*max_radius;
-    int rows, cols, arows, acols;
-    int astep, *adata;
+    int rows, arows, acols;
+    int *adata;
     float* ddata;
     CvSeq *nz, *centers;
     float idp, dr;
@@ -1048,75 +1307,34 @@ icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
     centers = cvCreateSeq( CV_32SC1, sizeof(CvSeq), sizeof(int), storage );
 
     rows = img->rows;
-    cols = img->cols;
     arows = accum->rows - 2;
     acols = accum->cols - 2;
     adata = accum->data.i;
-    astep = accum->step/sizeof(adata[0]);
     // Accumulate circle evidence for each edge pixel
-    for( y = 0; y < rows; y++ )
-    {
-        const uchar* edges_row = edges->data.ptr + y*edges->step;
-        const short* dx_row = (const short*)(dx->data.ptr + y*dx->step);
-        const short* dy_row = (const short*)(dy->data.ptr + y*dy->step);
-
-        for( x = 0; x < cols; x++ )
-        {
-            float vx, vy;
-            int sx, sy, x0, y0, x1, y1, r;
-            CvPoint pt;
-
-            vx = dx_row[x];
-            vy = dy_row[x];
-
-            if( !edges_row[x] || (vx == 0 && vy == 0) )
-                continue;
-
-            float mag = std::sqrt(vx*vx+vy*vy);
-            assert( mag >= 1 );
-            sx = cvRound((vx*idp)*ONE/mag);
-            sy = cvRound((vy*idp)*ONE/mag);
-
-            x0 = cvRound((x*idp)*ONE);
-            y0 = cvRound((y*idp)*ONE);
-            // Step from min_radius to max_radius in both directions of the gradient
-            for(int k1 = 0; k1 < 2; k1++ )
-            {
-                x1 = x0 + min_radius * sx;
-                y1 = y0 + min_radius * sy;
-
-                for( r = min_radius; r <= max_radius; x1 += sx, y1 += sy, r++ )
-                {
-                    int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
-                    if( (unsigned)x2 >= (unsigned)acols ||
-                        (unsigned)y2 >= (unsigned)arows )
-                        break;
-                    adata[y2*astep + x2]++;
-                }
-
-                sx = -sx; sy = -sy;
-            }
-
-            pt.x = x; pt.y = y;
-            cvSeqPush( nz, &pt );
-        }
-    }
+    int nstripes = std::max(std::min(cv::getNumThreads(), rows / 32), 1);
+    std::vector<std::vector<cv::Point> > stripePts(nstripes);
+    cv::parallel_for_(cv::Range(0, nstripes),
+                      cv::HoughCirclesAccumInvoker(edges, dx, dy, accum, idp,
+                                                   min_radius, max_radius, stripePts),
+                      nstripes);
+
+    // keep the edge points in raster order regardless of the number of stripes
+    for( i = 0; i < nstripes; i++ )
+        if( !stripePts[i].empty() )
+            cvSeqPushMulti( nz, &stripePts[i][0], (int)stripePts[i].size() );
+    std::vector<std::vector<cv::Point> >().swap(stripePts);
 
     nz_count = nz->total;
     if( !nz_count )
         return;
     //Find possible circle centers
-    for( y = 1; y < arows - 1; y++ )
-    {
-        for( x = 1; x < acols - 1; x++ )
-        {
-            int base = y*(acols+2) + x;
-            if( adata[base] > acc_threshold &&
-                adata[base] > adata[base-1] && adata[base] >= adata[base+1] &&
-                adata[base] > adata[base-acols-2] && adata[base] >= adata[base+acols+2] )
-                cvSeqPush(centers, &base);
-        }
-    }
+    std::vector<int> centerBuf;
+    if( arows > 2 )
+        cv::parallel_for_(cv::Range(1, arows - 1),
+                          cv::HoughCirclesCentersInvoker(adata, acols, acc_threshold, centerBuf),
+                          nstripes);
+    if( !centerBuf.empty() )
+        cvSeqPushMulti( centers, &centerBuf[0], (int)centerBuf.size() );
 
     center_count = centers->total;
     if( !center_count )
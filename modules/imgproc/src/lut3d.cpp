@@ -0,0 +1,251 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv
+{
+
+// Maps the normalized and scaled to the lattice color component to the cell index and the
+// fractional part. The last cell is closed, so x == nmax gives (nmax - 1, 1).
+static inline void lut3dCoord( float x, int nmax, int& i, float& f )
+{
+    x = x > 0.f ? x : 0.f; // also replaces NaN
+    x = std::min(x, (float)nmax);
+    i = std::min(cvFloor(x), nmax - 1);
+    f = x - i;
+}
+
+// The tetrahedron goes from c000 to c111 along the axes sorted by the fractional parts.
+// The order is looked up by the comparison results, so there are no unpredictable branches.
+static const uchar tetrahedralOrder[8][3] =
+{
+    { 2, 1, 0 }, { 2, 1, 0 }, { 1, 2, 0 }, { 1, 0, 2 },
+    { 2, 0, 1 }, { 0, 2, 1 }, { 0, 1, 2 }, { 0, 1, 2 }
+};
+
+static inline void tetrahedralNodes( float f0, float f1, float f2, int s0, int s1, int s2,
+                                     int* ofs, float* w )
+{
+    const float f[] = { f0, f1, f2 };
+    const int s[] = { s0, s1, s2 };
+    const uchar* order = tetrahedralOrder[(f0 >= f1)*4 + (f1 >= f2)*2 + (f0 >= f2)];
+    float fa = f[order[0]], fb = f[order[1]], fc = f[order[2]];
+
+    ofs[0] = 0; ofs[1] = s[order[0]]; ofs[2] = ofs[1] + s[order[1]]; ofs[3] = s0 + s1 + s2;
+    w[0] = 1.f - fa; w[1] = fa - fb; w[2] = fb - fc; w[3] = fc;
+}
+
+static inline void trilinearNodes( float f0, float f1, float f2, int s0, int s1, int s2,
+                                   int* ofs, float* w )
+{
+    float g0 = 1.f - f0, g1 = 1.f - f1, g2 = 1.f - f2;
+
+    ofs[0] = 0;            w[0] = g0*g1*g2;
+    ofs[1] = s2;           w[1] = g0*g1*f2;
+    ofs[2] = s1;           w[2] = g0*f1*g2;
+    ofs[3] = s1 + s2;      w[3] = g0*f1*f2;
+    ofs[4] = s0;           w[4] = f0*g1*g2;
+    ofs[5] = s0 + s2;      w[5] = f0*g1*f2;
+    ofs[6] = s0 + s1;      w[6] = f0*f1*g2;
+    ofs[7] = s0 + s1 + s2; w[7] = f0*f1*f2;
+}
+
+// Sums the weighted nodes. The nodes are padded to 4 floats, so each of them is a single vector.
+template<int n> static inline void
+blendNodes( const float* c, const int* ofs, const float* w, float* dst, bool haveSIMD )
+{
+#if CV_SIMD128
+    if( haveSIMD )
+    {
+        v_float32x4 r = v_load(c)*v_setall_f32(w[0]);
+        for( int k = 1; k < n; k++ )
+            r += v_load(c + ofs[k])*v_setall_f32(w[k]);
+        v_store(dst, r);
+        return;
+    }
+#else
+    (void)haveSIMD;
+#endif
+    float r0 = c[0]*w[0], r1 = c[1]*w[0], r2 = c[2]*w[0];
+    for( int k = 1; k < n; k++ )
+    {
+        const float* ck = c + ofs[k];
+        r0 += ck[0]*w[k];
+        r1 += ck[1]*w[k];
+        r2 += ck[2]*w[k];
+    }
+    dst[0] = r0; dst[1] = r1; dst[2] = r2;
+}
+
+template<typename T>
+class LUT3D_Invoker : public ParallelLoopBody
+{
+public:
+    LUT3D_Invoker( const Mat& _src, Mat& _dst, const float* _lut, int _lutSize,
+                   float _inScale, bool _tetrahedral )
+        : src(_src), dst(_dst), lut(_lut), lutSize(_lutSize),
+          inScale(_inScale), tetrahedral(_tetrahedral) {}
+
+    virtual void operator()( const Range& range ) const
+    {
+        int cn = src.channels(), width = src.cols;
+        int nmax = lutSize - 1;
+        // node strides in floats, each node is padded to 4 floats
+        int s0 = lutSize*lutSize*4, s1 = lutSize*4, s2 = 4;
+        bool haveSIMD = false;
+#if CV_SIMD128
+        haveSIMD = hasSIMD128();
+#endif
+        int ofs[8];
+        float w[8], buf[4];
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const T* s = src.ptr<T>(y);
+            T* d = (T*)(dst.data + dst.step*y);
+
+            for( int x = 0; x < width; x++, s += cn, d += cn )
+            {
+                int i0, i1, i2;
+                float f0, f1, f2;
+                lut3dCoord(s[0]*inScale, nmax, i0, f0);
+                lut3dCoord(s[1]*inScale, nmax, i1, f1);
+                lut3dCoord(s[2]*inScale, nmax, i2, f2);
+                const float* c = lut + i0*s0 + i1*s1 + i2*s2;
+
+                if( tetrahedral )
+                {
+                    tetrahedralNodes(f0, f1, f2, s0, s1, s2, ofs, w);
+                    blendNodes<4>(c, ofs, w, buf, haveSIMD);
+                }
+                else
+                {
+                    trilinearNodes(f0, f1, f2, s0, s1, s2, ofs, w);
+                    blendNodes<8>(c, ofs, w, buf, haveSIMD);
+                }
+
+                d[0] = saturate_cast<T>(buf[0]);
+                d[1] = saturate_cast<T>(buf[1]);
+                d[2] = saturate_cast<T>(buf[2]);
+                if( cn == 4 )
+                    d[3] = s[3];
+            }
+        }
+    }
+
+private:
+    Mat src, dst;
+    const float* lut;
+    int lutSize;
+    float inScale;
+    bool tetrahedral;
+};
+
+class BakeLUT3D_Invoker : public ParallelLoopBody
+{
+public:
+    BakeLUT3D_Invoker( Mat& _lut, LUT3DCallback _func, void* _userdata )
+        : lut(_lut), func(_func), userdata(_userdata) {}
+
+    virtual void operator()( const Range& range ) const
+    {
+        int n = lut.cols;
+        float scale = 1.f/(n - 1);
+
+        for( int i = range.start; i < range.end; i++ )
+            for( int j = 0; j < n; j++ )
+            {
+                Vec3f* dst = (Vec3f*)(lut.data + lut.step*(i*n + j));
+                for( int k = 0; k < n; k++ )
+                {
+                    float color[] = { i*scale, j*scale, k*scale };
+                    if( func )
+                        func(color, dst[k].val, userdata);
+                    else
+                        dst[k] = Vec3f(color[0], color[1], color[2]);
+                }
+            }
+    }
+
+private:
+    Mat lut;
+    LUT3DCallback func;
+    void* userdata;
+};
+
+}
+
+void cv::applyLUT3D( InputArray _src, InputArray _lut, OutputArray _dst, int interpolation )
+{
+    CV_INSTRUMENT_REGION()
+
+    Mat src = _src.getMat(), lut = _lut.getMat();
+    int depth = src.depth(), cn = src.channels();
+
+    CV_Assert( cn == 3 || cn == 4 );
+    CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_32F );
+    CV_Assert( interpolation == LUT3D_INTER_TRILINEAR || interpolation == LUT3D_INTER_TETRAHEDRAL );
+    CV_Assert( lut.type() == CV_32FC3 );
+
+    int n;
+    if( lut.dims == 3 )
+    {
+        n = lut.size[0];
+        CV_Assert( lut.size[1] == n && lut.size[2] == n && lut.isContinuous() );
+        lut = Mat(n*n, n, CV_32FC3, lut.data);
+    }
+    else
+    {
+        n = lut.cols;
+        CV_Assert( lut.dims == 2 && lut.rows == n*n );
+    }
+    CV_Assert( n >= 2 );
+
+    // the nodes are padded to 4 floats and pre-scaled to the output range
+    double maxVal = depth == CV_8U ? 255. : depth == CV_16U ? 65535. : 1.;
+    AutoBuffer<float> _nodes(n*n*n*4);
+    float* nodes = _nodes;
+    float outScale = (float)maxVal;
+    for( int i = 0; i < n*n; i++ )
+    {
+        const Vec3f* row = lut.ptr<Vec3f>(i);
+        for( int k = 0; k < n; k++, nodes += 4 )
+        {
+            nodes[0] = row[k][0]*outScale;
+            nodes[1] = row[k][1]*outScale;
+            nodes[2] = row[k][2]*outScale;
+            nodes[3] = 0.f;
+        }
+    }
+
+    _dst.create(src.size(), src.type());
+    Mat dst = _dst.getMat();
+    if( src.data == dst.data )
+        src = src.clone();
+
+    float inScale = (float)((n - 1)/maxVal);
+    bool tetrahedral = interpolation == LUT3D_INTER_TETRAHEDRAL;
+    double nstripes = src.total()/(double)(1 << 16);
+    Range range(0, src.rows);
+
+    if( depth == CV_8U )
+        parallel_for_(range, LUT3D_Invoker<uchar>(src, dst, _nodes, n, inScale, tetrahedral), nstripes);
+    else if( depth == CV_16U )
+        parallel_for_(range, LUT3D_Invoker<ushort>(src, dst, _nodes, n, inScale, tetrahedral), nstripes);
+    else
+        parallel_for_(range, LUT3D_Invoker<float>(src, dst, _nodes, n, inScale, tetrahedral), nstripes);
+}
+
+void cv::bakeLUT3D( int size, OutputArray _lut, LUT3DCallback func, void* userdata )
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert( size >= 2 );
+    _lut.create(size*size, size, CV_32FC3);
+    Mat lut = _lut.getMat();
+
+    parallel_for_(Range(0, size), BakeLUT3D_Invoker(lut, func, userdata));
+}
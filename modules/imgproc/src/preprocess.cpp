@@ -0,0 +1,812 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2017, Intel Corporation, all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+/*
+ Fused image preprocessing: color conversion, resizing, conversion to floating-point,
+ per-channel normalization and repacking into the planar (NCHW) layout in a single pass.
+
+ The destination is processed in horizontal chunks. For every chunk only the source rows
+ it depends on are color-converted into a small buffer, which is then resized and
+ normalized while it is still in cache.
+*/
+
+#include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv
+{
+
+static inline bool isYUV420Code( int code )
+{
+    return code >= COLOR_YUV2RGB_NV12 && code <= COLOR_YUV2GRAY_420;
+}
+
+static inline bool isBayerCode( int code )
+{
+    return (code >= COLOR_BayerBG2BGR && code <= COLOR_BayerGR2BGR) ||
+           (code >= COLOR_BayerBG2BGR_VNG && code <= COLOR_BayerGR2BGR_VNG) ||
+           (code >= COLOR_BayerBG2GRAY && code <= COLOR_BayerGR2GRAY) ||
+           (code >= COLOR_BayerBG2BGR_EA && code <= COLOR_BayerGR2BGRA);
+}
+
+// extra rows demosaicing needs around a band, so that the band rows
+// are interpolated exactly as in the whole image; must be even to keep the pattern
+static const int BAYER_BAND_MARGIN = 4;
+
+// horizontal pass of the linear (and nearest-neighbour) interpolation
+template<typename T> static void
+hresizeLinear( const T* S, float* D, int dwidth, int cn, const int* xofs, const float* alpha )
+{
+    for( int dx = 0; dx < dwidth; dx++ )
+    {
+        const T* s0 = S + xofs[dx*2];
+        const T* s1 = S + xofs[dx*2+1];
+        float a0 = alpha[dx*2], a1 = alpha[dx*2+1];
+        for( int k = 0; k < cn; k++ )
+            D[dx*cn + k] = s0[k]*a0 + s1[k]*a1;
+    }
+}
+
+// horizontal pass of the area interpolation with an integer scale factor;
+// the row sums are accumulated into D
+template<typename T> static void
+hresizeAreaFast( const T* S, float* D, int dwidth, int cn, int scale_x, bool init )
+{
+    for( int dx = 0; dx < dwidth; dx++ )
+    {
+        const T* s = S + dx*scale_x*cn;
+        for( int k = 0; k < cn; k++ )
+        {
+            float sum = init ? 0.f : D[dx*cn + k];
+            for( int i = 0; i < scale_x; i++ )
+                sum += s[i*cn + k];
+            D[dx*cn + k] = sum;
+        }
+    }
+}
+
+// vertical pass: D_c[x] = (S0[x*cn+c]*b0 + S1[x*cn+c]*b1 - mean[c])*scale[c]
+static void
+vresizeNormalize( const float* S0, const float* S1, float b0, float b1,
+                  const float* mean, const float* scale, float** D, int width, int cn )
+{
+    int x = 0;
+#if CV_SIMD128
+    if( hasSIMD128() )
+    {
+        v_float32x4 vb0 = v_setall_f32(b0), vb1 = v_setall_f32(b1);
+        if( cn == 1 )
+        {
+            v_float32x4 m = v_setall_f32(mean[0]), s = v_setall_f32(scale[0]);
+            for( ; x <= width - 4; x += 4 )
+                v_store(D[0] + x, (v_load(S0 + x)*vb0 + v_load(S1 + x)*vb1 - m)*s);
+        }
+        else if( cn == 3 )
+        {
+            v_float32x4 m0 = v_setall_f32(mean[0]), m1 = v_setall_f32(mean[1]), m2 = v_setall_f32(mean[2]);
+            v_float32x4 s0 = v_setall_f32(scale[0]), s1 = v_setall_f32(scale[1]), s2 = v_setall_f32(scale[2]);
+            for( ; x <= width - 4; x += 4 )
+            {
+                v_float32x4 a0, a1, a2, c0, c1, c2;
+                v_load_deinterleave(S0 + x*3, a0, a1, a2);
+                v_load_deinterleave(S1 + x*3, c0, c1, c2);
+                v_store(D[0] + x, (a0*vb0 + c0*vb1 - m0)*s0);
+                v_store(D[1] + x, (a1*vb0 + c1*vb1 - m1)*s1);
+                v_store(D[2] + x, (a2*vb0 + c2*vb1 - m2)*s2);
+            }
+        }
+        else if( cn == 4 )
+        {
+            v_float32x4 m0 = v_setall_f32(mean[0]), m1 = v_setall_f32(mean[1]);
+            v_float32x4 m2 = v_setall_f32(mean[2]), m3 = v_setall_f32(mean[3]);
+            v_float32x4 s0 = v_setall_f32(scale[0]), s1 = v_setall_f32(scale[1]);
+            v_float32x4 s2 = v_setall_f32(scale[2]), s3 = v_setall_f32(scale[3]);
+            for( ; x <= width - 4; x += 4 )
+            {
+                v_float32x4 a0, a1, a2, a3, c0, c1, c2, c3;
+                v_load_deinterleave(S0 + x*4, a0, a1, a2, a3);
+                v_load_deinterleave(S1 + x*4, c0, c1, c2, c3);
+                v_store(D[0] + x, (a0*vb0 + c0*vb1 - m0)*s0);
+                v_store(D[1] + x, (a1*vb0 + c1*vb1 - m1)*s1);
+                v_store(D[2] + x, (a2*vb0 + c2*vb1 - m2)*s2);
+                v_store(D[3] + x, (a3*vb0 + c3*vb1 - m3)*s3);
+            }
+        }
+    }
+#endif
+    for( ; x < width; x++ )
+        for( int k = 0; k < cn; k++ )
+            D[k][x] = (S0[x*cn + k]*b0 + S1[x*cn + k]*b1 - mean[k])*scale[k];
+}
+
+class ColorResizeNormalize_Invoker : public ParallelLoopBody
+{
+public:
+    ColorResizeNormalize_Invoker(const Mat& _src, Mat& _blob, Size _ssize, int _code, int _cn,
+                                 const float* _mean, const float* _scale, int _scale_x, int _scale_y,
+                                 const std::vector<int>& _xofs, const std::vector<float>& _alpha,
+                                 const std::vector<int>& _yofs, const std::vector<float>& _beta, int _chunk)
+        : src(_src), blob(_blob), ssize(_ssize), code(_code), cn(_cn), mean(_mean), scale(_scale),
+          scale_x(_scale_x), scale_y(_scale_y), xofs(_xofs), alpha(_alpha), yofs(_yofs), beta(_beta),
+          chunk(_chunk)
+    {
+    }
+
+    virtual void operator()(const Range& range) const
+    {
+        int dwidth = blob.size[3];
+        std::vector<float> rowbuf(dwidth*cn*2);
+        float* rows[2] = { &rowbuf[0], &rowbuf[dwidth*cn] };
+        int tags[2] = { -1, -1 };
+        float* planes[4];
+        std::vector<uchar> needed;
+        std::vector<int> rowIdx;
+        Mat band;
+
+        for( int y0 = range.start; y0 < range.end; y0 += chunk )
+        {
+            int y1 = std::min(y0 + chunk, range.end);
+            int sy0, sy1;
+            if( scale_y > 0 )
+                sy0 = y0*scale_y, sy1 = y1*scale_y;
+            else
+                sy0 = yofs[y0*2], sy1 = yofs[(y1-1)*2+1] + 1;
+
+            // when downscaling, only some of the source rows contribute to the output
+            needed.clear();
+            if( scale_y == 0 )
+            {
+                needed.resize(sy1 - sy0, (uchar)0);
+                for( int dy = y0; dy < y1; dy++ )
+                    needed[yofs[dy*2] - sy0] = needed[yofs[dy*2+1] - sy0] = 1;
+            }
+            convertBand(sy0, sy1, needed, band, rowIdx);
+            int depth = band.depth();
+
+            for( int dy = y0; dy < y1; dy++ )
+            {
+                for( int k = 0; k < cn; k++ )
+                    planes[k] = blob.ptr<float>(0, k, dy);
+
+                if( scale_y > 0 )
+                {
+                    for( int i = 0; i < scale_y; i++ )
+                    {
+                        const uchar* S = band.ptr(rowIdx[dy*scale_y + i - sy0]);
+                        if( depth == CV_8U )
+                            hresizeAreaFast((const uchar*)S, rows[0], dwidth, cn, scale_x, i == 0);
+                        else if( depth == CV_16U )
+                            hresizeAreaFast((const ushort*)S, rows[0], dwidth, cn, scale_x, i == 0);
+                        else
+                            hresizeAreaFast((const float*)S, rows[0], dwidth, cn, scale_x, i == 0);
+                    }
+                    tags[0] = -1;
+                    vresizeNormalize(rows[0], rows[0], 1.f/(scale_x*scale_y), 0.f,
+                                     mean, scale, planes, dwidth, cn);
+                    continue;
+                }
+
+                // two consecutive source rows always have different parity,
+                // so each of them has its own cached buffer
+                const float* S[2];
+                for( int k = 0; k < 2; k++ )
+                {
+                    int sy = yofs[dy*2 + k], b = sy & 1;
+                    if( tags[b] != sy )
+                    {
+                        const uchar* srow = band.ptr(rowIdx[sy - sy0]);
+                        if( depth == CV_8U )
+                            hresizeLinear((const uchar*)srow, rows[b], dwidth, cn, &xofs[0], &alpha[0]);
+                        else if( depth == CV_16U )
+                            hresizeLinear((const ushort*)srow, rows[b], dwidth, cn, &xofs[0], &alpha[0]);
+                        else
+                            hresizeLinear((const float*)srow, rows[b], dwidth, cn, &xofs[0], &alpha[0]);
+                        tags[b] = sy;
+                    }
+                    S[k] = rows[b];
+                }
+                vresizeNormalize(S[0], S[1], beta[dy*2], beta[dy*2+1], mean, scale, planes, dwidth, cn);
+            }
+        }
+    }
+
+private:
+    // color-converts the source rows [sy0, sy1) marked in 'needed' (all of them if it is empty)
+    // into band; rowIdx maps the source row sy to the band row rowIdx[sy - sy0]
+    void convertBand(int sy0, int sy1, const std::vector<uchar>& needed,
+                     Mat& band, std::vector<int>& rowIdx) const
+    {
+        int nrows = sy1 - sy0;
+        rowIdx.resize(nrows);
+
+        if( code < 0 || code == COLOR_YUV2GRAY_420 )
+        {
+            band = src.rowRange(sy0, sy1);
+            for( int i = 0; i < nrows; i++ )
+                rowIdx[i] = i;
+            return;
+        }
+
+        if( isBayerCode(code) )
+        {
+            int b0 = std::max((sy0 & ~1) - BAYER_BAND_MARGIN, 0);
+            int b1 = std::min(sy1 + BAYER_BAND_MARGIN, ssize.height);
+            cvtColor(src.rowRange(b0, b1), band, code);
+            for( int i = 0; i < nrows; i++ )
+                rowIdx[i] = i + sy0 - b0;
+            return;
+        }
+
+        if( isYUV420Code(code) )
+        {
+            // copy the selected pairs of luma rows and the corresponding chroma bytes
+            // into a buffer with the layout of a smaller 4:2:0 image
+            std::vector<int> pairs;
+            for( int p = sy0/2; p*2 < sy1; p++ )
+            {
+                bool used = needed.empty();
+                for( int j = 0; j < 2 && !used; j++ )
+                {
+                    int i = p*2 + j - sy0;
+                    used = i >= 0 && i < nrows && needed[i];
+                }
+                if( used )
+                    pairs.push_back(p);
+            }
+
+            int width = ssize.width, npairs = (int)pairs.size(), h = npairs*2;
+            int cwidth = width/2;
+            Mat yuv(h*3/2, width, CV_8UC1);
+            const uchar* data = src.ptr();
+            const uchar* chroma = data + (size_t)ssize.height*width;
+            size_t planeSize = (size_t)(ssize.height/2)*cwidth;
+            uchar* ychroma = yuv.ptr(h);
+            for( int k = 0; k < npairs; k++ )
+            {
+                int p = pairs[k];
+                memcpy(yuv.ptr(k*2), data + (size_t)p*2*width, (size_t)width*2);
+                if( code <= COLOR_YUV2BGRA_NV21 )
+                    memcpy(ychroma + (size_t)k*width, chroma + (size_t)p*width, width);
+                else
+                {
+                    memcpy(ychroma + (size_t)k*cwidth, chroma + (size_t)p*cwidth, cwidth);
+                    memcpy(ychroma + (size_t)(npairs + k)*cwidth, chroma + planeSize + (size_t)p*cwidth, cwidth);
+                }
+                for( int j = 0; j < 2; j++ )
+                {
+                    int i = p*2 + j - sy0;
+                    if( i >= 0 && i < nrows )
+                        rowIdx[i] = k*2 + j;
+                }
+            }
+            cvtColor(yuv, band, code);
+            return;
+        }
+
+        int nsel = 0;
+        for( int i = 0; i < nrows; i++ )
+            nsel += needed.empty() || needed[i];
+
+        if( nsel == nrows )
+        {
+            cvtColor(src.rowRange(sy0, sy1), band, code);
+            for( int i = 0; i < nrows; i++ )
+                rowIdx[i] = i;
+            return;
+        }
+
+        Mat rows(nsel, ssize.width, src.type());
+        size_t rowSize = ssize.width*src.elemSize();
+        for( int i = 0, k = 0; i < nrows; i++ )
+            if( needed[i] )
+            {
+                memcpy(rows.ptr(k), src.ptr(sy0 + i), rowSize);
+                rowIdx[i] = k++;
+            }
+        cvtColor(rows, band, code);
+    }
+
+    const Mat& src;
+    Mat& blob;
+    Size ssize;
+    int code, cn;
+    const float* mean;
+    const float* scale;
+    int scale_x, scale_y;
+    const std::vector<int>& xofs;
+    const std::vector<float>& alpha;
+    const std::vector<int>& yofs;
+    const std::vector<float>& beta;
+    int chunk;
+};
+
+// Direct conversion of YUV images into planar floating-point RGB/BGR, computed with the
+// same ITU-R BT.601 coefficients as cvtColor but without rounding to 8 bits
+
+struct YUV2PlanarLayout
+{
+    int bIdx;        // 0 for BGR output, 2 for RGB output
+    bool is422;      // packed 4:2:2 (YUY2 etc.) or 4:2:0
+    bool planar;     // 4:2:0 with separate U and V planes
+    int uIdx;        // position of U: within a UV pair (semi-planar), plane order (planar)
+                     // or byte index within the 4-byte macropixel (4:2:2)
+    int vIdx;        // position of V within the 4:2:2 macropixel
+    int yIdx;        // position of the first Y within the 4:2:2 macropixel
+};
+
+static bool getYUV2PlanarLayout( int code, YUV2PlanarLayout& l )
+{
+    l.is422 = l.planar = false;
+    l.uIdx = l.vIdx = l.yIdx = 0;
+    switch( code )
+    {
+    case COLOR_YUV2RGB_NV12: case COLOR_YUV2BGR_NV12:
+    case COLOR_YUV2RGB_NV21: case COLOR_YUV2BGR_NV21:
+        l.bIdx = code == COLOR_YUV2BGR_NV12 || code == COLOR_YUV2BGR_NV21 ? 0 : 2;
+        l.uIdx = code == COLOR_YUV2RGB_NV21 || code == COLOR_YUV2BGR_NV21 ? 1 : 0;
+        return true;
+    case COLOR_YUV2RGB_YV12: case COLOR_YUV2BGR_YV12:
+    case COLOR_YUV2RGB_IYUV: case COLOR_YUV2BGR_IYUV:
+        l.planar = true;
+        l.bIdx = code == COLOR_YUV2BGR_YV12 || code == COLOR_YUV2BGR_IYUV ? 0 : 2;
+        l.uIdx = code == COLOR_YUV2RGB_YV12 || code == COLOR_YUV2BGR_YV12 ? 1 : 0;
+        return true;
+    case COLOR_YUV2RGB_UYVY: case COLOR_YUV2BGR_UYVY:
+        l.is422 = true;
+        l.bIdx = code == COLOR_YUV2BGR_UYVY ? 0 : 2;
+        l.uIdx = 0; l.yIdx = 1; l.vIdx = 2;
+        return true;
+    case COLOR_YUV2RGB_YUY2: case COLOR_YUV2BGR_YUY2:
+        l.is422 = true;
+        l.bIdx = code == COLOR_YUV2BGR_YUY2 ? 0 : 2;
+        l.yIdx = 0; l.uIdx = 1; l.vIdx = 3;
+        return true;
+    case COLOR_YUV2RGB_YVYU: case COLOR_YUV2BGR_YVYU:
+        l.is422 = true;
+        l.bIdx = code == COLOR_YUV2BGR_YVYU ? 0 : 2;
+        l.yIdx = 0; l.vIdx = 1; l.uIdx = 3;
+        return true;
+    default:
+        return false;
+    }
+}
+
+class YUV2Planar_Invoker : public ParallelLoopBody
+{
+public:
+    YUV2Planar_Invoker(const Mat& _src, Mat& _dst, const YUV2PlanarLayout& _layout, Size _ssize,
+                       Rect _roi, const float* _mean, const float* _scale)
+        : src(_src), dst(_dst), layout(_layout), ssize(_ssize), roi(_roi), mean(_mean), scale(_scale)
+    {
+        const float k = 1.f/(1 << 20);
+        cy = 1220542*k; cub = 2116026*k; cug = -409993*k; cvg = -852492*k; cvr = 1673527*k;
+#if CV_SIMD128
+        haveSIMD = hasSIMD128();
+#endif
+    }
+
+    virtual void operator()(const Range& range) const
+    {
+        int width = roi.width;
+        float* planes[3];
+        const uchar *Y, *U, *V;
+        int ystep, cstep;
+
+        for( int dy = range.start; dy < range.end; dy++ )
+        {
+            int sy = roi.y + dy;
+            for( int k = 0; k < 3; k++ )
+                planes[k] = dst.ptr<float>(0, k, dy);
+
+            // pointers to the samples of the first pixel pair of the source row
+            if( layout.is422 )
+            {
+                const uchar* row = src.ptr(sy);
+                Y = row + layout.yIdx; U = row + layout.uIdx; V = row + layout.vIdx;
+                ystep = 2; cstep = 4;
+            }
+            else
+            {
+                const uchar* data = src.ptr();
+                size_t lumaSize = (size_t)ssize.height*ssize.width;
+                Y = data + (size_t)sy*ssize.width;
+                ystep = 1;
+                if( layout.planar )
+                {
+                    size_t planeSize = (size_t)(ssize.height/2)*(ssize.width/2);
+                    const uchar* c = data + lumaSize + (size_t)(sy/2)*(ssize.width/2);
+                    U = c + planeSize*layout.uIdx;
+                    V = c + planeSize*(1 - layout.uIdx);
+                    cstep = 1;
+                }
+                else
+                {
+                    const uchar* uv = data + lumaSize + (size_t)(sy/2)*ssize.width;
+                    U = uv + layout.uIdx;
+                    V = uv + 1 - layout.uIdx;
+                    cstep = 2;
+                }
+            }
+
+            float* R = planes[2 - layout.bIdx];
+            float* G = planes[1];
+            float* B = planes[layout.bIdx];
+            int x = 0, sx = roi.x;
+
+            // the vectorized loop requires the block to start at a pixel pair
+            if( (sx & 1) != 0 && width > 0 )
+            {
+                convertPixel(Y[sx*ystep], U[(sx/2)*cstep], V[(sx/2)*cstep], R, G, B, 0);
+                x = 1;
+            }
+#if CV_SIMD128
+            if( haveSIMD )
+            {
+                for( ; x <= width - 32; x += 32 )
+                {
+                    int px = sx + x, cx = px/2;
+                    v_uint8x16 y0, y1, u, v;
+                    if( layout.is422 )
+                    {
+                        v_uint8x16 c[4];
+                        v_load_deinterleave(src.ptr(sy) + px*2, c[0], c[1], c[2], c[3]);
+                        v_zip(c[layout.yIdx], c[layout.yIdx + 2], y0, y1);
+                        u = c[layout.uIdx];
+                        v = c[layout.vIdx];
+                    }
+                    else
+                    {
+                        y0 = v_load(Y + px);
+                        y1 = v_load(Y + px + 16);
+                        if( layout.planar )
+                        {
+                            u = v_load(U + cx);
+                            v = v_load(V + cx);
+                        }
+                        else if( layout.uIdx == 0 )
+                            v_load_deinterleave(U + cx*2, u, v);
+                        else
+                            v_load_deinterleave(V + cx*2, v, u);
+                    }
+
+                    v_uint8x16 u0, u1, v0, v1;
+                    v_zip(u, u, u0, u1);
+                    v_zip(v, v, v0, v1);
+                    convertBlock(y0, u0, v0, R + x, G + x, B + x);
+                    convertBlock(y1, u1, v1, R + x + 16, G + x + 16, B + x + 16);
+                }
+            }
+#endif
+            for( ; x < width; x++ )
+            {
+                int px = sx + x;
+                convertPixel(Y[px*ystep], U[(px/2)*cstep], V[(px/2)*cstep], R, G, B, x);
+            }
+        }
+    }
+
+private:
+    inline void convertPixel(int y, int u, int v, float* R, float* G, float* B, int x) const
+    {
+        float yf = std::max(y - 16, 0)*cy, uf = (float)(u - 128), vf = (float)(v - 128);
+        float r = std::min(std::max(yf + cvr*vf, 0.f), 255.f);
+        float g = std::min(std::max(yf + cvg*vf + cug*uf, 0.f), 255.f);
+        float b = std::min(std::max(yf + cub*uf, 0.f), 255.f);
+        int ri = 2 - layout.bIdx, bi = layout.bIdx;
+        R[x] = (r - mean[ri])*scale[ri];
+        G[x] = (g - mean[1])*scale[1];
+        B[x] = (b - mean[bi])*scale[bi];
+    }
+
+#if CV_SIMD128
+    static inline v_float32x4 toFloat(const v_uint32x4& a)
+    {
+        return v_cvt_f32(v_reinterpret_as_s32(a));
+    }
+
+    void convertBlock(const v_uint8x16& y, const v_uint8x16& u, const v_uint8x16& v,
+                      float* R, float* G, float* B) const
+    {
+        int ri = 2 - layout.bIdx, bi = layout.bIdx;
+        v_float32x4 vzero = v_setzero_f32(), vmax = v_setall_f32(255.f);
+        v_float32x4 vc16 = v_setall_f32(16.f), vc128 = v_setall_f32(128.f);
+        v_float32x4 vcy = v_setall_f32(cy), vcub = v_setall_f32(cub), vcug = v_setall_f32(cug);
+        v_float32x4 vcvg = v_setall_f32(cvg), vcvr = v_setall_f32(cvr);
+        v_float32x4 mr = v_setall_f32(mean[ri]), mg = v_setall_f32(mean[1]), mb = v_setall_f32(mean[bi]);
+        v_float32x4 sr = v_setall_f32(scale[ri]), sg = v_setall_f32(scale[1]), sb = v_setall_f32(scale[bi]);
+
+        v_uint16x8 y16[2], u16[2], v16[2];
+        v_expand(y, y16[0], y16[1]);
+        v_expand(u, u16[0], u16[1]);
+        v_expand(v, v16[0], v16[1]);
+        for( int i = 0; i < 2; i++ )
+        {
+            v_uint32x4 y32[2], u32[2], v32[2];
+            v_expand(y16[i], y32[0], y32[1]);
+            v_expand(u16[i], u32[0], u32[1]);
+            v_expand(v16[i], v32[0], v32[1]);
+            for( int j = 0; j < 2; j++ )
+            {
+                int ofs = i*8 + j*4;
+                v_float32x4 yf = v_max(toFloat(y32[j]) - vc16, vzero)*vcy;
+                v_float32x4 uf = toFloat(u32[j]) - vc128, vf = toFloat(v32[j]) - vc128;
+                v_float32x4 r = v_min(v_max(yf + vcvr*vf, vzero), vmax);
+                v_float32x4 g = v_min(v_max(yf + vcvg*vf + vcug*uf, vzero), vmax);
+                v_float32x4 b = v_min(v_max(yf + vcub*uf, vzero), vmax);
+                v_store(R + ofs, (r - mr)*sr);
+                v_store(G + ofs, (g - mg)*sg);
+                v_store(B + ofs, (b - mb)*sb);
+            }
+        }
+    }
+#endif
+
+    const Mat& src;
+    Mat& dst;
+    YUV2PlanarLayout layout;
+    Size ssize;
+    Rect roi;
+    const float* mean;
+    const float* scale;
+    float cy, cub, cug, cvg, cvr;
+#if CV_SIMD128
+    bool haveSIMD;
+#endif
+};
+
+static void yuv2Planar( const Mat& src, OutputArray _dst, const YUV2PlanarLayout& layout,
+                        Size ssize, Rect roi, const Scalar& _mean, const Scalar& _scale )
+{
+    int sz[] = { 1, 3, roi.height, roi.width };
+    _dst.create(4, sz, CV_32F);
+    Mat dst = _dst.getMat();
+
+    float mean[3], scale[3];
+    for( int k = 0; k < 3; k++ )
+    {
+        mean[k] = (float)_mean[k];
+        scale[k] = (float)_scale[k];
+    }
+
+    parallel_for_(Range(0, roi.height),
+                  YUV2Planar_Invoker(src, dst, layout, ssize, roi, mean, scale),
+                  roi.width*(double)roi.height/(1 << 16));
+}
+
+}
+
+void cv::colorResizeNormalize( InputArray _src, OutputArray _blob, Size dsize, int code,
+                               const Scalar& _mean, const Scalar& _scale, int interpolation )
+{
+    CV_INSTRUMENT_REGION()
+
+    Mat src = _src.getMat();
+    CV_Assert( !src.empty() && src.dims <= 2 && dsize.width > 0 && dsize.height > 0 );
+    CV_Assert( interpolation == INTER_NEAREST || interpolation == INTER_LINEAR || interpolation == INTER_AREA );
+
+    int depth = src.depth();
+    CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_32F );
+
+    Size ssize = src.size();
+    int cn = src.channels();
+    if( code >= 0 )
+    {
+        if( isYUV420Code(code) )
+        {
+            CV_Assert( depth == CV_8U && cn == 1 && ssize.height % 3 == 0 && ssize.width % 2 == 0 );
+            ssize.height = ssize.height*2/3;
+            CV_Assert( ssize.height % 2 == 0 );
+            if( !src.isContinuous() )
+                src = src.clone();
+        }
+
+        // find out the number of destination channels with a tiny image of the same format
+        Mat probe(isYUV420Code(code) ? 6 : 4, 4, src.type(), Scalar::all(0)), probeDst;
+        cvtColor(probe, probeDst, code);
+        cn = probeDst.channels();
+    }
+    CV_Assert( cn <= 4 );
+
+    // without resizing, YUV sources are converted straight into the planes
+    YUV2PlanarLayout layout;
+    if( dsize == ssize && getYUV2PlanarLayout(code, layout) )
+    {
+        yuv2Planar(src, _blob, layout, ssize, Rect(Point(), ssize), _mean, _scale);
+        return;
+    }
+
+    int sz[] = { 1, cn, dsize.height, dsize.width };
+    _blob.create(4, sz, CV_32F);
+    Mat blob = _blob.getMat();
+
+    float mean[4], scale[4];
+    for( int k = 0; k < 4; k++ )
+    {
+        mean[k] = (float)_mean[k];
+        scale[k] = (float)_scale[k];
+    }
+
+    double inv_scale_x = (double)dsize.width/ssize.width;
+    double inv_scale_y = (double)dsize.height/ssize.height;
+    double scale_x = 1./inv_scale_x, scale_y = 1./inv_scale_y;
+    int iscale_x = saturate_cast<int>(scale_x);
+    int iscale_y = saturate_cast<int>(scale_y);
+    bool is_area_fast = std::abs(scale_x - iscale_x) < DBL_EPSILON &&
+            std::abs(scale_y - iscale_y) < DBL_EPSILON;
+
+    // the same mapping as in cv::resize
+    if( interpolation == INTER_LINEAR && is_area_fast && iscale_x == 2 && iscale_y == 2 )
+        interpolation = INTER_AREA;
+
+    bool area_mode = false;
+    if( interpolation == INTER_AREA && scale_x >= 1 && scale_y >= 1 )
+    {
+        if( !is_area_fast )
+        {
+            // the generic area decimation is not fused: convert the whole image first
+            Mat converted, resized;
+            if( code >= 0 )
+                cvtColor(src, converted, code);
+            else
+                converted = src;
+            converted.convertTo(converted, CV_32F);
+            resize(converted, resized, dsize, 0, 0, INTER_AREA);
+            colorResizeNormalize(resized, _blob, dsize, -1, _mean, _scale, INTER_NEAREST);
+            return;
+        }
+    }
+    else if( interpolation == INTER_AREA )
+    {
+        area_mode = true;
+        interpolation = INTER_LINEAR;
+    }
+
+    std::vector<int> xofs, yofs;
+    std::vector<float> alpha, beta;
+    if( interpolation != INTER_AREA )
+    {
+        iscale_x = iscale_y = 0;
+        xofs.resize(dsize.width*2);
+        alpha.resize(dsize.width*2);
+        yofs.resize(dsize.height*2);
+        beta.resize(dsize.height*2);
+
+        for( int dx = 0; dx < dsize.width; dx++ )
+        {
+            int sx;
+            float fx;
+            if( interpolation == INTER_NEAREST )
+            {
+                sx = std::min(cvFloor(dx*scale_x), ssize.width - 1);
+                fx = 0.f;
+            }
+            else
+            {
+                if( !area_mode )
+                {
+                    fx = (float)((dx+0.5)*scale_x - 0.5);
+                    sx = cvFloor(fx);
+                    fx -= sx;
+                }
+                else
+                {
+                    sx = cvFloor(dx*scale_x);
+                    fx = (float)((dx+1) - (sx+1)*inv_scale_x);
+                    fx = fx <= 0 ? 0.f : fx - cvFloor(fx);
+                }
+                if( sx < 0 )
+                    fx = 0, sx = 0;
+                if( sx >= ssize.width - 1 )
+                    fx = 0, sx = ssize.width - 1;
+            }
+            xofs[dx*2] = sx*cn;
+            xofs[dx*2+1] = std::min(sx + 1, ssize.width - 1)*cn;
+            alpha[dx*2] = 1.f - fx;
+            alpha[dx*2+1] = fx;
+        }
+
+        for( int dy = 0; dy < dsize.height; dy++ )
+        {
+            int sy;
+            float fy;
+            if( interpolation == INTER_NEAREST )
+            {
+                sy = std::min(cvFloor(dy*scale_y), ssize.height - 1);
+                fy = 0.f;
+            }
+            else if( !area_mode )
+            {
+                fy = (float)((dy+0.5)*scale_y - 0.5);
+                sy = cvFloor(fy);
+                fy -= sy;
+            }
+            else
+            {
+                sy = cvFloor(dy*scale_y);
+                fy = (float)((dy+1) - (sy+1)*inv_scale_y);
+                fy = fy <= 0 ? 0.f : fy - cvFloor(fy);
+            }
+            yofs[dy*2] = std::min(std::max(sy, 0), ssize.height - 1);
+            yofs[dy*2+1] = std::min(std::max(sy + 1, 0), ssize.height - 1);
+            beta[dy*2] = 1.f - fy;
+            beta[dy*2+1] = fy;
+        }
+    }
+
+    // about 32 source rows are converted at once
+    int chunk = std::max(cvRound(32*inv_scale_y), 1);
+    double nstripes = std::max((double)dsize.height/chunk, 1.);
+    parallel_for_(Range(0, dsize.height),
+                  ColorResizeNormalize_Invoker(src, blob, ssize, code, cn, mean, scale, iscale_x, iscale_y,
+                                               xofs, alpha, yofs, beta, chunk),
+                  nstripes);
+}
+
+void cv::cvtColorYUV2Planar( InputArray _src, OutputArray _dst, int code, const Rect& _roi,
+                             const Scalar& mean, const Scalar& scale )
+{
+    CV_INSTRUMENT_REGION()
+
+    YUV2PlanarLayout layout;
+    if( !getYUV2PlanarLayout(code, layout) )
+        CV_Error( CV_StsBadFlag, "Unsupported color conversion code" );
+
+    Mat src = _src.getMat();
+    Size ssize = src.size();
+    if( layout.is422 )
+    {
+        CV_Assert( src.type() == CV_8UC2 && ssize.width % 2 == 0 );
+    }
+    else
+    {
+        CV_Assert( src.type() == CV_8UC1 && ssize.height % 3 == 0 && ssize.width % 2 == 0 );
+        ssize.height = ssize.height*2/3;
+        CV_Assert( ssize.height % 2 == 0 );
+        if( !src.isContinuous() )
+            src = src.clone();
+    }
+
+    Rect roi = _roi.area() > 0 ? _roi : Rect(Point(), ssize);
+    CV_Assert( 0 <= roi.x && 0 <= roi.y && roi.x + roi.width <= ssize.width &&
+               roi.y + roi.height <= ssize.height );
+
+    yuv2Planar(src, _dst, layout, ssize, roi, mean, scale);
+}
@@ -82,160 +82,106 @@ allocWSNodes( std::vector<WSNode>& storage )
     return sz;
 }
 
-}
+// Labels for pixels
+static const int WS_IN_QUEUE = -2; // Pixel visited
+static const int WS_WSHED = -1; // Pixel belongs to watershed
 
+// possible bit values = 2^8
+static const int WS_NQ = 256;
 
-void cv::watershed( InputArray _src, InputOutputArray _markers )
+// Priority queue of queues of nodes
+// from high priority (0) to low priority (255)
+struct WSPriorityQueue
 {
-    CV_INSTRUMENT_REGION()
-
-    // Labels for pixels
-    const int IN_QUEUE = -2; // Pixel visited
-    const int WSHED = -1; // Pixel belongs to watershed
-
-    // possible bit values = 2^8
-    const int NQ = 256;
-
-    Mat src = _src.getMat(), dst = _markers.getMat();
-    Size size = src.size();
+    WSPriorityQueue() { free_node = 0; }
 
     // Vector of every created node
     std::vector<WSNode> storage;
-    int free_node = 0, node;
-    // Priority queue of queues of nodes
-    // from high priority (0) to low priority (255)
-    WSQueue q[NQ];
-    // Non-empty queue with highest priority
-    int active_queue;
-    int i, j;
-    // Color differences
-    int db, dg, dr;
-    int subs_tab[513];
-
-    // MAX(a,b) = b + MAX(a-b,0)
-    #define ws_max(a,b) ((b) + subs_tab[(a)-(b)+NQ])
-    // MIN(a,b) = a - MAX(a-b,0)
-    #define ws_min(a,b) ((a) - subs_tab[(a)-(b)+NQ])
-
-    // Create a new node with offsets mofs and iofs in queue idx
-    #define ws_push(idx,mofs,iofs)          \
-    {                                       \
-        if( !free_node )                    \
-            free_node = allocWSNodes( storage );\
-        node = free_node;                   \
-        free_node = storage[free_node].next;\
-        storage[node].next = 0;             \
-        storage[node].mask_ofs = mofs;      \
-        storage[node].img_ofs = iofs;       \
-        if( q[idx].last )                   \
-            storage[q[idx].last].next=node; \
-        else                                \
-            q[idx].first = node;            \
-        q[idx].last = node;                 \
-    }
-
-    // Get next node from queue idx
-    #define ws_pop(idx,mofs,iofs)           \
-    {                                       \
-        node = q[idx].first;                \
-        q[idx].first = storage[node].next;  \
-        if( !storage[node].next )           \
-            q[idx].last = 0;                \
-        storage[node].next = free_node;     \
-        free_node = node;                   \
-        mofs = storage[node].mask_ofs;      \
-        iofs = storage[node].img_ofs;       \
-    }
-
-    // Get highest absolute channel difference in diff
-    #define c_diff(ptr1,ptr2,diff)           \
-    {                                        \
-        db = std::abs((ptr1)[0] - (ptr2)[0]);\
-        dg = std::abs((ptr1)[1] - (ptr2)[1]);\
-        dr = std::abs((ptr1)[2] - (ptr2)[2]);\
-        diff = ws_max(db,dg);                \
-        diff = ws_max(diff,dr);              \
-        assert( 0 <= diff && diff <= 255 );  \
-    }
+    int free_node;
+    WSQueue q[WS_NQ];
+};
 
-    CV_Assert( src.type() == CV_8UC3 && dst.type() == CV_32SC1 );
-    CV_Assert( src.size() == dst.size() );
+// MAX(a,b) = b + MAX(a-b,0)
+#define ws_max(a,b) ((b) + subs_tab[(a)-(b)+WS_NQ])
+// MIN(a,b) = a - MAX(a-b,0)
+#define ws_min(a,b) ((a) - subs_tab[(a)-(b)+WS_NQ])
+
+// Create a new node with offsets mofs and iofs in queue idx
+#define ws_push(idx,mofs,iofs)          \
+{                                       \
+    if( !free_node )                    \
+        free_node = allocWSNodes( storage );\
+    node = free_node;                   \
+    free_node = storage[free_node].next;\
+    storage[node].next = 0;             \
+    storage[node].mask_ofs = mofs;      \
+    storage[node].img_ofs = iofs;       \
+    if( q[idx].last )                   \
+        storage[q[idx].last].next=node; \
+    else                                \
+        q[idx].first = node;            \
+    q[idx].last = node;                 \
+}
 
-    // Current pixel in input image
-    const uchar* img = src.ptr();
-    // Step size to next row in input image
-    int istep = int(src.step/sizeof(img[0]));
+// Get next node from queue idx
+#define ws_pop(idx,mofs,iofs)           \
+{                                       \
+    node = q[idx].first;                \
+    q[idx].first = storage[node].next;  \
+    if( !storage[node].next )           \
+        q[idx].last = 0;                \
+    storage[node].next = free_node;     \
+    free_node = node;                   \
+    mofs = storage[node].mask_ofs;      \
+    iofs = storage[node].img_ofs;       \
+}
 
-    // Current pixel in mask image
-    int* mask = dst.ptr<int>();
-    // Step size to next row in mask image
-    int mstep = int(dst.step / sizeof(mask[0]));
+// Get highest absolute channel difference in diff
+#define c_diff(ptr1,ptr2,diff)           \
+{                                        \
+    db = std::abs((ptr1)[0] - (ptr2)[0]);\
+    dg = std::abs((ptr1)[1] - (ptr2)[1]);\
+    dr = std::abs((ptr1)[2] - (ptr2)[2]);\
+    diff = ws_max(db,dg);                \
+    diff = ws_max(diff,dr);              \
+    assert( 0 <= diff && diff <= 255 );  \
+}
 
-    for( i = 0; i < 256; i++ )
+static void initWSSubsTab( int* subs_tab )
+{
+    for( int i = 0; i < 256; i++ )
         subs_tab[i] = 0;
-    for( i = 256; i <= 512; i++ )
+    for( int i = 256; i <= 512; i++ )
         subs_tab[i] = i - 256;
+}
 
-    // draw a pixel-wide border of dummy "watershed" (i.e. boundary) pixels
-    for( j = 0; j < size.width; j++ )
-        mask[j] = mask[j + mstep*(size.height-1)] = WSHED;
-
-    // initial phase: put all the neighbor pixels of each marker to the ordered queue -
-    // determine the initial boundaries of the basins
-    for( i = 1; i < size.height-1; i++ )
-    {
-        img += istep; mask += mstep;
-        mask[0] = mask[size.width-1] = WSHED; // boundary pixels
-
-        for( j = 1; j < size.width-1; j++ )
-        {
-            int* m = mask + j;
-            if( m[0] < 0 ) m[0] = 0;
-            if( m[0] == 0 && (m[-1] > 0 || m[1] > 0 || m[-mstep] > 0 || m[mstep] > 0) )
-            {
-                // Find smallest difference to adjacent markers
-                const uchar* ptr = img + j*3;
-                int idx = 256, t;
-                if( m[-1] > 0 )
-                    c_diff( ptr, ptr - 3, idx );
-                if( m[1] > 0 )
-                {
-                    c_diff( ptr, ptr + 3, t );
-                    idx = ws_min( idx, t );
-                }
-                if( m[-mstep] > 0 )
-                {
-                    c_diff( ptr, ptr - istep, t );
-                    idx = ws_min( idx, t );
-                }
-                if( m[mstep] > 0 )
-                {
-                    c_diff( ptr, ptr + istep, t );
-                    idx = ws_min( idx, t );
-                }
+// recursively fill the basins, starting from the pixels put into the queue
+static void floodWatershed( const Mat& src, Mat& dst, WSPriorityQueue& pq )
+{
+    std::vector<WSNode>& storage = pq.storage;
+    int& free_node = pq.free_node;
+    WSQueue* q = pq.q;
+    int node, active_queue, i;
+    int db, dg, dr;
+    int subs_tab[513];
 
-                // Add to according queue
-                assert( 0 <= idx && idx <= 255 );
-                ws_push( idx, i*mstep + j, i*istep + j*3 );
-                m[0] = IN_QUEUE;
-            }
-        }
-    }
+    initWSSubsTab( subs_tab );
 
     // find the first non-empty queue
-    for( i = 0; i < NQ; i++ )
+    for( i = 0; i < WS_NQ; i++ )
         if( q[i].first )
             break;
 
     // if there is no markers, exit immediately
-    if( i == NQ )
+    if( i == WS_NQ )
         return;
 
     active_queue = i;
-    img = src.ptr();
-    mask = dst.ptr<int>();
+    const uchar* img = src.ptr();
+    int istep = int(src.step/sizeof(img[0]));
+    int* mask = dst.ptr<int>();
+    int mstep = int(dst.step / sizeof(mask[0]));
 
-    // recursively fill the basins
     for(;;)
     {
         int mofs, iofs;
@@ -247,10 +193,10 @@ void cv::watershed( InputArray _src, InputOutputArray _markers )
         // Exit condition: empty priority queue
         if( q[active_queue].first == 0 )
         {
-            for( i = active_queue+1; i < NQ; i++ )
+            for( i = active_queue+1; i < WS_NQ; i++ )
                 if( q[i].first )
                     break;
-            if( i == NQ )
+            if( i == WS_NQ )
                 break;
             active_queue = i;
         }
@@ -270,26 +216,26 @@ void cv::watershed( InputArray _src, InputOutputArray _markers )
         if( t > 0 )
         {
             if( lab == 0 ) lab = t;
-            else if( t != lab ) lab = WSHED;
+            else if( t != lab ) lab = WS_WSHED;
         }
         t = m[-mstep]; // Top
         if( t > 0 )
         {
             if( lab == 0 ) lab = t;
-            else if( t != lab ) lab = WSHED;
+            else if( t != lab ) lab = WS_WSHED;
         }
         t = m[mstep]; // Bottom
         if( t > 0 )
         {
             if( lab == 0 ) lab = t;
-            else if( t != lab ) lab = WSHED;
+            else if( t != lab ) lab = WS_WSHED;
         }
 
         // Set label to current pixel in marker image
         assert( lab != 0 );
         m[0] = lab;
 
-        if( lab == WSHED )
+        if( lab == WS_WSHED )
             continue;
 
         // Add adjacent, unlabeled pixels to corresponding queue
@@ -298,32 +244,187 @@ void cv::watershed( InputArray _src, InputOutputArray _markers )
             c_diff( ptr, ptr - 3, t );
             ws_push( t, mofs - 1, iofs - 3 );
             active_queue = ws_min( active_queue, t );
-            m[-1] = IN_QUEUE;
+            m[-1] = WS_IN_QUEUE;
         }
         if( m[1] == 0 )
         {
             c_diff( ptr, ptr + 3, t );
             ws_push( t, mofs + 1, iofs + 3 );
             active_queue = ws_min( active_queue, t );
-            m[1] = IN_QUEUE;
+            m[1] = WS_IN_QUEUE;
         }
         if( m[-mstep] == 0 )
         {
             c_diff( ptr, ptr - istep, t );
             ws_push( t, mofs - mstep, iofs - istep );
             active_queue = ws_min( active_queue, t );
-            m[-mstep] = IN_QUEUE;
+            m[-mstep] = WS_IN_QUEUE;
         }
         if( m[mstep] == 0 )
         {
             c_diff( ptr, ptr + istep, t );
             ws_push( t, mofs + mstep, iofs + istep );
             active_queue = ws_min( active_queue, t );
-            m[mstep] = IN_QUEUE;
+            m[mstep] = WS_IN_QUEUE;
         }
     }
 }
 
+class FloodWatershed_Invoker : public ParallelLoopBody
+{
+public:
+    FloodWatershed_Invoker( const Mat& _src, Mat& _dst, std::vector<WSPriorityQueue>& _queues )
+        : src(_src), dst(_dst), queues(_queues)
+    {
+    }
+
+    virtual void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            floodWatershed( src, dst, queues[i] );
+            // release the nodes early
+            std::vector<WSNode>().swap( queues[i].storage );
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    std::vector<WSPriorityQueue>& queues;
+};
+
+/*
+  The flooding spreads only through the unlabeled pixels, and the label of a pixel depends only on
+  its 4-neighbours. So the 4-connected components of the unlabeled pixels are flooded independently
+  of each other: the pixels of every component are popped in the same order as by a single
+  priority queue over the whole image. The components are distributed among several queues
+  (the largest first, to the least loaded queue), which are then flooded in parallel.
+*/
+static int groupWatershedRegions( const Mat& dst, Mat& labels, std::vector<int>& groupOfLabel, int ngroups )
+{
+    Mat stats, centroids;
+    int ncomp = connectedComponentsWithStats( dst == 0, labels, stats, centroids, 4, CV_32S );
+
+    std::vector<std::pair<int, int> > areas( ncomp - 1 );
+    for( int i = 1; i < ncomp; i++ )
+        areas[i - 1] = std::make_pair( -stats.at<int>(i, CC_STAT_AREA), i );
+    std::sort( areas.begin(), areas.end() );
+
+    ngroups = std::max( std::min( ngroups, ncomp - 1 ), 1 );
+    std::vector<int64> loads( ngroups, 0 );
+    groupOfLabel.assign( ncomp, 0 );
+    for( size_t i = 0; i < areas.size(); i++ )
+    {
+        int g = (int)(std::min_element( loads.begin(), loads.end() ) - loads.begin());
+        groupOfLabel[areas[i].second] = g;
+        loads[g] -= areas[i].first;
+    }
+    return ngroups;
+}
+
+}
+
+
+void cv::watershed( InputArray _src, InputOutputArray _markers )
+{
+    CV_INSTRUMENT_REGION()
+
+    Mat src = _src.getMat(), dst = _markers.getMat();
+    Size size = src.size();
+
+    int node;
+    int i, j;
+    // Color differences
+    int db, dg, dr;
+    int subs_tab[513];
+
+    CV_Assert( src.type() == CV_8UC3 && dst.type() == CV_32SC1 );
+    CV_Assert( src.size() == dst.size() );
+
+    // Current pixel in input image
+    const uchar* img = src.ptr();
+    // Step size to next row in input image
+    int istep = int(src.step/sizeof(img[0]));
+
+    // Current pixel in mask image
+    int* mask = dst.ptr<int>();
+    // Step size to next row in mask image
+    int mstep = int(dst.step / sizeof(mask[0]));
+
+    initWSSubsTab( subs_tab );
+
+    // draw a pixel-wide border of dummy "watershed" (i.e. boundary) pixels
+    // and reset the non-marker pixels
+    for( j = 0; j < size.width; j++ )
+        mask[j] = mask[j + mstep*(size.height-1)] = WS_WSHED;
+    for( i = 1; i < size.height-1; i++ )
+    {
+        int* m = mask + i*mstep;
+        m[0] = m[size.width-1] = WS_WSHED; // boundary pixels
+        for( j = 1; j < size.width-1; j++ )
+            if( m[j] < 0 ) m[j] = 0;
+    }
+
+    int nthreads = getNumThreads(), ngroups = 1;
+    Mat labels;
+    std::vector<int> groupOfLabel;
+    if( nthreads > 1 && size.area() >= (1 << 16) )
+        ngroups = groupWatershedRegions( dst, labels, groupOfLabel, nthreads*2 );
+    std::vector<WSPriorityQueue> queues( ngroups );
+
+    // initial phase: put all the neighbor pixels of each marker to the ordered queue -
+    // determine the initial boundaries of the basins
+    for( i = 1; i < size.height-1; i++ )
+    {
+        img += istep; mask += mstep;
+        const int* lrow = ngroups > 1 ? labels.ptr<int>(i) : 0;
+
+        for( j = 1; j < size.width-1; j++ )
+        {
+            int* m = mask + j;
+            if( m[0] == 0 && (m[-1] > 0 || m[1] > 0 || m[-mstep] > 0 || m[mstep] > 0) )
+            {
+                // Find smallest difference to adjacent markers
+                const uchar* ptr = img + j*3;
+                int idx = 256, t;
+                if( m[-1] > 0 )
+                    c_diff( ptr, ptr - 3, idx );
+                if( m[1] > 0 )
+                {
+                    c_diff( ptr, ptr + 3, t );
+                    idx = ws_min( idx, t );
+                }
+                if( m[-mstep] > 0 )
+                {
+                    c_diff( ptr, ptr - istep, t );
+                    idx = ws_min( idx, t );
+                }
+                if( m[mstep] > 0 )
+                {
+                    c_diff( ptr, ptr + istep, t );
+                    idx = ws_min( idx, t );
+                }
+
+                // Add to according queue
+                assert( 0 <= idx && idx <= 255 );
+                WSPriorityQueue& pq = queues[lrow ? groupOfLabel[lrow[j]] : 0];
+                std::vector<WSNode>& storage = pq.storage;
+                int& free_node = pq.free_node;
+                WSQueue* q = pq.q;
+                ws_push( idx, i*mstep + j, i*istep + j*3 );
+                m[0] = WS_IN_QUEUE;
+            }
+        }
+    }
+
+    labels.release();
+    if( ngroups > 1 )
+        parallel_for_( Range(0, ngroups), FloodWatershed_Invoker(src, dst, queues), ngroups );
+    else
+        floodWatershed( src, dst, queues[0] );
+}
+
 
 /****************************************************************************************\
 *                                         Meanshift                                      *
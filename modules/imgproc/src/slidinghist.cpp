@@ -0,0 +1,291 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv
+{
+
+// Statistics of a window, all of them are kept as exact integers, so the incremental
+// updates do not accumulate any error.
+struct WindowStats
+{
+    void reset(int histSize)
+    {
+        window = Rect();
+        hist.assign(histSize + 1, 0);
+        sum = sqsum = 0;
+    }
+
+    Rect window;
+    std::vector<int> hist; // the last bin collects the values outside of the histogram range
+    int64 sum, sqsum;
+};
+
+// Adds (delta = 1) or removes (delta = -1) n pixels of an image row
+static void updateSpan( const uchar* p, int n, const int* tab, int delta,
+                        int* hist, int64& sum, int64& sqsum )
+{
+    int i = 0;
+    int64 s = 0, sq = 0;
+
+    for( ; i <= n - 4; i += 4 )
+    {
+        hist[tab[p[i]]] += delta;
+        hist[tab[p[i+1]]] += delta;
+        hist[tab[p[i+2]]] += delta;
+        hist[tab[p[i+3]]] += delta;
+    }
+    for( ; i < n; i++ )
+        hist[tab[p[i]]] += delta;
+
+    i = 0;
+#if CV_SIMD128
+    if( hasSIMD128() )
+    {
+        while( i <= n - 16 )
+        {
+            // the sums of squares stay in 32 bits for the blocks up to 16K pixels
+            int blockEnd = std::min(i + (1 << 14), n) - 16;
+            v_uint32x4 vs = v_setzero_u32(), vsq = v_setzero_u32();
+
+            for( ; i <= blockEnd; i += 16 )
+            {
+                v_uint16x8 a0, a1;
+                v_expand(v_load(p + i), a0, a1);
+
+                v_uint32x4 b0, b1;
+                v_expand(a0 + a1, b0, b1);
+                vs += b0 + b1;
+
+                v_int16x8 c0 = v_reinterpret_as_s16(a0), c1 = v_reinterpret_as_s16(a1);
+                vsq += v_reinterpret_as_u32(v_dotprod(c0, c0) + v_dotprod(c1, c1));
+            }
+            s += v_reduce_sum(vs);
+            sq += v_reduce_sum(vsq);
+        }
+    }
+#endif
+    for( ; i < n; i++ )
+    {
+        int v = p[i];
+        s += v;
+        sq += v*v;
+    }
+
+    sum += delta*s;
+    sqsum += delta*sq;
+}
+
+static void updateRect( const Mat& img, const Rect& r, const int* tab, int delta, WindowStats& st )
+{
+    for( int y = r.y; y < r.y + r.height; y++ )
+        updateSpan(img.ptr(y) + r.x, r.width, tab, delta, &st.hist[0], st.sum, st.sqsum);
+}
+
+// Moves the window to b. The pixels that leave and enter the window are processed in two steps:
+// first the columns are changed over the rows of the old window, then the rows are changed over
+// the columns of the new window. When the windows do not overlap or the update costs more than
+// the new window area, the statistics are computed from scratch.
+static void moveWindow( const Mat& img, const int* tab, WindowStats& st, const Rect& b )
+{
+    Rect a = st.window;
+    int ax1 = a.x + a.width, ay1 = a.y + a.height;
+    int bx1 = b.x + b.width, by1 = b.y + b.height;
+    double cost = (double)(std::abs(b.x - a.x) + std::abs(bx1 - ax1))*a.height +
+                  (double)(std::abs(b.y - a.y) + std::abs(by1 - ay1))*b.width;
+
+    if( (a & b).empty() || cost >= (double)b.area() )
+    {
+        std::fill(st.hist.begin(), st.hist.end(), 0);
+        st.sum = st.sqsum = 0;
+        updateRect(img, b, tab, 1, st);
+    }
+    else
+    {
+        if( a.x < b.x )
+            updateRect(img, Rect(a.x, a.y, b.x - a.x, a.height), tab, -1, st);
+        else if( b.x < a.x )
+            updateRect(img, Rect(b.x, a.y, a.x - b.x, a.height), tab, 1, st);
+        if( bx1 < ax1 )
+            updateRect(img, Rect(bx1, a.y, ax1 - bx1, a.height), tab, -1, st);
+        else if( ax1 < bx1 )
+            updateRect(img, Rect(ax1, a.y, bx1 - ax1, a.height), tab, 1, st);
+
+        if( a.y < b.y )
+            updateRect(img, Rect(b.x, a.y, b.width, b.y - a.y), tab, -1, st);
+        else if( b.y < a.y )
+            updateRect(img, Rect(b.x, b.y, b.width, a.y - b.y), tab, 1, st);
+        if( by1 < ay1 )
+            updateRect(img, Rect(b.x, by1, b.width, ay1 - by1), tab, -1, st);
+        else if( ay1 < by1 )
+            updateRect(img, Rect(b.x, ay1, b.width, by1 - ay1), tab, 1, st);
+    }
+    st.window = b;
+}
+
+static void getMoments( const WindowStats& st, double& mean, double& stddev )
+{
+    int n = st.window.area();
+    mean = stddev = 0;
+    if( n > 0 )
+    {
+        double scale = 1./n;
+        mean = st.sum*scale;
+        stddev = std::sqrt(std::max(st.sqsum*scale - mean*mean, 0.));
+    }
+}
+
+class SlidingHistogramInvoker : public ParallelLoopBody
+{
+public:
+    SlidingHistogramInvoker( const Mat& _image, const int* _tab, int _histSize,
+                             const std::vector<Rect>& _windows, Mat& _hists,
+                             Mat& _means, Mat& _stddevs )
+        : image(_image), tab(_tab), histSize(_histSize), windows(&_windows),
+          hists(&_hists), means(&_means), stddevs(&_stddevs) {}
+
+    virtual void operator()( const Range& range ) const
+    {
+        WindowStats st;
+        st.reset(histSize);
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            moveWindow(image, tab, st, (*windows)[i]);
+
+            float* h = hists->ptr<float>(i);
+            for( int j = 0; j < histSize; j++ )
+                h[j] = (float)st.hist[j];
+
+            double mean, stddev;
+            getMoments(st, mean, stddev);
+            if( !means->empty() )
+                means->at<double>(i) = mean;
+            if( !stddevs->empty() )
+                stddevs->at<double>(i) = stddev;
+        }
+    }
+
+private:
+    Mat image;
+    const int* tab;
+    int histSize;
+    const std::vector<Rect>* windows;
+    Mat* hists;
+    Mat* means;
+    Mat* stddevs;
+};
+
+class SlidingHistogramImpl : public SlidingHistogram
+{
+public:
+    SlidingHistogramImpl( int _histSize, float rangeMin, float rangeMax )
+    {
+        CV_Assert( _histSize > 0 && rangeMin < rangeMax );
+        histSize = _histSize;
+
+        // the same bins as calcHist computes for the uniform ranges
+        double a = histSize/((double)rangeMax - rangeMin), b = -a*rangeMin;
+        for( int j = 0; j < 256; j++ )
+        {
+            int idx = cvFloor(j*a + b);
+            tab[j] = (unsigned)idx < (unsigned)histSize ? idx : histSize;
+        }
+        stats.reset(histSize);
+    }
+
+    void setImage( InputArray _image )
+    {
+        CV_Assert( _image.type() == CV_8UC1 );
+        image = _image.getMat();
+        window &= Rect(0, 0, image.cols, image.rows);
+        stats.reset(histSize);
+    }
+
+    void setWindow( const Rect& _window )
+    {
+        checkWindow(_window);
+        window = _window;
+    }
+
+    Rect getWindow() const { return window; }
+
+    void getHist( OutputArray _hist )
+    {
+        update();
+        _hist.create(histSize, 1, CV_32F);
+        Mat hist = _hist.getMat();
+        for( int j = 0; j < histSize; j++ )
+            hist.at<float>(j) = (float)stats.hist[j];
+    }
+
+    void getMeanStdDev( double& mean, double& stddev )
+    {
+        update();
+        getMoments(stats, mean, stddev);
+    }
+
+    void calcWindows( const std::vector<Rect>& windows, OutputArray _hists,
+                      OutputArray _means, OutputArray _stddevs )
+    {
+        CV_INSTRUMENT_REGION()
+
+        int nwindows = (int)windows.size();
+        for( int i = 0; i < nwindows; i++ )
+            checkWindow(windows[i]);
+
+        _hists.create(nwindows, histSize, CV_32F);
+        Mat hists = _hists.getMat(), means, stddevs;
+        if( _means.needed() )
+        {
+            _means.create(nwindows, 1, CV_64F);
+            means = _means.getMat();
+        }
+        if( _stddevs.needed() )
+        {
+            _stddevs.create(nwindows, 1, CV_64F);
+            stddevs = _stddevs.getMat();
+        }
+        if( nwindows == 0 )
+            return;
+
+        // a few stripes per thread, so that the neighbouring windows are updated incrementally
+        double nstripes = std::min((double)nwindows, std::max(getNumThreads(), 1)*4.);
+        parallel_for_(Range(0, nwindows),
+                      SlidingHistogramInvoker(image, tab, histSize, windows, hists, means, stddevs),
+                      nstripes);
+    }
+
+    int getHistSize() const { return histSize; }
+
+private:
+    void checkWindow( const Rect& r ) const
+    {
+        CV_Assert( !image.empty() );
+        CV_Assert( r.width >= 0 && r.height >= 0 &&
+                   (r & Rect(0, 0, image.cols, image.rows)) == r );
+    }
+
+    void update()
+    {
+        CV_Assert( !image.empty() );
+        if( stats.window != window )
+            moveWindow(image, tab, stats, window);
+    }
+
+    Mat image;
+    int histSize;
+    int tab[256];
+    Rect window;
+    WindowStats stats;
+};
+
+}
+
+cv::Ptr<cv::SlidingHistogram> cv::createSlidingHistogram( int histSize, float rangeMin, float rangeMax )
+{
+    return makePtr<SlidingHistogramImpl>(histSize, rangeMin, rangeMax);
+}
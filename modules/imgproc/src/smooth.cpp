@@ -2879,6 +2879,225 @@ medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
     }
 }
 
+/*
+ Rank (percentile) filter based on a sliding-window histogram.
+
+ The window is moved in a zig-zag manner over a band of rows (Huang's algorithm),
+ so every step costs 2*ksize histogram updates. Pixel values are mapped to dense
+ integer keys: 8u/16u/16s values are used directly, while floating-point values
+ of the band are replaced with their ranks in the sorted band. The histogram has
+ two tiers (256 keys per coarse bin) and the coarse position of the answer is
+ tracked incrementally, since it rarely moves far between neighbouring pixels.
+*/
+class RankHistogram
+{
+public:
+    RankHistogram() : pos(0), below(0) {}
+
+    void reset(int nkeys)
+    {
+        int ncoarse = (nkeys + 255) >> 8;
+        coarse.assign(ncoarse, 0);
+        fine.assign(ncoarse << 8, 0);
+        pos = below = 0;
+    }
+
+    void add(int key)
+    {
+        coarse[key >> 8]++;
+        fine[key]++;
+        below += (key >> 8) < pos;
+    }
+
+    void remove(int key)
+    {
+        coarse[key >> 8]--;
+        fine[key]--;
+        below -= (key >> 8) < pos;
+    }
+
+    // returns the key of the rank-th (0-based) smallest element
+    int find(int rank)
+    {
+        const int* c = &coarse[0];
+        while( below > rank )
+            below -= c[--pos];
+        while( below + c[pos] <= rank )
+            below += c[pos++];
+
+        const int* f = &fine[pos << 8];
+        int k, s;
+        if( rank - below < (c[pos] >> 1) )
+        {
+            for( k = 0, s = below + f[0]; s <= rank; )
+                s += f[++k];
+        }
+        else
+        {
+            for( k = 255, s = below + c[pos]; s - f[k] > rank; )
+                s -= f[k--];
+        }
+        return (pos << 8) + k;
+    }
+
+private:
+    std::vector<int> coarse, fine;
+    int pos, below;
+};
+
+static inline unsigned sortableFloatKey(float v)
+{
+    Cv32suf u;
+    u.f = v;
+    return (u.u & 0x80000000u) ? ~u.u : (u.u | 0x80000000u);
+}
+
+class RankFilter_Invoker : public ParallelLoopBody
+{
+public:
+    RankFilter_Invoker(const Mat& _src, Mat& _dst, int _ksize, int _rank)
+        : src(_src), dst(_dst), ksize(_ksize), rank(_rank)
+    {
+    }
+
+    virtual void operator()(const Range& range) const
+    {
+        int depth = src.depth(), cn = src.channels();
+        int width = src.cols, brows = range.end - range.start + ksize - 1;
+        int nelems = width * brows;
+        std::vector<int> keys(nelems);
+        std::vector<float> values;
+        std::vector<uint64> order;
+        RankHistogram hist;
+
+        for( int c = 0; c < cn; c++ )
+        {
+            int nkeys = 0;
+            if( depth == CV_8U || depth == CV_16U || depth == CV_16S )
+            {
+                nkeys = depth == CV_8U ? 256 : 65536;
+                for( int i = 0; i < brows; i++ )
+                {
+                    int* krow = &keys[i * width];
+                    if( depth == CV_8U )
+                    {
+                        const uchar* s = src.ptr<uchar>(range.start + i) + c;
+                        for( int j = 0; j < width; j++ )
+                            krow[j] = s[j * cn];
+                    }
+                    else if( depth == CV_16U )
+                    {
+                        const ushort* s = src.ptr<ushort>(range.start + i) + c;
+                        for( int j = 0; j < width; j++ )
+                            krow[j] = s[j * cn];
+                    }
+                    else
+                    {
+                        const short* s = src.ptr<short>(range.start + i) + c;
+                        for( int j = 0; j < width; j++ )
+                            krow[j] = s[j * cn] + 32768;
+                    }
+                }
+            }
+            else
+            {
+                CV_Assert( depth == CV_32F );
+                nkeys = nelems;
+                order.resize(nelems);
+                values.resize(nelems);
+                for( int i = 0; i < brows; i++ )
+                {
+                    const float* s = src.ptr<float>(range.start + i) + c;
+                    uint64* o = &order[i * width];
+                    for( int j = 0; j < width; j++ )
+                        o[j] = ((uint64)sortableFloatKey(s[j * cn]) << 32) | (unsigned)(i * width + j);
+                }
+                std::sort(order.begin(), order.end());
+                for( int k = 0; k < nelems; k++ )
+                {
+                    int idx = (int)(order[k] & 0xffffffffu);
+                    keys[idx] = k;
+                    values[k] = src.ptr<float>(range.start + idx / width)[(idx % width) * cn + c];
+                }
+            }
+
+            hist.reset(nkeys);
+            filterBand(hist, &keys[0], width, range, c, values.empty() ? 0 : &values[0]);
+        }
+    }
+
+private:
+    void filterBand(RankHistogram& hist, const int* keys, int kstep,
+                    const Range& range, int c, const float* values) const
+    {
+        int cn = dst.channels(), depth = dst.depth();
+        int width = dst.cols;
+
+        for( int i = 0; i < ksize; i++ )
+            for( int j = 0; j < ksize; j++ )
+                hist.add(keys[i * kstep + j]);
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const int* top = keys + (y - range.start) * kstep;
+            bool forward = ((y - range.start) & 1) == 0;
+            int x = forward ? 0 : width - 1;
+
+            for( int n = 0; ; n++ )
+            {
+                int key = hist.find(rank);
+                if( depth == CV_8U )
+                    dst.ptr<uchar>(y)[x * cn + c] = (uchar)key;
+                else if( depth == CV_16U )
+                    dst.ptr<ushort>(y)[x * cn + c] = (ushort)key;
+                else if( depth == CV_16S )
+                    dst.ptr<short>(y)[x * cn + c] = (short)(key - 32768);
+                else
+                    dst.ptr<float>(y)[x * cn + c] = values[key];
+
+                if( n == width - 1 )
+                    break;
+
+                // shift the window horizontally by one column
+                int out = forward ? x : x + ksize - 1;
+                int in = forward ? x + ksize : x - 1;
+                for( int i = 0; i < ksize; i++ )
+                {
+                    hist.remove(top[i * kstep + out]);
+                    hist.add(top[i * kstep + in]);
+                }
+                x += forward ? 1 : -1;
+            }
+
+            // shift the window down by one row
+            if( y + 1 < range.end )
+            {
+                const int* bottom = top + ksize * kstep;
+                for( int j = x; j < x + ksize; j++ )
+                {
+                    hist.remove(top[j]);
+                    hist.add(bottom[j]);
+                }
+            }
+        }
+    }
+
+    const Mat& src;
+    Mat& dst;
+    int ksize, rank;
+};
+
+// src is the input padded by ksize/2 pixels on each side
+static void
+rankFilter_Hist( const Mat& src, Mat& dst, int ksize, int rank )
+{
+    // bands should be noticeably taller than the aperture, otherwise
+    // the initialization and the overlapping rows dominate
+    int bandRows = std::max(ksize * 4, 32);
+    double nstripes = std::max(dst.rows / bandRows, 1);
+    parallel_for_(Range(0, dst.rows), RankFilter_Invoker(src, dst, ksize, rank), nstripes);
+}
+
 #ifdef HAVE_OPENCL
 
 static bool ocl_medianFilter(InputArray _src, OutputArray _dst, int m)
@@ -3160,6 +3379,11 @@ void cv::medianBlur( InputArray _src0, OutputArray _dst, int ksize )
 
         return;
     }
+    else if( src0.depth() != CV_8U )
+    {
+        cv::copyMakeBorder( src0, src, ksize/2, ksize/2, ksize/2, ksize/2, BORDER_REPLICATE );
+        rankFilter_Hist( src, dst, ksize, ksize*ksize/2 );
+    }
     else
     {
         cv::copyMakeBorder( src0, src, 0, 0, ksize/2, ksize/2, BORDER_REPLICATE );
@@ -3176,6 +3400,28 @@ void cv::medianBlur( InputArray _src0, OutputArray _dst, int ksize )
     }
 }
 
+void cv::rankFilter( InputArray _src0, OutputArray _dst, int ksize, double percentile )
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert( (ksize % 2 == 1) && (_src0.dims() <= 2) && 0 <= percentile && percentile <= 100 );
+    int depth = _src0.depth();
+    CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_16S || depth == CV_32F );
+
+    if( ksize <= 1 || _src0.empty() )
+    {
+        _src0.copyTo(_dst);
+        return;
+    }
+
+    Mat src0 = _src0.getMat(), src;
+    cv::copyMakeBorder( src0, src, ksize/2, ksize/2, ksize/2, ksize/2, BORDER_REPLICATE );
+    _dst.create( src0.size(), src0.type() );
+    Mat dst = _dst.getMat();
+
+    rankFilter_Hist( src, dst, ksize, cvRound(percentile*0.01*(ksize*ksize - 1)) );
+}
+
 /****************************************************************************************\
                                    Bilateral Filtering
 \****************************************************************************************/
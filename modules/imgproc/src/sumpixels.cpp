@@ -43,6 +43,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_imgproc.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -140,6 +141,286 @@ struct Integral_SIMD<uchar, int, double>
 
 #endif
 
+/*
+   Block-parallel integral image (sum and optionally sqsum, no tilted sum).
+
+   The first pass computes horizontal prefix sums of the source rows (rows are split
+   between threads), the second pass accumulates them vertically (columns are split
+   between threads). Both passes perform the same additions in the same order as
+   integral_, so the result matches the sequential code.
+*/
+template<typename T, typename ST>
+static void integralRowPrefix_( const T* src, ST* sum, int width, int cn )
+{
+    for( int k = 0; k < cn; k++ )
+    {
+        ST s = 0;
+        for( int x = k; x < width*cn; x += cn )
+        {
+            s += src[x];
+            sum[x] = s;
+        }
+    }
+}
+
+template<typename T, typename ST>
+struct IntegralRowPrefix
+{
+    void operator()(const T* src, ST* sum, int*, int width, int cn) const
+    {
+        integralRowPrefix_(src, sum, width, cn);
+    }
+};
+
+static void integralRowPrefix_8u32s( const uchar* src, int* sum, int width )
+{
+    int x = 0, s = 0;
+#if CV_SIMD128
+    if( hasSIMD128() )
+    {
+        v_uint16x8 v_zero = v_setzero_u16();
+        for( ; x <= width - 8; x += 8 )
+        {
+            // in-register prefix sum of 8 elements, 8*255 fits into 16 bits
+            v_uint16x8 v = v_load_expand(src + x);
+            v += v_extract<7>(v_zero, v);
+            v += v_extract<6>(v_zero, v);
+            v += v_extract<4>(v_zero, v);
+
+            v_uint32x4 v_lo, v_hi;
+            v_expand(v, v_lo, v_hi);
+            v_int32x4 v_s = v_setall_s32(s);
+            v_store(sum + x, v_reinterpret_as_s32(v_lo) + v_s);
+            v_store(sum + x + 4, v_reinterpret_as_s32(v_hi) + v_s);
+            s = sum[x + 7];
+        }
+    }
+#endif
+    for( ; x < width; x++ )
+        sum[x] = (s += src[x]);
+}
+
+template<>
+struct IntegralRowPrefix<uchar, int>
+{
+    void operator()(const uchar* src, int* sum, int*, int width, int cn) const
+    {
+        if( cn == 1 )
+            integralRowPrefix_8u32s(src, sum, width);
+        else
+            integralRowPrefix_(src, sum, width, cn);
+    }
+};
+
+template<>
+struct IntegralRowPrefix<uchar, float>
+{
+    void operator()(const uchar* src, float* sum, int* buf, int width, int cn) const
+    {
+        if( cn != 1 )
+        {
+            integralRowPrefix_(src, sum, width, cn);
+            return;
+        }
+
+        integralRowPrefix_8u32s(src, buf, width);
+        int x = 0;
+#if CV_SIMD128
+        if( hasSIMD128() )
+        {
+            for( ; x <= width - 4; x += 4 )
+                v_store(sum + x, v_cvt_f32(v_load(buf + x)));
+        }
+#endif
+        for( ; x < width; x++ )
+            sum[x] = (float)buf[x];
+    }
+};
+
+template<>
+struct IntegralRowPrefix<uchar, double>
+{
+    void operator()(const uchar* src, double* sum, int* buf, int width, int cn) const
+    {
+        if( cn != 1 )
+        {
+            integralRowPrefix_(src, sum, width, cn);
+            return;
+        }
+
+        integralRowPrefix_8u32s(src, buf, width);
+        int x = 0;
+#if CV_SIMD128_64F
+        if( hasSIMD128() )
+        {
+            for( ; x <= width - 4; x += 4 )
+            {
+                v_int32x4 v = v_load(buf + x);
+                v_store(sum + x, v_cvt_f64(v));
+                v_store(sum + x + 2, v_cvt_f64_high(v));
+            }
+        }
+#endif
+        for( ; x < width; x++ )
+            sum[x] = (double)buf[x];
+    }
+};
+
+template<typename T, typename QT>
+static void integralRowSqPrefix( const T* src, QT* sqsum, int width, int cn )
+{
+    for( int k = 0; k < cn; k++ )
+    {
+        QT sq = 0;
+        for( int x = k; x < width*cn; x += cn )
+        {
+            T it = src[x];
+            sq += (QT)it*it;
+            sqsum[x] = sq;
+        }
+    }
+}
+
+template<typename ST>
+static void integralAccumulateRow( const ST* prev, ST* row, int len )
+{
+    for( int x = 0; x < len; x++ )
+        row[x] += prev[x];
+}
+
+#if CV_SIMD128
+template<typename ST, typename VT>
+static void integralAccumulateRow_SIMD( const ST* prev, ST* row, int len )
+{
+    int x = 0;
+    if( hasSIMD128() )
+    {
+        for( ; x <= len - VT::nlanes*2; x += VT::nlanes*2 )
+        {
+            VT v0 = v_load(row + x) + v_load(prev + x);
+            VT v1 = v_load(row + x + VT::nlanes) + v_load(prev + x + VT::nlanes);
+            v_store(row + x, v0);
+            v_store(row + x + VT::nlanes, v1);
+        }
+    }
+    for( ; x < len; x++ )
+        row[x] += prev[x];
+}
+
+template<>
+void integralAccumulateRow<int>( const int* prev, int* row, int len )
+{
+    integralAccumulateRow_SIMD<int, v_int32x4>(prev, row, len);
+}
+
+template<>
+void integralAccumulateRow<float>( const float* prev, float* row, int len )
+{
+    integralAccumulateRow_SIMD<float, v_float32x4>(prev, row, len);
+}
+
+#if CV_SIMD128_64F
+template<>
+void integralAccumulateRow<double>( const double* prev, double* row, int len )
+{
+    integralAccumulateRow_SIMD<double, v_float64x2>(prev, row, len);
+}
+#endif
+#endif
+
+template<typename T, typename ST, typename QT>
+class IntegralRowsInvoker : public ParallelLoopBody
+{
+public:
+    IntegralRowsInvoker(const T* _src, size_t _srcstep, ST* _sum, size_t _sumstep,
+                        QT* _sqsum, size_t _sqsumstep, int _width, int _cn) :
+        src(_src), srcstep(_srcstep), sum(_sum), sumstep(_sumstep),
+        sqsum(_sqsum), sqsumstep(_sqsumstep), width(_width), cn(_cn) {}
+
+    void operator()(const Range& range) const
+    {
+        AutoBuffer<int> _buf(width + 1);
+        IntegralRowPrefix<T, ST> rowPrefix;
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const T* srcrow = (const T*)((const uchar*)src + srcstep*y);
+            ST* sumrow = (ST*)((uchar*)sum + sumstep*(y + 1));
+            for( int k = 0; k < cn; k++ )
+                sumrow[k] = 0;
+            rowPrefix(srcrow, sumrow + cn, _buf, width, cn);
+
+            if( sqsum )
+            {
+                QT* sqsumrow = (QT*)((uchar*)sqsum + sqsumstep*(y + 1));
+                for( int k = 0; k < cn; k++ )
+                    sqsumrow[k] = 0;
+                integralRowSqPrefix(srcrow, sqsumrow + cn, width, cn);
+            }
+        }
+    }
+
+private:
+    const T* src;
+    size_t srcstep;
+    ST* sum;
+    size_t sumstep;
+    QT* sqsum;
+    size_t sqsumstep;
+    int width, cn;
+};
+
+template<typename ST>
+class IntegralColsInvoker : public ParallelLoopBody
+{
+public:
+    IntegralColsInvoker(ST* _sum, size_t _sumstep, int _len, int _height, int _blockSize) :
+        sum(_sum), sumstep(_sumstep), len(_len), height(_height), blockSize(_blockSize) {}
+
+    void operator()(const Range& range) const
+    {
+        int x0 = range.start*blockSize, x1 = std::min(range.end*blockSize, len);
+        const ST* prev = (const ST*)((const uchar*)sum + sumstep) + x0;
+        for( int y = 2; y <= height; y++ )
+        {
+            ST* row = (ST*)((uchar*)sum + sumstep*y) + x0;
+            integralAccumulateRow(prev, row, x1 - x0);
+            prev = row;
+        }
+    }
+
+private:
+    ST* sum;
+    size_t sumstep;
+    int len, height, blockSize;
+};
+
+template<typename T, typename ST, typename QT>
+static bool integral_parallel( const T* src, size_t srcstep, ST* sum, size_t sumstep,
+                               QT* sqsum, size_t sqsumstep, ST* tilted,
+                               int width, int height, int cn )
+{
+    if( tilted || getNumThreads() <= 1 || height < 64 ||
+        (double)width*height*cn < (double)(1 << 17) )
+        return false;
+
+    int len = (width + 1)*cn;
+    memset( sum, 0, len*sizeof(sum[0]) );
+    if( sqsum )
+        memset( sqsum, 0, len*sizeof(sqsum[0]) );
+
+    parallel_for_(Range(0, height), IntegralRowsInvoker<T, ST, QT>(src, srcstep, sum, sumstep,
+                  sqsum, sqsumstep, width, cn), (double)width*height*cn/(1 << 16));
+
+    // columns are processed in blocks of a few cache lines to keep the vertical pass streaming
+    const int blockSize = 256;
+    int nblocks = (len + blockSize - 1)/blockSize;
+    parallel_for_(Range(0, nblocks), IntegralColsInvoker<ST>(sum, sumstep, len, height, blockSize));
+    if( sqsum )
+        parallel_for_(Range(0, nblocks), IntegralColsInvoker<QT>(sqsum, sqsumstep, len, height, blockSize));
+    return true;
+}
+
 template<typename T, typename ST, typename QT>
 void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
                 QT* sqsum, size_t _sqsumstep, ST* tilted, size_t _tiltedstep,
@@ -147,6 +428,9 @@ void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
 {
     int x, y, k;
 
+    if (integral_parallel(src, _srcstep, sum, _sumstep, sqsum, _sqsumstep, tilted, width, height, cn))
+        return;
+
     if (Integral_SIMD<T, ST, QT>()(src, _srcstep,
                                    sum, _sumstep,
                                    sqsum, _sqsumstep,
@@ -41,6 +41,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_imgproc.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 ////////////////////////////////////////////////// matchTemplate //////////////////////////////////////////////////////////
 
@@ -563,12 +564,34 @@ static bool ocl_matchTemplate( InputArray _img, InputArray _templ, OutputArray _
 
 #include "opencv2/core/hal/hal.hpp"
 
+static void crossCorrBlockSize( Size corrsize, Size templsize, Size& blocksize, Size& dftsize )
+{
+    const double blockScale = 4.5;
+    const int minBlockSize = 256;
+
+    blocksize.width = cvRound(templsize.width*blockScale);
+    blocksize.width = std::max( blocksize.width, minBlockSize - templsize.width + 1 );
+    blocksize.width = std::min( blocksize.width, corrsize.width );
+    blocksize.height = cvRound(templsize.height*blockScale);
+    blocksize.height = std::max( blocksize.height, minBlockSize - templsize.height + 1 );
+    blocksize.height = std::min( blocksize.height, corrsize.height );
+
+    dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templsize.width - 1), 2);
+    dftsize.height = getOptimalDFTSize(blocksize.height + templsize.height - 1);
+    if( dftsize.width <= 0 || dftsize.height <= 0 )
+        CV_Error( CV_StsOutOfRange, "the input arrays are too big" );
+
+    // recompute block size
+    blocksize.width = dftsize.width - templsize.width + 1;
+    blocksize.width = MIN( blocksize.width, corrsize.width );
+    blocksize.height = dftsize.height - templsize.height + 1;
+    blocksize.height = MIN( blocksize.height, corrsize.height );
+}
+
 void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
                 Size corrsize, int ctype,
                 Point anchor, double delta, int borderType )
 {
-    const double blockScale = 4.5;
-    const int minBlockSize = 256;
     std::vector<uchar> buf;
 
     Mat templ = _templ;
@@ -594,24 +617,7 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
 
     int maxDepth = depth > CV_8S ? CV_64F : std::max(std::max(CV_32F, tdepth), cdepth);
     Size blocksize, dftsize;
-
-    blocksize.width = cvRound(templ.cols*blockScale);
-    blocksize.width = std::max( blocksize.width, minBlockSize - templ.cols + 1 );
-    blocksize.width = std::min( blocksize.width, corr.cols );
-    blocksize.height = cvRound(templ.rows*blockScale);
-    blocksize.height = std::max( blocksize.height, minBlockSize - templ.rows + 1 );
-    blocksize.height = std::min( blocksize.height, corr.rows );
-
-    dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templ.cols - 1), 2);
-    dftsize.height = getOptimalDFTSize(blocksize.height + templ.rows - 1);
-    if( dftsize.width <= 0 || dftsize.height <= 0 )
-        CV_Error( CV_StsOutOfRange, "the input arrays are too big" );
-
-    // recompute block size
-    blocksize.width = dftsize.width - templ.cols + 1;
-    blocksize.width = MIN( blocksize.width, corr.cols );
-    blocksize.height = dftsize.height - templ.rows + 1;
-    blocksize.height = MIN( blocksize.height, corr.rows );
+    crossCorrBlockSize(corr.size(), templ.size(), blocksize, dftsize);
 
     Mat dftTempl( dftsize.height*tcn, dftsize.width, maxDepth );
     Mat dftImg( dftsize, maxDepth );
@@ -762,6 +768,363 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
     }
 }
 
+/*
+   Direct (spatial domain) cross-correlation. For small templates it is considerably
+   faster than the DFT-based crossCorr, which has to transform the whole image in
+   overlapping blocks. The result rows are processed in parallel, each value is a dot
+   product of a template row with the image row, computed with SIMD.
+*/
+static double crossCorrDirect_8u( const uchar* src, size_t srcstep, const short* templ, int len, int rows )
+{
+    int sum = 0;
+    for( int ty = 0; ty < rows; ty++, src += srcstep, templ += len )
+    {
+        int k = 0;
+#if CV_SIMD128
+        if( hasSIMD128() )
+        {
+            v_int32x4 v_sum = v_setzero_s32();
+            for( ; k <= len - 16; k += 16 )
+            {
+                v_uint16x8 v_src0, v_src1;
+                v_expand(v_load(src + k), v_src0, v_src1);
+                v_sum += v_dotprod(v_reinterpret_as_s16(v_src0), v_load(templ + k));
+                v_sum += v_dotprod(v_reinterpret_as_s16(v_src1), v_load(templ + k + 8));
+            }
+            for( ; k <= len - 8; k += 8 )
+                v_sum += v_dotprod(v_reinterpret_as_s16(v_load_expand(src + k)), v_load(templ + k));
+            sum += v_reduce_sum(v_sum);
+        }
+#endif
+        for( ; k < len; k++ )
+            sum += src[k]*templ[k];
+    }
+    return sum;
+}
+
+static double crossCorrDirect_32f( const float* src, size_t srcstep, const float* templ, int len, int rows )
+{
+    double sum = 0;
+    for( int ty = 0; ty < rows; ty++, src = (const float*)((const uchar*)src + srcstep), templ += len )
+    {
+        int k = 0;
+#if CV_SIMD128_64F
+        if( hasSIMD128() )
+        {
+            v_float64x2 v_sum0 = v_setzero_f64(), v_sum1 = v_setzero_f64();
+            for( ; k <= len - 4; k += 4 )
+            {
+                v_float32x4 v_mul = v_load(src + k) * v_load(templ + k);
+                v_sum0 += v_cvt_f64(v_mul);
+                v_sum1 += v_cvt_f64_high(v_mul);
+            }
+            double CV_DECL_ALIGNED(16) buf[2];
+            v_store_aligned(buf, v_sum0 + v_sum1);
+            sum += buf[0] + buf[1];
+        }
+#endif
+        for( ; k < len; k++ )
+            sum += (double)src[k]*templ[k];
+    }
+    return sum;
+}
+
+template<typename T, typename WT>
+class CrossCorrDirect_Invoker : public ParallelLoopBody
+{
+public:
+    CrossCorrDirect_Invoker(const Mat& _img, const Mat& _templ, Mat& _corr) :
+        img(_img), templ(_templ), corr(_corr) {}
+
+    void operator()(const Range& range) const
+    {
+        int cn = img.channels(), len = templ.cols*cn;
+        for( int y = range.start; y < range.end; y++ )
+        {
+            float* crow = corr.ptr<float>(y);
+            const T* src = img.ptr<T>(y);
+            int x = rowSIMD(src, crow);
+            for( ; x < corr.cols; x++ )
+                crow[x] = (float)crossCorr(src + x*cn, img.step, templ.ptr<WT>(), len, templ.rows);
+        }
+    }
+
+protected:
+    // computes a few output values at once for single-channel images, returns the number of processed values
+    int rowSIMD(const T*, float*) const { return 0; }
+
+    static double crossCorr(const uchar* src, size_t step, const short* t, int len, int rows)
+    { return crossCorrDirect_8u(src, step, t, len, rows); }
+    static double crossCorr(const float* src, size_t step, const float* t, int len, int rows)
+    { return crossCorrDirect_32f(src, step, t, len, rows); }
+
+    const Mat& img;
+    const Mat& templ;
+    Mat& corr;
+};
+
+#if CV_SIMD128
+template<>
+int CrossCorrDirect_Invoker<uchar, short>::rowSIMD(const uchar* src, float* dst) const
+{
+    if( img.channels() != 1 || !hasSIMD128() )
+        return 0;
+
+    // template taps are processed in pairs: a dot product of interleaved neighbour pixels
+    // with the (t[2i], t[2i+1]) pair gives the contribution of both taps to 4 outputs
+    int npairs = (templ.cols + 1)/2, x = 0;
+    int xmax = std::min(corr.cols - 8, img.cols - npairs*2 - 7);
+    if( xmax < 0 )
+        return 0;
+
+    AutoBuffer<short> _tpairs(templ.rows*npairs*8);
+    short* tpairs = _tpairs;
+    for( int ty = 0; ty < templ.rows; ty++ )
+    {
+        const short* trow = templ.ptr<short>(ty);
+        for( int i = 0; i < npairs; i++ )
+        {
+            short t0 = trow[i*2], t1 = i*2 + 1 < templ.cols ? trow[i*2 + 1] : 0;
+            for( int j = 0; j < 8; j += 2 )
+            {
+                tpairs[(ty*npairs + i)*8 + j] = t0;
+                tpairs[(ty*npairs + i)*8 + j + 1] = t1;
+            }
+        }
+    }
+
+    for( ; x <= xmax; x += 8 )
+    {
+        v_int32x4 v_sum0 = v_setzero_s32(), v_sum1 = v_setzero_s32();
+        const uchar* p = src + x;
+        const short* tp = tpairs;
+        for( int ty = 0; ty < templ.rows; ty++, p += img.step )
+        {
+            for( int i = 0; i < npairs; i++, tp += 8 )
+            {
+                v_int16x8 v_t = v_load(tp), v_lo, v_hi;
+                v_zip(v_reinterpret_as_s16(v_load_expand(p + i*2)),
+                      v_reinterpret_as_s16(v_load_expand(p + i*2 + 1)), v_lo, v_hi);
+                v_sum0 += v_dotprod(v_lo, v_t);
+                v_sum1 += v_dotprod(v_hi, v_t);
+            }
+        }
+        v_store(dst + x, v_cvt_f32(v_sum0));
+        v_store(dst + x + 4, v_cvt_f32(v_sum1));
+    }
+    return x;
+}
+
+#if CV_SIMD128_64F
+template<>
+int CrossCorrDirect_Invoker<float, float>::rowSIMD(const float* src, float* dst) const
+{
+    if( img.channels() != 1 || !hasSIMD128() )
+        return 0;
+
+    // each template row is accumulated in single precision, the rows are summed up in double
+    int x = 0;
+    for( ; x <= corr.cols - 4; x += 4 )
+    {
+        v_float64x2 v_sum0 = v_setzero_f64(), v_sum1 = v_setzero_f64();
+        const float* p = src + x;
+        for( int ty = 0; ty < templ.rows; ty++, p = (const float*)((const uchar*)p + img.step) )
+        {
+            const float* trow = templ.ptr<float>(ty);
+            v_float32x4 v_rsum = v_setzero_f32();
+            for( int tx = 0; tx < templ.cols; tx++ )
+                v_rsum += v_load(p + tx)*v_setall_f32(trow[tx]);
+            v_sum0 += v_cvt_f64(v_rsum);
+            v_sum1 += v_cvt_f64_high(v_rsum);
+        }
+        v_store(dst + x, v_combine_low(v_cvt_f32(v_sum0), v_cvt_f32(v_sum1)));
+    }
+    return x;
+}
+#endif
+#endif
+
+static void crossCorrDirect( const Mat& img, const Mat& templ, Mat& corr )
+{
+    CV_Assert( img.type() == templ.type() && (img.depth() == CV_8U || img.depth() == CV_32F) );
+    CV_Assert( corr.type() == CV_32FC1 && corr.rows == img.rows - templ.rows + 1 &&
+               corr.cols == img.cols - templ.cols + 1 );
+
+    double nstripes = (double)corr.total()*templ.total()*templ.channels()/(1 << 16);
+    if( img.depth() == CV_8U )
+    {
+        Mat templ16;
+        templ.convertTo(templ16, CV_16S);
+        CV_Assert( templ16.isContinuous() );
+        parallel_for_(Range(0, corr.rows), CrossCorrDirect_Invoker<uchar, short>(img, templ16, corr), nstripes);
+    }
+    else
+    {
+        Mat templ32 = templ.isContinuous() ? templ : templ.clone();
+        parallel_for_(Range(0, corr.rows), CrossCorrDirect_Invoker<float, float>(img, templ32, corr), nstripes);
+    }
+}
+
+/*
+   Cost model choosing between the direct and the DFT-based correlation, both estimated
+   in nanoseconds. The DFT cost follows the tiling used by crossCorr (forward and inverse
+   transforms of every tile plus spectrum multiplication, per channel), the direct cost
+   counts the inner SIMD iterations of CrossCorrDirect_Invoker. The direct path is
+   parallel while crossCorr is not, which is taken into account as well.
+*/
+static bool useDirectCrossCorr( Size imgSize, Size templSize, int depth, int cn )
+{
+    Size corrSize(imgSize.width - templSize.width + 1, imgSize.height - templSize.height + 1);
+    Size blocksize, dftsize;
+    crossCorrBlockSize(corrSize, templSize, blocksize, dftsize);
+
+    double tileCount = (double)((corrSize.width + blocksize.width - 1)/blocksize.width)*
+                       ((corrSize.height + blocksize.height - 1)/blocksize.height);
+    double dftArea = (double)dftsize.area();
+    double dftCost = tileCount*cn*dftArea*(std::log(dftArea)*(1/CV_LOG2) + 4)*(depth == CV_8U ? 0.9 : 1.1);
+
+    double corrArea = (double)corrSize.area(), directCost;
+    if( cn == 1 && depth == CV_8U )
+        directCost = corrArea/8*templSize.height*((templSize.width + 1)/2)*1.2;
+    else if( cn == 1 )
+        directCost = corrArea/4*templSize.height*templSize.width*0.8;
+    else
+    {
+        int lanes = depth == CV_8U ? 8 : 4;
+        directCost = corrArea*templSize.height*((templSize.width*cn + lanes - 1)/lanes + 3)*0.55;
+    }
+
+    return directCost/std::max(getNumThreads(), 1) < dftCost;
+}
+
+/*
+   DFT-based cross-correlation of one image with several templates. The tiling is computed
+   for the largest template, so the spectrum of every image tile is computed once and shared
+   by all the templates; tiles are processed in parallel.
+*/
+class CrossCorrBatch_Invoker : public ParallelLoopBody
+{
+public:
+    CrossCorrBatch_Invoker(const Mat& _img, const std::vector<Mat>& _templ, const std::vector<Mat>& _dftTempl,
+                           std::vector<Mat>& _corr, Size _blocksize, Size _dftsize, int _tileCountX) :
+        img(_img), templ(_templ), dftTempl(_dftTempl), corr(_corr),
+        blocksize(_blocksize), dftsize(_dftsize), tileCountX(_tileCountX) {}
+
+    void operator()(const Range& range) const
+    {
+        int cn = img.channels(), depth = dftTempl[0].depth();
+        Mat dftImg(dftsize, depth), dftCorr(dftsize, depth), plane, src;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int x = (i%tileCountX)*blocksize.width;
+            int y = (i/tileCountX)*blocksize.height;
+            Rect roi(x, y, std::min(dftsize.width, img.cols - x), std::min(dftsize.height, img.rows - y));
+            Mat src0(img, roi);
+
+            for( int k = 0; k < cn; k++ )
+            {
+                dftImg = Scalar::all(0);
+                Mat dst1(dftImg, Rect(0, 0, roi.width, roi.height));
+                if( cn > 1 )
+                {
+                    plane.create(roi.size(), img.depth());
+                    int pairs[] = {k, 0};
+                    mixChannels(&src0, 1, &plane, 1, pairs, 1);
+                    src = plane;
+                }
+                else
+                    src = src0;
+                src.convertTo(dst1, depth);
+                dft(dftImg, dftImg, 0, roi.height);
+
+                for( size_t t = 0; t < templ.size(); t++ )
+                {
+                    Mat& cdst0 = corr[t];
+                    if( x >= cdst0.cols || y >= cdst0.rows )
+                        continue;
+
+                    Size bsz(std::min(blocksize.width, cdst0.cols - x), std::min(blocksize.height, cdst0.rows - y));
+                    Mat cdst(cdst0, Rect(x, y, bsz.width, bsz.height));
+                    Mat dftTempl1(dftTempl[t], Rect(0, k*dftsize.height, dftsize.width, dftsize.height));
+
+                    mulSpectrums(dftImg, dftTempl1, dftCorr, 0, true);
+                    dft(dftCorr, dftCorr, DFT_INVERSE + DFT_SCALE, bsz.height);
+
+                    Mat res(dftCorr, Rect(0, 0, bsz.width, bsz.height));
+                    if( k == 0 )
+                        res.convertTo(cdst, CV_32F);
+                    else
+                    {
+                        if( depth != CV_32F )
+                        {
+                            res.convertTo(plane, CV_32F);
+                            res = plane;
+                        }
+                        add(res, cdst, cdst);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    const Mat& img;
+    const std::vector<Mat>& templ;
+    const std::vector<Mat>& dftTempl;
+    std::vector<Mat>& corr;
+    Size blocksize, dftsize;
+    int tileCountX;
+};
+
+static void crossCorrBatch( const Mat& img, const std::vector<Mat>& templ, std::vector<Mat>& corr )
+{
+    CV_Assert( !templ.empty() && templ.size() == corr.size() );
+
+    int cn = img.channels();
+    int maxDepth = img.depth() > CV_8S ? CV_64F : CV_32F;
+    Size maxTemplSize, corrSize;
+    for( size_t t = 0; t < templ.size(); t++ )
+    {
+        maxTemplSize.width = std::max(maxTemplSize.width, templ[t].cols);
+        maxTemplSize.height = std::max(maxTemplSize.height, templ[t].rows);
+        corrSize.width = std::max(corrSize.width, corr[t].cols);
+        corrSize.height = std::max(corrSize.height, corr[t].rows);
+    }
+
+    Size blocksize, dftsize;
+    crossCorrBlockSize(Size(img.cols - maxTemplSize.width + 1, img.rows - maxTemplSize.height + 1),
+                       maxTemplSize, blocksize, dftsize);
+
+    // compute DFT of each template plane
+    std::vector<Mat> dftTempl(templ.size());
+    for( size_t t = 0; t < templ.size(); t++ )
+    {
+        dftTempl[t].create(dftsize.height*cn, dftsize.width, maxDepth);
+        dftTempl[t] = Scalar::all(0);
+        for( int k = 0; k < cn; k++ )
+        {
+            Mat dst(dftTempl[t], Rect(0, k*dftsize.height, dftsize.width, dftsize.height));
+            Mat dst1(dst, Rect(0, 0, templ[t].cols, templ[t].rows));
+            if( cn > 1 )
+            {
+                Mat plane(templ[t].size(), templ[t].depth());
+                int pairs[] = {k, 0};
+                mixChannels(&templ[t], 1, &plane, 1, pairs, 1);
+                plane.convertTo(dst1, maxDepth);
+            }
+            else
+                templ[t].convertTo(dst1, maxDepth);
+            dft(dst, dst, 0, templ[t].rows);
+        }
+    }
+
+    int tileCountX = (corrSize.width + blocksize.width - 1)/blocksize.width;
+    int tileCountY = (corrSize.height + blocksize.height - 1)/blocksize.height;
+    parallel_for_(Range(0, tileCountX*tileCountY),
+                  CrossCorrBatch_Invoker(img, templ, dftTempl, corr, blocksize, dftsize, tileCountX));
+}
+
 static void matchTemplateMask( InputArray _img, InputArray _templ, OutputArray _result, int method, InputArray _mask )
 {
     int type = _img.type(), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
@@ -841,32 +1204,130 @@ static void matchTemplateMask( InputArray _img, InputArray _templ, OutputArray _
         CV_Error(Error::StsNotImplemented, "");
 }
 
-static void common_matchTemplate( Mat& img, Mat& templ, Mat& result, int method, int cn )
+class MatchTemplateNormalize_Invoker : public ParallelLoopBody
+{
+public:
+    MatchTemplateNormalize_Invoker(const Mat& _sum, const Mat& _sqsum, Size _templSize, Mat& _result,
+                                   int _method, int _cn, const Scalar& _templMean,
+                                   double _templNorm, double _templSum2) :
+        sum(_sum), sqsum(_sqsum), templSize(_templSize), result(_result), method(_method), cn(_cn),
+        templMean(_templMean), templNorm(_templNorm), templSum2(_templSum2) {}
+
+    void operator()(const Range& range) const
+    {
+        int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
+                      method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
+        bool isNormed = method == CV_TM_CCORR_NORMED ||
+                        method == CV_TM_SQDIFF_NORMED ||
+                        method == CV_TM_CCOEFF_NORMED;
+        double invArea = 1./((double)templSize.height * templSize.width);
+
+        const double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
+        if( method != CV_TM_CCOEFF )
+        {
+            CV_Assert(sqsum.data != NULL);
+            q0 = (const double*)sqsum.data;
+            q1 = q0 + templSize.width*cn;
+            q2 = (const double*)(sqsum.data + templSize.height*sqsum.step);
+            q3 = q2 + templSize.width*cn;
+        }
+
+        CV_Assert(sum.data != NULL);
+        const double* p0 = (const double*)sum.data;
+        const double* p1 = p0 + templSize.width*cn;
+        const double* p2 = (const double*)(sum.data + templSize.height*sum.step);
+        const double* p3 = p2 + templSize.width*cn;
+
+        int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
+        int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
+
+        int i, j, k;
+
+        for( i = range.start; i < range.end; i++ )
+        {
+            float* rrow = result.ptr<float>(i);
+            int idx = i * sumstep;
+            int idx2 = i * sqstep;
+
+            for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
+            {
+                double num = rrow[j], t;
+                double wndMean2 = 0, wndSum2 = 0;
+
+                if( numType == 1 )
+                {
+                    for( k = 0; k < cn; k++ )
+                    {
+                        t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
+                        wndMean2 += t*t;
+                        num -= t*templMean[k];
+                    }
+
+                    wndMean2 *= invArea;
+                }
+
+                if( isNormed || numType == 2 )
+                {
+                    for( k = 0; k < cn; k++ )
+                    {
+                        t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
+                        wndSum2 += t;
+                    }
+
+                    if( numType == 2 )
+                    {
+                        num = wndSum2 - 2*num + templSum2;
+                        num = MAX(num, 0.);
+                    }
+                }
+
+                if( isNormed )
+                {
+                    t = std::sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
+                    if( fabs(num) < t )
+                        num /= t;
+                    else if( fabs(num) < t*1.125 )
+                        num = num > 0 ? 1 : -1;
+                    else
+                        num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
+                }
+
+                rrow[j] = (float)num;
+            }
+        }
+    }
+
+private:
+    const Mat& sum;
+    const Mat& sqsum;
+    Size templSize;
+    Mat& result;
+    int method, cn;
+    Scalar templMean;
+    double templNorm, templSum2;
+};
+
+// turns the cross-correlation stored in result into the requested matching measure,
+// sum and sqsum are the integral images (CV_64F) of the source image
+static void matchTemplateNormalize( const Mat& sum, const Mat& sqsum, const Mat& templ, Mat& result, int method, int cn )
 {
     if( method == CV_TM_CCORR )
         return;
 
     int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
                   method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
-    bool isNormed = method == CV_TM_CCORR_NORMED ||
-                    method == CV_TM_SQDIFF_NORMED ||
-                    method == CV_TM_CCOEFF_NORMED;
 
     double invArea = 1./((double)templ.rows * templ.cols);
 
-    Mat sum, sqsum;
     Scalar templMean, templSdv;
-    double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
     double templNorm = 0, templSum2 = 0;
 
     if( method == CV_TM_CCOEFF )
     {
-        integral(img, sum, CV_64F);
         templMean = mean(templ);
     }
     else
     {
-        integral(img, sum, sqsum, CV_64F);
         meanStdDev( templ, templMean, templSdv );
 
         templNorm = templSdv[0]*templSdv[0] + templSdv[1]*templSdv[1] + templSdv[2]*templSdv[2] + templSdv[3]*templSdv[3];
@@ -888,77 +1349,26 @@ static void common_matchTemplate( Mat& img, Mat& templ, Mat& result, int method,
         templSum2 /= invArea;
         templNorm = std::sqrt(templNorm);
         templNorm /= std::sqrt(invArea); // care of accuracy here
-
-        CV_Assert(sqsum.data != NULL);
-        q0 = (double*)sqsum.data;
-        q1 = q0 + templ.cols*cn;
-        q2 = (double*)(sqsum.data + templ.rows*sqsum.step);
-        q3 = q2 + templ.cols*cn;
     }
 
-    CV_Assert(sum.data != NULL);
-    double* p0 = (double*)sum.data;
-    double* p1 = p0 + templ.cols*cn;
-    double* p2 = (double*)(sum.data + templ.rows*sum.step);
-    double* p3 = p2 + templ.cols*cn;
-
-    int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
-    int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
-
-    int i, j, k;
-
-    for( i = 0; i < result.rows; i++ )
-    {
-        float* rrow = result.ptr<float>(i);
-        int idx = i * sumstep;
-        int idx2 = i * sqstep;
-
-        for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
-        {
-            double num = rrow[j], t;
-            double wndMean2 = 0, wndSum2 = 0;
-
-            if( numType == 1 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
-                    wndMean2 += t*t;
-                    num -= t*templMean[k];
-                }
-
-                wndMean2 *= invArea;
-            }
-
-            if( isNormed || numType == 2 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
-                    wndSum2 += t;
-                }
+    parallel_for_(Range(0, result.rows),
+                  MatchTemplateNormalize_Invoker(sum, sqsum, templ.size(), result, method, cn,
+                                                 templMean, templNorm, templSum2),
+                  result.total()/(double)(1 << 16));
+}
 
-                if( numType == 2 )
-                {
-                    num = wndSum2 - 2*num + templSum2;
-                    num = MAX(num, 0.);
-                }
-            }
+static void common_matchTemplate( Mat& img, Mat& templ, Mat& result, int method, int cn )
+{
+    if( method == CV_TM_CCORR )
+        return;
 
-            if( isNormed )
-            {
-                t = std::sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
-                if( fabs(num) < t )
-                    num /= t;
-                else if( fabs(num) < t*1.125 )
-                    num = num > 0 ? 1 : -1;
-                else
-                    num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
-            }
+    Mat sum, sqsum;
+    if( method == CV_TM_CCOEFF )
+        integral(img, sum, CV_64F);
+    else
+        integral(img, sum, sqsum, CV_64F);
 
-            rrow[j] = (float)num;
-        }
-    }
+    matchTemplateNormalize(sum, sqsum, templ, result, method, cn);
 }
 }
 
@@ -1125,11 +1535,69 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
 
     CV_IPP_RUN_FAST(ipp_matchTemplate(img, templ, result, method))
 
-    crossCorr( img, templ, result, result.size(), result.type(), Point(0,0), 0, 0);
+    if( useDirectCrossCorr(img.size(), templ.size(), depth, cn) )
+        crossCorrDirect( img, templ, result );
+    else
+        crossCorr( img, templ, result, result.size(), result.type(), Point(0,0), 0, 0);
 
     common_matchTemplate(img, templ, result, method, cn);
 }
 
+void cv::matchTemplateBatch( InputArray _img, InputArrayOfArrays _templs, OutputArrayOfArrays _results, int method )
+{
+    CV_INSTRUMENT_REGION()
+
+    int type = _img.type(), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    CV_Assert( CV_TM_SQDIFF <= method && method <= CV_TM_CCOEFF_NORMED );
+    CV_Assert( (depth == CV_8U || depth == CV_32F) && _img.dims() <= 2 );
+
+    Mat img = _img.getMat();
+    std::vector<Mat> templs;
+    _templs.getMatVector(templs);
+    int i, ntempl = (int)templs.size();
+
+    if( ntempl == 0 )
+    {
+        _results.clear();
+        return;
+    }
+
+    std::vector<Mat> results(ntempl), dftTempls, dftResults;
+    _results.create(ntempl, 1, CV_32F, -1, true);
+    for( i = 0; i < ntempl; i++ )
+    {
+        const Mat& templ = templs[i];
+        CV_Assert( templ.type() == type && templ.dims <= 2 &&
+                   templ.rows <= img.rows && templ.cols <= img.cols );
+
+        _results.create(img.rows - templ.rows + 1, img.cols - templ.cols + 1, CV_32F, i, true);
+        results[i] = _results.getMat(i);
+
+        if( useDirectCrossCorr(img.size(), templ.size(), depth, cn) )
+            crossCorrDirect( img, templ, results[i] );
+        else
+        {
+            dftTempls.push_back(templ);
+            dftResults.push_back(results[i]);
+        }
+    }
+
+    if( !dftTempls.empty() )
+        crossCorrBatch( img, dftTempls, dftResults );
+
+    if( method != CV_TM_CCORR )
+    {
+        Mat sum, sqsum;
+        if( method == CV_TM_CCOEFF )
+            integral(img, sum, CV_64F);
+        else
+            integral(img, sum, sqsum, CV_64F);
+
+        for( i = 0; i < ntempl; i++ )
+            matchTemplateNormalize(sum, sqsum, templs[i], results[i], method, cn);
+    }
+}
+
 CV_IMPL void
 cvMatchTemplate( const CvArr* _img, const CvArr* _templ, CvArr* _result, int method )
 {
@@ -2021,6 +2021,67 @@ TEST(Imgproc_ColorBayerVNG_Strict, regression)
     }
 }
 
+static Mat makeBayerTestImage(Size size, int depth, RNG& rng)
+{
+    // smooth content, so that the gradients select a few directions only
+    Mat small(size.height/8 + 2, size.width/8 + 2, CV_8U), bayer8, bayer;
+    rng.fill(small, RNG::UNIFORM, 0, 256);
+    resize(small, bayer8, size, 0, 0, INTER_CUBIC);
+    bayer8.convertTo(bayer, depth, depth == CV_16U ? 256 : 1);
+    return bayer;
+}
+
+TEST(Imgproc_ColorBayerVNG, 16u)
+{
+    RNG& rng = theRNG();
+
+    for (int iter = 0; iter < 20; iter++)
+    {
+        Size size(rng.uniform(8, 200), rng.uniform(8, 100));
+        int code = COLOR_BayerBG2BGR_VNG + iter % 4;
+        Mat bayer8 = makeBayerTestImage(size, CV_8U, rng), bayer16, dst8, dst16;
+
+        // with 8-bit values the 16-bit path computes the very same gradients and sums;
+        // the 8-bit SIMD code uses a slightly different scale for 7 directions
+        bayer8.convertTo(bayer16, CV_16U);
+        cvtColor(bayer8, dst8, code);
+        cvtColor(bayer16, dst16, code);
+        ASSERT_EQ(CV_16UC3, dst16.type());
+        dst16.convertTo(dst16, CV_8U);
+        EXPECT_LE(cvtest::norm(dst8, dst16, NORM_INF), 1.) << "size: " << size << ", code: " << code;
+
+        // full 16-bit range; thresholds are rounded a bit differently than for 8u
+        bayer8.convertTo(bayer16, CV_16U, 256);
+        cvtColor(bayer16, dst16, code);
+        dst8.convertTo(dst8, CV_16U, 256);
+        EXPECT_LE(cvtest::norm(dst8, dst16, NORM_L1) / dst16.total() / 3, 256.) << "size: " << size << ", code: " << code;
+    }
+}
+
+TEST(Imgproc_ColorBayer, threads)
+{
+    const int codes[] = { COLOR_BayerBG2BGR_VNG, COLOR_BayerGB2BGR_VNG, COLOR_BayerRG2BGR_VNG, COLOR_BayerGR2BGR_VNG,
+                          COLOR_BayerBG2BGR_EA, COLOR_BayerGB2BGR_EA, COLOR_BayerRG2BGR_EA, COLOR_BayerGR2BGR_EA };
+    RNG& rng = theRNG();
+    int nthreads = getNumThreads();
+
+    for (int iter = 0; iter < 16; iter++)
+    {
+        Size size(rng.uniform(100, 400), rng.uniform(200, 600));
+        int depth = iter % 2 == 0 ? CV_8U : CV_16U;
+        int code = codes[(iter / 2) % 8];
+        Mat bayer = makeBayerTestImage(size, depth, rng), dst1, dst4;
+
+        setNumThreads(1);
+        cvtColor(bayer, dst1, code);
+        setNumThreads(4);
+        cvtColor(bayer, dst4, code);
+        setNumThreads(nthreads);
+
+        EXPECT_EQ(0, cvtest::norm(dst1, dst4, NORM_INF)) << "size: " << size << ", depth: " << depth << ", code: " << code;
+    }
+}
+
 static void getTestMatrix(Mat& src)
 {
     Size ssize(1000, 1000);
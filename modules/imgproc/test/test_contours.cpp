@@ -485,4 +485,42 @@ TEST(Imgproc_FindContours, border)
     ASSERT_TRUE(norm(img - img_draw_contours, NORM_INF) == 0.0);
 }
 
+TEST(Imgproc_FindContours, parallel_bands)
+{
+    RNG& rng = theRNG();
+    Mat img = Mat::zeros(2000, 1100, CV_8U);
+    for( int i = 0; i < 3000; i++ )
+    {
+        Point center(rng.uniform(0, img.cols), rng.uniform(0, img.rows));
+        Size axes(rng.uniform(1, 30), rng.uniform(1, 30));
+        ellipse(img, center, axes, rng.uniform(0, 180), 0, 360, Scalar::all(rng.uniform(1, 256)), rng.uniform(-1, 4));
+    }
+    // empty rows let the image be split into independent bands
+    for( int y = 0; y < img.rows; y += 64 )
+        img.row(y).setTo(Scalar::all(0));
+
+    int nthreads = getNumThreads();
+    const int modes[] = { RETR_EXTERNAL, RETR_LIST };
+    const int methods[] = { CHAIN_APPROX_NONE, CHAIN_APPROX_SIMPLE, CHAIN_APPROX_TC89_KCOS };
+    for( int m = 0; m < 2; m++ )
+        for( int k = 0; k < 3; k++ )
+        {
+            vector<vector<Point> > ref, dst;
+            vector<Vec4i> refHierarchy, dstHierarchy;
+
+            setNumThreads(1);
+            findContours(img, ref, refHierarchy, modes[m], methods[k], Point(3, -2));
+            setNumThreads(4);
+            findContours(img, dst, dstHierarchy, modes[m], methods[k], Point(3, -2));
+            setNumThreads(nthreads);
+
+            ASSERT_EQ(ref.size(), dst.size());
+            for( size_t i = 0; i < ref.size(); i++ )
+                ASSERT_TRUE(ref[i] == dst[i]) << "contour " << i;
+            ASSERT_EQ(refHierarchy.size(), dstHierarchy.size());
+            for( size_t i = 0; i < refHierarchy.size(); i++ )
+                ASSERT_EQ(refHierarchy[i], dstHierarchy[i]) << "hierarchy " << i;
+        }
+}
+
 /* End of file. */
@@ -724,3 +724,58 @@ INSTANTIATE_TEST_CASE_P(cvt422, Imgproc_ColorYUV,
                       (int)CV_YUV2RGB_YUY2, (int)CV_YUV2BGR_YUY2, (int)CV_YUV2RGB_YVYU, (int)CV_YUV2BGR_YVYU,
                       (int)CV_YUV2RGBA_YUY2, (int)CV_YUV2BGRA_YUY2, (int)CV_YUV2RGBA_YVYU, (int)CV_YUV2BGRA_YVYU,
                       (int)CV_YUV2GRAY_UYVY, (int)CV_YUV2GRAY_YUY2));
+
+typedef ::testing::TestWithParam<int> Imgproc_ColorYUV2Planar;
+
+TEST_P(Imgproc_ColorYUV2Planar, accuracy)
+{
+    int code = GetParam();
+    bool is422 = code == COLOR_YUV2RGB_UYVY || code == COLOR_YUV2BGR_UYVY || code == COLOR_YUV2RGB_YUY2 ||
+                 code == COLOR_YUV2BGR_YUY2 || code == COLOR_YUV2RGB_YVYU || code == COLOR_YUV2BGR_YVYU;
+    RNG& random = theRNG();
+    Scalar mean(127.5, 100, 50), scale(1/255., 1/128., 2);
+
+    for(int iter = 0; iter < 30; ++iter)
+    {
+        Size sz(random.uniform(1, 321) * 2, random.uniform(1, 241) * 2);
+        Mat src = is422 ? Mat(sz, CV_8UC2) : Mat(sz.height * 3 / 2, sz.width, CV_8UC1);
+        random.fill(src, RNG::UNIFORM, 0, 256);
+
+        Rect roi;
+        if (iter % 3 != 0)
+        {
+            roi.x = random.uniform(0, sz.width);
+            roi.y = random.uniform(0, sz.height);
+            roi.width = random.uniform(1, sz.width - roi.x + 1);
+            roi.height = random.uniform(1, sz.height - roi.y + 1);
+        }
+
+        Mat gold;
+        cvtColor(src, gold, code);
+        if (roi.area() > 0)
+            gold = gold(roi);
+
+        Mat dst;
+        cvtColorYUV2Planar(src, dst, code, roi, mean, scale);
+        ASSERT_EQ(4, dst.dims);
+        ASSERT_EQ(3, dst.size[1]);
+        ASSERT_EQ(gold.rows, dst.size[2]);
+        ASSERT_EQ(gold.cols, dst.size[3]);
+
+        for (int c = 0; c < 3; c++)
+        {
+            Mat plane(gold.size(), CV_32F, dst.ptr<float>(0, c)), expected;
+            extractChannel(gold, expected, c);
+            expected.convertTo(expected, CV_32F, scale[c], -mean[c] * scale[c]);
+            // cvtColor rounds the result to 8 bits
+            EXPECT_LE(cvtest::norm(plane, expected, NORM_INF), (0.5 + 1e-3) * scale[c])
+                << "iter=" << iter << " channel=" << c;
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(Imgproc, Imgproc_ColorYUV2Planar,
+    ::testing::Values((int)COLOR_YUV2RGB_NV12, (int)COLOR_YUV2BGR_NV12, (int)COLOR_YUV2RGB_NV21, (int)COLOR_YUV2BGR_NV21,
+                      (int)COLOR_YUV2RGB_YV12, (int)COLOR_YUV2BGR_YV12, (int)COLOR_YUV2RGB_IYUV, (int)COLOR_YUV2BGR_IYUV,
+                      (int)COLOR_YUV2RGB_UYVY, (int)COLOR_YUV2BGR_UYVY, (int)COLOR_YUV2RGB_YUY2, (int)COLOR_YUV2BGR_YUY2,
+                      (int)COLOR_YUV2RGB_YVYU, (int)COLOR_YUV2BGR_YVYU));
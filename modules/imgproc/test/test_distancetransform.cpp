@@ -283,3 +283,188 @@ void CV_DisTransTest::prepare_to_validation( int /*test_case_idx*/ )
 
 
 TEST(Imgproc_DistanceTransform, accuracy) { CV_DisTransTest test; test.safe_run(); }
+
+static Mat makeDistTransSource(Size size, double zeroRatio, RNG& rng)
+{
+    Mat src(size, CV_8U), noise(size, CV_32F);
+    rng.fill(noise, RNG::UNIFORM, 0., 1.);
+    src.setTo(Scalar::all(255));
+    src.setTo(Scalar::all(0), noise < zeroRatio);
+    return src;
+}
+
+TEST(Imgproc_DistanceTransform, parallel_masks)
+{
+    RNG& rng = theRNG();
+    const int distTypes[] = { DIST_L1, DIST_L2, DIST_C };
+    const int maskSizes[] = { DIST_MASK_3, DIST_MASK_5 };
+    const double ratios[] = { 0.0001, 0.01, 0.3 };
+    int nthreads = getNumThreads();
+
+    for (int r = 0; r < 3; r++)
+    {
+        Mat src = makeDistTransSource(Size(401, 307), ratios[r], rng);
+        src.at<uchar>(150, 200) = 0;
+        for (int d = 0; d < 3; d++)
+            for (int m = 0; m < 2; m++)
+            {
+                SCOPED_TRACE(cv::format("ratio=%g distType=%d maskSize=%d", ratios[r], distTypes[d], maskSizes[m]));
+                Mat dst[2];
+                for (int i = 0; i < 2; i++)
+                {
+                    setNumThreads(i == 0 ? 1 : 4);
+                    distanceTransform(src, dst[i], distTypes[d], maskSizes[m]);
+                }
+                setNumThreads(nthreads);
+                EXPECT_EQ(0, cvtest::norm(dst[0], dst[1], NORM_INF));
+            }
+    }
+}
+
+TEST(Imgproc_DistanceTransform, parallel_no_zeros)
+{
+    // no pixel is reached from a zero one, the result is the same as with the sequential scans
+    Mat src(307, 401, CV_8U, Scalar::all(255));
+    const int maskSizes[] = { DIST_MASK_3, DIST_MASK_5 };
+    int nthreads = getNumThreads();
+
+    for (int m = 0; m < 2; m++)
+    {
+        SCOPED_TRACE(cv::format("maskSize=%d", maskSizes[m]));
+        Mat dst[2];
+        for (int i = 0; i < 2; i++)
+        {
+            setNumThreads(i == 0 ? 1 : 4);
+            distanceTransform(src, dst[i], DIST_L2, maskSizes[m]);
+        }
+        setNumThreads(nthreads);
+        EXPECT_EQ(0, cvtest::norm(dst[0], dst[1], NORM_INF));
+    }
+}
+
+TEST(Imgproc_DistanceTransform, precise_labels)
+{
+    RNG& rng = theRNG();
+    Mat src = makeDistTransSource(Size(67, 53), 0.01, rng);
+    src.at<uchar>(20, 30) = 0;
+
+    for (int labelType = DIST_LABEL_CCOMP; labelType <= DIST_LABEL_PIXEL; labelType++)
+    {
+        SCOPED_TRACE(cv::format("labelType=%d", labelType));
+        Mat dst, labels, dstRef;
+        distanceTransform(src, dst, labels, DIST_L2, DIST_MASK_PRECISE, labelType);
+        distanceTransform(src, dstRef, DIST_L2, DIST_MASK_PRECISE);
+        EXPECT_LE(cvtest::norm(dst, dstRef, NORM_INF), 1e-5);
+
+        Mat zeroLabels;
+        if (labelType == DIST_LABEL_CCOMP)
+            connectedComponents(src == 0, zeroLabels, 8, CV_32S, CCL_WU);
+
+        int k = 0;
+        vector<Point> zeros;
+        vector<int> zeroLabel;
+        for (int y = 0; y < src.rows; y++)
+            for (int x = 0; x < src.cols; x++)
+                if (src.at<uchar>(y, x) == 0)
+                {
+                    zeros.push_back(Point(x, y));
+                    zeroLabel.push_back(labelType == DIST_LABEL_PIXEL ? ++k : zeroLabels.at<int>(y, x));
+                }
+
+        for (int y = 0; y < src.rows; y++)
+            for (int x = 0; x < src.cols; x++)
+            {
+                double best = DBL_MAX;
+                for (size_t i = 0; i < zeros.size(); i++)
+                    best = std::min(best, norm(zeros[i] - Point(x, y)));
+                ASSERT_NEAR(best, dst.at<float>(y, x), 1e-3) << "at (" << x << ", " << y << ")";
+
+                // the label belongs to one of the closest zero pixels
+                int label = labels.at<int>(y, x);
+                bool found = false;
+                for (size_t i = 0; i < zeros.size() && !found; i++)
+                    found = zeroLabel[i] == label && std::abs(norm(zeros[i] - Point(x, y)) - best) < 1e-3;
+                ASSERT_TRUE(found) << "at (" << x << ", " << y << ")";
+            }
+    }
+}
+
+TEST(Imgproc_DistanceTransform, precise_labels_threads)
+{
+    Mat src = makeDistTransSource(Size(640, 480), 0.001, theRNG());
+    Mat dst[2], labels[2];
+    int nthreads = getNumThreads();
+    for (int i = 0; i < 2; i++)
+    {
+        setNumThreads(i == 0 ? 1 : 4);
+        distanceTransform(src, dst[i], labels[i], DIST_L2, DIST_MASK_PRECISE, DIST_LABEL_PIXEL);
+    }
+    setNumThreads(nthreads);
+    EXPECT_EQ(0, cvtest::norm(dst[0], dst[1], NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(labels[0], labels[1], NORM_INF));
+}
+
+TEST(Imgproc_DistanceTransform, precise_labels_roi)
+{
+    Mat src = makeDistTransSource(Size(64, 64), 0.01, theRNG());
+    for (int labelType = DIST_LABEL_CCOMP; labelType <= DIST_LABEL_PIXEL; labelType++)
+    {
+        SCOPED_TRACE(cv::format("labelType=%d", labelType));
+        Mat dst, labels;
+        distanceTransform(src, dst, labels, DIST_L2, DIST_MASK_PRECISE, labelType);
+
+        Mat bigDst(80, 100, CV_32F, Scalar::all(-1)), bigLabels(80, 100, CV_32S, Scalar::all(-1));
+        Mat dstRoi = bigDst(Rect(10, 5, 64, 64)), labelsRoi = bigLabels(Rect(20, 3, 64, 64));
+        distanceTransform(src, dstRoi, labelsRoi, DIST_L2, DIST_MASK_PRECISE, labelType);
+        ASSERT_EQ(bigLabels.data, labelsRoi.datastart);
+
+        EXPECT_EQ(0, cvtest::norm(dst, dstRoi, NORM_INF));
+        EXPECT_EQ(0, cvtest::norm(labels, labelsRoi, NORM_INF));
+        // nothing is written outside of the ROI
+        EXPECT_EQ(80*100 - 64*64, countNonZero(bigLabels == -1));
+    }
+}
+
+TEST(Imgproc_DistanceTransform, volume)
+{
+    RNG& rng = theRNG();
+    int sizes[] = { 9, 13, 17 };
+    Mat src(3, sizes, CV_8U);
+    rng.fill(src, RNG::UNIFORM, 0, 40);
+    const Vec3f spacing(0.7f, 0.8f, 2.5f);
+
+    vector<Point3i> zeros;
+    for (int z = 0; z < sizes[0]; z++)
+        for (int y = 0; y < sizes[1]; y++)
+            for (int x = 0; x < sizes[2]; x++)
+                if (src.at<uchar>(z, y, x) == 0)
+                    zeros.push_back(Point3i(x, y, z));
+    ASSERT_FALSE(zeros.empty());
+
+    for (int distType = DIST_L1; distType <= DIST_L2; distType++)
+    {
+        SCOPED_TRACE(cv::format("distType=%d", distType));
+        Mat dst;
+        distanceTransform3D(src, dst, distType, spacing);
+        ASSERT_EQ(CV_32F, dst.type());
+        ASSERT_EQ(3, dst.dims);
+
+        double maxErr = 0;
+        for (int z = 0; z < sizes[0]; z++)
+            for (int y = 0; y < sizes[1]; y++)
+                for (int x = 0; x < sizes[2]; x++)
+                {
+                    double best = DBL_MAX;
+                    for (size_t i = 0; i < zeros.size(); i++)
+                    {
+                        double dx = (zeros[i].x - x)*spacing[0], dy = (zeros[i].y - y)*spacing[1],
+                               dz = (zeros[i].z - z)*spacing[2];
+                        double d = distType == DIST_L1 ? std::abs(dx) + std::abs(dy) + std::abs(dz) :
+                                                         std::sqrt(dx*dx + dy*dy + dz*dz);
+                        best = std::min(best, d);
+                    }
+                    maxErr = std::max(maxErr, std::abs(best - dst.at<float>(z, y, x)));
+                }
+        EXPECT_LE(maxErr, 1e-3);
+    }
+}
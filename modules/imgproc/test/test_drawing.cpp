@@ -751,4 +751,99 @@ TEST(Drawing, putText_no_garbage)
 
 
 
+TEST(Drawing, batch_identical_to_sequential)
+{
+    const int types[] = { CV_8UC3, CV_8UC1, CV_8UC4, CV_16UC3, CV_32FC1 };
+    RNG rng(0x7531);
+    int nthreads = getNumThreads();
+
+    for (int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++)
+    {
+        Size sz(rng.uniform(300, 700), rng.uniform(200, 500));
+        Mat seq(sz, types[t]), bat;
+        rng.fill(seq, RNG::UNIFORM, Scalar::all(0), Scalar::all(200));
+        seq.copyTo(bat);
+
+        DrawingBatch batch;
+        for (int i = 0; i < 400; i++)
+        {
+            Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+            const int lineTypes[] = { LINE_4, LINE_8, LINE_AA };
+            int lineType = lineTypes[rng.uniform(0, 3)];
+            int shift = rng.uniform(0, 3) == 0 ? rng.uniform(1, 4) : 0;
+            int scale = 1 << shift;
+            int thickness = rng.uniform(0, 4) == 0 ? rng.uniform(2, 12) : 1;
+            // the shapes may span several bands or cross the image borders
+            Point p1(rng.uniform(-50, sz.width + 50)*scale + rng.uniform(0, scale),
+                     rng.uniform(-50, sz.height + 50)*scale + rng.uniform(0, scale));
+            Point p2 = p1 + Point(rng.uniform(-150, 150)*scale, rng.uniform(-150, 150)*scale);
+            std::vector<Point> poly;
+            for (int k = rng.uniform(3, 8); k > 0; k--)
+                poly.push_back(p1 + Point(rng.uniform(-100, 100)*scale, rng.uniform(-100, 100)*scale));
+            std::vector<std::vector<Point> > polys(1, poly);
+
+            switch (rng.uniform(0, 6))
+            {
+            case 0:
+                line(seq, p1, p2, color, thickness, lineType, shift);
+                batch.line(p1, p2, color, thickness, lineType, shift);
+                break;
+            case 1:
+                if (rng.uniform(0, 2))
+                    thickness = FILLED;
+                rectangle(seq, p1, p2, color, thickness, lineType, shift);
+                batch.rectangle(p1, p2, color, thickness, lineType, shift);
+                break;
+            case 2:
+            {
+                if (rng.uniform(0, 2))
+                    thickness = FILLED;
+                int radius = rng.uniform(0, 80)*scale;
+                circle(seq, p1, radius, color, thickness, lineType, shift);
+                batch.circle(p1, radius, color, thickness, lineType, shift);
+                break;
+            }
+            case 3:
+            {
+                bool isClosed = rng.uniform(0, 2) != 0;
+                polylines(seq, polys, isClosed, color, thickness, lineType, shift);
+                batch.polylines(polys, isClosed, color, thickness, lineType, shift);
+                break;
+            }
+            case 4:
+            {
+                Point offset(rng.uniform(-20, 20), rng.uniform(-20, 20));
+                fillPoly(seq, polys, color, lineType, shift, offset);
+                batch.fillPoly(polys, color, lineType, shift, offset);
+                break;
+            }
+            default:
+            {
+                std::vector<Point> hull;
+                convexHull(poly, hull);
+                fillConvexPoly(seq, hull, color, lineType, shift);
+                batch.fillConvexPoly(hull, color, lineType, shift);
+            }
+            }
+        }
+
+        setNumThreads(4);
+        batch.draw(bat);
+        setNumThreads(nthreads);
+
+        EXPECT_EQ(400u, batch.size());
+        EXPECT_EQ(0, cvtest::norm(seq, bat, NORM_INF)) << "type: " << types[t];
+    }
+}
+
+TEST(Drawing, batch_rejects_zero_thickness)
+{
+    DrawingBatch batch;
+    std::vector<Point> poly(3, Point(10, 10));
+    EXPECT_THROW(batch.line(Point(0, 0), Point(10, 10), Scalar::all(255), 0), cv::Exception);
+    EXPECT_THROW(batch.polylines(poly, true, Scalar::all(255), 0), cv::Exception);
+    EXPECT_EQ(0u, batch.size());
+}
+
+
 } // namespace
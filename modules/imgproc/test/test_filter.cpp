@@ -2098,3 +2098,115 @@ TEST(Imgproc_MorphEx, hitmiss_zero_kernel)
 
     ASSERT_DOUBLE_EQ(norm(dst, src, NORM_INF), 0.);
 }
+
+TEST(Imgproc_Integral, parallel)
+{
+    const int types[][3] = {
+        { CV_8UC1, CV_32S, CV_64F }, { CV_8UC1, CV_32F, CV_64F }, { CV_8UC1, CV_64F, CV_64F },
+        { CV_8UC3, CV_32S, CV_32S }, { CV_8UC4, CV_32F, CV_32F }, { CV_16UC1, CV_64F, CV_64F },
+        { CV_32FC1, CV_32F, CV_64F }, { CV_32FC2, CV_64F, CV_64F }, { CV_64FC1, CV_64F, CV_64F }
+    };
+    int nthreads = getNumThreads();
+    RNG& rng = theRNG();
+
+    for( size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++ )
+    {
+        Mat src(601, 713, types[i][0]);
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+
+        Mat refSum, refSqsum, dstSum, dstSqsum;
+        setNumThreads(1);
+        integral(src, refSum, refSqsum, types[i][1], types[i][2]);
+        setNumThreads(4);
+        integral(src, dstSum, dstSqsum, types[i][1], types[i][2]);
+        setNumThreads(nthreads);
+
+        EXPECT_EQ(0., cvtest::norm(refSum, dstSum, NORM_INF)) << "type index " << i;
+        EXPECT_EQ(0., cvtest::norm(refSqsum, dstSqsum, NORM_INF)) << "type index " << i;
+    }
+}
+
+template<typename T> static void
+test_rankFilter( const Mat& src, Mat& dst, int ksize, int rank )
+{
+    int r = ksize/2, cn = src.channels();
+    Mat bsrc;
+    copyMakeBorder(src, bsrc, r, r, r, r, BORDER_REPLICATE);
+    dst.create(src.size(), src.type());
+    vector<T> buf(ksize*ksize);
+    for( int y = 0; y < src.rows; y++ )
+        for( int x = 0; x < src.cols; x++ )
+            for( int c = 0; c < cn; c++ )
+            {
+                for( int i = 0; i < ksize; i++ )
+                    for( int j = 0; j < ksize; j++ )
+                        buf[i*ksize + j] = bsrc.ptr<T>(y + i)[(x + j)*cn + c];
+                std::nth_element(buf.begin(), buf.begin() + rank, buf.end());
+                dst.ptr<T>(y)[x*cn + c] = buf[rank];
+            }
+}
+
+static void test_rankFilter( const Mat& src, Mat& dst, int ksize, int rank )
+{
+    switch( src.depth() )
+    {
+    case CV_8U: test_rankFilter<uchar>(src, dst, ksize, rank); break;
+    case CV_16U: test_rankFilter<ushort>(src, dst, ksize, rank); break;
+    case CV_16S: test_rankFilter<short>(src, dst, ksize, rank); break;
+    case CV_32F: test_rankFilter<float>(src, dst, ksize, rank); break;
+    default: CV_Error(CV_StsUnsupportedFormat, "");
+    }
+}
+
+TEST(Imgproc_MedianBlur, large_ksize_16u_16s_32f)
+{
+    RNG& rng = theRNG();
+    int types[] = { CV_16UC1, CV_16SC1, CV_32FC1, CV_16UC3, CV_32FC4 };
+    int ksizes[] = { 7, 9, 15 };
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int k = 0; k < (int)(sizeof(ksizes)/sizeof(ksizes[0])); k++ )
+        {
+            Mat src(rng.uniform(20, 150), rng.uniform(20, 150), types[t]);
+            if( CV_MAT_DEPTH(types[t]) == CV_32F )
+                rng.fill(src, RNG::UNIFORM, -1000, 1000);
+            else
+                rng.fill(src, RNG::UNIFORM, -70000, 70000);
+            // narrow value range to get repeating values
+            if( k == 1 )
+                src.convertTo(src, -1, 1./256);
+
+            Mat dst, ref;
+            medianBlur(src, dst, ksizes[k]);
+            test_rankFilter(src, ref, ksizes[k], ksizes[k]*ksizes[k]/2);
+            EXPECT_EQ(0, cvtest::norm(dst, ref, NORM_INF))
+                << "type=" << types[t] << " ksize=" << ksizes[k];
+        }
+}
+
+TEST(Imgproc_RankFilter, accuracy)
+{
+    RNG& rng = theRNG();
+    int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_16SC1, CV_32FC1 };
+    double percentiles[] = { 0, 10, 50, 75, 100 };
+    int nthreads = getNumThreads();
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int p = 0; p < (int)(sizeof(percentiles)/sizeof(percentiles[0])); p++ )
+        {
+            int ksize = 2*rng.uniform(1, 6) + 1;
+            Mat src(rng.uniform(100, 300), rng.uniform(10, 100), types[t]);
+            rng.fill(src, RNG::UNIFORM, -1000, 1000);
+
+            Mat ref;
+            test_rankFilter(src, ref, ksize, cvRound(percentiles[p]*0.01*(ksize*ksize - 1)));
+            for( int threads = 1; threads <= 4; threads += 3 )
+            {
+                setNumThreads(threads);
+                Mat dst;
+                rankFilter(src, dst, ksize, percentiles[p]);
+                EXPECT_EQ(0, cvtest::norm(dst, ref, NORM_INF))
+                    << "type=" << types[t] << " ksize=" << ksize << " percentile=" << percentiles[p]
+                    << " threads=" << threads;
+            }
+        }
+    setNumThreads(nthreads);
+}
@@ -542,4 +542,127 @@ TEST(Imgproc_FloodFill, maskValue)
     ASSERT_TRUE(norm(mask.rowRange(1, n-1).colRange(1, n-1), NORM_INF) == 1.);
 }
 
+static Mat makeFloodFillTestImage(Size size, int type, RNG& rng)
+{
+    Mat img(size, CV_8UC3, Scalar::all(0));
+    for (int i = 0; i < 60; i++)
+    {
+        Point center(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        Scalar color(rng.uniform(0, 4)*40, rng.uniform(0, 4)*40, rng.uniform(0, 4)*40);
+        if (i % 2 == 0)
+            circle(img, center, rng.uniform(2, size.width/6), color, -1);
+        else
+            rectangle(img, center, center + Point(rng.uniform(1, size.width/4), rng.uniform(1, 20)), color, -1);
+    }
+    // small variations for the range modes
+    Mat noise(size, CV_8UC3);
+    rng.fill(noise, RNG::UNIFORM, 0, 3);
+    img += noise;
+
+    if (CV_MAT_CN(type) == 1)
+        cvtColor(img, img, COLOR_BGR2GRAY);
+    img.convertTo(img, CV_MAT_DEPTH(type));
+    return img;
+}
+
+TEST(Imgproc_FloodFill, batch)
+{
+    RNG rng(12345);
+    const Size size(160, 120);
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32SC1, CV_32FC3 };
+    const int modes[] = { 0, FLOODFILL_FIXED_RANGE, 0, FLOODFILL_MASK_ONLY };
+
+    for (int ti = 0; ti < 4; ti++)
+        for (int mi = 0; mi < 4; mi++)
+        {
+            SCOPED_TRACE(cv::format("type=%d mode=%d", types[ti], mi));
+            Mat img = makeFloodFillTestImage(size, types[ti], rng);
+            bool useMask = mi >= 2;
+            Scalar diff = mi == 0 ? Scalar() : Scalar::all(2);
+            int flags = (mi % 2 == 0 ? 4 : 8) | (200 << 8) | modes[mi];
+
+            vector<Point> seeds;
+            vector<Scalar> vals;
+            for (int i = 0; i < 200; i++)
+            {
+                seeds.push_back(Point(rng.uniform(0, size.width), rng.uniform(0, size.height)));
+                vals.push_back(Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)));
+            }
+
+            Mat img0 = img.clone(), img1 = img.clone();
+            Mat mask0, mask1;
+            if (useMask)
+            {
+                mask0 = Mat::zeros(size.height + 2, size.width + 2, CV_8U);
+                rectangle(mask0, Point(40, 0), Point(42, size.height + 1), Scalar(1), -1);
+                mask1 = mask0.clone();
+            }
+
+            vector<int> areas0;
+            vector<Rect> rects0;
+            for (size_t i = 0; i < seeds.size(); i++)
+            {
+                Rect r;
+                areas0.push_back(floodFill(img0, mask0, seeds[i], vals[i], &r, diff, diff, flags));
+                rects0.push_back(r);
+            }
+
+            vector<int> areas1;
+            vector<Rect> rects1;
+            floodFillBatch(img1, mask1, seeds, vals, &areas1, &rects1, diff, diff, flags);
+
+            EXPECT_EQ(0, cvtest::norm(img0, img1, NORM_INF));
+            if (useMask)
+            {
+                EXPECT_EQ(0, cvtest::norm(mask0, mask1, NORM_INF));
+            }
+            EXPECT_TRUE(areas0 == areas1);
+            EXPECT_TRUE(rects0 == rects1);
+        }
+}
+
+TEST(Imgproc_FloodFill, parallel)
+{
+    RNG rng(54321);
+    const Size size(640, 480);
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32SC1, CV_32FC1 };
+    int nthreads = getNumThreads();
+    setNumThreads(4);
+
+    for (int ti = 0; ti < 4; ti++)
+        for (int mode = 0; mode < 3; mode++)
+        {
+            SCOPED_TRACE(cv::format("type=%d mode=%d", types[ti], mode));
+            Mat img = makeFloodFillTestImage(size, types[ti], rng);
+            Scalar diff = mode == 0 ? Scalar() : Scalar::all(3);
+            int flags = (mode == 1 ? 8 : 4) | (mode > 0 ? FLOODFILL_FIXED_RANGE : 0) |
+                        (mode == 2 ? FLOODFILL_MASK_ONLY : 0);
+            Mat mask0;
+            if (mode == 2)
+                mask0 = Mat::zeros(size.height + 2, size.width + 2, CV_8U);
+
+            for (int iter = 0; iter < 5; iter++)
+            {
+                Point seed(rng.uniform(0, size.width), rng.uniform(0, size.height));
+                Scalar val(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+                Mat img0 = img.clone(), img1 = img.clone();
+                Mat mask1 = mask0.clone();
+                Rect r0, r1;
+
+                int area0 = floodFill(img0, mask0, seed, val, &r0, diff, diff, flags);
+                int area1 = floodFill(img1, mask1, seed, val, &r1, diff, diff, flags | FLOODFILL_PARALLEL);
+
+                EXPECT_EQ(area0, area1);
+                EXPECT_EQ(r0, r1);
+                EXPECT_EQ(0, cvtest::norm(img0, img1, NORM_INF));
+                if (mode == 2)
+                {
+                    EXPECT_EQ(0, cvtest::norm(mask0, mask1, NORM_INF));
+                }
+            }
+        }
+
+    setNumThreads(nthreads);
+}
+
 /* End of file. */
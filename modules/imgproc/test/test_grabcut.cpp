@@ -41,6 +41,7 @@
 //M*/
 
 #include "test_precomp.hpp"
+#include "../src/gcgraph.hpp"
 
 #include <string>
 #include <iostream>
@@ -170,3 +171,187 @@ TEST(Imgproc_GrabCut, repeatability)
     EXPECT_EQ(0, countNonZero(mask_1 != mask_3));
     EXPECT_EQ(0, countNonZero(mask_2 != mask_3));
 }
+
+static Mat makeGrabCutImage(Mat& objects)
+{
+    RNG& rng = theRNG();
+    Mat img(240, 320, CV_8UC3);
+    rng.fill(img, RNG::NORMAL, Scalar(140, 110, 60), Scalar(20, 20, 20));
+    objects = Mat::zeros(img.size(), CV_8U);
+    circle(objects, Point(90, 120), 45, Scalar(255), FILLED);
+    rectangle(objects, Rect(200, 60, 80, 120), Scalar(255), FILLED);
+    Mat fg(img.size(), CV_8UC3);
+    rng.fill(fg, RNG::NORMAL, Scalar(40, 70, 200), Scalar(20, 20, 20));
+    fg.copyTo(img, objects);
+    return img;
+}
+
+TEST(Imgproc_GrabCut, regions_and_threads)
+{
+    theRNG().state = 0x12345;
+    Mat objects;
+    Mat img = makeGrabCutImage(objects);
+
+    // two separate uncertain windows, each of them is segmented independently
+    Mat initMask(img.size(), CV_8U, Scalar(GC_BGD));
+    initMask(Rect(30, 60, 120, 120)).setTo(GC_PR_FGD);
+    initMask(Rect(180, 40, 120, 160)).setTo(GC_PR_FGD);
+
+    int nthreads = getNumThreads();
+    Mat masks[3];
+    for (int i = 0; i < 3; i++)
+    {
+        setNumThreads(i == 0 ? 1 : 4);
+        theRNG().state = 0x54321;
+        Mat bgdModel, fgdModel;
+        masks[i] = initMask.clone();
+        grabCut(img, masks[i], Rect(), bgdModel, fgdModel, 3,
+                GC_INIT_WITH_MASK | (i == 2 ? GC_FLOAT_WEIGHTS : 0));
+    }
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, countNonZero(masks[0] != masks[1]));
+    EXPECT_LE(countNonZero(masks[0] != masks[2]), (int)(img.total() / 1000));
+
+    Mat fgd = (masks[0] & 1) * 255;
+    EXPECT_LE(countNonZero(fgd != objects), (int)(img.total() / 100));
+}
+
+// the likelihood of the color under the GMM stored in the model, computed as GrabCut does
+static double refGMM(const Mat& model, const Vec3d& color)
+{
+    const int componentsCount = 5;
+    const double* coefs = model.ptr<double>();
+    const double* mean = coefs + componentsCount;
+    const double* cov = mean + 3*componentsCount;
+
+    double res = 0;
+    for (int ci = 0; ci < componentsCount; ci++)
+    {
+        if (coefs[ci] <= 0)
+            continue;
+        const double* c = cov + 9*ci;
+        double dtrm = c[0]*(c[4]*c[8]-c[5]*c[7]) - c[1]*(c[3]*c[8]-c[5]*c[6]) + c[2]*(c[3]*c[7]-c[4]*c[6]);
+        double inv[3][3];
+        inv[0][0] =  (c[4]*c[8] - c[5]*c[7]) / dtrm;
+        inv[1][0] = -(c[3]*c[8] - c[5]*c[6]) / dtrm;
+        inv[2][0] =  (c[3]*c[7] - c[4]*c[6]) / dtrm;
+        inv[0][1] = -(c[1]*c[8] - c[2]*c[7]) / dtrm;
+        inv[1][1] =  (c[0]*c[8] - c[2]*c[6]) / dtrm;
+        inv[2][1] = -(c[0]*c[7] - c[1]*c[6]) / dtrm;
+        inv[0][2] =  (c[1]*c[5] - c[2]*c[4]) / dtrm;
+        inv[1][2] = -(c[0]*c[5] - c[2]*c[3]) / dtrm;
+        inv[2][2] =  (c[0]*c[4] - c[1]*c[3]) / dtrm;
+
+        const double* m = mean + 3*ci;
+        Vec3d diff(color[0] - m[0], color[1] - m[1], color[2] - m[2]);
+        double mult = diff[0]*(diff[0]*inv[0][0] + diff[1]*inv[1][0] + diff[2]*inv[2][0])
+                    + diff[1]*(diff[0]*inv[0][1] + diff[1]*inv[1][1] + diff[2]*inv[2][1])
+                    + diff[2]*(diff[0]*inv[0][2] + diff[1]*inv[1][2] + diff[2]*inv[2][2]);
+        res += coefs[ci] * (1.0f/sqrt(dtrm) * exp(-0.5f*mult));
+    }
+    return res;
+}
+
+// one graph cut over the whole image with the learned models, as GrabCut did before the graph
+// was split into the regions of the uncertain pixels
+static void refSegmentation(const Mat& img, Mat& mask, const Mat& bgdModel, const Mat& fgdModel)
+{
+    const double gamma = 50, lambda = 9*gamma, gammaDivSqrt2 = gamma / std::sqrt(2.0f);
+    const Point nbrs[] = { Point(-1, 0), Point(-1, -1), Point(0, -1), Point(1, -1) };
+
+    double beta = 0;
+    for (int y = 0; y < img.rows; y++)
+        for (int x = 0; x < img.cols; x++)
+            for (int k = 0; k < 4; k++)
+            {
+                Point q(x + nbrs[k].x, y + nbrs[k].y);
+                if (q.x < 0 || q.y < 0 || q.x >= img.cols)
+                    continue;
+                Vec3d diff = (Vec3d)img.at<Vec3b>(y, x) - (Vec3d)img.at<Vec3b>(q);
+                beta += diff.dot(diff);
+            }
+    beta = 1.f / (2 * beta/(4*img.cols*img.rows - 3*img.cols - 3*img.rows + 2));
+
+    GCGraph<double> graph(img.total(), 8*img.total());
+    for (int y = 0; y < img.rows; y++)
+        for (int x = 0; x < img.cols; x++)
+        {
+            int vtxIdx = graph.addVtx();
+            Vec3b color = img.at<Vec3b>(y, x);
+            uchar m = mask.at<uchar>(y, x);
+            if (m == GC_PR_BGD || m == GC_PR_FGD)
+                graph.addTermWeights(vtxIdx, -log(refGMM(bgdModel, color)), -log(refGMM(fgdModel, color)));
+            else
+                graph.addTermWeights(vtxIdx, m == GC_BGD ? 0 : lambda, m == GC_BGD ? lambda : 0);
+
+            for (int k = 0; k < 4; k++)
+            {
+                Point q(x + nbrs[k].x, y + nbrs[k].y);
+                if (q.x < 0 || q.y < 0 || q.x >= img.cols)
+                    continue;
+                Vec3d diff = (Vec3d)color - (Vec3d)img.at<Vec3b>(q);
+                double w = (k % 2 == 0 ? gamma : gammaDivSqrt2) * exp(-beta*diff.dot(diff));
+                graph.addEdges(vtxIdx, q.y*img.cols + q.x, w, w);
+            }
+        }
+
+    graph.maxFlow();
+    for (int y = 0; y < img.rows; y++)
+        for (int x = 0; x < img.cols; x++)
+        {
+            uchar& m = mask.at<uchar>(y, x);
+            if (m == GC_PR_BGD || m == GC_PR_FGD)
+                m = graph.inSourceSegment(y*img.cols + x) ? GC_PR_FGD : GC_PR_BGD;
+        }
+}
+
+TEST(Imgproc_GrabCut, regions_match_single_graph)
+{
+    theRNG().state = 0x12345;
+    Mat objects;
+    Mat img = makeGrabCutImage(objects);
+
+    // two uncertain windows, one of them with the fixed foreground seed inside
+    Mat mask(img.size(), CV_8U, Scalar(GC_BGD));
+    mask(Rect(30, 60, 120, 120)).setTo(GC_PR_FGD);
+    mask(Rect(180, 40, 120, 160)).setTo(GC_PR_FGD);
+    mask(Rect(80, 110, 20, 20)).setTo(GC_FGD);
+
+    Mat bgdModel, fgdModel;
+    theRNG().state = 0x54321;
+    grabCut(img, mask, Rect(), bgdModel, fgdModel, 1, GC_INIT_WITH_MASK);
+
+    // the iteration learns the models from the mask and cuts with them, the learned models
+    // are returned, so the same cut can be made with the single graph
+    Mat expected = mask.clone();
+    grabCut(img, mask, Rect(), bgdModel, fgdModel, 1, GC_EVAL);
+    refSegmentation(img, expected, bgdModel, fgdModel);
+
+    EXPECT_GT(countNonZero(mask == GC_PR_FGD), 0);
+    EXPECT_GT(countNonZero(mask == GC_PR_BGD), 0);
+    EXPECT_EQ(0, countNonZero(mask != expected));
+}
+
+TEST(Imgproc_GrabCut, rect_threads)
+{
+    theRNG().state = 0x12345;
+    Mat objects;
+    Mat img = makeGrabCutImage(objects);
+    Rect rect(20, 20, 290, 200);
+
+    int nthreads = getNumThreads();
+    Mat masks[2];
+    for (int i = 0; i < 2; i++)
+    {
+        setNumThreads(i == 0 ? 1 : 4);
+        theRNG().state = 0x54321;
+        Mat bgdModel, fgdModel;
+        grabCut(img, masks[i], rect, bgdModel, fgdModel, 3, GC_INIT_WITH_RECT);
+    }
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, countNonZero(masks[0] != masks[1]));
+    Mat fgd = (masks[0] & 1) * 255;
+    EXPECT_LE(countNonZero(fgd != objects), (int)(img.total() / 100));
+}
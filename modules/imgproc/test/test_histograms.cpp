@@ -1859,4 +1859,105 @@ TEST(Imgproc_Hist_CalcBackProject, accuracy) { CV_CalcBackProjectTest test; test
 TEST(Imgproc_Hist_CalcBackProjectPatch, accuracy) { CV_CalcBackProjectPatchTest test; test.safe_run(); }
 TEST(Imgproc_Hist_BayesianProb, accuracy) { CV_BayesianProbTest test; test.safe_run(); }
 
+TEST(Imgproc_Hist_Sliding, accuracy)
+{
+    RNG& rng = theRNG();
+    Mat img(240, 320, CV_8UC1);
+    rng.fill(img, RNG::UNIFORM, 0, 256);
+    GaussianBlur(img, img, Size(5, 5), 2);
+
+    const int histSizes[] = { 256, 30 };
+    const float ranges[][2] = { { 0.f, 256.f }, { 10.f, 200.5f } };
+
+    for (int k = 0; k < 2; k++)
+    {
+        Ptr<SlidingHistogram> sh = createSlidingHistogram(histSizes[k], ranges[k][0], ranges[k][1]);
+        sh->setImage(img);
+        const float* histRanges[] = { ranges[k] };
+        Rect r(10, 20, 40, 30);
+
+        for (int iter = 0; iter < 300; iter++)
+        {
+            if (iter % 50 == 49)
+                r = Rect(rng.uniform(0, 200), rng.uniform(0, 150), rng.uniform(1, 100), rng.uniform(1, 80));
+            else
+            {
+                // small moves, sometimes with resizing
+                r.x += rng.uniform(-3, 4);
+                r.y += rng.uniform(-3, 4);
+                if (iter % 7 == 0)
+                {
+                    r.width += rng.uniform(-2, 3);
+                    r.height += rng.uniform(-2, 3);
+                }
+            }
+            r.width = std::max(r.width, 1);
+            r.height = std::max(r.height, 1);
+            r &= Rect(0, 0, img.cols, img.rows);
+            sh->setWindow(r);
+            ASSERT_EQ(r, sh->getWindow());
+
+            Mat hist, hist0;
+            sh->getHist(hist);
+            Mat roi = img(r);
+            int channels[] = { 0 };
+            calcHist(&roi, 1, channels, Mat(), hist0, 1, &histSizes[k], histRanges);
+            ASSERT_EQ(0, cvtest::norm(hist, hist0, NORM_INF)) << "iter = " << iter;
+
+            double mean, stddev;
+            Scalar mean0, stddev0;
+            sh->getMeanStdDev(mean, stddev);
+            meanStdDev(roi, mean0, stddev0);
+            ASSERT_NEAR(mean0[0], mean, 1e-9);
+            ASSERT_NEAR(stddev0[0], stddev, 1e-6);
+        }
+    }
+}
+
+TEST(Imgproc_Hist_Sliding, calcWindows)
+{
+    RNG& rng = theRNG();
+    Mat img(480, 640, CV_8UC1);
+    rng.fill(img, RNG::UNIFORM, 0, 256);
+
+    vector<Rect> windows;
+    for (int y = 0; y + 32 <= img.rows; y += 3)
+        for (int x = 0; x + 48 <= img.cols; x += 5)
+            windows.push_back(Rect(x, y, 48, 32));
+    windows.push_back(Rect(100, 100, 1, 1));
+    windows.push_back(Rect(0, 0, img.cols, img.rows));
+
+    Ptr<SlidingHistogram> sh = createSlidingHistogram(64);
+    sh->setImage(img);
+    sh->setWindow(Rect(1, 2, 3, 4));
+
+    int nthreads = getNumThreads();
+    Mat hists[2], means[2], stddevs[2];
+    for (int i = 0; i < 2; i++)
+    {
+        setNumThreads(i == 0 ? 1 : 4);
+        sh->calcWindows(windows, hists[i], means[i], stddevs[i]);
+    }
+    setNumThreads(nthreads);
+
+    ASSERT_EQ((int)windows.size(), hists[0].rows);
+    ASSERT_EQ(64, hists[0].cols);
+    EXPECT_EQ(0, cvtest::norm(hists[0], hists[1], NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(means[0], means[1], NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(stddevs[0], stddevs[1], NORM_INF));
+    EXPECT_EQ(Rect(1, 2, 3, 4), sh->getWindow());
+
+    for (size_t i = 0; i < windows.size(); i += 97)
+    {
+        sh->setWindow(windows[i]);
+        Mat hist;
+        double mean, stddev;
+        sh->getHist(hist);
+        sh->getMeanStdDev(mean, stddev);
+        EXPECT_EQ(0, cvtest::norm(hist.t(), hists[0].row((int)i), NORM_INF));
+        EXPECT_EQ(mean, means[0].at<double>((int)i));
+        EXPECT_EQ(stddev, stddevs[0].at<double>((int)i));
+    }
+}
+
 /* End Of File */
@@ -219,3 +219,101 @@ INSTANTIATE_TEST_CASE_P( ImgProc, ProbabilisticHoughLinesTest, testing::Combine(
                                                                                 testing::Values( 0, 10 ),
                                                                                 testing::Values( 0, 4 )
                                                                                 ));
+
+static void referenceHoughLines(const Mat& img, float rho, float theta, int threshold, vector<Vec2f>& lines)
+{
+    int numangle = cvRound(CV_PI / theta);
+    int numrho = cvRound(((img.cols + img.rows) * 2 + 1) / rho);
+    Mat accum = Mat::zeros(numangle + 2, numrho + 2, CV_32S);
+    vector<float> tabSin(numangle), tabCos(numangle);
+    float irho = 1 / rho, ang = 0.f;
+    for (int n = 0; n < numangle; ang += theta, n++)
+    {
+        tabSin[n] = (float)(sin((double)ang) * irho);
+        tabCos[n] = (float)(cos((double)ang) * irho);
+    }
+    for (int i = 0; i < img.rows; i++)
+        for (int j = 0; j < img.cols; j++)
+            if (img.at<uchar>(i, j))
+                for (int n = 0; n < numangle; n++)
+                {
+                    int r = cvRound(j * tabCos[n] + i * tabSin[n]) + (numrho - 1) / 2;
+                    accum.at<int>(n + 1, r + 1)++;
+                }
+
+    vector<pair<int, int> > peaks; // (-votes, accumulator index)
+    for (int n = 1; n <= numangle; n++)
+        for (int r = 1; r <= numrho; r++)
+        {
+            int v = accum.at<int>(n, r);
+            if (v > threshold && v > accum.at<int>(n, r - 1) && v >= accum.at<int>(n, r + 1) &&
+                v > accum.at<int>(n - 1, r) && v >= accum.at<int>(n + 1, r))
+                peaks.push_back(make_pair(-v, n * (numrho + 2) + r));
+        }
+    std::sort(peaks.begin(), peaks.end());
+
+    lines.clear();
+    for (size_t k = 0; k < peaks.size(); k++)
+    {
+        int n = peaks[k].second / (numrho + 2) - 1;
+        int r = peaks[k].second - (n + 1) * (numrho + 2) - 1;
+        lines.push_back(Vec2f((r - (numrho - 1) * 0.5f) * rho, n * theta));
+    }
+}
+
+TEST(Imgproc_HoughLines, threads)
+{
+    RNG& rng = theRNG();
+    Mat img(480, 640, CV_8UC1, Scalar::all(0));
+    for (int k = 0; k < 20; k++)
+        line(img, Point(rng.uniform(0, img.cols), rng.uniform(0, img.rows)),
+             Point(rng.uniform(0, img.cols), rng.uniform(0, img.rows)), Scalar::all(255), 1);
+    for (int k = 0; k < 500; k++)
+        img.at<uchar>(rng.uniform(0, img.rows), rng.uniform(0, img.cols)) = 255;
+
+    const float rho = 1.f, theta = (float)(CV_PI / 180);
+    vector<Vec2f> ref;
+    referenceHoughLines(img, rho, theta, 60, ref);
+    ASSERT_FALSE(ref.empty());
+
+    int nthreads = getNumThreads();
+    int threads[] = { 1, 4 };
+    for (int t = 0; t < 2; t++)
+    {
+        setNumThreads(threads[t]);
+        vector<Vec2f> lines;
+        HoughLines(img, lines, rho, theta, 60);
+        ASSERT_EQ(ref.size(), lines.size()) << "threads=" << threads[t];
+        for (size_t k = 0; k < ref.size(); k++)
+        {
+            EXPECT_EQ(ref[k][0], lines[k][0]) << "line " << k;
+            EXPECT_EQ(ref[k][1], lines[k][1]) << "line " << k;
+        }
+    }
+    setNumThreads(nthreads);
+}
+
+TEST(Imgproc_HoughCircles, threads)
+{
+    Mat img(600, 800, CV_8UC1, Scalar::all(20));
+    circle(img, Point(200, 150), 60, Scalar::all(220), -1);
+    circle(img, Point(550, 200), 90, Scalar::all(160), -1);
+    circle(img, Point(400, 450), 40, Scalar::all(250), -1);
+    circle(img, Point(650, 480), 75, Scalar::all(120), 3);
+    GaussianBlur(img, img, Size(5, 5), 1.5);
+
+    int nthreads = getNumThreads();
+    setNumThreads(1);
+    vector<Vec3f> ref;
+    HoughCircles(img, ref, HOUGH_GRADIENT, 1, 50, 100, 30, 20, 120);
+    EXPECT_GE(ref.size(), 4u);
+
+    setNumThreads(4);
+    vector<Vec3f> circles;
+    HoughCircles(img, circles, HOUGH_GRADIENT, 1, 50, 100, 30, 20, 120);
+    setNumThreads(nthreads);
+
+    ASSERT_EQ(ref.size(), circles.size());
+    for (size_t k = 0; k < ref.size(); k++)
+        EXPECT_EQ(ref[k], circles[k]) << "circle " << k;
+}
@@ -1839,4 +1839,78 @@ TEST(Imgproc_logPolar, identity)
 }
 
 
+static void colorResizeNormalizeReference(const Mat& src, Mat& blob, Size dsize, int code,
+                                          const Scalar& mean, const Scalar& scale, int interpolation)
+{
+    Mat tmp;
+    if (code >= 0)
+        cvtColor(src, tmp, code);
+    else
+        tmp = src;
+    tmp.convertTo(tmp, CV_32F);
+    resize(tmp, tmp, dsize, 0, 0, interpolation);
+
+    int cn = tmp.channels();
+    int sz[] = { 1, cn, dsize.height, dsize.width };
+    blob.create(4, sz, CV_32F);
+    vector<Mat> planes(cn);
+    for (int c = 0; c < cn; c++)
+        planes[c] = Mat(dsize, CV_32F, blob.ptr<float>(0, c));
+    split(tmp, planes);
+    for (int c = 0; c < cn; c++)
+        planes[c] = (planes[c] - mean[c]) * scale[c];
+}
+
+TEST(Imgproc_ColorResizeNormalize, accuracy)
+{
+    struct
+    {
+        int type, code;
+        Size ssize, dsize;
+        int interpolation;
+    } cases[] =
+    {
+        { CV_8UC3, -1, Size(640, 480), Size(224, 224), INTER_LINEAR },
+        { CV_8UC3, COLOR_BGR2RGB, Size(640, 480), Size(320, 240), INTER_LINEAR },
+        { CV_8UC3, COLOR_BGR2RGB, Size(640, 480), Size(160, 120), INTER_AREA },
+        { CV_8UC3, COLOR_BGR2RGB, Size(640, 480), Size(300, 300), INTER_AREA },
+        { CV_8UC3, COLOR_BGR2GRAY, Size(333, 251), Size(512, 400), INTER_LINEAR },
+        { CV_8UC4, COLOR_BGRA2RGBA, Size(200, 150), Size(97, 61), INTER_NEAREST },
+        { CV_8UC1, COLOR_YUV2BGR_NV12, Size(640, 720), Size(300, 200), INTER_LINEAR },
+        { CV_8UC1, COLOR_YUV2RGB_I420, Size(640, 720), Size(320, 240), INTER_AREA },
+        { CV_8UC1, COLOR_YUV2RGBA_YV12, Size(320, 366), Size(640, 480), INTER_LINEAR },
+        { CV_8UC1, COLOR_YUV2GRAY_420, Size(320, 240), Size(100, 100), INTER_LINEAR },
+        { CV_8UC1, COLOR_BayerBG2BGR, Size(640, 480), Size(224, 224), INTER_LINEAR },
+        { CV_8UC1, COLOR_BayerGR2RGB_VNG, Size(320, 240), Size(160, 120), INTER_AREA },
+        { CV_16UC1, COLOR_BayerRG2BGR_EA, Size(320, 240), Size(200, 150), INTER_LINEAR },
+        { CV_32FC3, COLOR_BGR2RGB, Size(320, 240), Size(500, 400), INTER_AREA },
+    };
+
+    RNG& rng = theRNG();
+    Scalar mean(104, 117, 123, 50), scale(1/58., 1/57., 1/57.4, 0.5);
+    int nthreads = getNumThreads();
+    for (int i = 0; i < (int)(sizeof(cases)/sizeof(cases[0])); i++)
+    {
+        Mat src(cases[i].ssize, cases[i].type);
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+        GaussianBlur(src, src, Size(5, 5), 2);
+
+        Mat ref;
+        colorResizeNormalizeReference(src, ref, cases[i].dsize, cases[i].code, mean, scale, cases[i].interpolation);
+        for (int threads = 1; threads <= 4; threads += 3)
+        {
+            setNumThreads(threads);
+            Mat blob;
+            colorResizeNormalize(src, blob, cases[i].dsize, cases[i].code, mean, scale, cases[i].interpolation);
+            ASSERT_EQ(4, blob.dims);
+            ASSERT_EQ(CV_32F, blob.type());
+            for (int k = 0; k < 4; k++)
+                ASSERT_EQ(ref.size[k], blob.size[k]) << "case " << i;
+            EXPECT_LE(cvtest::norm(blob, ref, NORM_INF), 1e-3) << "case " << i << " threads=" << threads;
+        }
+    }
+    setNumThreads(nthreads);
+}
+
+
 /* End of file. */
@@ -0,0 +1,182 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+namespace
+{
+
+// straightforward double precision implementation of both interpolation methods
+static Vec3d refLUT3D(const Mat& lut, const double* c, bool tetrahedral)
+{
+    int n = lut.cols;
+    int idx[3];
+    double f[3];
+    for (int k = 0; k < 3; k++)
+    {
+        double x = std::min(std::max(c[k], 0.), 1.)*(n - 1);
+        idx[k] = std::min((int)std::floor(x), n - 2);
+        f[k] = x - idx[k];
+    }
+
+    Vec3d r;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        int b[] = { (corner >> 2) & 1, (corner >> 1) & 1, corner & 1 };
+        double w;
+        if (tetrahedral)
+        {
+            // barycentric weight of the corner within the tetrahedron containing the point,
+            // non-zero only for the corners on the path 000 -> 111 along the sorted axes
+            int order[] = { 0, 1, 2 };
+            for (int i = 0; i < 3; i++)
+                for (int j = i + 1; j < 3; j++)
+                    if (f[order[j]] > f[order[i]])
+                        std::swap(order[i], order[j]);
+            int nset = b[0] + b[1] + b[2];
+            bool onPath = true;
+            for (int i = 0; i < nset; i++)
+                onPath = onPath && b[order[i]] == 1;
+            if (!onPath)
+                continue;
+            double fs[] = { 1., f[order[0]], f[order[1]], f[order[2]], 0. };
+            w = fs[nset] - fs[nset + 1];
+        }
+        else
+            w = (b[0] ? f[0] : 1 - f[0])*(b[1] ? f[1] : 1 - f[1])*(b[2] ? f[2] : 1 - f[2]);
+
+        Vec3f node = lut.at<Vec3f>((idx[0] + b[0])*n + idx[1] + b[1], idx[2] + b[2]);
+        for (int k = 0; k < 3; k++)
+            r[k] += w*node[k];
+    }
+    return r;
+}
+
+static void squareGreen(const float* src, float* dst, void*)
+{
+    dst[0] = src[2];
+    dst[1] = src[1]*src[1];
+    dst[2] = src[0];
+}
+
+}
+
+TEST(Imgproc_LUT3D, identity)
+{
+    const int sizes[] = { 17, 33, 65 };
+    const int types[] = { CV_8UC3, CV_8UC4, CV_16UC3, CV_32FC3, CV_32FC4 };
+
+    for (int si = 0; si < 3; si++)
+    {
+        Mat lut;
+        bakeLUT3D(sizes[si], lut);
+        ASSERT_EQ(CV_32FC3, lut.type());
+        ASSERT_EQ(Size(sizes[si], sizes[si]*sizes[si]), lut.size());
+
+        for (int ti = 0; ti < 5; ti++)
+            for (int interp = LUT3D_INTER_TRILINEAR; interp <= LUT3D_INTER_TETRAHEDRAL; interp++)
+            {
+                SCOPED_TRACE(cv::format("size=%d type=%d interpolation=%d", sizes[si], types[ti], interp));
+                Mat src(97, 131, types[ti]), dst;
+                if (CV_MAT_DEPTH(types[ti]) == CV_32F)
+                    randu(src, 0., 1.);
+                else
+                    randu(src, 0., CV_MAT_DEPTH(types[ti]) == CV_8U ? 256. : 65536.);
+
+                applyLUT3D(src, lut, dst, interp);
+                ASSERT_EQ(src.type(), dst.type());
+                EXPECT_LE(cvtest::norm(src, dst, NORM_INF), CV_MAT_DEPTH(types[ti]) == CV_32F ? 1e-5 : 0.);
+            }
+    }
+}
+
+TEST(Imgproc_LUT3D, accuracy)
+{
+    RNG& rng = theRNG();
+    const int n = 17;
+    Mat lut(n*n, n, CV_32FC3);
+    rng.fill(lut, RNG::UNIFORM, 0., 1.);
+
+    // the same table as a 3-dimensional matrix
+    int lutSizes[] = { n, n, n };
+    Mat lut3(3, lutSizes, CV_32FC3, lut.data);
+
+    const int types[] = { CV_8UC3, CV_16UC4, CV_32FC3 };
+    for (int ti = 0; ti < 3; ti++)
+        for (int interp = LUT3D_INTER_TRILINEAR; interp <= LUT3D_INTER_TETRAHEDRAL; interp++)
+        {
+            SCOPED_TRACE(cv::format("type=%d interpolation=%d", types[ti], interp));
+            int depth = CV_MAT_DEPTH(types[ti]), cn = CV_MAT_CN(types[ti]);
+            double maxVal = depth == CV_8U ? 255. : depth == CV_16U ? 65535. : 1.;
+
+            Mat src(64, 80, types[ti]), dst, dst3;
+            if (depth == CV_32F)
+                randu(src, -0.1, 1.1);
+            else
+                randu(src, 0., maxVal + 1);
+            applyLUT3D(src, lut, dst, interp);
+            applyLUT3D(src, lut3, dst3, interp);
+            EXPECT_EQ(0, cvtest::norm(dst, dst3, NORM_INF));
+
+            Mat src64, dst64;
+            src.convertTo(src64, CV_64F, 1./maxVal);
+            dst.convertTo(dst64, CV_64F, 1./maxVal);
+            double maxErr = 0;
+            for (int y = 0; y < src.rows; y++)
+                for (int x = 0; x < src.cols; x++)
+                {
+                    const double* c = src64.ptr<double>(y) + x*cn;
+                    const double* d = dst64.ptr<double>(y) + x*cn;
+                    Vec3d r = refLUT3D(lut, c, interp == LUT3D_INTER_TETRAHEDRAL);
+                    for (int k = 0; k < 3; k++)
+                        maxErr = std::max(maxErr, std::abs(r[k] - d[k]));
+                    if (cn == 4)
+                    {
+                        ASSERT_EQ(c[3], d[3]);
+                    }
+                }
+            EXPECT_LE(maxErr, depth == CV_32F ? 1e-5 : 0.5/maxVal + 1e-6);
+        }
+}
+
+TEST(Imgproc_LUT3D, bake)
+{
+    Mat lut;
+    bakeLUT3D(65, lut, squareGreen);
+
+    Mat src(120, 160, CV_8UC3), dst;
+    randu(src, 0, 256);
+    applyLUT3D(src, lut, dst);
+
+    Mat expected(src.size(), CV_8UC3);
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+        {
+            Vec3b c = src.at<Vec3b>(y, x);
+            float g = c[1]/255.f;
+            expected.at<Vec3b>(y, x) = Vec3b(c[2], saturate_cast<uchar>(g*g*255), c[0]);
+        }
+    EXPECT_LE(cvtest::norm(expected, dst, NORM_INF), 1.);
+}
+
+TEST(Imgproc_LUT3D, threads)
+{
+    Mat lut(33*33, 33, CV_32FC3);
+    randu(lut, 0., 1.);
+    Mat src(480, 640, CV_16UC3), dst[2];
+    randu(src, 0, 65536);
+
+    int nthreads = getNumThreads();
+    for (int i = 0; i < 2; i++)
+    {
+        setNumThreads(i == 0 ? 1 : 4);
+        applyLUT3D(src, lut, dst[i]);
+    }
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, cvtest::norm(dst[0], dst[1], NORM_INF));
+}
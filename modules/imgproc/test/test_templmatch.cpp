@@ -334,3 +334,43 @@ void CV_TemplMatchTest::prepare_to_validation( int /*test_case_idx*/ )
 }
 
 TEST(Imgproc_MatchTemplate, accuracy) { CV_TemplMatchTest test; test.safe_run(); }
+
+TEST(Imgproc_MatchTemplate, batch)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32FC1 };
+    const Size templSizes[] = { Size(5, 7), Size(16, 16), Size(33, 21), Size(64, 48) };
+
+    for( int t = 0; t < 3; t++ )
+    {
+        Mat img(213, 307, types[t]);
+        rng.fill(img, RNG::UNIFORM, 0, 256);
+
+        std::vector<Mat> templs;
+        for( int i = 0; i < 4; i++ )
+        {
+            // cut the templates from the image, so the best match is well defined
+            Point ofs(rng.uniform(0, img.cols - templSizes[i].width), rng.uniform(0, img.rows - templSizes[i].height));
+            templs.push_back(img(Rect(ofs, templSizes[i])).clone());
+        }
+
+        for( int method = TM_SQDIFF; method <= TM_CCOEFF_NORMED; method++ )
+        {
+            std::vector<Mat> results;
+            matchTemplateBatch(img, templs, results, method);
+            ASSERT_EQ(templs.size(), results.size());
+
+            for( size_t i = 0; i < templs.size(); i++ )
+            {
+                Mat ref;
+                matchTemplate(img, templs[i], ref, method);
+                ASSERT_EQ(ref.size(), results[i].size());
+                ASSERT_EQ(CV_32FC1, results[i].type());
+
+                double maxRef = cvtest::norm(ref, NORM_INF);
+                EXPECT_LE(cvtest::norm(ref, results[i], NORM_INF), 1e-4*std::max(maxRef, 1.))
+                    << "type=" << types[t] << " method=" << method << " template=" << i;
+            }
+        }
+    }
+}
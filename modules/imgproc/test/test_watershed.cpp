@@ -130,3 +130,37 @@ void CV_WatershedTest::run( int /* start_from */)
 }
 
 TEST(Imgproc_Watershed, regression) { CV_WatershedTest test; test.safe_run(); }
+
+TEST(Imgproc_Watershed, threads)
+{
+    RNG rng(0x1234);
+    Mat src(480, 640, CV_8UC3);
+    rng.fill(src, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(src, src, Size(9, 9), 3);
+
+    // separate unknown areas around the seeds, and one large area with several seeds
+    Mat markers(src.size(), CV_32S, Scalar(1));
+    for (int y = 40; y < 440; y += 80)
+        for (int x = 40; x < 600; x += 80)
+        {
+            circle(markers, Point(x, y), 30, Scalar(0), FILLED);
+            circle(markers, Point(x + rng.uniform(-5, 5), y + rng.uniform(-5, 5)), 3,
+                   Scalar(2 + y/80*8 + x/80), FILLED);
+        }
+    markers(Rect(0, 300, 640, 100)).setTo(0);
+    for (int i = 0; i < 20; i++)
+        markers.at<int>(rng.uniform(300, 400), rng.uniform(0, 640)) = 100 + i;
+    for (int i = 0; i < 100; i++)
+        markers.at<int>(rng.uniform(0, 480), rng.uniform(0, 640)) = -1;
+
+    int nthreads = getNumThreads();
+    Mat m1 = markers.clone(), m2 = markers.clone();
+    setNumThreads(1);
+    watershed(src, m1);
+    setNumThreads(4);
+    watershed(src, m2);
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, countNonZero(m1 == 0));
+    EXPECT_EQ(0, cvtest::norm(m1, m2, NORM_INF));
+}